@@ -0,0 +1,381 @@
+#include "batch.hpp"
+
+#include <algorithm>
+#include <charconv>
+#include <cstdint>
+#include <exception>
+#include <optional>
+#include <system_error>
+
+namespace {
+
+constexpr std::string_view kParent = ".parent/";
+
+std::string Join(const std::vector<std::string_view>& dirs, size_t count) {
+  std::string joined;
+
+  for (size_t i = 0; i < count; ++i) {
+    joined.append(dirs[i]).push_back('/');
+  }
+
+  return joined;
+}
+
+void CheckName(std::string_view name) {
+  for (char c : name) {
+    if (uint8_t(c) < ' ' || c == ':') {
+      throw BatchError("bad name " + std::string(name));
+    }
+  }
+}
+
+std::vector<std::string_view> SplitParts(std::string_view path) {
+  std::vector<std::string_view> parts;
+
+  while (!path.empty()) {
+    size_t slash = path.find('/');
+    std::string_view part = path.substr(0, slash);
+
+    if (!part.empty() && part != ".") {
+      CheckName(part);
+      parts.push_back(part);
+    }
+
+    path.remove_prefix(slash == std::string_view::npos ? path.size()
+                                                      : slash + 1);
+  }
+
+  return parts;
+}
+
+std::vector<std::pair<std::string, std::string>>::iterator FindEntry(
+    std::vector<std::pair<std::string, std::string>>& entries,
+    std::string_view key) {
+  return std::lower_bound(
+      entries.begin(), entries.end(), key,
+      [](const auto& entry, std::string_view key) {
+        return entry.first < key;
+      });
+}
+
+bool HasKey(std::vector<std::pair<std::string, std::string>>& entries,
+            std::string_view key) {
+  auto it = FindEntry(entries, key);
+  return it != entries.end() && it->first == key;
+}
+
+void SetEntry(std::vector<std::pair<std::string, std::string>>& entries,
+              std::string key, std::string hash) {
+  auto it = FindEntry(entries, key);
+
+  if (it != entries.end() && it->first == key) {
+    it->second = std::move(hash);
+  } else {
+    entries.emplace(it, std::move(key), std::move(hash));
+  }
+}
+
+}  // namespace
+
+Batch::Path Batch::SplitPath(std::string_view path) {
+  Path split{SplitParts(path), {}};
+
+  if (!split.dirs.empty()) {
+    split.name = split.dirs.back();
+    split.dirs.pop_back();
+  }
+
+  return split;
+}
+
+std::string Batch::Rewrite(const std::string& hash, const Path& path,
+                           size_t depth, const Change& change) {
+  auto tree = cache_.Get(hash);
+
+  Entries entries;
+  entries.reserve(tree->Entries().size() + 1);
+
+  for (const auto& entry : tree->Entries()) {
+    entries.emplace_back(entry.Key(), entry.hash);
+  }
+
+  if (depth == path.dirs.size()) {
+    change(entries);
+  } else {
+    std::string key = std::string(path.dirs[depth]) + '/';
+    auto it = FindEntry(entries, key);
+
+    if (it == entries.end() || it->first != key) {
+      throw BatchError("no directory " + Join(path.dirs, depth + 1));
+    }
+
+    it->second = Rewrite(it->second, path, depth + 1, change);
+  }
+
+  // A new version links the one it was made from
+  if (depth == 0) {
+    SetEntry(entries, std::string(kParent), hash);
+  }
+
+  std::string content;
+  content.reserve(tree->Data().size() + cafs::kHashSize);
+
+  for (const auto& [key, entry_hash] : entries) {
+    content.append(key).append("\t").append(entry_hash).push_back('\n');
+  }
+
+  return cache_.WriteTree(std::move(content));
+}
+
+std::string Batch::Modify(std::string_view path, const std::string& root,
+                          const std::function<void(Entries&, const Path&)>&
+                              change) {
+  Path split = SplitPath(path);
+
+  if (split.name.empty()) {
+    throw BatchError("the path names the root");
+  }
+
+  return Rewrite(root, split, 0,
+                 [&](Entries& entries) { change(entries, split); });
+}
+
+std::string Batch::Put(std::string_view path, const std::string& root,
+                       std::string_view content) {
+  std::string blob;
+
+  return Modify(path, root, [&](Entries& entries, const Path& path) {
+    std::string name(path.name);
+
+    if (HasKey(entries, name + '/')) {
+      throw BatchError(Join(path.dirs, path.dirs.size()) + name +
+                       " is a directory");
+    }
+
+    // Written once the path is known to be good
+    if (blob.empty()) {
+      blob = cache_.WriteBlob(content);
+    }
+
+    SetEntry(entries, name + ':', blob);
+  });
+}
+
+std::string Batch::Mkdir(std::string_view path, const std::string& root) {
+  return Modify(path, root, [&](Entries& entries, const Path& path) {
+    std::string name(path.name);
+
+    if (HasKey(entries, name + ':') || HasKey(entries, name + '/')) {
+      throw BatchError(Join(path.dirs, path.dirs.size()) + name +
+                       " already exists");
+    }
+
+    SetEntry(entries, name + '/', cache_.WriteTree(""));
+  });
+}
+
+std::string Batch::Rm(std::string_view path, const std::string& root) {
+  return Modify(path, root, [&](Entries& entries, const Path& path) {
+    std::string name(path.name);
+
+    for (std::string key : {name + ':', name + '/'}) {
+      auto it = FindEntry(entries, key);
+
+      if (it != entries.end() && it->first == key) {
+        entries.erase(it);
+        return;
+      }
+    }
+
+    throw BatchError("no file or directory " +
+                     Join(path.dirs, path.dirs.size()) + name);
+  });
+}
+
+std::string Batch::ResolveDir(const std::string& root,
+                              const std::vector<std::string_view>& dirs) {
+  std::string hash = root;
+
+  for (size_t i = 0; i < dirs.size(); ++i) {
+    auto tree = cache_.Get(hash);
+    const cafs::TreeEntry* entry = tree->Find(std::string(dirs[i]) + '/');
+
+    if (entry == nullptr) {
+      throw BatchError("no directory " + Join(dirs, i + 1));
+    }
+
+    hash = entry->hash;
+  }
+
+  return hash;
+}
+
+cafs::Object Batch::Get(std::string_view path, const std::string& root) {
+  Path split = SplitPath(path);
+
+  if (split.name.empty()) {
+    throw BatchError("the path names the root");
+  }
+
+  auto tree = cache_.Get(ResolveDir(root, split.dirs));
+  std::string name(split.name);
+
+  if (const cafs::TreeEntry* entry = tree->Find(name + ':')) {
+    return cache_.ReadBlob(std::string(entry->hash));
+  }
+
+  std::string full = Join(split.dirs, split.dirs.size()) + name;
+
+  if (tree->Find(name + '/') != nullptr) {
+    throw BatchError(full + " is a directory");
+  }
+
+  throw BatchError("no file " + full);
+}
+
+std::string Batch::Ls(std::string_view path, const std::string& root) {
+  Path split = SplitPath(path);
+
+  // The dir is the whole path here, its last part included
+  if (!split.name.empty()) {
+    split.dirs.push_back(split.name);
+  }
+
+  std::string out;
+  List(ResolveDir(root, split.dirs), "", out);
+  return out;
+}
+
+void Batch::List(const std::string& hash, const std::string& prefix,
+                 std::string& out) {
+  // Held while the subtrees are listed, which may push it out of the cache
+  auto tree = cache_.Get(hash);
+
+  for (const auto& entry : tree->Entries()) {
+    if (entry.Key() == kParent) {
+      continue;
+    }
+
+    if (entry.type == cafs::EntryType::Blob) {
+      out.append(prefix).append(entry.name).push_back('\n');
+    } else {
+      std::string dir = prefix + std::string(entry.Key());
+      out.append(dir).push_back('\n');
+      List(std::string(entry.hash), dir, out);
+    }
+  }
+}
+
+namespace {
+
+std::vector<std::string_view> SplitFields(std::string_view line) {
+  std::vector<std::string_view> fields;
+
+  while (true) {
+    size_t tab = line.find('\t');
+    fields.push_back(line.substr(0, tab));
+
+    if (tab == std::string_view::npos) {
+      return fields;
+    }
+
+    line.remove_prefix(tab + 1);
+  }
+}
+
+// The size of the content that follows "put\t<path>\t<root-hash>\t<size>"
+std::optional<size_t> PutSize(const std::vector<std::string_view>& fields) {
+  if (fields.size() != 4) {
+    return std::nullopt;
+  }
+
+  std::string_view field = fields[3];
+  size_t size = 0;
+  auto [end, error] =
+      std::from_chars(field.data(), field.data() + field.size(), size);
+
+  if (error != std::errc{} || end != field.data() + field.size()) {
+    return std::nullopt;
+  }
+
+  return size;
+}
+
+void Answer(std::ostream& out, std::string_view data) {
+  out << data.size() << '\n';
+  out.write(data.data(), data.size());
+  out << '\n';
+}
+
+}  // namespace
+
+bool Serve(Batch& batch, std::istream& in, std::ostream& out, bool buffered) {
+  std::string line;
+  std::string content;
+
+  while (std::getline(in, line)) {
+    // Also the optional '\n' after the content of a put
+    if (line.empty()) {
+      continue;
+    }
+
+    std::vector<std::string_view> fields = SplitFields(line);
+    std::string_view command = fields[0];
+
+    // The content of a put that can not be framed would be read as
+    // commands, so nothing after it can be trusted
+    if (command == "put") {
+      std::optional<size_t> size = PutSize(fields);
+
+      if (!size) {
+        out << "error\tbad put, the rest of the input is dropped\n";
+        out.flush();
+        return false;
+      }
+
+      try {
+        content.resize(*size);
+      } catch (const std::exception&) {
+        out << "error\tthe content does not fit in memory\n";
+        out.flush();
+        return false;
+      }
+
+      if (!in.read(content.data(), *size)) {
+        out << "error\tthe input ends inside the content\n";
+        out.flush();
+        return false;
+      }
+    }
+
+    try {
+      if (command == "put") {
+        out << batch.Put(fields[1], std::string(fields[2]), content) << '\n';
+      } else if (command == "mkdir" && fields.size() == 3) {
+        out << batch.Mkdir(fields[1], std::string(fields[2])) << '\n';
+      } else if (command == "rm" && fields.size() == 3) {
+        out << batch.Rm(fields[1], std::string(fields[2])) << '\n';
+      } else if (command == "get" && fields.size() == 3) {
+        Answer(out, batch.Get(fields[1], std::string(fields[2])).View());
+      } else if (command == "ls" && fields.size() == 3) {
+        Answer(out, batch.Ls(fields[1], std::string(fields[2])));
+      } else if (command == "has" && fields.size() == 2) {
+        out << (batch.Has(std::string(fields[1])) ? "present\n" : "missing\n");
+      } else {
+        throw BatchError("bad command " + std::string(command) + " with " +
+                         std::to_string(fields.size() - 1) + " arguments");
+      }
+    } catch (const BatchError& err) {
+      out << "error\t" << err.what() << '\n';
+    } catch (const std::system_error& err) {
+      out << "error\t" << err.what() << '\n';
+    }
+
+    if (!buffered) {
+      out.flush();
+    }
+  }
+
+  out.flush();
+  return true;
+}
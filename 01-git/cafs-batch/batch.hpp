@@ -0,0 +1,85 @@
+#pragma once
+
+#include <functional>
+#include <istream>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "tree_cache.hpp"
+
+// The CAFS commands on one store, sharing a TreeCache. A path is
+// "a/b/name" from the root; empty parts are skipped, so "dir/" and "."
+// are fine too. Commands that change the tree answer with the hash of
+// the new root, which links the given root as its `.parent/`. All throw
+// BatchError if the command can not be done, leaving the tree as it was.
+class Batch {
+ public:
+  explicit Batch(TreeCache& cache) : cache_(cache) {}
+
+  std::string Put(std::string_view path, const std::string& root,
+                  std::string_view content);
+  std::string Mkdir(std::string_view path, const std::string& root);
+  std::string Rm(std::string_view path, const std::string& root);
+
+  cafs::Object Get(std::string_view path, const std::string& root);
+
+  // Every entry under the dir but `.parent/`, one path relative to the
+  // dir per line, dirs with their trailing '/', in tree order
+  std::string Ls(std::string_view path, const std::string& root);
+
+  bool Has(const std::string& hash) {
+    return cache_.Has(hash);
+  }
+
+ private:
+  // "name:" or "name/" to the hash, sorted as in a tree object
+  using Entries = std::vector<std::pair<std::string, std::string>>;
+  using Change = std::function<void(Entries&)>;
+
+  struct Path {
+    std::vector<std::string_view> dirs;
+    // Empty for the root
+    std::string_view name;
+  };
+
+  // Throws BatchError on a name the format does not allow
+  static Path SplitPath(std::string_view path);
+
+  // The tree at hash with change applied to the entries of the dir at
+  // path.dirs, written bottom-up, the root linking hash as `.parent/`;
+  // returns the hash of the new root
+  std::string Rewrite(const std::string& hash, const Path& path,
+                      size_t depth, const Change& change);
+
+  // Rewrite of the entries of the dir that holds path.name
+  std::string Modify(std::string_view path, const std::string& root,
+                     const std::function<void(Entries&, const Path&)>& change);
+
+  // The hash of the dir at dirs
+  std::string ResolveDir(const std::string& root,
+                         const std::vector<std::string_view>& dirs);
+  void List(const std::string& hash, const std::string& prefix,
+            std::string& out);
+
+  TreeCache& cache_;
+};
+
+// Answers the commands read from in, one per line, until the end of it:
+//
+//   put\t<path>\t<root-hash>\t<size>   and <size> bytes of content
+//   mkdir\t<path>\t<root-hash>
+//   rm\t<path>\t<root-hash>
+//   get\t<path>\t<root-hash>
+//   ls\t<path>\t<root-hash>
+//   has\t<hash>
+//
+// A change answers "<new-root-hash>\n", get and ls "<size>\n<data>\n",
+// has "present\n" or "missing\n", a failed command "error\t<reason>\n".
+// Unless buffered, out is flushed after every answer, so that the caller
+// can read it before sending the next command. A put whose content can
+// not be framed, for a bad size or field count or the end of in inside
+// the content, is answered with an error and ends the batch: false.
+bool Serve(Batch& batch, std::istream& in, std::ostream& out, bool buffered);
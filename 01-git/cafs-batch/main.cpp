@@ -0,0 +1,55 @@
+#include <charconv>
+#include <cstdlib>
+#include <iostream>
+#include <limits>
+#include <string>
+#include <string_view>
+#include <system_error>
+
+#include "batch.hpp"
+#include "tree_cache.hpp"
+
+namespace {
+
+constexpr size_t kDefaultCacheMb = 256;
+
+void Usage(const char* name) {
+  std::cerr << "Usage: " << name << " [--buffer] [--cache-mb <size>]"
+            << std::endl;
+  std::exit(1);
+}
+
+// False unless arg is a size in megabytes whose bytes fit in size_t
+bool ParseCacheMb(std::string_view arg, size_t& cache_mb) {
+  auto [end, error] =
+      std::from_chars(arg.data(), arg.data() + arg.size(), cache_mb);
+  return error == std::errc{} && end == arg.data() + arg.size() &&
+         cache_mb <= std::numeric_limits<size_t>::max() >> 20;
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  bool buffered = false;
+  size_t cache_mb = kDefaultCacheMb;
+
+  for (int i = 1; i < argc; ++i) {
+    const std::string arg{argv[i]};
+
+    if (arg == "--buffer") {
+      buffered = true;
+    } else if (arg == "--cache-mb" && i + 1 < argc &&
+               ParseCacheMb(argv[i + 1], cache_mb)) {
+      ++i;
+    } else {
+      Usage(argv[0]);
+    }
+  }
+
+  std::ios::sync_with_stdio(false);
+
+  TreeCache cache{cafs::ObjectStore::Current(), cache_mb << 20};
+  Batch batch{cache};
+
+  return Serve(batch, std::cin, std::cout, buffered) ? 0 : 1;
+}
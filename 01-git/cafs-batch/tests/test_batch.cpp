@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <sstream>
+#include <string>
+
+#include "batch.hpp"
+#include "tree_cache.hpp"
+
+namespace {
+
+class ServeTest : public ::testing::Test {
+ protected:
+  ServeTest()
+      : dir_(MakeDir()), store_(dir_), cache_(store_, 1 << 20),
+        batch_(cache_), empty_(cache_.WriteTree("")) {}
+
+  ~ServeTest() override {
+    std::filesystem::remove_all(dir_);
+  }
+
+  static std::string MakeDir() {
+    std::string dir =
+        (std::filesystem::temp_directory_path() / "cafs-batch-XXXXXX")
+            .string();
+    EXPECT_NE(mkdtemp(dir.data()), nullptr);
+    return dir;
+  }
+
+  // The answers to input, and what Serve returned
+  std::string Run(const std::string& input, bool* ok = nullptr) {
+    std::istringstream in(input);
+    std::ostringstream out;
+    bool served = Serve(batch_, in, out, false);
+
+    if (ok != nullptr) {
+      *ok = served;
+    }
+
+    return out.str();
+  }
+
+  // The root hash a change answers with
+  std::string NewRoot(const std::string& input) {
+    return Run(input).substr(0, cafs::kHashSize);
+  }
+
+  std::string Object(const std::string& hash) {
+    auto object = store_.Read(hash);
+    EXPECT_TRUE(object.has_value()) << hash;
+    return object ? std::string(object->View()) : "";
+  }
+
+  std::string dir_;
+  cafs::ObjectStore store_;
+  TreeCache cache_;
+  Batch batch_;
+  std::string empty_;
+};
+
+}  // namespace
+
+TEST_F(ServeTest, PutWritesBlobAndLinksParent) {
+  bool ok = false;
+  std::string answer = Run("put\ta.txt\t" + empty_ + "\t5\nhello\n", &ok);
+
+  ASSERT_TRUE(ok);
+  ASSERT_EQ(answer.size(), cafs::kHashSize + 1);
+  EXPECT_EQ(Object(answer.substr(0, cafs::kHashSize)),
+            ".parent/\t" + empty_ + "\na.txt:\t" +
+                cafs::ObjectStore::Hash("hello") + "\n");
+}
+
+TEST_F(ServeTest, ParentIsLinkedAtRootOnly) {
+  std::string root = NewRoot("mkdir\td\t" + empty_ + "\n");
+  std::string next = NewRoot("put\td/f\t" + root + "\t1\nx");
+
+  std::string tree = Object(next);
+  EXPECT_NE(tree.find(".parent/\t" + root + "\n"), std::string::npos);
+
+  std::string dir_hash = tree.substr(tree.find("d/\t") + 3, cafs::kHashSize);
+  EXPECT_EQ(Object(dir_hash), "f:\t" + cafs::ObjectStore::Hash("x") + "\n");
+}
+
+TEST_F(ServeTest, GetAndLsAnswersAreSized) {
+  std::string root = NewRoot("put\tf\t" + empty_ + "\t4\na\n\nb\n");
+  root = NewRoot("mkdir\td\t" + root + "\n");
+
+  EXPECT_EQ(Run("get\tf\t" + root + "\nls\t.\t" + root + "\n"),
+            "4\na\n\nb\n5\nd/\nf\n\n");
+}
+
+TEST_F(ServeTest, FailedCommandsAnswerErrorAndGoOn) {
+  bool ok = false;
+  std::string answer = Run("get\tnope\t" + empty_ + "\nmkdir\ta:b\t" +
+                               empty_ + "\nfrob\nhas\t" + empty_ + "\n",
+                           &ok);
+
+  EXPECT_TRUE(ok);
+  EXPECT_EQ(answer,
+            "error\tno file nope\n"
+            "error\tbad name a:b\n"
+            "error\tbad command frob with 0 arguments\n"
+            "present\n");
+}
+
+TEST_F(ServeTest, PutWithBadSizeEndsTheBatch) {
+  bool ok = true;
+  std::string answer =
+      Run("put\ta\t" + empty_ + "\tx\nrm\ta\t" + empty_ + "\n", &ok);
+
+  EXPECT_FALSE(ok);
+  EXPECT_EQ(answer, "error\tbad put, the rest of the input is dropped\n");
+}
+
+TEST_F(ServeTest, PutWithoutSizeEndsTheBatch) {
+  bool ok = true;
+  std::string answer =
+      Run("put\ta\t" + empty_ + "\nhas\t" + empty_ + "\n", &ok);
+
+  EXPECT_FALSE(ok);
+  EXPECT_EQ(answer, "error\tbad put, the rest of the input is dropped\n");
+}
+
+TEST_F(ServeTest, TruncatedContentEndsTheBatch) {
+  bool ok = true;
+  std::string answer = Run("put\ta\t" + empty_ + "\t10\nabc", &ok);
+
+  EXPECT_FALSE(ok);
+  EXPECT_EQ(answer, "error\tthe input ends inside the content\n");
+}
+
+TEST_F(ServeTest, RejectedPutKeepsFraming) {
+  std::string root = NewRoot("mkdir\td\t" + empty_ + "\n");
+
+  // The content is consumed even though the put fails
+  EXPECT_EQ(Run("put\td\t" + root + "\t6\nhas\tx\nhas\t" + empty_ + "\n"),
+            "error\td is a directory\npresent\n");
+}
@@ -0,0 +1,116 @@
+#include "tree_cache.hpp"
+
+#include <algorithm>
+#include <utility>
+
+Tree::Tree(std::string data)
+    : data_(std::move(data)), entries_(cafs::ParseTree(data_)) {}
+
+const cafs::TreeEntry* Tree::Find(std::string_view key) const {
+  // The parser has checked the lines are strictly sorted by key
+  auto it = std::lower_bound(
+      entries_.begin(), entries_.end(), key,
+      [](const cafs::TreeEntry& entry, std::string_view key) {
+        return entry.Key() < key;
+      });
+
+  if (it == entries_.end() || it->Key() != key) {
+    return nullptr;
+  }
+
+  return &*it;
+}
+
+TreeCache::TreeCache(cafs::ObjectStore& store, size_t max_bytes)
+    : store_(store), max_bytes_(max_bytes) {}
+
+std::shared_ptr<const Tree> TreeCache::Get(const std::string& hash) {
+  if (auto it = trees_.find(hash); it != trees_.end()) {
+    uses_.splice(uses_.begin(), uses_, it->second.use);
+    return it->second.tree;
+  }
+
+  auto object = store_.Read(hash);
+  if (!object) {
+    throw BatchError("no object " + hash);
+  }
+
+  std::shared_ptr<const Tree> tree;
+  try {
+    tree = std::make_shared<const Tree>(std::string(object->View()));
+  } catch (const cafs::TreeError& err) {
+    throw BatchError("bad directory " + hash + ": " + err.what());
+  }
+
+  known_.insert(hash);
+  Insert(hash, tree);
+  return tree;
+}
+
+std::string TreeCache::WriteBlob(std::string_view content) {
+  std::string hash = cafs::ObjectStore::Hash(content);
+
+  if (known_.count(hash) == 0) {
+    store_.Write(content);
+    known_.insert(hash);
+  }
+
+  return hash;
+}
+
+std::string TreeCache::WriteTree(std::string content) {
+  // Parsed before it is written, so a bad tree never gets to the store
+  std::shared_ptr<const Tree> tree;
+  try {
+    tree = std::make_shared<const Tree>(std::move(content));
+  } catch (const cafs::TreeError& err) {
+    throw BatchError(std::string("bad new directory: ") + err.what());
+  }
+
+  std::string hash = WriteBlob(tree->Data());
+
+  if (trees_.count(hash) == 0) {
+    Insert(hash, std::move(tree));
+  }
+
+  return hash;
+}
+
+cafs::Object TreeCache::ReadBlob(const std::string& hash) {
+  auto object = store_.Read(hash);
+  if (!object) {
+    throw BatchError("no object " + hash);
+  }
+
+  known_.insert(hash);
+  return std::move(*object);
+}
+
+bool TreeCache::Has(const std::string& hash) {
+  if (known_.count(hash) != 0) {
+    return true;
+  }
+
+  // A miss is not remembered: another process may write the object
+  if (!store_.Has(hash)) {
+    return false;
+  }
+
+  known_.insert(hash);
+  return true;
+}
+
+void TreeCache::Insert(const std::string& hash,
+                       std::shared_ptr<const Tree> tree) {
+  bytes_ += tree->Data().size();
+  uses_.push_front(hash);
+  trees_.emplace(hash, Slot{std::move(tree), uses_.begin()});
+
+  // The tree just added stays even if it alone is over the limit
+  while (bytes_ > max_bytes_ && uses_.size() > 1) {
+    auto it = trees_.find(uses_.back());
+    bytes_ -= it->second.tree->Data().size();
+    trees_.erase(it);
+    uses_.pop_back();
+  }
+}
@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <list>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include "cafs/object_store.hpp"
+#include "cafs/tree.hpp"
+
+// A command that can not be done; the server answers it with an error
+// and goes on to the next one
+class BatchError : public std::runtime_error {
+ public:
+  using std::runtime_error::runtime_error;
+};
+
+// A parsed tree object. The entries point into data, which the tree
+// owns and never moves.
+class Tree {
+ public:
+  // Throws cafs::TreeError
+  explicit Tree(std::string data);
+
+  Tree(const Tree&) = delete;
+  Tree& operator=(const Tree&) = delete;
+
+  std::string_view Data() const {
+    return data_;
+  }
+
+  const std::vector<cafs::TreeEntry>& Entries() const {
+    return entries_;
+  }
+
+  // The entry with this "name:" or "name/" key, nullptr if there is none
+  const cafs::TreeEntry* Find(std::string_view key) const;
+
+ private:
+  std::string data_;
+  std::vector<cafs::TreeEntry> entries_;
+};
+
+// Objects of one store as seen across the commands of a batch. The
+// content of an object never changes, so both caches stay valid for as
+// long as the process runs, even if a repack moves objects into a pack
+// meanwhile, which the store picks up on a miss:
+//  - trees parsed once, kept up to max_bytes of content, least recently
+//    used dropped first;
+//  - hashes of every object read, written or found, so that writing an
+//    object the store has already costs no file system call.
+class TreeCache {
+ public:
+  TreeCache(cafs::ObjectStore& store, size_t max_bytes);
+
+  // Throws BatchError if the tree is missing or malformed
+  std::shared_ptr<const Tree> Get(const std::string& hash);
+
+  // The hash of the content, written unless already in the store
+  std::string WriteBlob(std::string_view content);
+
+  // The hash of the tree, written unless already in the store; the
+  // parsed tree goes to the cache, as the next command likely reads it.
+  // Throws BatchError if the content is not a valid tree.
+  std::string WriteTree(std::string content);
+
+  // The blob's content; throws BatchError if it is missing
+  cafs::Object ReadBlob(const std::string& hash);
+
+  bool Has(const std::string& hash);
+
+ private:
+  struct Slot {
+    std::shared_ptr<const Tree> tree;
+    std::list<std::string>::iterator use;
+  };
+
+  void Insert(const std::string& hash, std::shared_ptr<const Tree> tree);
+
+  cafs::ObjectStore& store_;
+  size_t max_bytes_;
+  size_t bytes_ = 0;
+
+  // Most recently used first
+  std::list<std::string> uses_;
+  std::unordered_map<std::string, Slot> trees_;
+
+  std::unordered_set<std::string> known_;
+};
@@ -0,0 +1,182 @@
+// Parses a generated tree object with the shared parser and with the
+// regex and iostream parsers it replaced, printing the best time of
+// each over a few rounds.
+//
+//   bench_tree [entries] [rounds]
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <map>
+#include <random>
+#include <regex>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "cafs/tree.hpp"
+
+namespace {
+
+// Sorted lines of random names, a tenth of them subtrees
+std::string MakeTree(size_t entries) {
+  std::mt19937_64 random(42);
+  std::map<std::string, std::string> lines;
+  const char* hex = "0123456789abcdef";
+
+  while (lines.size() < entries) {
+    std::string name = "file_" + std::to_string(random() % (entries * 16));
+    name += random() % 10 == 0 ? "/" : ".txt:";
+
+    std::string hash(cafs::kHashSize, '0');
+    for (char& c : hash) {
+      c = hex[random() % 16];
+    }
+
+    lines.emplace(std::move(name), std::move(hash));
+  }
+
+  std::string tree;
+  for (const auto& [name, hash] : lines) {
+    tree += name + "\t" + hash + "\n";
+  }
+
+  return tree;
+}
+
+// rm-artemenko, Tree::ParseLine over getline
+size_t ParseRegexRm(const std::string& tree) {
+  static const std::regex blob_matcher("^([^\t :/]+):\t([a-fA-F0-9]{64})$");
+  static const std::regex tree_matcher("^([^\t :/]+)/\t([a-fA-F0-9]{64})$");
+
+  std::istringstream stream{tree};
+  size_t count = 0;
+
+  for (std::string line; std::getline(stream, line);) {
+    std::smatch pieces_match;
+
+    if (!std::regex_match(line, pieces_match, blob_matcher) &&
+        !std::regex_match(line, pieces_match, tree_matcher)) {
+      throw std::logic_error("incorrect format of tree file");
+    }
+
+    std::string name = pieces_match[1].str();
+    std::string hash = pieces_match[2].str();
+    count += name.size() + hash.size() > 0;
+  }
+
+  return count;
+}
+
+// check-alasheev, parseDir
+size_t ParseRegexCheck(const std::string& tree) {
+  static const std::regex line_regex(R"(^(\S+[:/])\t(\w+)$)");
+
+  std::map<std::string, std::string> hash_by_name;
+  std::vector<std::string> lines;
+  std::istringstream dir{tree};
+
+  for (std::string line; std::getline(dir, line);) {
+    if (!std::regex_match(line, line_regex)) {
+      throw std::logic_error("line don't match regex");
+    }
+
+    lines.push_back(line);
+    std::istringstream ss{line};
+    std::string name;
+    std::string hash;
+    ss >> name >> hash;
+
+    if (hash_by_name.count(name)) {
+      throw std::logic_error("duplicate name");
+    }
+
+    hash_by_name.emplace_hint(hash_by_name.end(), std::move(name),
+                              std::move(hash));
+  }
+
+  if (!std::is_sorted(lines.begin(), lines.end())) {
+    throw std::logic_error("not sorted");
+  }
+
+  return hash_by_name.size();
+}
+
+// put-osetrov, ParseDir with no checks at all
+size_t ParseStreamPut(const std::string& tree) {
+  std::map<std::string, std::string> hash_by_name;
+  std::istringstream dir{tree};
+
+  for (std::string line; std::getline(dir, line);) {
+    std::string name;
+    std::string hash;
+    std::istringstream ss{line};
+    ss >> name >> hash;
+
+    hash_by_name.emplace_hint(hash_by_name.end(), std::move(name),
+                              std::move(hash));
+  }
+
+  return hash_by_name.size();
+}
+
+size_t ParseShared(const std::string& tree) {
+  return cafs::ParseTree(tree).size();
+}
+
+// The shared parser filling the map put-osetrov keeps
+size_t ParseSharedMap(const std::string& tree) {
+  std::map<std::string, std::string> hash_by_name;
+
+  for (const cafs::TreeEntry& entry : cafs::ParseTree(tree)) {
+    hash_by_name.emplace_hint(hash_by_name.end(), entry.Key(), entry.hash);
+  }
+
+  return hash_by_name.size();
+}
+
+void Run(const char* name,
+         const std::function<size_t(const std::string&)>& parse,
+         const std::string& tree, size_t entries, size_t rounds) {
+  double best = 0;
+
+  for (size_t i = 0; i < rounds; ++i) {
+    auto start = std::chrono::steady_clock::now();
+    size_t count = parse(tree);
+    std::chrono::duration<double> elapsed =
+        std::chrono::steady_clock::now() - start;
+
+    if (count != entries) {
+      std::fprintf(stderr, "%s: parsed %zu of %zu entries\n", name, count,
+                   entries);
+      std::exit(1);
+    }
+
+    if (i == 0 || elapsed.count() < best) {
+      best = elapsed.count();
+    }
+  }
+
+  std::printf("%-20s %10.2f ms %10.1f MiB/s %8.1f ns/entry\n", name,
+              best * 1e3, tree.size() / best / (1 << 20),
+              best * 1e9 / entries);
+}
+
+}  // namespace
+
+int main(int argc, char** argv) {
+  size_t entries = argc > 1 ? std::stoul(argv[1]) : 100000;
+  size_t rounds = argc > 2 ? std::stoul(argv[2]) : 5;
+
+  std::string tree = MakeTree(entries);
+  std::printf("%zu entries, %zu bytes\n", entries, tree.size());
+
+  Run("regex rm", ParseRegexRm, tree, entries, rounds);
+  Run("regex check", ParseRegexCheck, tree, entries, rounds);
+  Run("iostream put", ParseStreamPut, tree, entries, rounds);
+  Run("cafs::ParseTree", ParseShared, tree, entries, rounds);
+  Run("cafs::ParseTree+map", ParseSharedMap, tree, entries, rounds);
+}
@@ -0,0 +1,65 @@
+#pragma once
+
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <objstore.h>
+
+namespace cafs {
+
+// An object read from the store. An unpacked one is mapped until the
+// object goes, a packed one points into the pack the store keeps mapped.
+class Object {
+ public:
+  Object(Object&& other) noexcept;
+  Object& operator=(Object&& other) noexcept;
+  ~Object();
+
+  Object(const Object&) = delete;
+  Object& operator=(const Object&) = delete;
+
+  std::string_view View() const {
+    return {reinterpret_cast<const char*>(data_.data), data_.len};
+  }
+
+ private:
+  friend class ObjectStore;
+
+  Object() = default;
+
+  obj_data_t data_{};
+};
+
+// The objstore library: flat files, loose objects under ab/cd/ fanout
+// dirs and packs in pack/ behind one interface. New objects are written
+// flat, or loose once the store is sharded
+class ObjectStore {
+ public:
+  // Throws std::system_error if the store can not be opened
+  explicit ObjectStore(const std::string& root);
+  ~ObjectStore();
+
+  ObjectStore(const ObjectStore&) = delete;
+  ObjectStore& operator=(const ObjectStore&) = delete;
+
+  // The store in the working directory, where the tools run
+  static ObjectStore& Current();
+
+  // The name an object with this content has, stored or not
+  static std::string Hash(std::string_view content);
+
+  bool Has(std::string_view hash) const;
+
+  // std::nullopt if the store has no such object
+  std::optional<Object> Read(std::string_view hash) const;
+
+  // The hash of the content, written unless already stored; throws
+  // std::system_error
+  std::string Write(std::string_view content);
+
+ private:
+  obj_store_t* store_;
+};
+
+}  // namespace cafs
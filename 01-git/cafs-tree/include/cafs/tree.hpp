@@ -0,0 +1,94 @@
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace cafs {
+
+// Length of an object name, the hex SHA-256 of its content
+inline constexpr size_t kHashSize = 64;
+
+enum class EntryType {
+  Blob,
+  Tree,
+};
+
+// One line of a tree object. The views point into the parsed buffer.
+struct TreeEntry {
+  std::string_view name;
+  std::string_view hash;
+  EntryType type;
+
+  // The name with its ':' or '/' suffix, the key lines are sorted by
+  std::string_view Key() const {
+    return {name.data(), name.size() + 1};
+  }
+};
+
+class TreeError : public std::runtime_error {
+ public:
+  TreeError(size_t line, const std::string& reason)
+      : std::runtime_error("line " + std::to_string(line) + ": " + reason),
+        line_(line) {}
+
+  // Zero-based line of the problem
+  size_t Line() const {
+    return line_;
+  }
+
+ private:
+  size_t line_;
+};
+
+// Reads a tree object line by line, checking each in the same scan:
+// the name charset, the `:\t` or `/\t` separator, 64 lowercase hex
+// digits, the final `\n`, and that the line sorts strictly after the
+// previous one. Throws TreeError on the first violation.
+class TreeParser {
+ public:
+  explicit TreeParser(std::string_view data) : data_(data) {}
+
+  // False at the end of the object
+  bool Next(TreeEntry& entry);
+
+  // Lines read so far
+  size_t Line() const {
+    return line_;
+  }
+
+ private:
+  std::string_view data_;
+  size_t offset_ = 0;
+  size_t line_ = 0;
+  std::string_view previous_;
+};
+
+// All the entries of a tree object, in order
+std::vector<TreeEntry> ParseTree(std::string_view data);
+
+// A read-only private mapping of a whole file; throws std::system_error
+// if the file can not be opened or mapped
+class MappedFile {
+ public:
+  explicit MappedFile(const std::string& path);
+  ~MappedFile();
+
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  MappedFile(MappedFile&& other) noexcept;
+  MappedFile& operator=(MappedFile&& other) noexcept;
+
+  std::string_view View() const {
+    return {data_, size_};
+  }
+
+ private:
+  const char* data_ = nullptr;
+  size_t size_ = 0;
+};
+
+}  // namespace cafs
@@ -0,0 +1,86 @@
+#include "cafs/object_store.hpp"
+
+#include <cerrno>
+#include <system_error>
+#include <utility>
+
+#include "cafs/tree.hpp"
+
+namespace cafs {
+
+Object::Object(Object&& other) noexcept
+    : data_(std::exchange(other.data_, obj_data_t{})) {}
+
+Object& Object::operator=(Object&& other) noexcept {
+  if (this != &other) {
+    obj_store_release(&data_);
+    data_ = std::exchange(other.data_, obj_data_t{});
+  }
+
+  return *this;
+}
+
+Object::~Object() {
+  obj_store_release(&data_);
+}
+
+ObjectStore::ObjectStore(const std::string& root)
+    : store_(obj_store_open(root.c_str())) {
+  if (store_ == nullptr) {
+    throw std::system_error(errno, std::generic_category(), root);
+  }
+}
+
+ObjectStore::~ObjectStore() {
+  obj_store_close(store_);
+}
+
+ObjectStore& ObjectStore::Current() {
+  static ObjectStore store(".");
+  return store;
+}
+
+std::string ObjectStore::Hash(std::string_view content) {
+  std::string hash(kHashSize, '0');
+  obj_store_hash(reinterpret_cast<const unsigned char*>(content.data()),
+                 content.size(), reinterpret_cast<unsigned char*>(hash.data()));
+  return hash;
+}
+
+bool ObjectStore::Has(std::string_view hash) const {
+  return hash.size() == kHashSize &&
+         obj_store_has(store_, reinterpret_cast<const unsigned char*>(
+                                   hash.data())) != 0;
+}
+
+std::optional<Object> ObjectStore::Read(std::string_view hash) const {
+  if (hash.size() != kHashSize) {
+    return std::nullopt;
+  }
+
+  Object object;
+
+  if (obj_store_read(store_,
+                     reinterpret_cast<const unsigned char*>(hash.data()),
+                     &object.data_) != 0) {
+    return std::nullopt;
+  }
+
+  return object;
+}
+
+std::string ObjectStore::Write(std::string_view content) {
+  std::string hash(kHashSize, '0');
+
+  if (obj_store_write(store_,
+                      reinterpret_cast<const unsigned char*>(content.data()),
+                      content.size(),
+                      reinterpret_cast<unsigned char*>(hash.data())) != 0) {
+    throw std::system_error(errno, std::generic_category(),
+                            "failed to write object");
+  }
+
+  return hash;
+}
+
+}  // namespace cafs
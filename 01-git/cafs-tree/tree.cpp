@@ -0,0 +1,225 @@
+#include "cafs/tree.hpp"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <array>
+#include <cerrno>
+#include <cstdint>
+#include <cstdio>
+#include <system_error>
+#include <utility>
+
+namespace cafs {
+
+namespace {
+
+constexpr uint8_t kNameByte = 1;
+constexpr uint8_t kHexDigit = 2;
+
+// Byte classes: a name is UTF-8 of space and above but the separators,
+// a hash is lowercase hex
+constexpr std::array<uint8_t, 256> kByteClass = [] {
+  std::array<uint8_t, 256> classes{};
+
+  for (size_t c = ' '; c < classes.size(); ++c) {
+    classes[c] = kNameByte;
+  }
+
+  classes[':'] = 0;
+  classes['/'] = 0;
+
+  for (char c = '0'; c <= '9'; ++c) {
+    classes[uint8_t(c)] |= kHexDigit;
+  }
+
+  for (char c = 'a'; c <= 'f'; ++c) {
+    classes[uint8_t(c)] |= kHexDigit;
+  }
+
+  return classes;
+}();
+
+uint8_t ClassOf(char c) {
+  return kByteClass[uint8_t(c)];
+}
+
+std::string ByteName(char c) {
+  char name[8];
+  std::snprintf(name, sizeof(name), "0x%02x", unsigned(uint8_t(c)));
+  return name;
+}
+
+}  // namespace
+
+bool TreeParser::Next(TreeEntry& entry) {
+  if (offset_ == data_.size()) {
+    return false;
+  }
+
+  const char* begin = data_.data() + offset_;
+  const char* end = data_.data() + data_.size();
+  const char* p = begin;
+
+  // Sign of the comparison to the previous key, decided on the first
+  // byte that differs while the name is scanned
+  int order = previous_.empty() ? 1 : 0;
+
+  for (; p != end && (ClassOf(*p) & kNameByte); ++p) {
+    size_t i = p - begin;
+
+    if (order == 0 && i == previous_.size()) {
+      order = 1;
+    } else if (order == 0 && *p != previous_[i]) {
+      order = uint8_t(*p) < uint8_t(previous_[i]) ? -1 : 1;
+    }
+  }
+
+  if (p == end) {
+    throw TreeError(line_, "line is not terminated");
+  }
+
+  if (*p != ':' && *p != '/') {
+    if (*p == '\t') {
+      throw TreeError(line_, "no ':' or '/' before the tab");
+    }
+    throw TreeError(line_, ByteName(*p) + " is not allowed in a name");
+  }
+
+  if (p == begin) {
+    throw TreeError(line_, "empty name");
+  }
+
+  // The suffix is the last byte of the key
+  size_t key_size = p - begin + 1;
+
+  if (order == 0 && key_size - 1 == previous_.size()) {
+    order = 1;
+  } else if (order == 0 && *p != previous_[key_size - 1]) {
+    order = uint8_t(*p) < uint8_t(previous_[key_size - 1]) ? -1 : 1;
+  }
+
+  if (order == 0) {
+    throw TreeError(line_, key_size == previous_.size()
+                               ? "duplicate name"
+                               : "not sorted after the previous line");
+  }
+
+  if (order < 0) {
+    throw TreeError(line_, "not sorted after the previous line");
+  }
+
+  EntryType type = *p == ':' ? EntryType::Blob : EntryType::Tree;
+  ++p;
+
+  if (p == end || *p != '\t') {
+    throw TreeError(line_, "no tab after the name");
+  }
+  ++p;
+
+  if (size_t(end - p) < kHashSize) {
+    throw TreeError(line_, "hash is not 64 lowercase hex digits");
+  }
+
+  uint8_t hex = kHexDigit;
+
+  for (size_t i = 0; i < kHashSize; ++i) {
+    hex &= ClassOf(p[i]);
+  }
+
+  if (hex == 0) {
+    throw TreeError(line_, "hash is not 64 lowercase hex digits");
+  }
+
+  const char* hash = p;
+  p += kHashSize;
+
+  if (p == end) {
+    throw TreeError(line_, "line is not terminated");
+  }
+
+  if (*p != '\n') {
+    throw TreeError(line_, "hash is not 64 lowercase hex digits");
+  }
+
+  entry.name = {begin, key_size - 1};
+  entry.hash = {hash, kHashSize};
+  entry.type = type;
+
+  previous_ = {begin, key_size};
+  offset_ = p + 1 - data_.data();
+  ++line_;
+  return true;
+}
+
+std::vector<TreeEntry> ParseTree(std::string_view data) {
+  std::vector<TreeEntry> entries;
+  // Every line is at least "x:\t", the hash and "\n"
+  entries.reserve(data.size() / (kHashSize + 4));
+
+  TreeParser parser(data);
+  TreeEntry entry;
+
+  while (parser.Next(entry)) {
+    entries.push_back(entry);
+  }
+
+  return entries;
+}
+
+MappedFile::MappedFile(const std::string& path) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+
+  if (fd < 0) {
+    throw std::system_error(errno, std::generic_category(), path);
+  }
+
+  struct stat st;
+
+  if (fstat(fd, &st) != 0) {
+    int error = errno;
+    close(fd);
+    throw std::system_error(error, std::generic_category(), path);
+  }
+
+  // An empty tree maps to nothing, which mmap refuses
+  if (st.st_size > 0) {
+    void* data = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+
+    if (data == MAP_FAILED) {
+      int error = errno;
+      close(fd);
+      throw std::system_error(error, std::generic_category(), path);
+    }
+
+    madvise(data, st.st_size, MADV_SEQUENTIAL);
+    data_ = static_cast<const char*>(data);
+    size_ = st.st_size;
+  }
+
+  close(fd);
+}
+
+MappedFile::~MappedFile() {
+  if (data_ != nullptr) {
+    munmap(const_cast<char*>(data_), size_);
+  }
+}
+
+MappedFile::MappedFile(MappedFile&& other) noexcept
+    : data_(std::exchange(other.data_, nullptr)),
+      size_(std::exchange(other.size_, 0)) {}
+
+MappedFile& MappedFile::operator=(MappedFile&& other) noexcept {
+  if (this != &other) {
+    this->~MappedFile();
+    data_ = std::exchange(other.data_, nullptr);
+    size_ = std::exchange(other.size_, 0);
+  }
+
+  return *this;
+}
+
+}  // namespace cafs
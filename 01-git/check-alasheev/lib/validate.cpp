@@ -1,24 +1,26 @@
 #include "validate.hpp"
 
-#include <unistd.h>
-
 #include <algorithm>
 #include <array>
-#include <map>
-#include <regex>
-#include <set>
-#include <sstream>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <exception>
+#include <memory>
+#include <mutex>
+#include <string_view>
+#include <thread>
+#include <unordered_set>
 #include <vector>
 
+#include "cafs/object_store.hpp"
+#include "cafs/tree.hpp"
 #include "fmt/core.h"
 #include "picosha2.h"
 
 namespace {
 
-std::string computeHash(const std::string& data) {
-    return picosha2::hash256_hex_string(data);
-}
-
 bool isValidSHA256(const std::string& data) {
     if (data.size() != 2 * picosha2::k_digest_size) {
         return false;
@@ -29,99 +31,279 @@ bool isValidSHA256(const std::string& data) {
     });
 }
 
-void validateHash(const std::string& path, const std::string& hash) {
+// Reads the object from the store and checks it against its name
+cafs::Object readObject(const cafs::ObjectStore& store,
+                        const std::string& path, const std::string& hash) {
     if (!isValidSHA256(hash)) {
         throw ValidationError(
             fmt::format("Directory or file hash is not valid: {}", hash));
     }
 
-    std::ifstream f(path + hash);
+    auto object = store.Read(hash);
 
-    if (!f.good()) {
+    if (!object) {
         throw ValidationError(
             fmt::format("No such file or directory: {}{}", path, hash));
     }
 
-    std::stringstream ss;
-    ss << f.rdbuf();
-    if (computeHash(ss.str()) != hash) {
+    std::string_view content = object->View();
+    picosha2::hash256_one_by_one hasher;
+    hasher.process(content.begin(), content.end());
+    hasher.finish();
+
+    std::string actual;
+    picosha2::get_hash_hex_string(hasher, actual);
+
+    if (actual != hash) {
         throw ValidationError(
             fmt::format("Hash of file or directory is not correct: {}", hash));
     }
+
+    return std::move(*object);
+}
+
+// Entries of a tree object, the format and order checked as it is read
+std::vector<cafs::TreeEntry> parseDir(std::string_view content,
+                                      const std::string& dir_hash) {
+    try {
+        return cafs::ParseTree(content);
+    } catch (const cafs::TreeError& err) {
+        throw ValidationError(
+            fmt::format("{} in directory {}", err.what(), dir_hash));
+    }
 }
 
-const std::regex DIRECTORY_LINE_REGEX(R"(^(\S+[:/])\t(\w+)$)");
+// Objects claimed for checking, sharded so that workers rarely wait on
+// each other. An object is claimed as a blob and as a tree separately:
+// the same bytes reached as a dir must still be parsed as one.
+class HashSet {
+public:
+    // Whether the object is new in this role; only the one worker that
+    // gets true checks it
+    bool insert(const std::string& hash, bool is_directory) {
+        std::string key = hash;
+        key.push_back(is_directory ? '/' : ':');
 
-std::map<std::string, std::string> parseDir(const std::string& path,
-                                            const std::string& dir_hash) {
-    std::map<std::string, std::string> hash_by_name;
-    std::vector<std::string> lines;
-    {
-        std::ifstream dir{path + dir_hash};
+        Shard& shard = shards_[std::hash<std::string>{}(key) % kShards];
+        std::lock_guard lock(shard.mutex);
+        return shard.hashes.insert(std::move(key)).second;
+    }
 
-        size_t line_num = 0;
-        for (std::string line; std::getline(dir, line); ++line_num) {
-            std::string name;
-            std::string hash;
+private:
+    static constexpr size_t kShards = 64;
 
-            if (!std::regex_match(line, DIRECTORY_LINE_REGEX)) {
-                throw ValidationError(
-                    fmt::format("line #{} don't match regex {} in directory {}",
-                                line_num, R"(^(\S+[:/])\t(\w+)$)", dir_hash));
-            }
+    struct Shard {
+        std::mutex mutex;
+        std::unordered_set<std::string> hashes;
+    };
 
-            lines.push_back(line);
-            std::istringstream ss{line};
-            ss >> name >> hash;
+    std::array<Shard, kShards> shards_;
+};
 
-            if (hash_by_name.count(name)) {
-                throw ValidationError(fmt::format(
-                    "line #{} contains duplicate name \"{}\" in directory {}",
-                    line_num, name, dir_hash));
+struct Task {
+    std::string hash;
+    bool is_directory = false;
+};
+
+// A worker's own tasks: it pushes and pops at the back, others steal
+// from the front, the oldest and so the biggest subtrees
+struct TaskQueue {
+    std::mutex mutex;
+    std::deque<Task> tasks;
+};
+
+class Checker {
+public:
+    Checker(const std::string& path, size_t threads)
+        : path_(path),
+          store_(path),
+          start_(std::chrono::steady_clock::now()) {
+        for (size_t i = 0; i < threads; ++i) {
+            queues_.push_back(std::make_unique<TaskQueue>());
+        }
+    }
+
+    ValidationProgress run(const std::string& root,
+                           const ValidationOptions& options) {
+        seen_.insert(root, true);
+        push(0, {root, true});
+
+        std::vector<std::thread> workers;
+        for (size_t i = 0; i < queues_.size(); ++i) {
+            workers.emplace_back([this, i] { work(i); });
+        }
+
+        {
+            std::unique_lock lock(done_mutex_);
+            while (!done_cv_.wait_for(lock, std::chrono::seconds(1),
+                                      [this] { return done_; })) {
+                if (options.on_progress) {
+                    options.on_progress(progress());
+                }
             }
+        }
+
+        for (auto& worker : workers) {
+            worker.join();
+        }
 
-            hash_by_name.emplace_hint(hash_by_name.end(), std::move(name),
-                                      std::move(hash));
+        if (error_) {
+            std::rethrow_exception(error_);
         }
+
+        ValidationProgress result = progress();
+        if (options.on_progress) {
+            options.on_progress(result);
+        }
+        return result;
     }
 
-    auto sorted_lines = lines;
-    sort(sorted_lines.begin(), sorted_lines.end());
-    for (int i = 0; i < lines.size(); ++i) {
-        if (lines[i] != sorted_lines[i]) {
-            throw ValidationError(
-                fmt::format("List is not sorted in directory {}", dir_hash));
+private:
+    void push(size_t worker, Task task) {
+        pending_.fetch_add(1);
+        {
+            TaskQueue& queue = *queues_[worker];
+            std::lock_guard lock(queue.mutex);
+            queue.tasks.push_back(std::move(task));
+        }
+
+        // A worker going idle counts itself before it looks at queued_,
+        // and this looks at idle_ after counting the task, so one of the
+        // two always sees the other
+        queued_.fetch_add(1);
+        if (idle_.load() != 0) {
+            std::lock_guard lock(done_mutex_);
+            work_cv_.notify_one();
         }
     }
 
-    return hash_by_name;
-}
+    bool pop(size_t worker, Task& task) {
+        for (size_t i = 0; i < queues_.size(); ++i) {
+            TaskQueue& queue = *queues_[(worker + i) % queues_.size()];
+            std::lock_guard lock(queue.mutex);
 
-void validateFile(const std::string& path, const std::string& hash) {
-    validateHash(path, hash);
-}
+            if (queue.tasks.empty()) {
+                continue;
+            }
 
-void validateDirectory(const std::string& path, const std::string& hash,
-                       std::set<std::string>& checked_directories) {
-    if (checked_directories.count(hash)) {
-        return;
+            if (i == 0) {
+                task = std::move(queue.tasks.back());
+                queue.tasks.pop_back();
+            } else {
+                task = std::move(queue.tasks.front());
+                queue.tasks.pop_front();
+            }
+            queued_.fetch_sub(1);
+            return true;
+        }
+
+        return false;
     }
-    validateHash(path, hash);
-    checked_directories.insert(hash);
-    auto parsed_dir = parseDir(path, hash);
-
-    for (auto [name, subhash] : parsed_dir) {
-        if (name[name.size() - 1] == '/') {
-            validateDirectory(path, subhash, checked_directories);
-        } else {
-            validateFile(path, subhash);
+
+    // Runs until every task is done or a check fails. With nothing to
+    // take, the worker sleeps until a task is pushed or the run ends.
+    void work(size_t worker) {
+        Task task;
+
+        while (!failed_.load()) {
+            if (!pop(worker, task)) {
+                std::unique_lock lock(done_mutex_);
+                idle_.fetch_add(1);
+                work_cv_.wait(lock,
+                              [this] { return done_ || queued_.load() != 0; });
+                idle_.fetch_sub(1);
+
+                if (done_) {
+                    return;
+                }
+                continue;
+            }
+
+            try {
+                check(worker, task);
+            } catch (...) {
+                std::lock_guard lock(done_mutex_);
+                if (!error_) {
+                    error_ = std::current_exception();
+                }
+                failed_.store(true);
+            }
+
+            if (pending_.fetch_sub(1) == 1 || failed_.load()) {
+                std::lock_guard lock(done_mutex_);
+                done_ = true;
+                done_cv_.notify_all();
+                work_cv_.notify_all();
+            }
         }
     }
-}
+
+    void check(size_t worker, const Task& task) {
+        cafs::Object object = readObject(store_, path_, task.hash);
+        objects_.fetch_add(1, std::memory_order_relaxed);
+        bytes_.fetch_add(object.View().size(), std::memory_order_relaxed);
+
+        if (!task.is_directory) {
+            return;
+        }
+
+        for (const auto& entry : parseDir(object.View(), task.hash)) {
+            std::string subhash{entry.hash};
+            bool is_directory = entry.type == cafs::EntryType::Tree;
+
+            if (!seen_.insert(subhash, is_directory)) {
+                reused_.fetch_add(1, std::memory_order_relaxed);
+                continue;
+            }
+
+            push(worker, {std::move(subhash), is_directory});
+        }
+    }
+
+    ValidationProgress progress() const {
+        std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start_;
+        return {objects_.load(), reused_.load(), bytes_.load(),
+                elapsed.count()};
+    }
+
+    std::string path_;
+    cafs::ObjectStore store_;
+    std::chrono::steady_clock::time_point start_;
+    std::vector<std::unique_ptr<TaskQueue>> queues_;
+    HashSet seen_;
+
+    // Tasks pushed and not yet done, tasks in the queues, and workers
+    // waiting for one
+    std::atomic<size_t> pending_ = 0;
+    std::atomic<size_t> queued_ = 0;
+    std::atomic<size_t> idle_ = 0;
+    std::atomic<bool> failed_ = false;
+    std::atomic<size_t> objects_ = 0;
+    std::atomic<size_t> reused_ = 0;
+    std::atomic<size_t> bytes_ = 0;
+
+    std::mutex done_mutex_;
+    std::condition_variable done_cv_;
+    std::condition_variable work_cv_;
+    bool done_ = false;
+    std::exception_ptr error_;
+};
 
 }  // namespace
 
+ValidationProgress validateDirectory(const std::string& path,
+                                     const std::string& hash,
+                                     const ValidationOptions& options) {
+    size_t threads = options.threads;
+    if (threads == 0) {
+        threads = std::max(1u, std::thread::hardware_concurrency());
+    }
+
+    Checker checker(path, threads);
+    return checker.run(hash, options);
+}
+
 void validateDirectory(const std::string& path, const std::string& hash) {
-    std::set<std::string> checked_directories;
-    validateDirectory(path, hash, checked_directories);
+    validateDirectory(path, hash, ValidationOptions{});
 }
@@ -1,5 +1,7 @@
 #pragma once
 
+#include <cstddef>
+#include <functional>
 #include <optional>
 #include <stdexcept>
 #include <string>
@@ -8,4 +10,28 @@ class ValidationError : public std::runtime_error {
     using std::runtime_error::runtime_error;
 };
 
+struct ValidationProgress {
+    // Objects hashed so far, and objects skipped as already checked
+    size_t objects = 0;
+    size_t reused = 0;
+    size_t bytes = 0;
+    double seconds = 0;
+};
+
+struct ValidationOptions {
+    // Worker threads, 0 for one per core
+    size_t threads = 0;
+    // Called about once a second while the check runs, and once at the
+    // end; may be empty
+    std::function<void(const ValidationProgress&)> on_progress;
+};
+
+// Checks the tree under the root hash on a pool of workers. Every
+// object is hashed once however many trees share it, or twice if it is
+// reached both as a blob and as a tree.
+// Throws ValidationError on the first problem found.
+ValidationProgress validateDirectory(const std::string& path,
+                                     const std::string& hash,
+                                     const ValidationOptions& options);
+
 void validateDirectory(const std::string& path, const std::string& hash);
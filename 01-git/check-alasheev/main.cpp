@@ -1,11 +1,43 @@
+#include <algorithm>
+#include <charconv>
+#include <iomanip>
 #include <iostream>
+#include <string>
+#include <string_view>
 
 #include "lib/validate.hpp"
 
+namespace {
+
+void printProgress(const ValidationProgress& progress) {
+    double mib = progress.bytes / double(1 << 20);
+    double seconds = std::max(progress.seconds, 1e-9);
+    std::cerr << std::fixed << std::setprecision(1) << "\rchecked "
+              << progress.objects << " objects (" << progress.reused
+              << " reused), " << mib << " MiB in " << progress.seconds
+              << "s, " << mib / seconds << " MiB/s, "
+              << std::setprecision(0) << progress.objects / seconds
+              << " objects/s";
+}
+
+// A positive number of threads, or nothing
+bool parseThreads(std::string_view arg, size_t& threads) {
+    auto [end, error] =
+        std::from_chars(arg.data(), arg.data() + arg.size(), threads);
+    return error == std::errc{} && end == arg.data() + arg.size() &&
+           threads != 0;
+}
+
+int usage(const char* name) {
+    std::cerr << "Format: " << name << " <path> <root-hash> [threads]\n";
+    return 1;
+}
+
+}  // namespace
+
 int main(int argc, char** argv) {
-    if (argc != 3) {
-        std::cerr << "Format: " << argv[0] << "<path> <root-hash>";
-        return 1;
+    if (argc != 3 && argc != 4) {
+        return usage(argv[0]);
     }
 
     std::string path = argv[1];
@@ -13,10 +45,18 @@ int main(int argc, char** argv) {
         path.push_back('/');
     }
 
+    ValidationOptions options;
+    options.on_progress = printProgress;
+    if (argc == 4 && !parseThreads(argv[3], options.threads)) {
+        return usage(argv[0]);
+    }
+
     std::cout << "Validation result:\n";
     try {
-        validateDirectory(path, argv[2]);
+        validateDirectory(path, argv[2], options);
+        std::cerr << '\n';
     } catch (ValidationError& err) {
+        std::cerr << '\n';
         std::cout << err.what() << '\n';
         return 0;
     }
@@ -0,0 +1,101 @@
+#include "tree_diff.h"
+
+#include <stdexcept>
+#include <string_view>
+#include <utility>
+
+namespace {
+
+bool isFile(const cafs::TreeEntry& entry) {
+    return entry.type == cafs::EntryType::Blob;
+}
+
+// The path of the entry under prefix, dirs with their trailing '/'
+std::string entryPath(const std::string& prefix, const cafs::TreeEntry& entry) {
+    return prefix + std::string(isFile(entry) ? entry.name : entry.Key());
+}
+
+// Every file under the dir, as added or removed
+void listAll(const std::string& hash, const std::string& prefix, char mark, std::ostream& out) {
+    Listing listing = readListing(hash);
+    for (const cafs::TreeEntry& entry : listing.entries) {
+        if (isFile(entry)) {
+            out << mark << '\t' << prefix << entry.name << '\n';
+        } else {
+            listAll(std::string(entry.hash), entryPath(prefix, entry), mark, out);
+        }
+    }
+}
+
+}  // namespace
+
+Listing readListing(const std::string& hash) {
+    auto object = cafs::ObjectStore::Current().Read(hash);
+    if (!object) {
+        throw std::runtime_error("No object " + hash);
+    }
+
+    try {
+        // The entries point into the mapping, which the move keeps
+        std::vector<cafs::TreeEntry> entries = cafs::ParseTree(object->View());
+        return {std::move(*object), std::move(entries)};
+    } catch (const cafs::TreeError& err) {
+        throw std::runtime_error("Bad directory " + hash + ": " + err.what());
+    }
+}
+
+void diffTrees(const std::string& hashFrom, const std::string& hashTo, std::ostream& out,
+               const std::string& prefix) {
+    if (hashFrom == hashTo) {
+        return;
+    }
+
+    Listing fromListing = readListing(hashFrom);
+    Listing toListing = readListing(hashTo);
+    const std::vector<cafs::TreeEntry>& from = fromListing.entries;
+    const std::vector<cafs::TreeEntry>& to = toListing.entries;
+
+    auto changed = [&](const cafs::TreeEntry& entry, char mark) {
+        if (isFile(entry)) {
+            out << mark << '\t' << prefix << entry.name << '\n';
+        } else {
+            listAll(std::string(entry.hash), entryPath(prefix, entry), mark, out);
+        }
+    };
+
+    size_t i = 0, j = 0;
+    while (i < from.size() || j < to.size()) {
+        int order = 0;
+        if (i == from.size()) {
+            order = 1;
+        } else if (j == to.size()) {
+            order = -1;
+        } else {
+            order = from[i].Key().compare(to[j].Key());
+        }
+
+        // Service entries, .parent/ and .commit, are not content
+        const cafs::TreeEntry& current = order <= 0 ? from[i] : to[j];
+        if (current.name.front() == '.') {
+            i += order <= 0;
+            j += order >= 0;
+            continue;
+        }
+
+        if (order < 0) {
+            changed(from[i++], '-');
+        } else if (order > 0) {
+            changed(to[j++], '+');
+        } else {
+            if (from[i].hash != to[j].hash) {
+                if (isFile(from[i])) {
+                    out << "d\t" << prefix << from[i].name << '\n';
+                } else {
+                    diffTrees(std::string(from[i].hash), std::string(to[j].hash), out,
+                              entryPath(prefix, from[i]));
+                }
+            }
+            ++i, ++j;
+        }
+    }
+}
@@ -0,0 +1,25 @@
+#pragma once
+
+#include <ostream>
+#include <string>
+#include <vector>
+
+#include <cafs/object_store.hpp>
+#include <cafs/tree.hpp>
+
+// A directory read from the store. The entries point into the object,
+// sorted by cafs::TreeEntry::Key(), the name with its ':' or '/'
+struct Listing {
+    cafs::Object object;
+    std::vector<cafs::TreeEntry> entries;
+};
+
+// Throws std::runtime_error if the object is missing or is not a valid,
+// sorted directory
+Listing readListing(const std::string& hash);
+
+// Merge-joins the two sorted listings, printing files as it goes.
+// A subtree with the same hash on both sides has the same content and
+// is never read, so the cost follows the changes, not the tree size.
+void diffTrees(const std::string& hashFrom, const std::string& hashTo, std::ostream& out,
+               const std::string& prefix = "");
@@ -29,9 +29,16 @@ int is_dir(const dir_ent_t *ent) {
 
 int open_dir_obj_by_hash(const unsigned char hash[HASH_LEN + 1],
                          dir_iter_t *dir_iter_out) {
-  unsigned char obj_path[HASH_LEN + 2];
-  obj_path_by_hash(hash, obj_path);
-  return open_dir_obj(obj_path, dir_iter_out);
+  assert(dir_iter_out != NULL);
+  FILE *f = open_object(hash);
+  if (f == NULL) {
+    fprintf(stderr, "failed to open dir: %.*s: %s\n", HASH_LEN, hash, strerror(errno));
+    return -1;
+  }
+  dir_iter_out->f = f;
+  dir_iter_out->current.name[0] = '\0';
+  dir_iter_out->current.hash[0] = '\0';
+  return 0;
 }
 
 int open_dir_obj(const unsigned char *obj_path, dir_iter_t *dir_iter_out) {
@@ -94,7 +101,6 @@ dir_ent_t *find_in_dir(dir_iter_t *dir, const unsigned char *name) {
 int go_down(const dir_ent_t *current_ent, dir_iter_t *dir_iter_out) {
   assert(current_ent != NULL);
   assert(dir_iter_out != NULL);
-  unsigned char next_dir_obj_path[HASH_LEN + 2];
   if (!is_dir(current_ent)) {
     fprintf(stderr, "%s is not a directory\n", current_ent->name);
     return -1;
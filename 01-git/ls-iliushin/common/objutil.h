@@ -3,14 +3,18 @@
 
 #include <openssl/sha.h>
 #include <stdint.h>
+#include <stdio.h>
+
+#include "objstore.h"
 
 #define HASH_LEN (SHA256_DIGEST_LENGTH * 2)
 #define MAX_NAME_LEN 512
 
 void obj_hash(const unsigned char *obj, uint64_t len,
               unsigned char hash_out[HASH_LEN]);
-void obj_path_by_hash(const unsigned char hash[HASH_LEN],
-                      unsigned char path_out[HASH_LEN + 2]);
+// The store in the working directory, opened on first use
+obj_store_t *objutil_store(void);
+FILE *open_object(const unsigned char hash[HASH_LEN]);
 int write_object(const unsigned char *obj, uint64_t len,
                  unsigned char hash_out[HASH_LEN]);
 
@@ -0,0 +1,1031 @@
+#define _DEFAULT_SOURCE
+
+#include "objstore.h"
+
+#include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <limits.h>
+#include <pthread.h>
+#include <stdarg.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <openssl/sha.h>
+
+// A pack is PACK_MAGIC and the objects back to back. Its index is
+// IDX_MAGIC, the u32 object count, 4 zero bytes, u32 fanout[256] with
+// the number of digests whose first byte is at most i, the sorted
+// digests, then u64 offsets and u64 lengths into the pack, all numbers
+// in host byte order. Both are named by the SHA-256 of the digests.
+#define PACK_MAGIC "CAFSPAK1"
+#define IDX_MAGIC "CAFSIDX1"
+#define MAGIC_LEN 8
+#define IDX_HEADER_LEN (MAGIC_LEN + 8)
+#define IDX_FANOUT_LEN (256 * sizeof(uint32_t))
+#define IDX_ENTRY_LEN (OBJ_DIGEST_LEN + 2 * sizeof(uint64_t))
+
+// Present in the root of a store whose layout is sharded
+#define SHARDED_FILE ".sharded"
+
+typedef struct pack {
+  unsigned char *idx_map;
+  size_t idx_len;
+  unsigned char *pack_map;
+  size_t pack_len;
+  uint32_t count;
+  const uint32_t *fanout;
+  const unsigned char *digests;
+  const uint64_t *offsets;
+  const uint64_t *lengths;
+  // <root>/pack/<name>, no extension
+  char *path;
+} pack_t;
+
+struct obj_store {
+  char *root;
+  int sharded;
+  // 0644 less the umask, as files created with open get
+  mode_t file_mode;
+  // Write-locked while packs are added
+  pthread_rwlock_t packs_lock;
+  pack_t *packs;
+  size_t n_packs;
+};
+
+static int hex_value(unsigned char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  return -1;
+}
+
+static int is_hex(const char *str, size_t len) {
+  for (size_t i = 0; i < len; i++) {
+    if (hex_value(str[i]) < 0) {
+      return 0;
+    }
+  }
+  return str[len] == '\0';
+}
+
+static int parse_hash(const unsigned char *hash,
+                      unsigned char digest[OBJ_DIGEST_LEN]) {
+  for (size_t i = 0; i < OBJ_DIGEST_LEN; i++) {
+    int high = hex_value(hash[2 * i]);
+    int low = hex_value(hash[2 * i + 1]);
+    if (high < 0 || low < 0) {
+      errno = EINVAL;
+      return -1;
+    }
+    digest[i] = high << 4 | low;
+  }
+  return 0;
+}
+
+static void to_hex(const unsigned char digest[OBJ_DIGEST_LEN],
+                   unsigned char hash_out[OBJ_HASH_LEN]) {
+  static const char digits[] = "0123456789abcdef";
+  for (size_t i = 0; i < OBJ_DIGEST_LEN; i++) {
+    hash_out[2 * i] = digits[digest[i] >> 4];
+    hash_out[2 * i + 1] = digits[digest[i] & 15];
+  }
+}
+
+void obj_store_hash(const unsigned char *obj, uint64_t len,
+                    unsigned char hash_out[OBJ_HASH_LEN]) {
+  unsigned char digest[OBJ_DIGEST_LEN];
+  SHA256(obj, len, digest);
+  to_hex(digest, hash_out);
+}
+
+// A path built from parts that came from the file system; -1 with
+// ENAMETOOLONG if it does not fit rather than a truncated path
+static int make_path(char path_out[PATH_MAX], const char *format, ...) {
+  va_list args;
+  va_start(args, format);
+  int len = vsnprintf(path_out, PATH_MAX, format, args);
+  va_end(args);
+  if (len < 0 || len >= PATH_MAX) {
+    path_out[0] = '\0';
+    errno = ENAMETOOLONG;
+    return -1;
+  }
+  return 0;
+}
+
+static void loose_path(const obj_store_t *store, const unsigned char *hash,
+                       char path_out[PATH_MAX]) {
+  snprintf(path_out, PATH_MAX, "%s/%.2s/%.2s/%.60s", store->root, hash,
+           hash + 2, hash + 4);
+}
+
+static void flat_path(const obj_store_t *store, const unsigned char *hash,
+                      char path_out[PATH_MAX]) {
+  snprintf(path_out, PATH_MAX, "%s/%.64s", store->root, hash);
+}
+
+// The whole file read-only; an empty one maps to NULL
+static int map_file(const char *path, unsigned char **map_out,
+                    size_t *len_out) {
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return -1;
+  }
+  struct stat st;
+  if (fstat(fd, &st) != 0) {
+    int err = errno;
+    close(fd);
+    errno = err;
+    return -1;
+  }
+  *map_out = NULL;
+  *len_out = st.st_size;
+  if (st.st_size > 0) {
+    void *map = mmap(NULL, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (map == MAP_FAILED) {
+      int err = errno;
+      close(fd);
+      errno = err;
+      return -1;
+    }
+    *map_out = map;
+  }
+  close(fd);
+  return 0;
+}
+
+static void unmap_file(unsigned char *map, size_t len) {
+  if (map != NULL) {
+    munmap(map, len);
+  }
+}
+
+static int check_pack(const pack_t *pack) {
+  if (pack->idx_len < IDX_HEADER_LEN + IDX_FANOUT_LEN ||
+      memcmp(pack->idx_map, IDX_MAGIC, MAGIC_LEN) != 0 ||
+      pack->pack_len < MAGIC_LEN ||
+      memcmp(pack->pack_map, PACK_MAGIC, MAGIC_LEN) != 0) {
+    return -1;
+  }
+  if (pack->idx_len !=
+      IDX_HEADER_LEN + IDX_FANOUT_LEN + (size_t)pack->count * IDX_ENTRY_LEN) {
+    return -1;
+  }
+  for (size_t i = 0; i < 256; i++) {
+    if ((i > 0 && pack->fanout[i] < pack->fanout[i - 1]) ||
+        pack->fanout[i] > pack->count) {
+      return -1;
+    }
+  }
+  if (pack->fanout[255] != pack->count) {
+    return -1;
+  }
+  for (uint32_t i = 0; i < pack->count; i++) {
+    if (pack->offsets[i] < MAGIC_LEN || pack->offsets[i] > pack->pack_len ||
+        pack->lengths[i] > pack->pack_len - pack->offsets[i]) {
+      return -1;
+    }
+  }
+  return 0;
+}
+
+static int load_pack(obj_store_t *store, const char *path, int report) {
+  pack_t pack;
+  memset(&pack, 0, sizeof(pack));
+  char file[PATH_MAX];
+
+  if (make_path(file, "%s.idx", path) != 0 ||
+      map_file(file, &pack.idx_map, &pack.idx_len) != 0) {
+    if (report) {
+      fprintf(stderr, "failed to open pack index: %s: %s\n", file,
+              strerror(errno));
+    }
+    return -1;
+  }
+  if (make_path(file, "%s.pack", path) != 0 ||
+      map_file(file, &pack.pack_map, &pack.pack_len) != 0) {
+    if (report) {
+      fprintf(stderr, "failed to open pack: %s: %s\n", file, strerror(errno));
+    }
+    unmap_file(pack.idx_map, pack.idx_len);
+    return -1;
+  }
+
+  if (pack.idx_len >= IDX_HEADER_LEN + IDX_FANOUT_LEN) {
+    memcpy(&pack.count, pack.idx_map + MAGIC_LEN, sizeof(pack.count));
+    pack.fanout = (const uint32_t *)(pack.idx_map + IDX_HEADER_LEN);
+    pack.digests = pack.idx_map + IDX_HEADER_LEN + IDX_FANOUT_LEN;
+    pack.offsets =
+        (const uint64_t *)(pack.digests + (size_t)pack.count * OBJ_DIGEST_LEN);
+    pack.lengths = pack.offsets + pack.count;
+  }
+  if (pack.idx_map == NULL || pack.pack_map == NULL || check_pack(&pack)) {
+    if (report) {
+      fprintf(stderr, "corrupt pack: %s\n", path);
+    }
+    unmap_file(pack.idx_map, pack.idx_len);
+    unmap_file(pack.pack_map, pack.pack_len);
+    return -1;
+  }
+  madvise(pack.idx_map, pack.idx_len, MADV_RANDOM);
+  madvise(pack.pack_map, pack.pack_len, MADV_RANDOM);
+
+  pack_t *packs =
+      realloc(store->packs, (store->n_packs + 1) * sizeof(pack_t));
+  pack.path = strdup(path);
+  if (packs == NULL || pack.path == NULL) {
+    store->packs = packs != NULL ? packs : store->packs;
+    free(pack.path);
+    unmap_file(pack.idx_map, pack.idx_len);
+    unmap_file(pack.pack_map, pack.pack_len);
+    return -1;
+  }
+  store->packs = packs;
+  store->packs[store->n_packs++] = pack;
+  return 0;
+}
+
+static int pack_loaded(const obj_store_t *store, const char *path) {
+  for (size_t i = 0; i < store->n_packs; i++) {
+    if (strcmp(store->packs[i].path, path) == 0) {
+      return 1;
+    }
+  }
+  return 0;
+}
+
+// The packs not loaded yet; one that can not be read is left out, and
+// reported if report is set. The number of packs added
+static size_t load_packs(obj_store_t *store, int report) {
+  char dir_path[PATH_MAX];
+  snprintf(dir_path, sizeof(dir_path), "%s/pack", store->root);
+  DIR *dir = opendir(dir_path);
+  if (dir == NULL) {
+    return 0;
+  }
+  size_t added = 0;
+  struct dirent *ent;
+  while ((ent = readdir(dir)) != NULL) {
+    size_t len = strlen(ent->d_name);
+    if (len <= 4 || strcmp(ent->d_name + len - 4, ".idx") != 0) {
+      continue;
+    }
+    char path[PATH_MAX];
+    if (make_path(path, "%s/%.*s", dir_path, (int)(len - 4), ent->d_name) ==
+            0 &&
+        !pack_loaded(store, path) && load_pack(store, path, report) == 0) {
+      added++;
+    }
+  }
+  closedir(dir);
+  return added;
+}
+
+static void unload_packs(obj_store_t *store) {
+  for (size_t i = 0; i < store->n_packs; i++) {
+    unmap_file(store->packs[i].idx_map, store->packs[i].idx_len);
+    unmap_file(store->packs[i].pack_map, store->packs[i].pack_len);
+    free(store->packs[i].path);
+  }
+  free(store->packs);
+  store->packs = NULL;
+  store->n_packs = 0;
+}
+
+// The index of the digest in the pack, or -1
+static int64_t pack_find(const pack_t *pack,
+                         const unsigned char digest[OBJ_DIGEST_LEN]) {
+  uint32_t lo = digest[0] == 0 ? 0 : pack->fanout[digest[0] - 1];
+  uint32_t hi = pack->fanout[digest[0]];
+  while (lo < hi) {
+    uint32_t mid = lo + (hi - lo) / 2;
+    int cmp = memcmp(pack->digests + (size_t)mid * OBJ_DIGEST_LEN, digest,
+                     OBJ_DIGEST_LEN);
+    if (cmp == 0) {
+      return mid;
+    }
+    if (cmp < 0) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  return -1;
+}
+
+// Under packs_lock
+static int find_in_packs(const obj_store_t *store,
+                         const unsigned char digest[OBJ_DIGEST_LEN],
+                         obj_data_t *data_out) {
+  for (size_t i = 0; i < store->n_packs; i++) {
+    const pack_t *pack = &store->packs[i];
+    int64_t index = pack_find(pack, digest);
+    if (index >= 0) {
+      data_out->data = pack->pack_map + pack->offsets[index];
+      data_out->len = pack->lengths[index];
+      data_out->map = NULL;
+      return 1;
+    }
+  }
+  return 0;
+}
+
+static int find_packed(obj_store_t *store,
+                       const unsigned char digest[OBJ_DIGEST_LEN],
+                       obj_data_t *data_out) {
+  pthread_rwlock_rdlock(&store->packs_lock);
+  int found = find_in_packs(store, digest, data_out);
+  pthread_rwlock_unlock(&store->packs_lock);
+  return found;
+}
+
+// For an object found nowhere: a repack in another process may have
+// moved it into a pack added since the store looked, as git rescans
+// its packs on a miss. The packs loaded before stay mapped even if
+// that repack removed them, as objects read from them may be in use
+static int find_repacked(obj_store_t *store,
+                         const unsigned char digest[OBJ_DIGEST_LEN],
+                         obj_data_t *data_out) {
+  pthread_rwlock_wrlock(&store->packs_lock);
+  // Searched again even if no pack is new: another thread may have
+  // loaded the one with the object since this one looked. A bad pack
+  // was reported at open, or is one a repack is still removing
+  load_packs(store, 0);
+  int found = find_in_packs(store, digest, data_out);
+  pthread_rwlock_unlock(&store->packs_lock);
+  return found;
+}
+
+obj_store_t *obj_store_open(const char *root) {
+  obj_store_t *store = calloc(1, sizeof(obj_store_t));
+  if (store == NULL) {
+    return NULL;
+  }
+  store->root = strdup(root);
+  if (store->root == NULL || pthread_rwlock_init(&store->packs_lock, NULL)) {
+    free(store->root);
+    free(store);
+    return NULL;
+  }
+  char path[PATH_MAX];
+  if (make_path(path, "%s/" SHARDED_FILE, root) != 0) {
+    obj_store_close(store);
+    return NULL;
+  }
+  store->sharded = access(path, F_OK) == 0;
+  // The umask can only be read by setting it
+  mode_t mask = umask(022);
+  umask(mask);
+  store->file_mode = 0644 & ~mask;
+  load_packs(store, 1);
+  return store;
+}
+
+void obj_store_close(obj_store_t *store) {
+  if (store == NULL) {
+    return;
+  }
+  unload_packs(store);
+  pthread_rwlock_destroy(&store->packs_lock);
+  free(store->root);
+  free(store);
+}
+
+int obj_store_has(obj_store_t *store, const unsigned char *hash) {
+  unsigned char digest[OBJ_DIGEST_LEN];
+  if (parse_hash(hash, digest) != 0) {
+    return 0;
+  }
+  obj_data_t data;
+  if (find_packed(store, digest, &data)) {
+    return 1;
+  }
+  char path[PATH_MAX];
+  loose_path(store, hash, path);
+  if (access(path, F_OK) == 0) {
+    return 1;
+  }
+  flat_path(store, hash, path);
+  if (access(path, F_OK) == 0) {
+    return 1;
+  }
+  return find_repacked(store, digest, &data);
+}
+
+static int map_object(const char *path, obj_data_t *data_out) {
+  unsigned char *map;
+  size_t len;
+  if (map_file(path, &map, &len) != 0) {
+    return -1;
+  }
+  data_out->data = map != NULL ? map : (const unsigned char *)"";
+  data_out->len = len;
+  data_out->map = map;
+  return 0;
+}
+
+int obj_store_read(obj_store_t *store, const unsigned char *hash,
+                   obj_data_t *data_out) {
+  unsigned char digest[OBJ_DIGEST_LEN];
+  if (parse_hash(hash, digest) != 0) {
+    return -1;
+  }
+  if (find_packed(store, digest, data_out)) {
+    return 0;
+  }
+  char path[PATH_MAX];
+  loose_path(store, hash, path);
+  if (map_object(path, data_out) == 0) {
+    return 0;
+  }
+  if (errno != ENOENT) {
+    return -1;
+  }
+  flat_path(store, hash, path);
+  if (map_object(path, data_out) == 0) {
+    return 0;
+  }
+  if (errno != ENOENT || !find_repacked(store, digest, data_out)) {
+    return -1;
+  }
+  return 0;
+}
+
+void obj_store_release(obj_data_t *data) {
+  if (data->map != NULL) {
+    munmap(data->map, data->len);
+  }
+  data->data = NULL;
+  data->len = 0;
+  data->map = NULL;
+}
+
+FILE *obj_store_open_stream(obj_store_t *store, const unsigned char *hash) {
+  unsigned char digest[OBJ_DIGEST_LEN];
+  if (parse_hash(hash, digest) != 0) {
+    return NULL;
+  }
+  obj_data_t data;
+  if (find_packed(store, digest, &data)) {
+    // The pack stays mapped as long as the store is open
+    return fmemopen((void *)data.data, data.len, "r");
+  }
+  char path[PATH_MAX];
+  loose_path(store, hash, path);
+  FILE *f = fopen(path, "r");
+  if (f != NULL || errno != ENOENT) {
+    return f;
+  }
+  flat_path(store, hash, path);
+  f = fopen(path, "r");
+  if (f != NULL || errno != ENOENT) {
+    return f;
+  }
+  if (!find_repacked(store, digest, &data)) {
+    errno = ENOENT;
+    return NULL;
+  }
+  return fmemopen((void *)data.data, data.len, "r");
+}
+
+static int write_all(int fd, const unsigned char *data, uint64_t len) {
+  while (len > 0) {
+    ssize_t n_written = write(fd, data, len);
+    if (n_written < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n_written < 0) {
+      return -1;
+    }
+    data += n_written;
+    len -= n_written;
+  }
+  return 0;
+}
+
+static int make_dir(const char *path) {
+  if (mkdir(path, 0755) != 0 && errno != EEXIST) {
+    return -1;
+  }
+  return 0;
+}
+
+int obj_store_write(obj_store_t *store, const unsigned char *obj,
+                    uint64_t len, unsigned char hash_out[OBJ_HASH_LEN]) {
+  obj_store_hash(obj, len, hash_out);
+  if (obj_store_has(store, hash_out)) {
+    return 0;
+  }
+
+  // Loose in a sharded store, flat in any other so that the tools that
+  // do not read through the store find it
+  char path[PATH_MAX];
+  if (store->sharded) {
+    char dir[PATH_MAX];
+    snprintf(dir, sizeof(dir), "%s/%.2s", store->root, hash_out);
+    int res = make_dir(dir);
+    snprintf(dir, sizeof(dir), "%s/%.2s/%.2s", store->root, hash_out,
+             hash_out + 2);
+    if (res != 0 || make_dir(dir) != 0) {
+      fprintf(stderr, "failed to write object: %s: %s\n", dir,
+              strerror(errno));
+      return -1;
+    }
+    loose_path(store, hash_out, path);
+  } else {
+    flat_path(store, hash_out, path);
+  }
+
+  // Written aside and renamed in, so readers never see a partial object
+  char tmp[PATH_MAX];
+  snprintf(tmp, sizeof(tmp), "%s/.tmp-XXXXXX", store->root);
+  int fd = mkstemp(tmp);
+  if (fd < 0) {
+    fprintf(stderr, "failed to write object: %s: %s\n", tmp, strerror(errno));
+    return -1;
+  }
+  // mkstemp makes it 0600
+  if (fchmod(fd, store->file_mode) != 0 || write_all(fd, obj, len) != 0 ||
+      close(fd) != 0 || rename(tmp, path) != 0) {
+    fprintf(stderr, "failed to write object: %s: %s\n", path, strerror(errno));
+    unlink(tmp);
+    return -1;
+  }
+  return 0;
+}
+
+int obj_store_is_sharded(const obj_store_t *store) {
+  return store->sharded;
+}
+
+int obj_store_shard(obj_store_t *store) {
+  if (store->sharded) {
+    return 0;
+  }
+  char path[PATH_MAX];
+  if (make_path(path, "%s/" SHARDED_FILE, store->root) != 0) {
+    return -1;
+  }
+  int fd = open(path, O_WRONLY | O_CREAT | O_CLOEXEC, 0644);
+  if (fd < 0 || close(fd) != 0) {
+    fprintf(stderr, "failed to shard store: %s: %s\n", path, strerror(errno));
+    return -1;
+  }
+  store->sharded = 1;
+  return 0;
+}
+
+typedef struct repack_ent {
+  unsigned char digest[OBJ_DIGEST_LEN];
+  // A loose object, or the object at index in pack
+  char *path;
+  const pack_t *pack;
+  uint32_t index;
+  // Dropped once the new pack is in place
+  int remove;
+} repack_ent_t;
+
+typedef struct repack_list {
+  repack_ent_t *ents;
+  size_t len;
+  size_t cap;
+} repack_list_t;
+
+static repack_ent_t *push_ent(repack_list_t *list) {
+  if (list->len == list->cap) {
+    size_t cap = list->cap == 0 ? 1024 : list->cap * 2;
+    repack_ent_t *ents = realloc(list->ents, cap * sizeof(repack_ent_t));
+    if (ents == NULL) {
+      return NULL;
+    }
+    list->ents = ents;
+    list->cap = cap;
+  }
+  repack_ent_t *ent = &list->ents[list->len++];
+  memset(ent, 0, sizeof(*ent));
+  return ent;
+}
+
+static int push_loose(repack_list_t *list, const char *path,
+                      const unsigned char *hash) {
+  repack_ent_t *ent = push_ent(list);
+  if (ent == NULL || (ent->path = strdup(path)) == NULL) {
+    return -1;
+  }
+  parse_hash(hash, ent->digest);
+  return 0;
+}
+
+// Loose objects under ab/cd/, and flat ones
+static int collect_loose(const obj_store_t *store, repack_list_t *list) {
+  DIR *root = opendir(store->root);
+  if (root == NULL) {
+    return -1;
+  }
+  int res = 0;
+  struct dirent *top;
+  while (res == 0 && (top = readdir(root)) != NULL) {
+    char path[PATH_MAX];
+    snprintf(path, sizeof(path), "%s/%s", store->root, top->d_name);
+    struct stat st;
+
+    if (is_hex(top->d_name, OBJ_HASH_LEN)) {
+      if (stat(path, &st) == 0 && S_ISREG(st.st_mode)) {
+        res = push_loose(list, path, (const unsigned char *)top->d_name);
+      }
+      continue;
+    }
+    if (!is_hex(top->d_name, 2)) {
+      continue;
+    }
+
+    DIR *first = opendir(path);
+    struct dirent *mid;
+    while (res == 0 && first != NULL && (mid = readdir(first)) != NULL) {
+      if (!is_hex(mid->d_name, 2)) {
+        continue;
+      }
+      char mid_path[PATH_MAX];
+      if (make_path(mid_path, "%s/%s", path, mid->d_name) != 0) {
+        continue;
+      }
+      DIR *second = opendir(mid_path);
+      struct dirent *obj;
+      while (res == 0 && second != NULL && (obj = readdir(second)) != NULL) {
+        if (!is_hex(obj->d_name, OBJ_HASH_LEN - 4)) {
+          continue;
+        }
+        unsigned char hash[OBJ_HASH_LEN];
+        memcpy(hash, top->d_name, 2);
+        memcpy(hash + 2, mid->d_name, 2);
+        memcpy(hash + 4, obj->d_name, OBJ_HASH_LEN - 4);
+        char obj_path[PATH_MAX];
+        if (make_path(obj_path, "%s/%s", mid_path, obj->d_name) != 0) {
+          continue;
+        }
+        res = push_loose(list, obj_path, hash);
+      }
+      if (second != NULL) {
+        closedir(second);
+      }
+    }
+    if (first != NULL) {
+      closedir(first);
+    }
+  }
+  closedir(root);
+  return res;
+}
+
+static int compare_ents(const void *lhs, const void *rhs) {
+  const repack_ent_t *l = lhs;
+  const repack_ent_t *r = rhs;
+  int cmp = memcmp(l->digest, r->digest, OBJ_DIGEST_LEN);
+  if (cmp != 0) {
+    return cmp;
+  }
+  // Packed copies first, their content is already checked
+  return (l->path != NULL) - (r->path != NULL);
+}
+
+// The loose object checked against its name, in buf
+static int read_loose(const repack_ent_t *ent, unsigned char **buf,
+                      size_t *cap, size_t *len_out) {
+  int fd = open(ent->path, O_RDONLY | O_CLOEXEC);
+  struct stat st;
+  if (fd < 0 || fstat(fd, &st) != 0) {
+    if (fd >= 0) {
+      close(fd);
+    }
+    return -1;
+  }
+  size_t len = st.st_size;
+  if (len > *cap) {
+    unsigned char *grown = realloc(*buf, len);
+    if (grown == NULL) {
+      close(fd);
+      return -1;
+    }
+    *buf = grown;
+    *cap = len;
+  }
+  size_t done = 0;
+  while (done < len) {
+    ssize_t n_read = read(fd, *buf + done, len - done);
+    if (n_read < 0 && errno == EINTR) {
+      continue;
+    }
+    if (n_read <= 0) {
+      close(fd);
+      return -1;
+    }
+    done += n_read;
+  }
+  close(fd);
+
+  unsigned char digest[OBJ_DIGEST_LEN];
+  SHA256(*buf, len, digest);
+  if (memcmp(digest, ent->digest, OBJ_DIGEST_LEN) != 0) {
+    errno = EILSEQ;
+    return -1;
+  }
+  *len_out = len;
+  return 0;
+}
+
+static void remove_loose(const char *path) {
+  unlink(path);
+  // The fanout dirs go once empty; rmdir fails on the others
+  char dir[PATH_MAX];
+  snprintf(dir, sizeof(dir), "%s", path);
+  for (int level = 0; level < 2; level++) {
+    char *slash = strrchr(dir, '/');
+    if (slash == NULL) {
+      return;
+    }
+    *slash = '\0';
+    if (rmdir(dir) != 0) {
+      return;
+    }
+  }
+}
+
+static int sync_dir(const char *path) {
+  int fd = open(path, O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  if (fd < 0) {
+    return -1;
+  }
+  if (fsync(fd) != 0) {
+    int err = errno;
+    close(fd);
+    errno = err;
+    return -1;
+  }
+  return close(fd);
+}
+
+static int write_file(const char *path, const unsigned char *data,
+                      size_t len) {
+  int fd = open(path, O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC, 0644);
+  if (fd < 0) {
+    return -1;
+  }
+  if (write_all(fd, data, len) != 0 || fsync(fd) != 0) {
+    close(fd);
+    return -1;
+  }
+  return close(fd);
+}
+
+// Writes the pack and its index for the sorted entries, marking the
+// ones to remove. The number of objects written, or -1
+static int64_t write_pack(obj_store_t *store, repack_list_t *list,
+                          char name_out[OBJ_HASH_LEN + 1]) {
+  char pack_dir[PATH_MAX];
+  snprintf(pack_dir, sizeof(pack_dir), "%s/pack", store->root);
+  if (make_dir(pack_dir) != 0) {
+    return -1;
+  }
+  char tmp[PATH_MAX];
+  if (make_path(tmp, "%s/.tmp-pack-XXXXXX", pack_dir) != 0) {
+    return -1;
+  }
+  int fd = mkstemp(tmp);
+  if (fd < 0) {
+    return -1;
+  }
+  FILE *out = fchmod(fd, store->file_mode) == 0 ? fdopen(fd, "wb") : NULL;
+  if (out == NULL) {
+    close(fd);
+    unlink(tmp);
+    return -1;
+  }
+
+  size_t idx_cap = IDX_HEADER_LEN + IDX_FANOUT_LEN + list->len * IDX_ENTRY_LEN;
+  unsigned char *digests = malloc(list->len * OBJ_DIGEST_LEN + 1);
+  uint64_t *offsets = malloc(list->len * sizeof(uint64_t) + 1);
+  uint64_t *lengths = malloc(list->len * sizeof(uint64_t) + 1);
+  unsigned char *idx = malloc(idx_cap);
+  unsigned char *buf = NULL;
+  size_t buf_cap = 0;
+  uint32_t count = 0;
+  uint64_t offset = MAGIC_LEN;
+  int failed = digests == NULL || offsets == NULL || lengths == NULL ||
+               idx == NULL || fwrite(PACK_MAGIC, 1, MAGIC_LEN, out) != MAGIC_LEN;
+
+  for (size_t i = 0; i < list->len && !failed; i++) {
+    repack_ent_t *ent = &list->ents[i];
+    if (count > 0 && memcmp(digests + (size_t)(count - 1) * OBJ_DIGEST_LEN,
+                            ent->digest, OBJ_DIGEST_LEN) == 0) {
+      ent->remove = 1;
+      continue;
+    }
+
+    const unsigned char *data;
+    size_t len;
+    if (ent->path == NULL) {
+      data = ent->pack->pack_map + ent->pack->offsets[ent->index];
+      len = ent->pack->lengths[ent->index];
+    } else if (read_loose(ent, &buf, &buf_cap, &len) == 0) {
+      data = buf;
+    } else {
+      fprintf(stderr, "skipping object: %s: %s\n", ent->path,
+              strerror(errno));
+      continue;
+    }
+
+    if (fwrite(data, 1, len, out) != len) {
+      failed = 1;
+      break;
+    }
+    memcpy(digests + (size_t)count * OBJ_DIGEST_LEN, ent->digest,
+           OBJ_DIGEST_LEN);
+    offsets[count] = offset;
+    lengths[count] = len;
+    offset += len;
+    count++;
+    ent->remove = 1;
+  }
+  free(buf);
+
+  failed = failed || fflush(out) != 0 || fsync(fd) != 0;
+  failed = fclose(out) != 0 || failed;
+  if (failed || count == 0) {
+    unlink(tmp);
+    free(digests);
+    free(offsets);
+    free(lengths);
+    free(idx);
+    return failed ? -1 : 0;
+  }
+
+  unsigned char name[OBJ_DIGEST_LEN];
+  SHA256(digests, (size_t)count * OBJ_DIGEST_LEN, name);
+  to_hex(name, (unsigned char *)name_out);
+  name_out[OBJ_HASH_LEN] = '\0';
+
+  uint32_t fanout[256] = {0};
+  for (uint32_t i = 0; i < count; i++) {
+    fanout[digests[(size_t)i * OBJ_DIGEST_LEN]]++;
+  }
+  for (size_t i = 1; i < 256; i++) {
+    fanout[i] += fanout[i - 1];
+  }
+  uint32_t zero = 0;
+  size_t idx_len = 0;
+  memcpy(idx + idx_len, IDX_MAGIC, MAGIC_LEN);
+  idx_len += MAGIC_LEN;
+  memcpy(idx + idx_len, &count, sizeof(count));
+  idx_len += sizeof(count);
+  memcpy(idx + idx_len, &zero, sizeof(zero));
+  idx_len += sizeof(zero);
+  memcpy(idx + idx_len, fanout, sizeof(fanout));
+  idx_len += sizeof(fanout);
+  memcpy(idx + idx_len, digests, (size_t)count * OBJ_DIGEST_LEN);
+  idx_len += (size_t)count * OBJ_DIGEST_LEN;
+  memcpy(idx + idx_len, offsets, count * sizeof(uint64_t));
+  idx_len += count * sizeof(uint64_t);
+  memcpy(idx + idx_len, lengths, count * sizeof(uint64_t));
+  idx_len += count * sizeof(uint64_t);
+  free(digests);
+  free(offsets);
+  free(lengths);
+
+  // The pack goes in first: the index is what makes it visible
+  char path[PATH_MAX];
+  char idx_tmp[PATH_MAX];
+  failed = make_path(idx_tmp, "%s.idx", tmp) != 0 ||
+           make_path(path, "%s/%s.pack", pack_dir, name_out) != 0 ||
+           rename(tmp, path) != 0;
+  if (!failed) {
+    failed = make_path(path, "%s/%s.idx", pack_dir, name_out) != 0 ||
+             write_file(idx_tmp, idx, idx_len) != 0 ||
+             rename(idx_tmp, path) != 0;
+  }
+  free(idx);
+  // Both renames must be on disk before the objects packed are removed
+  if (!failed && sync_dir(pack_dir) != 0) {
+    return -1;
+  }
+  if (failed) {
+    unlink(tmp);
+    unlink(idx_tmp);
+    return -1;
+  }
+  return count;
+}
+
+int64_t obj_store_repack(obj_store_t *store, int all) {
+  // Packs are only read through the store
+  if (!store->sharded) {
+    fprintf(stderr, "store is not sharded: %s\n", store->root);
+    errno = EPERM;
+    return -1;
+  }
+
+  repack_list_t list = {NULL, 0, 0};
+  if (collect_loose(store, &list) != 0) {
+    fprintf(stderr, "failed to list objects: %s: %s\n", store->root,
+            strerror(errno));
+    free(list.ents);
+    return -1;
+  }
+
+  size_t n_loose = list.len;
+  for (size_t i = 0; i < n_loose; i++) {
+    obj_data_t data;
+    // Already packed, the loose copy just goes
+    if (!all && find_packed(store, list.ents[i].digest, &data)) {
+      list.ents[i].remove = 1;
+    }
+  }
+  if (all) {
+    for (size_t p = 0; p < store->n_packs; p++) {
+      for (uint32_t i = 0; i < store->packs[p].count; i++) {
+        repack_ent_t *ent = push_ent(&list);
+        if (ent == NULL) {
+          free(list.ents);
+          return -1;
+        }
+        memcpy(ent->digest,
+               store->packs[p].digests + (size_t)i * OBJ_DIGEST_LEN,
+               OBJ_DIGEST_LEN);
+        ent->pack = &store->packs[p];
+        ent->index = i;
+      }
+    }
+  }
+
+  // Entries marked so far are in a pack already. A previous repack may
+  // have crashed before its renames reached the disk, so they do first
+  char pack_dir[PATH_MAX];
+  snprintf(pack_dir, sizeof(pack_dir), "%s/pack", store->root);
+  if (store->n_packs > 0 && sync_dir(pack_dir) != 0) {
+    fprintf(stderr, "failed to sync packs: %s: %s\n", pack_dir,
+            strerror(errno));
+    for (size_t i = 0; i < list.len; i++) {
+      free(list.ents[i].path);
+    }
+    free(list.ents);
+    return -1;
+  }
+
+  // Entries marked so far are not packed again
+  size_t kept = 0;
+  for (size_t i = 0; i < list.len; i++) {
+    if (list.ents[i].remove) {
+      remove_loose(list.ents[i].path);
+      free(list.ents[i].path);
+    } else {
+      list.ents[kept++] = list.ents[i];
+    }
+  }
+  list.len = kept;
+
+  int64_t count = 0;
+  char name[OBJ_HASH_LEN + 1] = "";
+  if (list.len > 0 && (all ? store->n_packs > 1 || n_loose > 0 : 1)) {
+    qsort(list.ents, list.len, sizeof(repack_ent_t), compare_ents);
+    count = write_pack(store, &list, name);
+  }
+
+  for (size_t i = 0; i < list.len; i++) {
+    if (count > 0 && list.ents[i].remove && list.ents[i].path != NULL) {
+      remove_loose(list.ents[i].path);
+    }
+    free(list.ents[i].path);
+  }
+  free(list.ents);
+  if (count < 0) {
+    fprintf(stderr, "failed to write pack: %s/pack: %s\n", store->root,
+            strerror(errno));
+    return -1;
+  }
+
+  if (all && count > 0) {
+    for (size_t p = 0; p < store->n_packs; p++) {
+      const char *old = strrchr(store->packs[p].path, '/') + 1;
+      if (strcmp(old, name) == 0) {
+        continue;
+      }
+      char path[PATH_MAX];
+      if (make_path(path, "%s.idx", store->packs[p].path) == 0) {
+        unlink(path);
+      }
+      if (make_path(path, "%s.pack", store->packs[p].path) == 0) {
+        unlink(path);
+      }
+    }
+  }
+  pthread_rwlock_wrlock(&store->packs_lock);
+  unload_packs(store);
+  load_packs(store, 1);
+  pthread_rwlock_unlock(&store->packs_lock);
+  return count;
+}
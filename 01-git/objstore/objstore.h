@@ -0,0 +1,75 @@
+#ifndef OBJSTORE_H
+#define OBJSTORE_H
+
+#include <stdint.h>
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+// Objects are named by the lowercase hex SHA-256 of their content
+#define OBJ_HASH_LEN 64
+#define OBJ_DIGEST_LEN 32
+
+// A CAFS object store rooted at a directory. A store starts flat: new
+// objects are written as <64 hex> files, which every CAFS tool reads.
+// Once sharded, which is kept in the store, they are written loose under
+// ab/cd/<60 hex> fanout dirs instead, and repack may move them into
+// immutable packs in pack/: <name>.pack is the objects back to back,
+// <name>.idx their sorted hashes with a fanout table, both mapped at
+// open. All three layouts are read either way, but only the tools that
+// read through the store see sharded objects. The layout is read at
+// open, so a store sharded while open goes on writing flat until reopened.
+// Reads are safe from several threads, and so are writes. An object
+// found nowhere is looked for again in the packs added to pack/ since,
+// so objects another process repacks stay readable.
+typedef struct obj_store obj_store_t;
+
+// The name of an object with this content, not NUL-terminated
+void obj_store_hash(const unsigned char *obj, uint64_t len,
+                    unsigned char hash_out[OBJ_HASH_LEN]);
+
+typedef struct obj_data {
+  const unsigned char *data;
+  uint64_t len;
+  // The mapping of an unpacked object, NULL for a packed one
+  void *map;
+} obj_data_t;
+
+obj_store_t *obj_store_open(const char *root);
+void obj_store_close(obj_store_t *store);
+
+int obj_store_has(obj_store_t *store, const unsigned char *hash);
+
+// 0 and the object in data_out, valid until obj_store_release, or -1
+int obj_store_read(obj_store_t *store, const unsigned char *hash,
+                   obj_data_t *data_out);
+void obj_store_release(obj_data_t *data);
+
+// The object as a read-only stream, NULL if there is none
+FILE *obj_store_open_stream(obj_store_t *store, const unsigned char *hash);
+
+// Writes the object unless the store has it already; the hex hash goes
+// to hash_out, not NUL-terminated. 0 on success, -1 on error
+int obj_store_write(obj_store_t *store, const unsigned char *obj,
+                    uint64_t len, unsigned char hash_out[OBJ_HASH_LEN]);
+
+int obj_store_is_sharded(const obj_store_t *store);
+
+// Switches the store to the sharded layout for good. 0 on success, -1
+// on error
+int obj_store_shard(obj_store_t *store);
+
+// Moves every flat and loose object of a sharded store into one new
+// pack, checking each against its name; with all set the existing packs
+// are folded into it as well. The number of objects packed, or -1, with
+// EPERM for a store that is not sharded. Packed objects read before
+// are no longer valid, so no other call may run on the store meanwhile
+int64_t obj_store_repack(obj_store_t *store, int all);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif // OBJSTORE_H
@@ -0,0 +1,44 @@
+#include <stdio.h>
+#include <string.h>
+
+#include "objstore.h"
+
+int main(int argc, char** argv) {
+  int all = 0;
+  int shard = 0;
+  const char* root = ".";
+  for (int i = 1; i < argc; i++) {
+    if (strcmp(argv[i], "-a") == 0) {
+      all = 1;
+    } else if (strcmp(argv[i], "-s") == 0) {
+      shard = 1;
+    } else if (root[0] == '.' && root[1] == '\0' && argv[i][0] != '-') {
+      root = argv[i];
+    } else {
+      printf("Invalid arguments. Usage: repack [-a] [-s] [store-dir]\n");
+      return 1;
+    }
+  }
+
+  obj_store_t* store = obj_store_open(root);
+  if (store == NULL) {
+    printf("failed to open store %s\n", root);
+    return 1;
+  }
+  if (shard && obj_store_shard(store) != 0) {
+    obj_store_close(store);
+    return 1;
+  }
+  if (!obj_store_is_sharded(store)) {
+    printf("store %s is not sharded, run with -s to shard it\n", root);
+    obj_store_close(store);
+    return 1;
+  }
+  int64_t count = obj_store_repack(store, all);
+  obj_store_close(store);
+  if (count < 0) {
+    return 1;
+  }
+  printf("packed %lld objects\n", (long long)count);
+  return 0;
+}
@@ -0,0 +1,309 @@
+#include <gtest/gtest.h>
+
+#include <sys/stat.h>
+
+#include <cerrno>
+#include <cstdint>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "objstore.h"
+
+namespace {
+
+namespace fs = std::filesystem;
+
+class StoreTest : public ::testing::Test {
+ protected:
+  StoreTest() : dir_(MakeDir()), store_(obj_store_open(dir_.c_str())) {}
+
+  ~StoreTest() override {
+    obj_store_close(store_);
+    fs::remove_all(dir_);
+  }
+
+  static std::string MakeDir() {
+    std::string dir = (fs::temp_directory_path() / "objstore-XXXXXX").string();
+    EXPECT_NE(mkdtemp(dir.data()), nullptr);
+    return dir;
+  }
+
+  static std::string Hash(const std::string& content) {
+    std::string hash(OBJ_HASH_LEN, '0');
+    obj_store_hash(reinterpret_cast<const unsigned char*>(content.data()),
+                   content.size(), reinterpret_cast<unsigned char*>(hash.data()));
+    return hash;
+  }
+
+  static const unsigned char* Bytes(const std::string& str) {
+    return reinterpret_cast<const unsigned char*>(str.data());
+  }
+
+  static std::string FlatName(const std::string& hash) {
+    return hash;
+  }
+
+  static std::string LooseName(const std::string& hash) {
+    return hash.substr(0, 2) + "/" + hash.substr(2, 2) + "/" + hash.substr(4);
+  }
+
+  std::string Write(const std::string& content) {
+    std::string hash(OBJ_HASH_LEN, '0');
+    EXPECT_EQ(obj_store_write(store_, Bytes(content), content.size(),
+                              reinterpret_cast<unsigned char*>(hash.data())),
+              0);
+    return hash;
+  }
+
+  bool Has(const std::string& hash) {
+    return obj_store_has(store_, Bytes(hash)) != 0;
+  }
+
+  std::optional<std::string> Read(const std::string& hash,
+                                  bool* packed = nullptr) {
+    obj_data_t data;
+    if (obj_store_read(store_, Bytes(hash), &data) != 0) {
+      return std::nullopt;
+    }
+
+    std::string content(reinterpret_cast<const char*>(data.data), data.len);
+    if (packed != nullptr) {
+      *packed = data.map == nullptr;
+    }
+
+    obj_store_release(&data);
+    return content;
+  }
+
+  // Put in place by hand, as a tool not on the store would
+  void Place(const std::string& name, const std::string& content) {
+    fs::path path = fs::path(dir_) / name;
+    fs::create_directories(path.parent_path());
+    std::ofstream(path, std::ios::binary) << content;
+  }
+
+  void Reopen() {
+    obj_store_close(store_);
+    store_ = obj_store_open(dir_.c_str());
+    ASSERT_NE(store_, nullptr);
+  }
+
+  std::vector<fs::path> Packs(const std::string& extension) {
+    std::vector<fs::path> packs;
+
+    for (const auto& entry : fs::directory_iterator(fs::path(dir_) / "pack")) {
+      if (entry.path().extension() == extension) {
+        packs.push_back(entry.path());
+      }
+    }
+
+    return packs;
+  }
+
+  std::string dir_;
+  obj_store_t* store_;
+};
+
+}  // namespace
+
+TEST_F(StoreTest, PlainStoreWritesFlat) {
+  ASSERT_FALSE(obj_store_is_sharded(store_));
+  std::string hash = Write("hello");
+
+  EXPECT_EQ(hash, Hash("hello"));
+  EXPECT_TRUE(fs::is_regular_file(fs::path(dir_) / FlatName(hash)));
+  EXPECT_TRUE(Has(hash));
+  EXPECT_EQ(Read(hash), "hello");
+
+  EXPECT_FALSE(Has(Hash("other")));
+  EXPECT_EQ(Read(Hash("other")), std::nullopt);
+  EXPECT_FALSE(Has(std::string(OBJ_HASH_LEN, 'z')));
+}
+
+TEST_F(StoreTest, ShardedStoreWritesLoose) {
+  ASSERT_EQ(obj_store_shard(store_), 0);
+  std::string hash = Write("hello");
+
+  EXPECT_TRUE(fs::is_regular_file(fs::path(dir_) / LooseName(hash)));
+  EXPECT_FALSE(fs::exists(fs::path(dir_) / FlatName(hash)));
+  EXPECT_EQ(Read(hash), "hello");
+
+  Reopen();
+  EXPECT_TRUE(obj_store_is_sharded(store_));
+  EXPECT_EQ(Read(hash), "hello");
+}
+
+TEST_F(StoreTest, WrittenObjectsFollowTheUmask) {
+  mode_t mask = umask(022);
+  Reopen();
+  std::string hash = Write("hello");
+  umask(mask);
+
+  struct stat st;
+  ASSERT_EQ(stat((fs::path(dir_) / FlatName(hash)).c_str(), &st), 0);
+  EXPECT_EQ(st.st_mode & 0777, 0644u);
+}
+
+TEST_F(StoreTest, EmptyObject) {
+  std::string hash = Write("");
+
+  EXPECT_TRUE(Has(hash));
+  EXPECT_EQ(Read(hash), "");
+}
+
+TEST_F(StoreTest, EveryLayoutIsRead) {
+  Place(FlatName(Hash("flat")), "flat");
+  Place(LooseName(Hash("loose")), "loose");
+
+  EXPECT_EQ(Read(Hash("flat")), "flat");
+  EXPECT_EQ(Read(Hash("loose")), "loose");
+  EXPECT_TRUE(Has(Hash("loose")));
+
+  // Already there, so not written again
+  Write("loose");
+  EXPECT_FALSE(fs::exists(fs::path(dir_) / FlatName(Hash("loose"))));
+}
+
+TEST_F(StoreTest, RepackNeedsShardedStore) {
+  Write("hello");
+
+  errno = 0;
+  EXPECT_EQ(obj_store_repack(store_, 0), -1);
+  EXPECT_EQ(errno, EPERM);
+  EXPECT_FALSE(fs::exists(fs::path(dir_) / "pack"));
+}
+
+TEST_F(StoreTest, RepackMovesFlatAndLooseIntoPack) {
+  Place(FlatName(Hash("flat")), "flat");
+  ASSERT_EQ(obj_store_shard(store_), 0);
+  std::string loose = Write("loose");
+
+  ASSERT_EQ(obj_store_repack(store_, 0), 2);
+  EXPECT_FALSE(fs::exists(fs::path(dir_) / FlatName(Hash("flat"))));
+  EXPECT_FALSE(fs::exists(fs::path(dir_) / LooseName(loose)));
+  // The fanout dirs go with their last object
+  EXPECT_FALSE(fs::exists(fs::path(dir_) / loose.substr(0, 2)));
+  EXPECT_EQ(Packs(".pack").size(), 1u);
+  EXPECT_EQ(Packs(".idx").size(), 1u);
+
+  for (const char* content : {"flat", "loose"}) {
+    bool packed = false;
+    EXPECT_EQ(Read(Hash(content), &packed), content);
+    EXPECT_TRUE(packed);
+  }
+
+  Reopen();
+  EXPECT_EQ(Read(Hash("flat")), "flat");
+  EXPECT_EQ(Read(Hash("loose")), "loose");
+}
+
+TEST_F(StoreTest, RepackDropsCopiesAlreadyPacked) {
+  ASSERT_EQ(obj_store_shard(store_), 0);
+  Write("hello");
+  ASSERT_EQ(obj_store_repack(store_, 0), 1);
+
+  Place(FlatName(Hash("hello")), "hello");
+  EXPECT_EQ(obj_store_repack(store_, 0), 0);
+  EXPECT_FALSE(fs::exists(fs::path(dir_) / FlatName(Hash("hello"))));
+  EXPECT_EQ(Packs(".pack").size(), 1u);
+  EXPECT_EQ(Read(Hash("hello")), "hello");
+}
+
+TEST_F(StoreTest, RepackSkipsCorruptObject) {
+  ASSERT_EQ(obj_store_shard(store_), 0);
+  std::string good = Write("good");
+  std::string bad = LooseName(Hash("bad"));
+  Place(bad, "not what the name says");
+
+  EXPECT_EQ(obj_store_repack(store_, 0), 1);
+  EXPECT_TRUE(fs::exists(fs::path(dir_) / bad));
+  EXPECT_FALSE(fs::exists(fs::path(dir_) / LooseName(good)));
+
+  bool packed = true;
+  EXPECT_EQ(Read(Hash("bad"), &packed), "not what the name says");
+  EXPECT_FALSE(packed);
+}
+
+TEST_F(StoreTest, RepackAllFoldsPacks) {
+  ASSERT_EQ(obj_store_shard(store_), 0);
+  std::vector<std::string> contents = {"a", "b", "c", "d"};
+
+  for (const std::string& content : contents) {
+    Write(content);
+    ASSERT_EQ(obj_store_repack(store_, 0), 1);
+  }
+  ASSERT_EQ(Packs(".pack").size(), contents.size());
+
+  Write("e");
+  contents.push_back("e");
+  EXPECT_EQ(obj_store_repack(store_, 1), 5);
+  EXPECT_EQ(Packs(".pack").size(), 1u);
+  EXPECT_EQ(Packs(".idx").size(), 1u);
+
+  Reopen();
+  for (const std::string& content : contents) {
+    EXPECT_EQ(Read(Hash(content)), content);
+  }
+
+  // One pack and nothing loose: nothing to do
+  EXPECT_EQ(obj_store_repack(store_, 1), 0);
+  EXPECT_EQ(Packs(".pack").size(), 1u);
+}
+
+TEST_F(StoreTest, RepackByAnotherStoreIsSeen) {
+  ASSERT_EQ(obj_store_shard(store_), 0);
+  std::string hash = Write("hello");
+  ASSERT_EQ(Read(hash), "hello");
+
+  obj_store_t* other = obj_store_open(dir_.c_str());
+  ASSERT_EQ(obj_store_repack(other, 0), 1);
+  obj_store_close(other);
+
+  bool packed = false;
+  EXPECT_EQ(Read(hash, &packed), "hello");
+  EXPECT_TRUE(packed);
+  EXPECT_TRUE(Has(hash));
+
+  FILE* stream = obj_store_open_stream(store_, Bytes(hash));
+  ASSERT_NE(stream, nullptr);
+  char buf[16] = {};
+  EXPECT_EQ(fread(buf, 1, sizeof(buf), stream), 5u);
+  EXPECT_STREQ(buf, "hello");
+  fclose(stream);
+}
+
+TEST_F(StoreTest, TruncatedIndexIsRejected) {
+  ASSERT_EQ(obj_store_shard(store_), 0);
+  std::string hash = Write("hello");
+  ASSERT_EQ(obj_store_repack(store_, 0), 1);
+
+  fs::path idx = Packs(".idx").at(0);
+  fs::resize_file(idx, fs::file_size(idx) - 1);
+
+  Reopen();
+  EXPECT_FALSE(Has(hash));
+  EXPECT_EQ(Read(hash), std::nullopt);
+}
+
+TEST_F(StoreTest, CorruptIndexIsRejected) {
+  ASSERT_EQ(obj_store_shard(store_), 0);
+  std::string hash = Write("hello");
+  ASSERT_EQ(obj_store_repack(store_, 0), 1);
+
+  // The offset of the only object, after the magic, count, padding,
+  // fanout and digest, pointed past the end of the pack
+  fs::path idx = Packs(".idx").at(0);
+  std::fstream file(idx, std::ios::in | std::ios::out | std::ios::binary);
+  uint64_t offset = 1 << 20;
+  file.seekp(8 + 8 + 256 * 4 + OBJ_DIGEST_LEN);
+  file.write(reinterpret_cast<const char*>(&offset), sizeof(offset));
+  file.close();
+
+  Reopen();
+  EXPECT_FALSE(Has(hash));
+  EXPECT_EQ(Read(hash), std::nullopt);
+}
@@ -1,12 +1,7 @@
 #include "empty_dir.hpp"
-#include "sha256.hpp"
 
-#include <fstream>
+#include "cafs/object_store.hpp"
 
 void CreateEmptyIfNotExists() {
-  static const auto empty_file_hash = ComputeHash("");
-
-  std::fstream empty_file;
-  empty_file.open(empty_file_hash, std::ios::out | std::ios::app);
-  empty_file.close();
+  cafs::ObjectStore::Current().Write("");
 }
@@ -1,16 +1,20 @@
 #include "git_put.hpp"
 
 #include <algorithm>
+#include <deque>
 #include <filesystem>
 #include <format>
-#include <fstream>
 #include <iostream>
 #include <map>
 #include <optional>
+#include <stdexcept>
+#include <system_error>
 #include <unordered_map>
 #include <vector>
 
-#include "sha256.hpp"
+#include "cafs/object_store.hpp"
+#include "cafs/tree.hpp"
+#include "read_content.hpp"
 
 namespace {
 
@@ -29,37 +33,30 @@ std::pair<std::string, std::vector<std::string>> SplitPath(
   return {std::move(filename), std::move(dirs)};
 }
 
-std::map<std::string, std::string> ParseDir(const std::string& dir_hash) {
+std::optional<std::map<std::string, std::string>> ParseDir(
+    const std::string& dir_hash) {
   std::map<std::string, std::string> hash_by_name;
 
-  {
-    std::ifstream dir{dir_hash};
-
-    for (std::string line; std::getline(dir, line);) {
-      std::string name;
-      std::string hash;
-
-      std::istringstream ss{line};
-      ss >> name >> hash;
+  const auto dir = cafs::ObjectStore::Current().Read(dir_hash);
+  if (!dir) {
+    std::cerr << std::format("No file with hash {}\n", dir_hash);
+    return std::nullopt;
+  }
 
-      hash_by_name.emplace_hint(hash_by_name.end(), std::move(name),
-                                std::move(hash));
+  try {
+    for (const auto& entry : cafs::ParseTree(dir->View())) {
+      hash_by_name.emplace_hint(hash_by_name.end(), entry.Key(), entry.hash);
     }
-
-    dir.close();
+  } catch (const cafs::TreeError& err) {
+    std::cerr << std::format("Bad directory {}: {}\n", dir_hash, err.what());
+    return std::nullopt;
   }
 
   return hash_by_name;
 }
 
 std::string CreateBlob(const std::string& file_content) {
-  std::string content_hash = ComputeHash(file_content);
-
-  std::ofstream file{content_hash};
-  file.write(file_content.data(), file_content.size());
-  file.close();
-
-  return content_hash;
+  return cafs::ObjectStore::Current().Write(file_content);
 }
 
 std::string CreateDir(const std::map<std::string, std::string>& hash_by_name) {
@@ -72,12 +69,23 @@ std::string CreateDir(const std::map<std::string, std::string>& hash_by_name) {
   return CreateBlob(result_content);
 }
 
+// A directory on the path of some put of a batch: its entries as read,
+// and what the batch changes in it
+struct TreeOverlay {
+  std::map<std::string, std::string> hash_by_name;
+  // By "name/"
+  std::map<std::string, TreeOverlay*> subdirs;
+  // By "name:", the index of the last put of the file
+  std::map<std::string, size_t> files;
+  std::string new_hash;
+};
+
 }  // namespace
 
 std::optional<std::string> GitPut(const std::string& root_hash,
                                   const std::string& file_path,
                                   const std::string& file_content) {
-  if (!std::filesystem::exists(root_hash)) {
+  if (!cafs::ObjectStore::Current().Has(root_hash)) {
     std::cerr << "Root directory does not exists" << std::endl;
     return std::nullopt;
   }
@@ -92,15 +100,13 @@ std::optional<std::string> GitPut(const std::string& root_hash,
   {
     std::string cur_hash{root_hash};
     for (size_t cur_dir = 0; cur_dir < dirs.size(); ++cur_dir) {
-      if (!std::filesystem::exists(cur_hash)) {
-        std::cerr << std::format("No file with hash {}\n", cur_hash);
+      auto hash_by_name = ParseDir(cur_hash);
+      if (!hash_by_name) {
         return std::nullopt;
       }
 
-      const auto hash_by_name = ParseDir(cur_hash);
-
-      auto next_hash_it = hash_by_name.find(dirs.at(cur_dir));
-      if (next_hash_it == hash_by_name.end()) {
+      auto next_hash_it = hash_by_name->find(dirs.at(cur_dir));
+      if (next_hash_it == hash_by_name->end()) {
         std::cerr << std::format("Not found reference to {} in {}\n",
                                  dirs.at(cur_dir), cur_hash);
         return std::nullopt;
@@ -114,17 +120,135 @@ std::optional<std::string> GitPut(const std::string& root_hash,
   std::ranges::reverse(dir_hashes);
 
   std::string new_filename = std::format("{}:", filename);
-  std::string new_file_hash = CreateBlob(file_content);
-  for (const auto& dir_hash : dir_hashes) {
-    auto dir = ParseDir(dir_hash);
-    dir[new_filename] = new_file_hash;
-    if (dir_hash == root_hash) {
-      dir[".parent/"] = root_hash;
-    }
+  std::string new_file_hash;
+  try {
+    new_file_hash = CreateBlob(file_content);
+    for (const auto& dir_hash : dir_hashes) {
+      auto dir = ParseDir(dir_hash);
+      if (!dir) {
+        return std::nullopt;
+      }
+
+      (*dir)[new_filename] = new_file_hash;
+      if (dir_hash == root_hash) {
+        (*dir)[".parent/"] = root_hash;
+      }
 
-    new_filename = dir_name_by_hash.at(dir_hash);
-    new_file_hash = CreateDir(dir);
+      new_filename = dir_name_by_hash.at(dir_hash);
+      new_file_hash = CreateDir(*dir);
+    }
+  } catch (const std::system_error& err) {
+    std::cerr << err.what() << std::endl;
+    return std::nullopt;
   }
 
   return new_file_hash;
 }
+
+std::optional<std::string> GitPutBatch(const std::string& root_hash,
+                                       const std::vector<PutRequest>& puts,
+                                       WorkerPool& pool) {
+  if (!cafs::ObjectStore::Current().Has(root_hash)) {
+    std::cerr << "Root directory does not exists" << std::endl;
+    return std::nullopt;
+  }
+
+  // Every touched directory is read once, however many puts go through it
+  std::deque<TreeOverlay> trees;
+  std::vector<std::vector<TreeOverlay*>> trees_by_depth{
+      {&trees.emplace_back()}};
+  {
+    auto root = ParseDir(root_hash);
+    if (!root) {
+      return std::nullopt;
+    }
+    trees.front().hash_by_name = std::move(*root);
+  }
+
+  for (size_t put = 0; put < puts.size(); ++put) {
+    const auto [filename, dirs] = SplitPath(puts[put].file_path);
+    TreeOverlay* tree = &trees.front();
+
+    for (size_t depth = 0; depth < dirs.size(); ++depth) {
+      const std::string& dir_name = dirs[depth];
+
+      if (auto it = tree->subdirs.find(dir_name); it != tree->subdirs.end()) {
+        tree = it->second;
+        continue;
+      }
+
+      auto hash_it = tree->hash_by_name.find(dir_name);
+      if (hash_it == tree->hash_by_name.end()) {
+        std::cerr << std::format("Not found reference to {} in {}\n",
+                                 dir_name, puts[put].file_path);
+        return std::nullopt;
+      }
+
+      auto subdir = ParseDir(hash_it->second);
+      if (!subdir) {
+        return std::nullopt;
+      }
+
+      TreeOverlay* child = &trees.emplace_back();
+      child->hash_by_name = std::move(*subdir);
+      tree->subdirs.emplace(dir_name, child);
+
+      if (trees_by_depth.size() == depth + 1) {
+        trees_by_depth.emplace_back();
+      }
+      trees_by_depth[depth + 1].push_back(child);
+      tree = child;
+    }
+
+    tree->files[std::format("{}:", filename)] = put;
+  }
+
+  try {
+    // Blobs first, each read from its source and written by a worker
+    std::vector<size_t> blob_puts;
+    for (const auto& tree : trees) {
+      for (const auto& [name, put] : tree.files) {
+        blob_puts.push_back(put);
+      }
+    }
+
+    std::vector<std::string> blob_hashes(puts.size());
+    pool.Run(blob_puts.size(), [&](size_t i) {
+      const PutRequest& put = puts[blob_puts[i]];
+      auto content = ReadContent(put.content_path);
+      if (!content) {
+        throw std::runtime_error(
+            std::format("Cannot read {} for {}", put.content_path,
+                        put.file_path));
+      }
+      blob_hashes[blob_puts[i]] = CreateBlob(*content);
+    });
+
+    // Then the directories bottom-up, one level at a time, each written
+    // once with all of its changes
+    for (size_t depth = trees_by_depth.size(); depth-- > 0;) {
+      const auto& level = trees_by_depth[depth];
+
+      pool.Run(level.size(), [&](size_t i) {
+        TreeOverlay& tree = *level[i];
+
+        for (const auto& [name, put] : tree.files) {
+          tree.hash_by_name[name] = blob_hashes[put];
+        }
+        for (const auto& [name, subdir] : tree.subdirs) {
+          tree.hash_by_name[name] = subdir->new_hash;
+        }
+        if (depth == 0) {
+          tree.hash_by_name[".parent/"] = root_hash;
+        }
+
+        tree.new_hash = CreateDir(tree.hash_by_name);
+      });
+    }
+  } catch (const std::exception& err) {
+    std::cerr << err.what() << std::endl;
+    return std::nullopt;
+  }
+
+  return trees.front().new_hash;
+}
@@ -1,8 +1,29 @@
+#pragma once
+
 #include <optional>
 #include <string>
+#include <vector>
+
+#include "worker_pool.hpp"
 
 /// @returns new root hash if put completed successfully, otherwise returns
 /// std::nullopt
 std::optional<std::string> GitPut(const std::string& root_hash,
                                   const std::string& file_path,
                                   const std::string& file_content);
+
+struct PutRequest {
+  std::string file_path;
+  // File to read the content from
+  std::string content_path;
+};
+
+/// Puts all files at once: every directory on their paths is read once
+/// and written once, bottom-up, and the root gets one `.parent/` link.
+/// Blobs and directories of one level are written on the pool. Of puts
+/// to the same path the last one wins.
+/// @returns new root hash if put completed successfully, otherwise returns
+/// std::nullopt
+std::optional<std::string> GitPutBatch(const std::string& root_hash,
+                                       const std::vector<PutRequest>& puts,
+                                       WorkerPool& pool);
@@ -1,16 +1,30 @@
 #include "read_content.hpp"
 
+#include <fcntl.h>
 #include <unistd.h>
 
 #include <array>
+#include <cerrno>
+#include <iostream>
+#include <sstream>
 
-std::string ReadContent() {
+namespace {
+
+/// Reads up to the end of the file, retrying reads an interrupt cut short
+/// @returns std::nullopt on a read error, EISDIR for a directory among them
+std::optional<std::string> ReadAll(int fd) {
   std::string result;
 
   std::array<char, 4096> buf;
   for (;;) {
-    const ssize_t bytes = read(STDIN_FILENO, buf.data(), buf.size());
-    if (bytes <= 0) {
+    const ssize_t bytes = read(fd, buf.data(), buf.size());
+    if (bytes < 0 && errno == EINTR) {
+      continue;
+    }
+    if (bytes < 0) {
+      return std::nullopt;
+    }
+    if (bytes == 0) {
       break;
     }
     result.append(buf.begin(), buf.begin() + bytes);
@@ -18,3 +32,48 @@ std::string ReadContent() {
 
   return result;
 }
+
+}  // namespace
+
+std::optional<std::string> ReadContent() {
+  return ReadAll(STDIN_FILENO);
+}
+
+std::optional<std::string> ReadContent(const std::string& path) {
+  const int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return std::nullopt;
+  }
+
+  auto result = ReadAll(fd);
+  close(fd);
+
+  return result;
+}
+
+std::optional<std::vector<PutRequest>> ReadPutList() {
+  std::vector<PutRequest> puts;
+
+  const auto content = ReadContent();
+  if (!content) {
+    std::cerr << "Cannot read the put list" << std::endl;
+    return std::nullopt;
+  }
+
+  std::istringstream list{*content};
+  for (std::string line; std::getline(list, line);) {
+    if (line.empty()) {
+      continue;
+    }
+
+    const size_t tab = line.find('\t');
+    if (tab == std::string::npos) {
+      std::cerr << "No tab in put list line: " << line << std::endl;
+      return std::nullopt;
+    }
+
+    puts.push_back({line.substr(0, tab), line.substr(tab + 1)});
+  }
+
+  return puts;
+}
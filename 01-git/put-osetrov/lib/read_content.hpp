@@ -1,3 +1,18 @@
+#pragma once
+
+#include <optional>
 #include <string>
+#include <vector>
+
+#include "git_put.hpp"
+
+/// @returns the content of stdin, std::nullopt if it can not be read
+std::optional<std::string> ReadContent();
+
+/// @returns the content of the file, std::nullopt if it can not be read
+std::optional<std::string> ReadContent(const std::string& path);
 
-std::string ReadContent();
+/// Reads the puts of a batch from stdin, a `<path>\t<content-file>` line
+/// each
+/// @returns std::nullopt if stdin can not be read or some line has no tab
+std::optional<std::vector<PutRequest>> ReadPutList();
@@ -0,0 +1,99 @@
+#include "worker_pool.hpp"
+
+#include <algorithm>
+#include <utility>
+
+WorkerPool::WorkerPool(size_t threads) {
+  if (threads == 0) {
+    threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+
+  for (size_t i = 1; i < threads; ++i) {
+    threads_.emplace_back([this] { Work(); });
+  }
+}
+
+WorkerPool::~WorkerPool() {
+  {
+    std::lock_guard lock(mutex_);
+    stop_ = true;
+  }
+  wake_.notify_all();
+
+  for (auto& thread : threads_) {
+    thread.join();
+  }
+}
+
+void WorkerPool::Run(size_t count, const std::function<void(size_t)>& task) {
+  {
+    std::lock_guard lock(mutex_);
+    task_ = &task;
+    count_ = count;
+    next_ = 0;
+    error_ = nullptr;
+    ++generation_;
+  }
+  wake_.notify_all();
+
+  Drain(task, count);
+
+  std::exception_ptr error;
+  {
+    std::unique_lock lock(mutex_);
+    done_.wait(lock, [this] { return busy_ == 0; });
+    task_ = nullptr;
+    error = std::exchange(error_, nullptr);
+  }
+
+  if (error) {
+    std::rethrow_exception(error);
+  }
+}
+
+void WorkerPool::Work() {
+  uint64_t seen = 0;
+
+  for (;;) {
+    std::unique_lock lock(mutex_);
+    wake_.wait(lock, [&] { return stop_ || generation_ != seen; });
+
+    if (stop_) {
+      return;
+    }
+
+    seen = generation_;
+
+    // Woken too late, the run is over
+    if (task_ == nullptr) {
+      continue;
+    }
+
+    const std::function<void(size_t)>& task = *task_;
+    size_t count = count_;
+    ++busy_;
+    lock.unlock();
+
+    Drain(task, count);
+
+    lock.lock();
+    if (--busy_ == 0) {
+      done_.notify_all();
+    }
+  }
+}
+
+void WorkerPool::Drain(const std::function<void(size_t)>& task,
+                       size_t count) {
+  for (size_t i; (i = next_.fetch_add(1)) < count;) {
+    try {
+      task(i);
+    } catch (...) {
+      std::lock_guard lock(mutex_);
+      if (!error_) {
+        error_ = std::current_exception();
+      }
+      next_ = count;
+    }
+  }
+}
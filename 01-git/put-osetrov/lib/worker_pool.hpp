@@ -0,0 +1,46 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <exception>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+/// Worker threads started once and reused by every Run
+class WorkerPool {
+ public:
+  /// @param threads workers including the calling thread, 0 for one per core
+  explicit WorkerPool(size_t threads = 0);
+  ~WorkerPool();
+
+  WorkerPool(const WorkerPool&) = delete;
+  WorkerPool& operator=(const WorkerPool&) = delete;
+
+  /// Calls task(i) for every i < count on the workers and the calling
+  /// thread, returns once all are done. Rethrows the first exception,
+  /// the tasks not yet started are then skipped.
+  void Run(size_t count, const std::function<void(size_t)>& task);
+
+ private:
+  void Work();
+  void Drain(const std::function<void(size_t)>& task, size_t count);
+
+  std::mutex mutex_;
+  std::condition_variable wake_;
+  std::condition_variable done_;
+
+  // The current run, guarded by mutex_
+  const std::function<void(size_t)>* task_ = nullptr;
+  size_t count_ = 0;
+  uint64_t generation_ = 0;
+  size_t busy_ = 0;
+  bool stop_ = false;
+  std::exception_ptr error_;
+
+  std::atomic<size_t> next_ = 0;
+  std::vector<std::thread> threads_;
+};
@@ -1,29 +1,82 @@
+#include <charconv>
 #include <iostream>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <system_error>
 
 #include "lib/empty_dir.hpp"
 #include "lib/git_put.hpp"
 #include "lib/read_content.hpp"
 #include "lib/sha256.hpp"
 
+namespace {
+
+// More is surely a typo; each is a thread of its own
+constexpr size_t kMaxThreads = 1024;
+
+void Usage(const char* name) {
+  std::cerr << "Usage: " << name << " <path> <root-hash>\n"
+            << "       " << name << " --batch <root-hash> [threads]"
+            << std::endl;
+  std::exit(1);
+}
+
+/// @returns false unless arg is a thread count in [1, kMaxThreads]
+bool ParseThreads(std::string_view arg, size_t& threads) {
+  auto [end, error] =
+      std::from_chars(arg.data(), arg.data() + arg.size(), threads);
+  return error == std::errc{} && end == arg.data() + arg.size() &&
+         threads != 0 && threads <= kMaxThreads;
+}
+
+std::optional<std::string> RunBatch(const std::string& root_hash,
+                                    size_t threads) {
+  const auto puts = ReadPutList();
+  if (!puts) {
+    return std::nullopt;
+  }
+
+  WorkerPool pool{threads};
+  return GitPutBatch(root_hash, *puts, pool);
+}
+
+}  // namespace
+
 int main(int argc, char* argv[]) {
-  if (argc != 3) {
-    std::cerr << "Usage: " << argv[0] << " <path> <root-hash>" << std::endl;
-    std::exit(1);
+  const bool batch = argc > 1 && std::string{argv[1]} == "--batch";
+  if (batch ? argc != 3 && argc != 4 : argc != 3) {
+    Usage(argv[0]);
   }
 
   CreateEmptyIfNotExists();
 
-  const std::string file_path{argv[1]};
   const std::string root_hash{argv[2]};
 
+  size_t threads = 0;
+  if (batch && argc == 4 && !ParseThreads(argv[3], threads)) {
+    Usage(argv[0]);
+  }
+
   if (!IsValidSHA256(root_hash)) {
     std::cerr << "Given hash is not valid SHA-256 hash hex string" << std::endl;
     std::exit(1);
   }
 
-  const std::string file_content = ReadContent();
+  std::optional<std::string> new_root_hash;
+  if (batch) {
+    new_root_hash = RunBatch(root_hash, threads);
+  } else {
+    const std::string file_path{argv[1]};
+    const auto file_content = ReadContent();
+    if (!file_content) {
+      std::cerr << "Cannot read the content from stdin" << std::endl;
+      std::exit(1);
+    }
+    new_root_hash = GitPut(root_hash, file_path, *file_content);
+  }
 
-  if (const auto new_root_hash = GitPut(root_hash, file_path, file_content)) {
+  if (new_root_hash) {
     std::cout << *new_root_hash << std::endl;
     std::exit(0);
   } else {
@@ -1,5 +1,6 @@
 #include <cassert>
 #include <cstddef>
+#include <regex>
 #include <vector>
 
 #include <argparse/argparse.hpp>
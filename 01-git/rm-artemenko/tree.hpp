@@ -1,15 +1,16 @@
 #pragma once
 
-#include <cassert>
-#include <fstream>
+#include <algorithm>
 #include <list>
 #include <optional>
 #include <sstream>
-#include <regex>
 #include <iostream>
 
 #include <fmt/core.h>
 
+#include <cafs/object_store.hpp>
+#include <cafs/tree.hpp>
+
 #include <picosha2.h>
 
 enum class EntryType {
@@ -25,29 +26,6 @@ struct Entry {
 
 class Tree {
  private:
-  static Entry ParseLine(const std::string& line) {
-    static const std::regex blob_matcher("^([^\t :/]+):\t([a-fA-F0-9]{64})$");
-    static const std::regex tree_matcher("^([^\t :/]+)/\t([a-fA-F0-9]{64})$");
-
-    std::smatch pieces_match;
-    Entry entry;
-
-    if (std::regex_match(line, pieces_match, blob_matcher)) {
-      entry.type = EntryType::Blob;
-    } else if (std::regex_match(line, pieces_match, tree_matcher)) {
-      entry.type = EntryType::Tree;
-    } else {
-      throw std::logic_error("incorrect format of tree file");
-    }
-
-    assert(pieces_match.size() == 3);
-
-    entry.name = pieces_match[1].str();
-    entry.hash = pieces_match[2].str();
-
-    return entry;
-  }
-
   explicit Tree(std::list<Entry> entries)
     : entries_{std::move(entries)} {}
 
@@ -79,16 +57,26 @@ class Tree {
 
  public:
   static Tree fromHash(const std::string& hash) {
-    std::ifstream tree_file(hash, std::ios::in);
+    auto tree_file = cafs::ObjectStore::Current().Read(hash);
 
-    if (!tree_file.good()) {
+    if (!tree_file) {
       throw std::logic_error(fmt::format("tree: '{}' not found", hash));
     }
 
     std::list<Entry> entries;
 
-    for (std::string line; std::getline(tree_file, line);) {
-      entries.push_back(ParseLine(line));
+    try {
+      cafs::TreeParser parser(tree_file->View());
+
+      for (cafs::TreeEntry line; parser.Next(line);) {
+        EntryType type = line.type == cafs::EntryType::Blob ? EntryType::Blob
+                                                            : EntryType::Tree;
+        entries.push_back(
+            Entry{std::string(line.name), std::string(line.hash), type});
+      }
+    } catch (const cafs::TreeError& err) {
+      throw std::logic_error(fmt::format(
+          "incorrect format of tree file '{}': {}", hash, err.what()));
     }
 
     return Tree(std::move(entries));
@@ -107,17 +95,7 @@ class Tree {
   }
 
   void WriteToFile() {
-    std::string data = Serialize();
-    std::string hash = picosha2::hash256_hex_string(data);
-
-    std::ofstream tree_file(hash, std::ios::out | std::ios::trunc);
-
-    if (!tree_file.good()) {
-      throw std::runtime_error("can not open output file");
-    }
-
-    tree_file << data;
-    tree_file.close();
+    cafs::ObjectStore::Current().Write(Serialize());
   }
 
   std::string CalculateHash() {
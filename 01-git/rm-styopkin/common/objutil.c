@@ -28,32 +28,30 @@ void obj_hash(const unsigned char *obj, uint64_t len, char unsigned hash_out[HAS
   hash_to_digest(hash_out, SHA256_DIGEST_LENGTH);
 }
 
-void obj_path_by_hash(const unsigned char hash[HASH_LEN], char unsigned path_out[HASH_LEN + 2]) {
-  for (int i = 0; i < HASH_LEN; i++) {
-    path_out[i] = hash[i];
+obj_store_t *objutil_store(void) {
+  static obj_store_t *store = NULL;
+  if (store == NULL) {
+    store = obj_store_open(".");
   }
-  path_out[HASH_LEN] = '\0';
+  return store;
+}
+
+FILE *open_object(const unsigned char hash[HASH_LEN]) {
+  obj_store_t *store = objutil_store();
+  if (store == NULL) {
+    return NULL;
+  }
+  return obj_store_open_stream(store, hash);
 }
 
 int write_object(const unsigned char *obj, uint64_t len, unsigned char hash_out[HASH_LEN]) {
-  obj_hash(obj, len, hash_out);
-  unsigned char obj_path[HASH_LEN + 2];
-  obj_path_by_hash(hash_out, obj_path);
-  unsigned char obj_dir[3];
-  int fd = open(obj_path, O_WRONLY | O_CREAT | O_EXCL, S_IRUSR | S_IWUSR);
-  if (fd < 0) {
-    fprintf(stderr, "failed to write object: %s: %s\n", obj_path, strerror(errno));
+  obj_store_t *store = objutil_store();
+  if (store == NULL) {
+    fprintf(stderr, "failed to open object store\n");
     return 3;
   }
-  FILE* stream = fdopen(fd, "w");
-  ssize_t n_written = fprintf(stream, "%s", obj);
-  fflush(stream);
-  if (n_written != len) {
-    fprintf(stderr, "failed to write object: %s: %s\n", obj_path, strerror(errno));
-    close(fd);
-    remove(obj_path);
+  if (obj_store_write(store, obj, len, hash_out) != 0) {
     return 3;
   }
-  close(fd);
   return 0;
 }
\ No newline at end of file
@@ -0,0 +1,64 @@
+#include "alloc_counter.hpp"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+// The replacements live apart from the benches and are never inlined
+// into them: gcc pairs an inlined new with the free in delete and warns
+// of a mismatch.
+namespace {
+
+std::atomic<size_t> allocations = 0;
+
+}  // namespace
+
+namespace bench {
+
+size_t Allocations() {
+  return allocations.load(std::memory_order_relaxed);
+}
+
+}  // namespace bench
+
+[[gnu::noinline]] void* operator new(size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+
+  if (void* pointer = std::malloc(size)) {
+    return pointer;
+  }
+
+  throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void* operator new(size_t size,
+                                     std::align_val_t alignment) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+
+  size_t align = size_t(alignment);
+  size = (size + align - 1) / align * align;
+
+  if (void* pointer = std::aligned_alloc(align, size)) {
+    return pointer;
+  }
+
+  throw std::bad_alloc();
+}
+
+[[gnu::noinline]] void operator delete(void* pointer,
+                                       std::align_val_t) noexcept {
+  std::free(pointer);
+}
+
+[[gnu::noinline]] void operator delete(void* pointer, size_t,
+                                       std::align_val_t) noexcept {
+  std::free(pointer);
+}
+
+[[gnu::noinline]] void operator delete(void* pointer) noexcept {
+  std::free(pointer);
+}
+
+[[gnu::noinline]] void operator delete(void* pointer, size_t) noexcept {
+  std::free(pointer);
+}
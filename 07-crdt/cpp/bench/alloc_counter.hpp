@@ -0,0 +1,12 @@
+#pragma once
+
+#include <cstddef>
+
+namespace bench {
+
+// Heap allocations of the whole process so far, from any thread. The
+// benches that read it link alloc_counter.cpp, which replaces the global
+// operator new and delete.
+size_t Allocations();
+
+}  // namespace bench
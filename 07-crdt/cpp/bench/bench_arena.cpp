@@ -0,0 +1,127 @@
+#include <benchmark/benchmark.h>
+
+#include <vector>
+
+#include <ll/arena.hpp>
+#include <ll/zipint.hpp>
+#include <isfr/types.hpp>
+#include <mel/element.hpp>
+#include <mel/set.hpp>
+
+#include "alloc_counter.hpp"
+
+namespace {
+
+constexpr size_t kReplicas = 4;
+
+// A packet's worth of LWW registers and small sets from 4 replicas
+struct Packet {
+  std::vector<ll::Bytes> registers;
+  std::vector<ll::Buffer> register_buffers;
+  std::vector<ll::Span> register_spans;
+
+  std::vector<ll::Buffer> values;
+  std::vector<ll::Buffer> sets;
+  std::vector<ll::Span> set_spans;
+};
+
+Packet MakePacket() {
+  Packet packet;
+
+  for (size_t replica = 0; replica < kReplicas; ++replica) {
+    ll::Bytes tlv = isfr::Itlv(int64_t(replica * 1000),
+                               isfr::Time{int64_t(replica % 3), replica});
+    packet.registers.push_back(tlv);
+    packet.register_buffers.emplace_back(tlv.begin(), tlv.end());
+  }
+
+  for (int64_t i = 0; i < 16; ++i) {
+    ll::Bytes zipped = ll::Zip(i);
+    packet.values.emplace_back(zipped.begin(), zipped.end());
+  }
+
+  for (size_t replica = 0; replica < kReplicas; ++replica) {
+    mel::Elements elements;
+
+    for (size_t i = replica; i < packet.values.size(); i += 2) {
+      elements.push_back({'I', {1, replica}, packet.values[i], {}});
+    }
+
+    packet.sets.push_back(mel::Etlv(elements));
+  }
+
+  packet.register_spans.assign(packet.register_buffers.begin(),
+                               packet.register_buffers.end());
+  packet.set_spans.assign(packet.sets.begin(), packet.sets.end());
+
+  return packet;
+}
+
+void Report(benchmark::State& state, size_t before) {
+  double allocated = double(bench::Allocations() - before);
+  state.counters["allocs_per_op"] =
+      benchmark::Counter(allocated / double(state.iterations()));
+}
+
+void BM_ImergeBytes(benchmark::State& state) {
+  Packet packet = MakePacket();
+  size_t before = bench::Allocations();
+
+  for (auto _ : state) {
+    ll::Bytes merged = isfr::Imerge(packet.registers);
+    ll::Bytes delta = isfr::Idelta(merged, 7);
+    benchmark::DoNotOptimize(delta);
+  }
+
+  Report(state, before);
+}
+
+void BM_ImergeArena(benchmark::State& state) {
+  Packet packet = MakePacket();
+  ll::Arena arena;
+  size_t before = bench::Allocations();
+
+  for (auto _ : state) {
+    ll::Span merged = isfr::Imerge(packet.register_spans, arena);
+    ll::Span delta = isfr::Idelta(merged, 7, arena);
+    benchmark::DoNotOptimize(delta.data());
+    arena.Reset();
+  }
+
+  Report(state, before);
+}
+
+void BM_EmergeBuffer(benchmark::State& state) {
+  Packet packet = MakePacket();
+  size_t before = bench::Allocations();
+
+  for (auto _ : state) {
+    ll::Buffer merged = mel::Emerge(packet.set_spans);
+    benchmark::DoNotOptimize(merged.data());
+  }
+
+  Report(state, before);
+}
+
+void BM_EmergeArena(benchmark::State& state) {
+  Packet packet = MakePacket();
+  ll::Arena arena;
+  size_t before = bench::Allocations();
+
+  for (auto _ : state) {
+    ll::Span merged = mel::Emerge(packet.set_spans, arena);
+    benchmark::DoNotOptimize(merged.data());
+    arena.Reset();
+  }
+
+  Report(state, before);
+}
+
+}  // namespace
+
+BENCHMARK(BM_ImergeBytes);
+BENCHMARK(BM_ImergeArena);
+BENCHMARK(BM_EmergeBuffer);
+BENCHMARK(BM_EmergeArena);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,58 @@
+#include <benchmark/benchmark.h>
+
+#include <random>
+#include <vector>
+
+#include <nz/natural.hpp>
+#include <bulk/merge.hpp>
+
+namespace {
+
+constexpr size_t kFields = 1 << 14;
+constexpr size_t kInputs = 8;
+
+// A pull worth of counters: every field gets the contributions of a
+// few replicas
+struct Pull {
+  std::vector<ll::Buffer> data;
+  std::vector<std::vector<ll::Span>> inputs;
+  std::vector<bulk::Field> fields;
+};
+
+Pull MakePull() {
+  std::mt19937_64 rng(42);
+  Pull pull;
+  pull.inputs.reserve(kFields);
+
+  for (size_t i = 0; i < kFields * kInputs; ++i) {
+    pull.data.push_back(nz::Ntlv(rng() % 100000, rng() % 64));
+  }
+
+  for (size_t i = 0; i < kFields; ++i) {
+    pull.inputs.emplace_back(pull.data.begin() + i * kInputs,
+                             pull.data.begin() + (i + 1) * kInputs);
+    pull.fields.push_back({cmn::Id{0, uint32_t(i), 1}, 'N',
+                           pull.inputs.back()});
+  }
+
+  return pull;
+}
+
+// Fields merged per second over range(0) workers
+void BM_BulkMerge(benchmark::State& state) {
+  Pull pull = MakePull();
+  bulk::MergeOptions options{.threads = size_t(state.range(0))};
+
+  for (auto _ : state) {
+    bulk::Merged merged = bulk::Merge(pull.fields, options);
+    benchmark::DoNotOptimize(merged.bytes.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * kFields);
+}
+
+}  // namespace
+
+BENCHMARK(BM_BulkMerge)->Arg(1)->Arg(2)->Arg(4)->Arg(8)->UseRealTime();
+
+BENCHMARK_MAIN();
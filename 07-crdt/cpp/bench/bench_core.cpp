@@ -0,0 +1,456 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <ll/arena.hpp>
+#include <ll/zipint.hpp>
+#include <tlv/io.hpp>
+#include <cmn/id.hpp>
+#include <isfr/types.hpp>
+
+// Baseline numbers for the shared libraries (tlv, zipint, isfr, cmn)
+// on fixed-seed corpora and the test_data/*.tlv files. Use the
+// bench_json target for machine-readable results.
+
+namespace {
+
+const char* kTestData[] = {"E0.tlv", "I0.tlv", "L0.tlv", "M0.tlv",
+                           "N0.tlv", "S0.tlv", "Z0.tlv"};
+
+ll::Buffer ReadTestData(const std::string& name) {
+  std::ifstream file(std::string(TEST_DATA_DIR) + "/" + name,
+                     std::ios::binary);
+  return ll::Buffer(std::istreambuf_iterator<char>(file), {});
+}
+
+// All test_data files back to back, repeated to about 64 KiB
+ll::Buffer TestDataCorpus() {
+  ll::Buffer one;
+
+  for (const char* name : kTestData) {
+    ll::Buffer data = ReadTestData(name);
+    one.insert(one.end(), data.begin(), data.end());
+  }
+
+  ll::Buffer corpus;
+
+  while (!one.empty() && corpus.size() < (64 << 10)) {
+    corpus.insert(corpus.end(), one.begin(), one.end());
+  }
+
+  return corpus;
+}
+
+std::vector<ll::Buffer> RandomBodies(size_t count) {
+  std::mt19937_64 rng(42);
+  std::vector<ll::Buffer> bodies(count);
+
+  for (ll::Buffer& body : bodies) {
+    body.resize(rng() % 300);
+
+    for (uint8_t& byte : body) {
+      byte = rng();
+    }
+  }
+
+  return bodies;
+}
+
+// Values with every zipped length: shifts spread them over 0..8 bytes
+std::vector<uint64_t> RandomValues(size_t count) {
+  std::mt19937_64 rng(42);
+  std::vector<uint64_t> values(count);
+
+  for (uint64_t& value : values) {
+    value = rng() >> (rng() % 64);
+  }
+
+  return values;
+}
+
+// `count` versions of an I register, as many replicas would send
+std::vector<ll::Bytes> Registers(size_t count) {
+  std::mt19937_64 rng(42);
+  std::vector<ll::Bytes> tlvs;
+
+  for (size_t i = 0; i < count; ++i) {
+    tlvs.push_back(isfr::Itlv(int64_t(rng() % 1000),
+                              {int64_t(rng() % 16), rng() % 64}));
+  }
+
+  return tlvs;
+}
+
+void BM_TlvWrite(benchmark::State& state) {
+  std::vector<ll::Buffer> bodies = RandomBodies(1000);
+  size_t bytes = 0;
+
+  for (auto _ : state) {
+    tlv::BufferWriter writer;
+
+    for (const ll::Buffer& body : bodies) {
+      writer.WriteRecord('S', body);
+    }
+
+    bytes += writer.Size();
+    benchmark::DoNotOptimize(writer.Extract());
+  }
+
+  state.SetBytesProcessed(bytes);
+}
+
+void BM_TlvWriteBytes(benchmark::State& state) {
+  std::vector<ll::Bytes> bodies;
+
+  for (const ll::Buffer& body : RandomBodies(1000)) {
+    bodies.emplace_back(body.begin(), body.end());
+  }
+  size_t bytes = 0;
+
+  for (auto _ : state) {
+    tlv::RecordWriter writer;
+
+    for (const ll::Bytes& body : bodies) {
+      writer.WriteRecord('S', body);
+    }
+
+    ll::Bytes tlv = writer.Extract();
+    bytes += tlv.size();
+    benchmark::DoNotOptimize(tlv);
+  }
+
+  state.SetBytesProcessed(bytes);
+}
+
+void BM_TlvRead(benchmark::State& state) {
+  ll::Buffer corpus = TestDataCorpus();
+
+  for (auto _ : state) {
+    tlv::ViewReader reader(corpus);
+
+    while (reader.HasSome()) {
+      benchmark::DoNotOptimize(reader.ReadNext());
+    }
+  }
+
+  state.SetBytesProcessed(state.iterations() * corpus.size());
+}
+
+void BM_TlvReadBytes(benchmark::State& state) {
+  ll::Buffer corpus = TestDataCorpus();
+  ll::Bytes bytes(corpus.begin(), corpus.end());
+
+  for (auto _ : state) {
+    tlv::RecordReader reader(bytes);
+
+    while (reader.HasSome()) {
+      benchmark::DoNotOptimize(reader.ReadNext());
+    }
+  }
+
+  state.SetBytesProcessed(state.iterations() * corpus.size());
+}
+
+void BM_Zip(benchmark::State& state) {
+  std::vector<uint64_t> values = RandomValues(1024);
+  uint8_t out[ll::kMaxZipLen];
+
+  for (auto _ : state) {
+    for (uint64_t value : values) {
+      benchmark::DoNotOptimize(ll::ZipTo(out, value));
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+void BM_Unzip(benchmark::State& state) {
+  std::vector<uint64_t> values = RandomValues(1024);
+  std::vector<uint8_t> zipped(values.size() * ll::kMaxZipLen);
+  std::vector<ll::Span> spans;
+
+  for (size_t i = 0; i < values.size(); ++i) {
+    uint8_t* out = zipped.data() + i * ll::kMaxZipLen;
+    spans.emplace_back(out, ll::ZipTo(out, values[i]));
+  }
+
+  for (auto _ : state) {
+    for (ll::Span span : spans) {
+      benchmark::DoNotOptimize(ll::UnzipU64(span));
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * spans.size());
+}
+
+void BM_ZipPair(benchmark::State& state) {
+  std::vector<uint64_t> values = RandomValues(1024);
+  uint8_t out[ll::kMaxZipLen];
+
+  for (auto _ : state) {
+    for (size_t i = 0; i + 1 < values.size(); i += 2) {
+      benchmark::DoNotOptimize(ll::ZipTo(out, values[i], values[i + 1]));
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * values.size() / 2);
+}
+
+void BM_UnzipPair(benchmark::State& state) {
+  std::vector<uint64_t> values = RandomValues(1024);
+  std::vector<uint8_t> zipped(values.size() * ll::kMaxZipLen);
+  std::vector<ll::Span> spans;
+
+  for (size_t i = 0; i + 1 < values.size(); i += 2) {
+    uint8_t* out = zipped.data() + i * ll::kMaxZipLen;
+    spans.emplace_back(out, ll::ZipTo(out, values[i], values[i + 1]));
+  }
+
+  for (auto _ : state) {
+    for (ll::Span span : spans) {
+      benchmark::DoNotOptimize(ll::UnzipU64Pair(span));
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * spans.size());
+}
+
+void BM_ZipBytes(benchmark::State& state) {
+  std::vector<uint64_t> values = RandomValues(1024);
+
+  for (auto _ : state) {
+    for (uint64_t value : values) {
+      ll::Bytes bytes = ll::Zip(value);
+      benchmark::DoNotOptimize(ll::UnzipU64(bytes));
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * values.size());
+}
+
+void BM_Imerge(benchmark::State& state) {
+  std::vector<ll::Bytes> tlvs = Registers(state.range(0));
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(isfr::Imerge(tlvs));
+  }
+
+  state.SetItemsProcessed(state.iterations() * tlvs.size());
+}
+
+void BM_ImergeArena(benchmark::State& state) {
+  std::vector<ll::Buffer> buffers;
+
+  for (const ll::Bytes& tlv : Registers(state.range(0))) {
+    buffers.emplace_back(tlv.begin(), tlv.end());
+  }
+
+  std::vector<ll::Span> spans(buffers.begin(), buffers.end());
+  ll::Arena arena;
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(isfr::Imerge(spans, arena));
+    arena.Reset();
+  }
+
+  state.SetItemsProcessed(state.iterations() * spans.size());
+}
+
+void BM_TestDataMerge(benchmark::State& state) {
+  std::vector<ll::Bytes> inputs[2];
+  ll::Buffer files[2] = {ReadTestData("I0.tlv"), ReadTestData("S0.tlv")};
+
+  for (size_t i = 0; i < 2; ++i) {
+    tlv::ViewReader reader(files[i]);
+
+    while (reader.HasSome()) {
+      ll::Span body = reader.ReadNext().body;
+      inputs[i].emplace_back(body.begin(), body.end());
+    }
+  }
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(isfr::Imerge(inputs[0]));
+    benchmark::DoNotOptimize(isfr::Smerge(inputs[1]));
+  }
+}
+
+// Render and parse back one value of each FIRST type
+void BM_TextRoundTrip(benchmark::State& state) {
+  std::mt19937_64 rng(42);
+  std::vector<ll::Bytes> tlvs;
+
+  for (size_t i = 0; i < 256; ++i) {
+    switch (state.range(0)) {
+      case 'I':
+        tlvs.push_back(isfr::Itlv(int64_t(rng())));
+        break;
+      case 'F':
+        tlvs.push_back(isfr::Ftlv(double(rng() % 1000000) / 64));
+        break;
+      case 'R':
+        tlvs.push_back(isfr::Rtlv(cmn::Id{rng() % 4096, rng(), rng()}));
+        break;
+      default:
+        tlvs.push_back(isfr::Stlv(std::string(rng() % 64, 'a') + "\n\"x\""));
+    }
+  }
+
+  for (auto _ : state) {
+    for (const ll::Bytes& tlv : tlvs) {
+      switch (state.range(0)) {
+        case 'I':
+          benchmark::DoNotOptimize(isfr::Iparse(isfr::Istring(tlv)));
+          break;
+        case 'F':
+          benchmark::DoNotOptimize(isfr::Fparse(isfr::Fstring(tlv)));
+          break;
+        case 'R':
+          benchmark::DoNotOptimize(isfr::Rparse(isfr::Rstring(tlv)));
+          break;
+        default:
+          benchmark::DoNotOptimize(isfr::Sparse(isfr::Sstring(tlv)));
+      }
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * tlvs.size());
+  state.SetLabel(std::string(1, char(state.range(0))));
+}
+
+void BM_IdParse(benchmark::State& state) {
+  std::mt19937_64 rng(42);
+  std::vector<std::string> texts;
+
+  for (size_t i = 0; i < 256; ++i) {
+    texts.push_back(cmn::ToString(cmn::Id{rng() % 4096, rng(), rng()}));
+  }
+
+  for (auto _ : state) {
+    for (const std::string& text : texts) {
+      benchmark::DoNotOptimize(cmn::FromString(text));
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * texts.size());
+}
+
+void BM_IdFormat(benchmark::State& state) {
+  std::mt19937_64 rng(42);
+  std::vector<cmn::Id> ids;
+
+  for (size_t i = 0; i < 256; ++i) {
+    ids.push_back(cmn::Id{rng() % 4096, rng(), rng()});
+  }
+
+  for (auto _ : state) {
+    for (cmn::Id id : ids) {
+      benchmark::DoNotOptimize(cmn::ToString(id));
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * ids.size());
+}
+
+std::vector<cmn::Id> RandomIds() {
+  std::mt19937_64 rng(42);
+  std::vector<cmn::Id> ids;
+
+  for (size_t i = 0; i < 256; ++i) {
+    ids.push_back(cmn::Id{rng() % 4096, rng(), rng()});
+  }
+
+  return ids;
+}
+
+// The deque round trip the zero-copy one replaces
+void BM_IdZipBytes(benchmark::State& state) {
+  std::vector<cmn::Id> ids = RandomIds();
+
+  for (auto _ : state) {
+    for (cmn::Id id : ids) {
+      benchmark::DoNotOptimize(cmn::UnzipID(cmn::Zip(id)));
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * ids.size());
+}
+
+void BM_IdZip(benchmark::State& state) {
+  std::vector<cmn::Id> ids = RandomIds();
+  uint8_t out[ll::kMaxZipLen];
+
+  for (auto _ : state) {
+    for (cmn::Id id : ids) {
+      size_t size = cmn::ZipTo(out, id);
+      benchmark::DoNotOptimize(cmn::UnzipID(ll::Span(out, size)));
+    }
+  }
+
+  state.SetItemsProcessed(state.iterations() * ids.size());
+}
+
+void BM_IdWriteRead(benchmark::State& state) {
+  std::vector<cmn::Id> ids = RandomIds();
+
+  for (auto _ : state) {
+    tlv::BufferWriter writer;
+    cmn::WriteIds(writer, 'V', ids);
+    benchmark::DoNotOptimize(cmn::ReadIds(writer.View(), 'V'));
+  }
+
+  state.SetItemsProcessed(state.iterations() * ids.size());
+}
+
+void BM_IdParseBatch(benchmark::State& state) {
+  std::string text;
+  cmn::AppendStrings(text, RandomIds());
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(cmn::FromStrings(text));
+  }
+
+  state.SetItemsProcessed(state.iterations() * 256);
+}
+
+void BM_IdFormatBatch(benchmark::State& state) {
+  std::vector<cmn::Id> ids = RandomIds();
+
+  for (auto _ : state) {
+    std::string text;
+    cmn::AppendStrings(text, ids);
+    benchmark::DoNotOptimize(text);
+  }
+
+  state.SetItemsProcessed(state.iterations() * ids.size());
+}
+
+}  // namespace
+
+BENCHMARK(BM_TlvWrite);
+BENCHMARK(BM_TlvWriteBytes);
+BENCHMARK(BM_TlvRead);
+BENCHMARK(BM_TlvReadBytes);
+BENCHMARK(BM_Zip);
+BENCHMARK(BM_Unzip);
+BENCHMARK(BM_ZipPair);
+BENCHMARK(BM_UnzipPair);
+BENCHMARK(BM_ZipBytes);
+BENCHMARK(BM_Imerge)->RangeMultiplier(2)->Range(2, 64);
+BENCHMARK(BM_ImergeArena)->RangeMultiplier(2)->Range(2, 64);
+BENCHMARK(BM_TestDataMerge);
+BENCHMARK(BM_TextRoundTrip)->Arg('I')->Arg('F')->Arg('R')->Arg('S');
+BENCHMARK(BM_IdParse);
+BENCHMARK(BM_IdFormat);
+BENCHMARK(BM_IdZipBytes);
+BENCHMARK(BM_IdZip);
+BENCHMARK(BM_IdWriteRead);
+BENCHMARK(BM_IdParseBatch);
+BENCHMARK(BM_IdFormatBatch);
+
+BENCHMARK_MAIN();
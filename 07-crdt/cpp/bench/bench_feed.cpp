@@ -0,0 +1,103 @@
+#include <benchmark/benchmark.h>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <string>
+#include <thread>
+
+#include <feed/feed.hpp>
+
+namespace {
+
+constexpr uint64_t kSources = 64;
+constexpr uint64_t kPerSource = 256;
+
+std::filesystem::path BenchDir(const char* name) {
+  return std::filesystem::temp_directory_path() /
+         ("bench_feed_" + std::to_string(getpid()) + "_" + name);
+}
+
+cmn::Id PacketId(uint64_t source, uint64_t sequence) {
+  cmn::Id id;
+  id.source = source;
+  id.sequence = sequence;
+  return id;
+}
+
+// A full log of range(0) byte packets fed into one that has the first
+// range(1) percent of every source, over a socketpair
+void BM_Feed(benchmark::State& state) {
+  plog::LogOptions options;
+  options.sync = false;
+  ll::Buffer body(state.range(0), 0x5a);
+  uint64_t known = kPerSource * state.range(1) / 100;
+
+  std::filesystem::remove_all(BenchDir("from"));
+  plog::PacketLog from(BenchDir("from"), options);
+
+  for (uint64_t sequence = 0; sequence < kPerSource; ++sequence) {
+    for (uint64_t source = 0; source < kSources; ++source) {
+      from.Append(PacketId(source, sequence), 'E', body);
+    }
+  }
+
+  from.Commit();
+  feed::FeedStats pushed;
+  size_t packets = 0;
+  size_t bytes = 0;
+
+  for (auto _ : state) {
+    state.PauseTiming();
+    std::filesystem::remove_all(BenchDir("to"));
+
+    {
+      plog::PacketLog to(BenchDir("to"), options);
+
+      for (uint64_t sequence = 0; sequence < known; ++sequence) {
+        for (uint64_t source = 0; source < kSources; ++source) {
+          to.Append(PacketId(source, sequence), 'E', body);
+        }
+      }
+
+      to.Commit();
+
+      int fds[2];
+      socketpair(AF_UNIX, SOCK_STREAM, 0, fds);
+      state.ResumeTiming();
+
+      std::thread pusher([&]() { pushed = feed::Push(from, fds[0]); });
+      feed::FeedStats pulled = feed::Pull(to, fds[1]);
+      pusher.join();
+
+      packets += pushed.packets;
+      bytes += pushed.sent + pulled.sent;
+      state.PauseTiming();
+
+      close(fds[0]);
+      close(fds[1]);
+    }
+
+    state.ResumeTiming();
+  }
+
+  std::filesystem::remove_all(BenchDir("to"));
+  std::filesystem::remove_all(BenchDir("from"));
+
+  state.SetItemsProcessed(packets);
+  state.SetBytesProcessed(bytes);
+  state.counters["bytes_per_op"] = packets == 0 ? 0 : double(bytes) / packets;
+}
+
+}  // namespace
+
+BENCHMARK(BM_Feed)
+    ->Args({64, 0})
+    ->Args({256, 0})
+    ->Args({256, 90})
+    ->Args({4096, 0})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,96 @@
+#include <benchmark/benchmark.h>
+
+#include <vv/vv.hpp>
+
+#include <bench_gen.hpp>
+
+namespace {
+
+ll::Buffer MakePerson() {
+  rdx::Person empty({});
+  tlv::BufferWriter writer;
+  ll::Buffer seen = vv::Vparse("1-5,2-3,3-7,4-1");
+
+  rdx::PersonDelta(empty, 1, writer)
+      .SetName("a name long enough to not be a short string")
+      .SetAge(42)
+      .SetScore(0.75)
+      .SetBestFriend(cmn::FromString("2-3"))
+      .SetLikes(1000)
+      .SetBalance(-50)
+      .MergeSeen(seen);
+
+  return writer.Extract();
+}
+
+// What a view saves: one field decoded out of seven
+void BM_ViewOneField(benchmark::State& state) {
+  ll::Buffer tlv = MakePerson();
+
+  for (auto _ : state) {
+    rdx::Person person(tlv);
+    benchmark::DoNotOptimize(person.Age());
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_ViewAllFields(benchmark::State& state) {
+  ll::Buffer tlv = MakePerson();
+
+  for (auto _ : state) {
+    rdx::Person person(tlv);
+    benchmark::DoNotOptimize(person.Name());
+    benchmark::DoNotOptimize(person.Age());
+    benchmark::DoNotOptimize(person.Score());
+    benchmark::DoNotOptimize(person.BestFriend());
+    benchmark::DoNotOptimize(person.Likes());
+    benchmark::DoNotOptimize(person.Balance());
+    benchmark::DoNotOptimize(vv::Vnative(person.Seen()));
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+// Two changed FIRST fields and one unchanged, into a reused buffer
+void BM_Delta(benchmark::State& state) {
+  ll::Buffer tlv = MakePerson();
+  rdx::Person person(tlv);
+  ll::Buffer packet;
+  int64_t age = 0;
+
+  for (auto _ : state) {
+    packet.clear();
+    tlv::BufferWriter writer(std::move(packet));
+    rdx::PersonDelta(person, 2, writer)
+        .SetAge(++age)
+        .SetScore(0.5)
+        .SetName("a name long enough to not be a short string");
+    packet = writer.Extract();
+    benchmark::DoNotOptimize(packet.data());
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_LoadFromStore(benchmark::State& state) {
+  lsm::Store store;
+  cmn::Id id = cmn::FromString("1-1");
+  gen::Apply(store, id, MakePerson());
+
+  for (auto _ : state) {
+    ll::Buffer tlv = gen::Load(store, id, rdx::Person::kLiterals);
+    benchmark::DoNotOptimize(rdx::Person(tlv).Age());
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+}  // namespace
+
+BENCHMARK(BM_ViewOneField);
+BENCHMARK(BM_ViewAllFields);
+BENCHMARK(BM_Delta);
+BENCHMARK(BM_LoadFromStore);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,180 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <isfr/types.hpp>
+#include <nz/natural.hpp>
+#include <lsm/field_cache.hpp>
+#include <lsm/fields.hpp>
+#include <lsm/merge_operator.hpp>
+#include <lsm/store.hpp>
+
+namespace {
+
+constexpr size_t kOps = 1 << 14;
+
+struct Op {
+  std::string key;
+  ll::Buffer value;
+};
+
+// Counter increments and register writes spread over range(0) fields
+std::vector<Op> MakeOps(size_t fields) {
+  std::mt19937_64 rng(42);
+  std::vector<Op> ops;
+  ops.reserve(kOps);
+
+  for (size_t i = 0; i < kOps; ++i) {
+    cmn::Id field;
+    field.sequence = rng() % fields;
+
+    if (rng() % 2 != 0) {
+      ops.push_back({lsm::FieldKey(field, 'N'),
+                     nz::Ntlv(i, rng() % 16)});
+    } else {
+      ll::Bytes tlv = isfr::Itlv(int64_t(rng() % 1000),
+                                 {int64_t(i), rng() % 16});
+      ops.push_back({lsm::FieldKey(field, 'I'),
+                     ll::Buffer(tlv.begin(), tlv.end())});
+    }
+  }
+
+  return ops;
+}
+
+// Blind writes: the op goes in as a merge operand, never read back
+void BM_StoreMerge(benchmark::State& state) {
+  std::vector<Op> ops = MakeOps(state.range(0));
+
+  for (auto _ : state) {
+    lsm::Store store;
+
+    for (const Op& op : ops) {
+      store.Merge(op.key, op.value);
+    }
+
+    store.Flush();
+    benchmark::DoNotOptimize(store.RunCount());
+  }
+
+  state.SetItemsProcessed(state.iterations() * kOps);
+}
+
+// The baseline the merge operators remove: read, merge, write back
+void BM_StoreReadModifyWrite(benchmark::State& state) {
+  std::vector<Op> ops = MakeOps(state.range(0));
+
+  for (auto _ : state) {
+    lsm::Store store;
+    ll::Buffer merged;
+
+    for (const Op& op : ops) {
+      std::optional<ll::Buffer> value = store.Get(op.key);
+
+      if (value.has_value()) {
+        ll::Span existing = *value;
+        ll::Span operand = op.value;
+        lsm::FullMerge(lsm::LiteralOf(op.key), &existing, {&operand, 1},
+                       merged);
+      } else {
+        merged = op.value;
+      }
+
+      store.Put(op.key, merged);
+    }
+
+    store.Flush();
+    benchmark::DoNotOptimize(store.RunCount());
+  }
+
+  state.SetItemsProcessed(state.iterations() * kOps);
+}
+
+// The merge operator alone, one operand into a stored value
+void BM_FullMergeOne(benchmark::State& state) {
+  std::vector<Op> ops = MakeOps(1);
+  lsm::MergeOperator merge;
+  ll::Buffer merged;
+  size_t i = 0;
+
+  for (auto _ : state) {
+    const Op& op = ops[i++ % kOps];
+    ll::Span existing = op.value;
+    ll::Span operand = op.value;
+    merge.FullMerge(op.key, &existing, {&operand, 1}, merged);
+    benchmark::DoNotOptimize(merged.data());
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+// range(0) S fields, a few ops each, half of them still in the memtable
+void FillFields(lsm::Fields& fields, size_t count, lsm::Store& store) {
+  for (size_t round = 0; round < 8; ++round) {
+    for (size_t i = 0; i < count; ++i) {
+      cmn::Id field;
+      field.sequence = i;
+      ll::Bytes tlv = isfr::Stlv("value " + std::to_string(round),
+                                 {int64_t(round), i % 16});
+      fields.Merge(field, 'S', ll::Buffer(tlv.begin(), tlv.end()));
+    }
+
+    if (round == 3) {
+      store.Flush();
+    }
+  }
+}
+
+// Every read merges the field ops and decodes the result
+void BM_ReadUncached(benchmark::State& state) {
+  lsm::Store store;
+  lsm::FieldCache cache(1);
+  lsm::Fields fields(store, cache);
+  FillFields(fields, state.range(0), store);
+  std::mt19937_64 rng(42);
+
+  for (auto _ : state) {
+    cmn::Id field;
+    field.sequence = rng() % state.range(0);
+    std::optional<ll::Buffer> value = store.Get(lsm::FieldKey(field, 'S'));
+    benchmark::DoNotOptimize(lsm::Decode('S', *value));
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+void BM_ReadCached(benchmark::State& state) {
+  lsm::Store store;
+  lsm::FieldCache cache(state.range(0));
+  lsm::Fields fields(store, cache);
+  FillFields(fields, state.range(0), store);
+  std::mt19937_64 rng(42);
+
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    cmn::Id field;
+    field.sequence = i;
+    fields.Read(field, 'S');
+  }
+
+  for (auto _ : state) {
+    cmn::Id field;
+    field.sequence = rng() % state.range(0);
+    benchmark::DoNotOptimize(fields.Read(field, 'S'));
+  }
+
+  state.SetItemsProcessed(state.iterations());
+  state.counters["hit_rate"] = cache.Stats().HitRate();
+}
+
+}  // namespace
+
+BENCHMARK(BM_StoreMerge)->Arg(16)->Arg(1024)->Arg(16384);
+BENCHMARK(BM_StoreReadModifyWrite)->Arg(16)->Arg(1024)->Arg(16384);
+BENCHMARK(BM_FullMergeOne);
+BENCHMARK(BM_ReadUncached)->Arg(1024)->Arg(65536);
+BENCHMARK(BM_ReadCached)->Arg(1024)->Arg(65536);
+
+BENCHMARK_MAIN();
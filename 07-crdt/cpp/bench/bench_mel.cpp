@@ -0,0 +1,239 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <ll/zipint.hpp>
+#include <mel/element.hpp>
+#include <mel/set.hpp>
+#include <mel/map.hpp>
+#include <mel/array.hpp>
+#include <mel/weave.hpp>
+
+namespace {
+
+constexpr size_t kElements = 1'000'000;
+
+// Every element lives on its home replica and gets re-added (or
+// removed, 1 in 10) on another one, so each benchmark merges about
+// 2e6 ops into a 1e6 set regardless of the replica count
+struct SetCorpus {
+  std::vector<ll::Buffer> values;
+  std::vector<ll::Buffer> replicas;
+  std::vector<ll::Span> spans;
+  size_t bytes = 0;
+};
+
+SetCorpus MakeSetCorpus(size_t replicas) {
+  std::mt19937_64 rng(42);
+  SetCorpus corpus;
+
+  corpus.values.reserve(kElements);
+
+  for (size_t i = 0; i < kElements; ++i) {
+    ll::Bytes zipped = ll::Zip(int64_t(rng()));
+    corpus.values.emplace_back(zipped.begin(), zipped.end());
+  }
+
+  std::vector<mel::Elements> elements(replicas);
+
+  for (const ll::Buffer& value : corpus.values) {
+    size_t home = rng() % replicas;
+    size_t other = rng() % replicas;
+    int64_t revision = 1 + rng() % 8;
+
+    elements[home].push_back({'I', {revision, home}, value, {}});
+
+    if (other != home) {
+      bool removed = rng() % 10 == 0;
+      isfr::Time time{removed ? -revision : revision, other};
+      elements[other].push_back({'I', time, value, {}});
+    }
+  }
+
+  for (mel::Elements& replica : elements) {
+    std::sort(replica.begin(), replica.end(),
+              [](const mel::Element& lhs, const mel::Element& rhs) {
+                return mel::Compare(lhs, rhs) < 0;
+              });
+    replica.erase(std::unique(replica.begin(), replica.end(),
+                              [](const mel::Element& lhs,
+                                 const mel::Element& rhs) {
+                                return mel::Compare(lhs, rhs) == 0;
+                              }),
+                  replica.end());
+
+    corpus.replicas.push_back(mel::Etlv(replica));
+    corpus.bytes += corpus.replicas.back().size();
+  }
+
+  corpus.spans.assign(corpus.replicas.begin(), corpus.replicas.end());
+
+  return corpus;
+}
+
+mel::Entries AsEntries(const mel::Elements& keys) {
+  mel::Entries entries;
+  entries.reserve(keys.size());
+
+  for (const mel::Element& key : keys) {
+    mel::Element value = key;
+    value.time.revision = std::abs(value.time.revision);
+    entries.push_back({key, value});
+  }
+
+  return entries;
+}
+
+void BM_Emerge(benchmark::State& state) {
+  SetCorpus corpus = MakeSetCorpus(state.range(0));
+
+  for (auto _ : state) {
+    ll::Buffer merged = mel::Emerge(corpus.spans);
+    benchmark::DoNotOptimize(merged.data());
+  }
+
+  state.SetBytesProcessed(state.iterations() * corpus.bytes);
+  state.SetItemsProcessed(state.iterations() * kElements);
+}
+
+void BM_Mmerge(benchmark::State& state) {
+  SetCorpus corpus = MakeSetCorpus(state.range(0));
+
+  std::vector<ll::Buffer> maps;
+  size_t bytes = 0;
+
+  for (ll::Span replica : corpus.spans) {
+    mel::Elements keys = mel::Enative(replica);
+    maps.push_back(mel::Mtlv(AsEntries(keys)));
+    bytes += maps.back().size();
+  }
+
+  std::vector<ll::Span> spans(maps.begin(), maps.end());
+
+  for (auto _ : state) {
+    ll::Buffer merged = mel::Mmerge(spans);
+    benchmark::DoNotOptimize(merged.data());
+  }
+
+  state.SetBytesProcessed(state.iterations() * bytes);
+}
+
+ll::Buffer MakeArray(const SetCorpus& corpus) {
+  mel::Elements elements;
+  elements.reserve(kElements);
+
+  for (const ll::Buffer& value : corpus.values) {
+    elements.push_back({'I', {}, value, {}});
+  }
+
+  return mel::Ltlv(elements);
+}
+
+// Two replicas of a 1e6 array insert and delete at random positions
+// concurrently, then exchange patches; one item is one local edit
+// plus its application on the other replica
+void BM_WeaveEdits(benchmark::State& state) {
+  SetCorpus corpus = MakeSetCorpus(1);
+  ll::Buffer array = MakeArray(corpus);
+
+  mel::Weave alice;
+  mel::Weave bob;
+  alice.ApplyView(array);
+  bob.ApplyView(array);
+
+  std::mt19937_64 rng(7);
+  size_t batch = state.range(0);
+  std::vector<ll::Buffer> from_alice;
+  std::vector<ll::Buffer> from_bob;
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < batch; ++i) {
+      const ll::Buffer& value = corpus.values[rng() % kElements];
+
+      if (rng() % 4 == 0) {
+        from_alice.push_back(alice.Remove(rng() % alice.Size(), 1));
+        from_bob.push_back(bob.Remove(rng() % bob.Size(), 2));
+      } else {
+        from_alice.push_back(
+            alice.Insert(rng() % alice.Size(), {'I', {}, value, {}}, 1));
+        from_bob.push_back(
+            bob.Insert(rng() % bob.Size(), {'I', {}, value, {}}, 2));
+      }
+    }
+
+    for (ll::Buffer& patch : from_bob) {
+      alice.Apply(std::move(patch));
+    }
+
+    for (ll::Buffer& patch : from_alice) {
+      bob.Apply(std::move(patch));
+    }
+
+    from_alice.clear();
+    from_bob.clear();
+  }
+
+  state.SetItemsProcessed(state.iterations() * batch * 2);
+}
+
+void BM_WeaveAt(benchmark::State& state) {
+  SetCorpus corpus = MakeSetCorpus(1);
+  ll::Buffer array = MakeArray(corpus);
+
+  mel::Weave weave;
+  weave.ApplyView(array);
+
+  std::mt19937_64 rng(7);
+
+  for (auto _ : state) {
+    const mel::Element& element = weave.At(rng() % weave.Size());
+    benchmark::DoNotOptimize(element.value.data());
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+// A 1e6 array merged with 2 * range(0) concurrent edit patches
+void BM_Lmerge(benchmark::State& state) {
+  SetCorpus corpus = MakeSetCorpus(1);
+  ll::Buffer array = MakeArray(corpus);
+
+  mel::Weave alice;
+  mel::Weave bob;
+  alice.ApplyView(array);
+  bob.ApplyView(array);
+
+  std::mt19937_64 rng(7);
+  std::vector<ll::Buffer> patches;
+
+  for (int64_t i = 0; i < state.range(0); ++i) {
+    const ll::Buffer& value = corpus.values[i];
+    patches.push_back(
+        alice.Insert(rng() % alice.Size(), {'I', {}, value, {}}, 1));
+    patches.push_back(
+        bob.Insert(rng() % bob.Size(), {'I', {}, value, {}}, 2));
+  }
+
+  std::vector<ll::Span> spans = {array};
+  spans.insert(spans.end(), patches.begin(), patches.end());
+
+  for (auto _ : state) {
+    ll::Buffer merged = mel::Lmerge(spans);
+    benchmark::DoNotOptimize(merged.data());
+  }
+
+  state.SetBytesProcessed(state.iterations() * array.size());
+}
+
+}  // namespace
+
+BENCHMARK(BM_Emerge)->Arg(2)->Arg(8)->Arg(64)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Mmerge)->Arg(2)->Arg(8)->Arg(64)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_WeaveEdits)->Arg(1000)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_WeaveAt);
+BENCHMARK(BM_Lmerge)->Arg(1000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,59 @@
+#include <benchmark/benchmark.h>
+
+#include <mesh/simulator.hpp>
+
+namespace {
+
+// One simulated run of range(0) nodes; the counters are the protocol
+// metrics, the time is the simulator's own cost
+void RunMesh(benchmark::State& state, const mesh::MeshConfig& config) {
+  mesh::MeshStats stats;
+
+  for (auto _ : state) {
+    stats = mesh::Simulate(config);
+  }
+
+  state.counters["nodes"] = stats.nodes;
+  state.counters["converged"] = stats.converged;
+  state.counters["delivered"] =
+      stats.expected == 0 ? 0 : double(stats.delivered) / stats.expected;
+  state.counters["convergence_s"] = stats.convergence_time;
+  state.counters["bytes_on_air"] = stats.bytes_on_air;
+  state.counters["packet_sends"] = stats.packet_sends;
+  state.counters["announce_sends"] = stats.announce_sends;
+  state.counters["redundant_sends"] = stats.redundant_sends;
+  state.counters["duplicates"] = stats.duplicate_receptions;
+  state.counters["events"] = stats.events;
+}
+
+// range(1) version vector entries per announce
+void BM_Announce(benchmark::State& state) {
+  mesh::MeshConfig config;
+  config.nodes = state.range(0);
+  config.fragment_entries = state.range(1);
+  RunMesh(state, config);
+}
+
+void BM_Flood(benchmark::State& state) {
+  mesh::MeshConfig config;
+  config.protocol = mesh::Protocol::kFlood;
+  config.nodes = state.range(0);
+  RunMesh(state, config);
+}
+
+}  // namespace
+
+BENCHMARK(BM_Announce)
+    ->ArgsProduct({{10, 100, 1000, 10000}, {2, 8}})
+    ->Iterations(1)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK(BM_Flood)
+    ->Arg(10)
+    ->Arg(100)
+    ->Arg(1000)
+    ->Arg(10000)
+    ->Iterations(1)
+    ->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
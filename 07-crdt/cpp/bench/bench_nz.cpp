@@ -0,0 +1,91 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <nz/counter.hpp>
+#include <nz/integer.hpp>
+#include <nz/natural.hpp>
+
+namespace {
+
+constexpr size_t kSources = 100'000;
+
+// range(0) replica states, each knowing a random half of the sources
+std::vector<ll::Buffer> MakeStates(size_t replicas, bool two_way) {
+  std::mt19937_64 rng(42);
+  std::vector<ll::Buffer> states;
+
+  for (size_t replica = 0; replica < replicas; ++replica) {
+    nz::NCounter n;
+    nz::ZCounter z;
+
+    for (uint64_t source = 0; source < kSources; ++source) {
+      if (rng() % 2 != 0) {
+        continue;
+      }
+
+      uint64_t value = rng() % 100000;
+
+      if (two_way) {
+        z.Apply(source, 1 + rng() % 8, int64_t(value) - 50000);
+      } else {
+        n.Apply(source, value);
+      }
+    }
+
+    states.push_back(two_way ? z.Tlv() : n.Tlv());
+  }
+
+  return states;
+}
+
+void BM_Nmerge(benchmark::State& state) {
+  std::vector<ll::Buffer> states = MakeStates(state.range(0), false);
+  std::vector<ll::Span> spans(states.begin(), states.end());
+
+  for (auto _ : state) {
+    ll::Buffer merged = nz::Nmerge(spans);
+    benchmark::DoNotOptimize(merged.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0) * kSources /
+                          2);
+}
+
+void BM_Zmerge(benchmark::State& state) {
+  std::vector<ll::Buffer> states = MakeStates(state.range(0), true);
+  std::vector<ll::Span> spans(states.begin(), states.end());
+
+  for (auto _ : state) {
+    ll::Buffer merged = nz::Zmerge(spans);
+    benchmark::DoNotOptimize(merged.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0) * kSources /
+                          2);
+}
+
+// A stream of single ops over range(0) sources
+void BM_ZCounterApply(benchmark::State& state) {
+  std::mt19937_64 rng(42);
+  nz::ZCounter counter;
+  int64_t revision = 0;
+
+  for (auto _ : state) {
+    uint64_t source = rng() % state.range(0);
+    counter.Apply(source, ++revision, int64_t(rng() % 1000) - 500);
+    benchmark::DoNotOptimize(counter.Sum());
+  }
+
+  state.SetItemsProcessed(state.iterations());
+}
+
+}  // namespace
+
+BENCHMARK(BM_Nmerge)->Arg(2)->Arg(8)->Arg(64)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_Zmerge)->Arg(2)->Arg(8)->Arg(64)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ZCounterApply)->Arg(64)->Arg(kSources);
+
+BENCHMARK_MAIN();
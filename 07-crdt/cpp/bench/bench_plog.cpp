@@ -0,0 +1,96 @@
+#include <benchmark/benchmark.h>
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <plog/packet_log.hpp>
+
+namespace {
+
+constexpr uint64_t kSources = 64;
+
+std::filesystem::path BenchDir() {
+  return std::filesystem::temp_directory_path() /
+         ("bench_plog_" + std::to_string(getpid()));
+}
+
+cmn::Id PacketId(uint64_t source, uint64_t sequence) {
+  cmn::Id id;
+  id.source = source;
+  id.sequence = sequence;
+  return id;
+}
+
+// Ingest of range(0) byte packets round robin over the sources, one
+// group commit per range(1) packets
+void BM_Append(benchmark::State& state) {
+  ll::Buffer body(state.range(0), 0x5a);
+  size_t group = state.range(1);
+  size_t appended = 0;
+
+  std::filesystem::remove_all(BenchDir());
+
+  {
+    plog::PacketLog log(BenchDir());
+
+    for (auto _ : state) {
+      for (size_t i = 0; i < group; ++i, ++appended) {
+        log.Append(PacketId(appended % kSources, appended / kSources), 'E',
+                   body);
+      }
+
+      log.Commit();
+    }
+  }
+
+  std::filesystem::remove_all(BenchDir());
+  state.SetItemsProcessed(appended);
+  state.SetBytesProcessed(appended * body.size());
+}
+
+void BM_Get(benchmark::State& state) {
+  constexpr uint64_t kPerSource = 4096;
+  ll::Buffer body(512, 0x5a);
+
+  std::filesystem::remove_all(BenchDir());
+
+  {
+    plog::LogOptions options;
+    options.sync = false;
+    plog::PacketLog log(BenchDir(), options);
+
+    for (uint64_t sequence = 0; sequence < kPerSource; ++sequence) {
+      for (uint64_t source = 0; source < kSources; ++source) {
+        log.Append(PacketId(source, sequence), 'E', body);
+      }
+    }
+
+    log.Commit();
+    std::mt19937_64 rng(42);
+
+    for (auto _ : state) {
+      auto packet =
+          log.Get(PacketId(rng() % kSources, rng() % kPerSource));
+      benchmark::DoNotOptimize(packet->body.data());
+    }
+  }
+
+  std::filesystem::remove_all(BenchDir());
+  state.SetItemsProcessed(state.iterations());
+}
+
+}  // namespace
+
+BENCHMARK(BM_Append)
+    ->Args({256, 1})
+    ->Args({256, 256})
+    ->Args({4096, 1})
+    ->Args({4096, 64})
+    ->UseRealTime();
+BENCHMARK(BM_Get);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,132 @@
+#include <benchmark/benchmark.h>
+
+#include <unistd.h>
+
+#include <cstdlib>
+#include <filesystem>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <lsm/merge_operator.hpp>
+#include <lsm/store.hpp>
+#include <bulk/merge.hpp>
+#include <replay/corpus.hpp>
+
+#include "alloc_counter.hpp"
+
+namespace {
+
+// Replays the corpus at $RDX_REPLAY_CORPUS, as tools/replaygen makes
+// it, or a default one of 2^20 ops generated on the first run
+const replay::Corpus& TheCorpus() {
+  static const std::unique_ptr<replay::Corpus> corpus = [] {
+    if (const char* path = std::getenv("RDX_REPLAY_CORPUS")) {
+      return std::make_unique<replay::Corpus>(path);
+    }
+
+    std::filesystem::path path =
+        std::filesystem::temp_directory_path() /
+        ("bench_replay_" + std::to_string(getpid()) + ".rpl");
+    replay::CorpusOptions options;
+    options.ops = 1 << 20;
+    replay::Generate(path, options);
+
+    // The map stays valid once the file is gone
+    auto corpus = std::make_unique<replay::Corpus>(path);
+    std::filesystem::remove(path);
+    return corpus;
+  }();
+
+  return *corpus;
+}
+
+void Report(benchmark::State& state, size_t allocated) {
+  size_t ops = state.iterations() * TheCorpus().Header().ops;
+  state.SetItemsProcessed(ops);
+  state.counters["allocs_per_op"] = double(allocated) / ops;
+}
+
+// Decoding the op stream off the map alone
+void BM_ReplayRead(benchmark::State& state) {
+  const replay::Corpus& corpus = TheCorpus();
+  size_t before = bench::Allocations();
+
+  for (auto _ : state) {
+    replay::OpReader reader = corpus.Read();
+    replay::Op op;
+    size_t bytes = 0;
+
+    while (reader.Next(op)) {
+      bytes += op.body.size();
+    }
+
+    benchmark::DoNotOptimize(bytes);
+  }
+
+  Report(state, bench::Allocations() - before);
+}
+
+// Every op as a store merge operand, then flushed
+void BM_ReplayStore(benchmark::State& state) {
+  const replay::Corpus& corpus = TheCorpus();
+  size_t before = bench::Allocations();
+
+  for (auto _ : state) {
+    lsm::Store store;
+    replay::OpReader reader = corpus.Read();
+    replay::Op op;
+
+    while (reader.Next(op)) {
+      store.Merge(lsm::FieldKey(op.field, op.literal), op.body);
+    }
+
+    store.Flush();
+    benchmark::DoNotOptimize(store.RunCount());
+  }
+
+  Report(state, bench::Allocations() - before);
+}
+
+// The ops grouped by field, as a pull brings them, merged in one batch
+// over range(0) workers, 0 for all cores
+void BM_ReplayBulk(benchmark::State& state) {
+  const replay::Corpus& corpus = TheCorpus();
+  std::vector<std::vector<ll::Span>> inputs(corpus.Header().fields);
+  std::vector<bulk::Field> fields(corpus.Header().fields);
+
+  replay::OpReader reader = corpus.Read();
+  replay::Op op;
+
+  while (reader.Next(op)) {
+    inputs[op.field.sequence].push_back(op.body);
+    fields[op.field.sequence].id = op.field;
+    fields[op.field.sequence].literal = op.literal;
+  }
+
+  for (size_t i = 0; i < fields.size(); ++i) {
+    fields[i].inputs = inputs[i];
+  }
+
+  bulk::MergeOptions options{.threads = size_t(state.range(0))};
+  size_t before = bench::Allocations();
+
+  for (auto _ : state) {
+    bulk::Merged merged = bulk::Merge(fields, options);
+    benchmark::DoNotOptimize(merged.bytes.data());
+  }
+
+  Report(state, bench::Allocations() - before);
+}
+
+}  // namespace
+
+BENCHMARK(BM_ReplayRead)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ReplayStore)->Unit(benchmark::kMillisecond);
+BENCHMARK(BM_ReplayBulk)
+    ->Arg(1)
+    ->Arg(0)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,163 @@
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include <cmn/id.hpp>
+#include <ll/zipint.hpp>
+#include <mel/set.hpp>
+#include <txt/text.hpp>
+
+namespace {
+
+// Mostly ASCII text with an escape every ~50 bytes
+std::string MakeText(size_t size) {
+  std::mt19937_64 rng(42);
+  std::string text(size, ' ');
+
+  for (char& byte : text) {
+    byte = rng() % 50 == 0 ? '\n' : char('a' + rng() % 26);
+  }
+
+  return text;
+}
+
+// Cyrillic, CJK and emoji among ASCII, about a third of each
+std::string MakeMultibyteText(size_t size) {
+  std::mt19937_64 rng(42);
+  const char* pieces[] = {"a", "b", " ", "\xd0\xbf", "\xd1\x8f",
+                          "\xe6\x96\x87", "\xe2\x82\xac",
+                          "\xf0\x9f\x98\x80"};
+  std::string text;
+
+  while (text.size() < size) {
+    text += pieces[rng() % std::size(pieces)];
+  }
+
+  return text;
+}
+
+// The stringstream escaping the txt writers replaced
+std::string StreamQuote(const std::string& value) {
+  std::stringstream ss;
+  ss << '"';
+
+  for (char byte : value) {
+    if (byte == '\n') {
+      ss << "\\n";
+    } else {
+      ss << byte;
+    }
+  }
+
+  ss << '"';
+
+  return ss.str();
+}
+
+void BM_QuoteStream(benchmark::State& state) {
+  std::string text = MakeText(state.range(0));
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(StreamQuote(text));
+  }
+
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+void BM_Quote(benchmark::State& state) {
+  std::string text = MakeText(state.range(0));
+  std::string out;
+
+  for (auto _ : state) {
+    out.clear();
+    txt::AppendQuoted(out, text);
+    benchmark::DoNotOptimize(out.data());
+  }
+
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+void BM_FindInvalidUtf8(benchmark::State& state) {
+  std::string text = MakeMultibyteText(state.range(0));
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(txt::FindInvalidUtf8(text));
+  }
+
+  state.SetBytesProcessed(state.iterations() * text.size());
+}
+
+void BM_FloatToString(benchmark::State& state) {
+  double value = 12345.678901;
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(std::to_string(value));
+  }
+}
+
+void BM_AppendFloat(benchmark::State& state) {
+  double value = 12345.678901;
+  std::string out;
+
+  for (auto _ : state) {
+    out.clear();
+    txt::AppendFloat(out, value);
+    benchmark::DoNotOptimize(out.data());
+  }
+}
+
+void BM_IdRoundTrip(benchmark::State& state) {
+  cmn::Id id = cmn::FromString("abcde-12345678-fff");
+  std::string out;
+
+  for (auto _ : state) {
+    out.clear();
+    cmn::AppendString(out, id);
+    benchmark::DoNotOptimize(cmn::FromString(out));
+  }
+}
+
+// A 1000 element integer set rendered as text
+void BM_Estring(benchmark::State& state) {
+  std::vector<ll::Buffer> values;
+  mel::Elements elements;
+
+  for (int64_t i = 0; i < 1000; ++i) {
+    ll::Bytes zipped = ll::Zip(i * 7919);
+    values.emplace_back(zipped.begin(), zipped.end());
+  }
+
+  for (const ll::Buffer& value : values) {
+    elements.push_back({'I', {}, value, {}});
+  }
+
+  std::sort(elements.begin(), elements.end(),
+            [](const mel::Element& lhs, const mel::Element& rhs) {
+              return mel::Compare(lhs, rhs) < 0;
+            });
+
+  ll::Buffer set = mel::Etlv(elements);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(mel::Estring(set));
+  }
+
+  state.SetItemsProcessed(state.iterations() * elements.size());
+}
+
+}  // namespace
+
+BENCHMARK(BM_QuoteStream)->Arg(64)->Arg(4096);
+BENCHMARK(BM_Quote)->Arg(64)->Arg(4096);
+BENCHMARK(BM_FindInvalidUtf8)->Arg(4096)->Arg(1 << 20);
+BENCHMARK(BM_FloatToString);
+BENCHMARK(BM_AppendFloat);
+BENCHMARK(BM_IdRoundTrip);
+BENCHMARK(BM_Estring);
+
+BENCHMARK_MAIN();
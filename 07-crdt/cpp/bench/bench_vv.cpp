@@ -0,0 +1,89 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <random>
+#include <vector>
+
+#include <tlv/io.hpp>
+#include <vv/vv.hpp>
+
+namespace {
+
+// Two replicas' views of the same range(0) sources, as on the
+// announce path; `sparse` drops a quarter of the entries of one side
+std::pair<vv::VersionVector, vv::VersionVector> MakePair(size_t sources,
+                                                         bool sparse) {
+  std::mt19937_64 rng(42);
+  vv::VersionVector lhs;
+  vv::VersionVector rhs;
+
+  for (size_t source = 1; source <= sources; ++source) {
+    uint64_t progress = rng() % 100000;
+    lhs.Put(source, progress + rng() % 8);
+
+    if (!sparse || rng() % 4 != 0) {
+      rhs.Put(source, progress + rng() % 8);
+    }
+  }
+
+  return {lhs, rhs};
+}
+
+void BM_Vmerge(benchmark::State& state) {
+  auto [lhs, rhs] = MakePair(state.range(0), state.range(1));
+
+  for (auto _ : state) {
+    vv::VersionVector merged = lhs;
+    merged.Merge(rhs);
+    benchmark::DoNotOptimize(merged.Progress().data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_Vdominates(benchmark::State& state) {
+  auto [lhs, rhs] = MakePair(state.range(0), state.range(1));
+  lhs.Merge(rhs);
+
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(lhs.Dominates(rhs));
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_Vdifference(benchmark::State& state) {
+  auto [lhs, rhs] = MakePair(state.range(0), state.range(1));
+
+  for (auto _ : state) {
+    vv::VersionVector difference = lhs.Difference(rhs);
+    benchmark::DoNotOptimize(difference.Sources().data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+
+void BM_VparseWrite(benchmark::State& state) {
+  auto [lhs, rhs] = MakePair(state.range(0), false);
+  ll::Buffer tlv = lhs.Tlv();
+  tlv::BufferWriter writer;
+  writer.Reserve(tlv.size());
+
+  for (auto _ : state) {
+    vv::VersionVector vector = vv::VersionVector::FromTlv(tlv);
+    vector.WriteTlv(writer);
+    benchmark::DoNotOptimize(writer.Extract().data());
+    writer.Reserve(tlv.size());
+  }
+
+  state.SetBytesProcessed(state.iterations() * tlv.size());
+}
+
+}  // namespace
+
+BENCHMARK(BM_Vmerge)->ArgsProduct({{16, 1024}, {0, 1}});
+BENCHMARK(BM_Vdominates)->ArgsProduct({{16, 1024}, {0, 1}});
+BENCHMARK(BM_Vdifference)->ArgsProduct({{16, 1024}, {0, 1}});
+BENCHMARK(BM_VparseWrite)->Arg(16)->Arg(1024);
+
+BENCHMARK_MAIN();
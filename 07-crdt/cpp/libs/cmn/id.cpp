@@ -1,10 +1,12 @@
+#include <algorithm>
+#include <charconv>
 #include <cstddef>
-#include <ios>
+#include <stdexcept>
+
 #include <ll/zipint.hpp>
+#include <txt/text.hpp>
 
 #include <cmn/id.hpp>
-#include <sstream>
-#include <stdexcept>
 
 namespace cmn {
 
@@ -17,6 +19,56 @@ uint64_t GetProgress(Id id) {
   return (offset << 32) | sequence;
 }
 
+Id FromPair(uint64_t progress, uint64_t source) {
+  Id id;
+  id.offset = progress >> 32;
+  id.sequence = progress & 0xffffffff;
+  id.source = source;
+
+  return id;
+}
+
+// One id of the text up to the separator or the end; returns where it
+// stopped, or nullptr if the text is malformed
+const char* ParseId(const char* begin, const char* end, char separator,
+                    Id& id) {
+  uint64_t parts[3] = {};
+  size_t count = 0;
+
+  for (;;) {
+    auto [next, error] = std::from_chars(begin, end, parts[count], 16);
+
+    if (error != std::errc() || next == begin) {
+      return nullptr;
+    }
+
+    ++count;
+    begin = next;
+
+    if (begin == end || *begin == separator) {
+      break;
+    }
+
+    if (*begin != '-' || count == 3) {
+      return nullptr;
+    }
+
+    ++begin;
+  }
+
+  id = {};
+
+  if (count == 1) {
+    id.offset = parts[0];
+  } else {
+    id.source = parts[0];
+    id.sequence = parts[1];
+    id.offset = parts[2];
+  }
+
+  return begin;
+}
+
 }  // namespace
 
 ll::Bytes Zip(Id id) {
@@ -25,72 +77,121 @@ ll::Bytes Zip(Id id) {
 
 Id UnzipID(ll::Bytes bytes) {
   auto [big, lil] = ll::UnzipU64Pair(bytes);
+  return FromPair(big, lil);
+}
 
-  Id id;
-  id.offset = big >> 32;
-  id.sequence = big & 0xffffffff;
-  id.source = lil;
+size_t ZipTo(uint8_t* out, Id id) {
+  return ll::ZipTo(out, GetProgress(id), uint64_t(id.source));
+}
 
-  return id;
+Id UnzipID(ll::Span bytes) {
+  auto [big, lil] = ll::UnzipU64Pair(bytes);
+  return FromPair(big, lil);
+}
+
+void AppendString(std::string& out, Id id) {
+  if (id.source == 0 && id.sequence == 0) {
+    txt::AppendHex(out, id.offset);
+    return;
+  }
+
+  txt::AppendHex(out, id.source);
+  out += '-';
+  txt::AppendHex(out, id.sequence);
+
+  if (id.offset != 0) {
+    out += '-';
+    txt::AppendHex(out, id.offset);
+  }
 }
 
 std::string ToString(Id id) {
-  std::stringstream ss;
+  std::string text;
+  AppendString(text, id);
+  return text;
+}
 
-  if (id.source == 0 && id.sequence == 0) {
-    ss << std::hex << id.offset;
-  } else if (id.offset == 0) {
-    ss << std::hex << id.source << "-" << id.sequence;
-  } else {
-    ss << std::hex << id.source << "-" << id.sequence << "-" << id.offset;
+Id FromString(std::string_view text) {
+  const char* end = text.data() + text.size();
+  Id id;
+
+  // A NUL stops the parse short of the end, which fails it too
+  if (ParseId(text.data(), end, '\0', id) != end) {
+    throw std::runtime_error("Incorrect Id format");
   }
 
-  return ss.str();
+  return id;
 }
 
-Id FromString(std::string text) {
-  std::stringstream ss(text);
+void WriteIds(tlv::BufferWriter& writer, char literal,
+              std::span<const Id> ids) {
+  uint8_t zipped[ll::kMaxZipLen];
+  size_t bytes = 0;
 
-  size_t i = 0;
-  uint64_t parts[3] = {};
+  for (Id id : ids) {
+    size_t size = ll::ZipLen(GetProgress(id), id.source);
+    bytes += tlv::HeaderSize(literal, size) + size;
+  }
 
-  char c;
-  for (; i < 3; ++i) {
-    bool new_part = bool(ss >> std::hex >> parts[i]);
+  writer.Reserve(bytes);
 
-    if (!new_part) {
-      throw std::runtime_error("Incorrect Id format");
-    }
+  for (Id id : ids) {
+    writer.WriteRecord(literal, {zipped, ZipTo(zipped, id)});
+  }
+}
 
-    if (ss.eof()) {
-      break;
-    }
+std::vector<Id> ReadIds(ll::Span tlv, char literal) {
+  std::vector<Id> ids;
+  tlv::ViewReader reader(tlv);
 
-    ss >> c;
+  while (reader.HasSome()) {
+    tlv::RecordView record = reader.ReadNext();
 
-    if (c != '-') {
-      throw std::runtime_error("Incorrect Id format");
+    if (record.header.literal != literal ||
+        !ll::IsPairLen(record.body.size())) {
+      throw std::runtime_error("Invalid Id record");
     }
+
+    ids.push_back(UnzipID(record.body));
   }
 
-  if (!ss.eof()) {
-    throw std::runtime_error("Incorrect Id format");
+  return ids;
+}
+
+void AppendStrings(std::string& out, std::span<const Id> ids,
+                   char separator) {
+  // Up to 5 + 8 + 3 hex digits and two dashes each
+  out.reserve(out.size() + ids.size() * 19);
+
+  for (size_t i = 0; i < ids.size(); ++i) {
+    if (i != 0) {
+      out += separator;
+    }
+
+    AppendString(out, ids[i]);
   }
+}
 
-  Id id;
+std::vector<Id> FromStrings(std::string_view text, char separator) {
+  std::vector<Id> ids;
+  ids.reserve(std::count(text.begin(), text.end(), separator) + 1);
+  const char* begin = text.data();
+  const char* end = begin + text.size();
 
-  if (i == 0) {
-    id.offset = parts[0];
-  } else if (i == 1) {
-    id.source = parts[0];
-    id.sequence = parts[1];
-  } else {
-    id.source = parts[0];
-    id.sequence = parts[1];
-    id.offset = parts[2];
+  while (begin != end) {
+    ids.emplace_back();
+    begin = ParseId(begin, end, separator, ids.back());
+
+    if (begin == nullptr) {
+      throw std::runtime_error("Incorrect Id format");
+    }
+
+    if (begin != end) {
+      ++begin;
+    }
   }
 
-  return id;
+  return ids;
 }
 
 }  // namespace cmn
@@ -1,9 +1,14 @@
 #pragma once
 
 #include <cstdint>
+#include <span>
 #include <string>
+#include <string_view>
+#include <vector>
 
 #include <ll/bytes.hpp>
+#include <ll/zipint.hpp>
+#include <tlv/io.hpp>
 
 namespace cmn {
 
@@ -20,7 +25,26 @@ static_assert(sizeof(Id) == sizeof(uint64_t), "Invalid ID structure");
 ll::Bytes Zip(Id id);
 Id UnzipID(ll::Bytes bytes);
 
+// Zero-copy variants: the zipped pair of {offset << 32 | sequence,
+// source}, into at least ll::kMaxZipLen bytes
+size_t ZipTo(uint8_t* out, Id id);
+Id UnzipID(ll::Span bytes);
+
 std::string ToString(Id id);
-Id FromString(std::string text);
+// Appends the ToString form
+void AppendString(std::string& out, Id id);
+// No allocations; throws std::runtime_error on malformed text
+Id FromString(std::string_view text);
+
+// Batches, for announces and version vectors. Every id is a record of
+// the literal; ReadIds throws on other records.
+void WriteIds(tlv::BufferWriter& writer, char literal,
+              std::span<const Id> ids);
+std::vector<Id> ReadIds(ll::Span tlv, char literal);
+
+// The ToString forms joined by the separator
+void AppendStrings(std::string& out, std::span<const Id> ids,
+                   char separator = ',');
+std::vector<Id> FromStrings(std::string_view text, char separator = ',');
 
 }  // namespace cmn
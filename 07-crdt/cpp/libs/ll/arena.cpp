@@ -0,0 +1,87 @@
+#include <algorithm>
+
+#include <ll/arena.hpp>
+
+namespace ll {
+
+Arena::Arena(size_t block_size)
+    : block_size_(block_size) {
+}
+
+void* Arena::Allocate(size_t bytes, size_t alignment) {
+  while (current_ < blocks_.size()) {
+    Block& block = blocks_[current_];
+    uintptr_t base = reinterpret_cast<uintptr_t>(block.memory.get());
+    size_t aligned = (base + offset_ + alignment - 1) / alignment * alignment -
+                     base;
+
+    if (aligned + bytes <= block.size) {
+      offset_ = aligned + bytes;
+      used_ += bytes;
+      return block.memory.get() + aligned;
+    }
+
+    ++current_;
+    offset_ = 0;
+  }
+
+  // Blocks grow geometrically, a batch takes O(log size) of them
+  AddBlock(std::max(bytes + alignment, block_size_));
+  block_size_ *= 2;
+
+  return Allocate(bytes, alignment);
+}
+
+Span Arena::Copy(Span bytes) {
+  uint8_t* copy = AllocateArray<uint8_t>(bytes.size());
+  std::copy(bytes.begin(), bytes.end(), copy);
+  return {copy, bytes.size()};
+}
+
+void Arena::Reset() {
+  if (blocks_.size() > 1) {
+    size_t total = Capacity();
+    blocks_.clear();
+    AddBlock(total);
+  }
+
+  current_ = 0;
+  offset_ = 0;
+  used_ = 0;
+}
+
+size_t Arena::Used() const {
+  return used_;
+}
+
+size_t Arena::Capacity() const {
+  size_t capacity = 0;
+
+  for (const Block& block : blocks_) {
+    capacity += block.size;
+  }
+
+  return capacity;
+}
+
+size_t Arena::BlockAllocations() const {
+  return block_allocations_;
+}
+
+void Arena::AddBlock(size_t size) {
+  blocks_.push_back({std::make_unique_for_overwrite<uint8_t[]>(size), size});
+  ++block_allocations_;
+}
+
+void* Arena::do_allocate(size_t bytes, size_t alignment) {
+  return Allocate(bytes, alignment);
+}
+
+void Arena::do_deallocate(void*, size_t, size_t) {
+}
+
+bool Arena::do_is_equal(const std::pmr::memory_resource& other) const noexcept {
+  return this == &other;
+}
+
+}  // namespace ll
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <memory_resource>
+#include <vector>
+
+#include <ll/bytes.hpp>
+
+namespace ll {
+
+// Per-batch monotonic arena: allocation bumps a pointer, nothing is
+// freed until Reset(), which keeps the memory for the next batch (a
+// batch that needed several blocks leaves one block of their total
+// size). Also a memory resource for std::pmr containers.
+class Arena : public std::pmr::memory_resource {
+ public:
+  explicit Arena(size_t block_size = 64 << 10);
+
+  Arena(const Arena&) = delete;
+  Arena& operator=(const Arena&) = delete;
+
+  void* Allocate(size_t bytes, size_t alignment = alignof(std::max_align_t));
+
+  template <class T>
+  T* AllocateArray(size_t count) {
+    return static_cast<T*>(Allocate(count * sizeof(T), alignof(T)));
+  }
+
+  Span Copy(Span bytes);
+
+  void Reset();
+
+  // Bytes handed out since the last Reset()
+  size_t Used() const;
+  // Bytes held
+  size_t Capacity() const;
+  // Blocks taken from the heap over the arena lifetime
+  size_t BlockAllocations() const;
+
+ private:
+  struct Block {
+    std::unique_ptr<uint8_t[]> memory;
+    size_t size = 0;
+  };
+
+  void AddBlock(size_t size);
+
+  void* do_allocate(size_t bytes, size_t alignment) override;
+  void do_deallocate(void* pointer, size_t bytes, size_t alignment) override;
+  bool do_is_equal(const std::pmr::memory_resource& other)
+      const noexcept override;
+
+ private:
+  std::vector<Block> blocks_;
+  size_t block_size_;
+  size_t current_ = 0;
+  size_t offset_ = 0;
+  size_t used_ = 0;
+  size_t block_allocations_ = 0;
+};
+
+}  // namespace ll
@@ -37,4 +37,23 @@ void Bytes::Append(Bytes bytes) {
   insert(end(), bytes.begin(), bytes.end());
 }
 
+uint64_t ReadLittleEndian(Span bytes) {
+  assert(bytes.size() <= 8);
+
+  uint64_t value = 0;
+
+  for (size_t i = 0; i < bytes.size(); ++i) {
+    value |= uint64_t(bytes[i]) << (8 * i);
+  }
+
+  return value;
+}
+
+void WriteLittleEndian(uint8_t* out, uint64_t value, uint8_t bytes) {
+  for (size_t i = 0; i < bytes; ++i) {
+    out[i] = value & 0xff;
+    value >>= 8;
+  }
+}
+
 }  // namespace ll
@@ -3,6 +3,8 @@
 #include <cstdint>
 #include <deque>
 #include <cstddef>
+#include <span>
+#include <vector>
 
 namespace ll {
 
@@ -17,4 +19,12 @@ class Bytes : public std::deque<uint8_t> {
   void WriteLittleEndian(uint64_t value, uint8_t min_bytes = 0);
 };
 
+// Zero-copy counterparts of Bytes: a read-only view into somebody
+// else's memory and a contiguous output buffer
+using Span = std::span<const uint8_t>;
+using Buffer = std::vector<uint8_t>;
+
+uint64_t ReadLittleEndian(Span bytes);
+void WriteLittleEndian(uint8_t* out, uint64_t value, uint8_t bytes);
+
 }  // namespace ll
@@ -0,0 +1,81 @@
+#include <array>
+#include <cstring>
+
+#include <ll/crc32c.hpp>
+
+#if defined(__x86_64__)
+#include <nmmintrin.h>
+#endif
+
+namespace ll {
+
+namespace {
+
+// The reflected Castagnoli polynomial
+constexpr uint32_t kPolynomial = 0x82f63b78;
+
+constexpr std::array<uint32_t, 256> MakeTable() {
+  std::array<uint32_t, 256> table{};
+
+  for (uint32_t i = 0; i < 256; ++i) {
+    uint32_t crc = i;
+
+    for (int bit = 0; bit < 8; ++bit) {
+      crc = (crc >> 1) ^ (crc & 1 ? kPolynomial : 0);
+    }
+
+    table[i] = crc;
+  }
+
+  return table;
+}
+
+constexpr std::array<uint32_t, 256> kTable = MakeTable();
+
+uint32_t Crc32cTable(Span bytes, uint32_t crc) {
+  for (uint8_t byte : bytes) {
+    crc = kTable[(crc ^ byte) & 0xff] ^ (crc >> 8);
+  }
+
+  return crc;
+}
+
+#if defined(__x86_64__)
+__attribute__((target("sse4.2"))) uint32_t Crc32cSse42(Span bytes,
+                                                       uint32_t crc) {
+  uint64_t wide = crc;
+  size_t i = 0;
+
+  for (; i + 8 <= bytes.size(); i += 8) {
+    uint64_t word;
+    std::memcpy(&word, bytes.data() + i, 8);
+    wide = _mm_crc32_u64(wide, word);
+  }
+
+  crc = uint32_t(wide);
+
+  for (; i < bytes.size(); ++i) {
+    crc = _mm_crc32_u8(crc, bytes[i]);
+  }
+
+  return crc;
+}
+
+const bool kHasSse42 = __builtin_cpu_supports("sse4.2");
+#endif
+
+}  // namespace
+
+uint32_t Crc32c(Span bytes, uint32_t crc) {
+  crc = ~crc;
+
+#if defined(__x86_64__)
+  if (kHasSse42) {
+    return ~Crc32cSse42(bytes, crc);
+  }
+#endif
+
+  return ~Crc32cTable(bytes, crc);
+}
+
+}  // namespace ll
@@ -0,0 +1,14 @@
+#pragma once
+
+#include <cstdint>
+
+#include <ll/bytes.hpp>
+
+namespace ll {
+
+// CRC-32C (Castagnoli) of the bytes; pass the previous value as crc to
+// go on over several pieces. Uses the SSE4.2 crc32 instruction where
+// the CPU has it.
+uint32_t Crc32c(Span bytes, uint32_t crc = 0);
+
+}  // namespace ll
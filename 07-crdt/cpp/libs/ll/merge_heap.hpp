@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <memory_resource>
+#include <utility>
+#include <vector>
+
+namespace ll {
+
+// Binary min-heap of input indices for k-way merges of sorted
+// inputs. `Less` compares the current heads of two inputs. Once the
+// head of Top() is consumed, either Update() after advancing that
+// input (a single sift-down) or Pop() it if exhausted.
+template <class Less>
+class MergeHeap {
+ public:
+  explicit MergeHeap(Less less, std::pmr::memory_resource* memory =
+                                      std::pmr::get_default_resource());
+
+  void Reserve(size_t inputs);
+  void Push(size_t input);
+
+  bool IsEmpty() const;
+  size_t Size() const;
+  size_t Top() const;
+
+  void Update();
+  void Pop();
+
+ private:
+  void SiftUp(size_t pos);
+  void SiftDown(size_t pos);
+
+ private:
+  Less less_;
+  std::pmr::vector<size_t> heap_;
+};
+
+template <class Less>
+MergeHeap<Less>::MergeHeap(Less less, std::pmr::memory_resource* memory)
+    : less_(std::move(less)),
+      heap_(memory) {
+}
+
+template <class Less>
+void MergeHeap<Less>::Reserve(size_t inputs) {
+  heap_.reserve(inputs);
+}
+
+template <class Less>
+void MergeHeap<Less>::Push(size_t input) {
+  heap_.push_back(input);
+  SiftUp(heap_.size() - 1);
+}
+
+template <class Less>
+bool MergeHeap<Less>::IsEmpty() const {
+  return heap_.empty();
+}
+
+template <class Less>
+size_t MergeHeap<Less>::Size() const {
+  return heap_.size();
+}
+
+template <class Less>
+size_t MergeHeap<Less>::Top() const {
+  return heap_.front();
+}
+
+template <class Less>
+void MergeHeap<Less>::Update() {
+  SiftDown(0);
+}
+
+template <class Less>
+void MergeHeap<Less>::Pop() {
+  heap_.front() = heap_.back();
+  heap_.pop_back();
+
+  if (!heap_.empty()) {
+    SiftDown(0);
+  }
+}
+
+template <class Less>
+void MergeHeap<Less>::SiftUp(size_t pos) {
+  size_t input = heap_[pos];
+
+  while (pos > 0) {
+    size_t parent = (pos - 1) / 2;
+
+    if (!less_(input, heap_[parent])) {
+      break;
+    }
+
+    heap_[pos] = heap_[parent];
+    pos = parent;
+  }
+
+  heap_[pos] = input;
+}
+
+template <class Less>
+void MergeHeap<Less>::SiftDown(size_t pos) {
+  size_t input = heap_[pos];
+  size_t size = heap_.size();
+
+  while (true) {
+    size_t child = 2 * pos + 1;
+
+    if (child >= size) {
+      break;
+    }
+
+    if (child + 1 < size && less_(heap_[child + 1], heap_[child])) {
+      ++child;
+    }
+
+    if (!less_(heap_[child], input)) {
+      break;
+    }
+
+    heap_[pos] = heap_[child];
+    pos = child;
+  }
+
+  heap_[pos] = input;
+}
+
+}  // namespace ll
@@ -1,5 +1,7 @@
+#include <bit>
 #include <cassert>
 #include <cstddef>
+#include <algorithm>
 #include <cstdint>
 #include <iostream>
 
@@ -9,24 +11,22 @@ namespace ll {
 
 namespace {
 
-uint8_t ByteLen(uint64_t value) {
-  if (value == 0) {
-    return 0;
-  }
+// Significant bytes rounded up to 0, 1, 2, 4 or 8
+constexpr uint8_t kByteLen[9] = {0, 1, 2, 4, 4, 8, 8, 8, 8};
 
-  if (value <= 0xff) {
-    return 1;
-  }
+uint8_t ByteLen(uint64_t value) {
+  return kByteLen[(std::bit_width(value) + 7) / 8];
+}
 
-  if (value <= 0xffff) {
-    return 2;
-  }
+// ReadLittleEndian, inlined into the hot unzip paths
+uint64_t Load(const uint8_t* bytes, size_t size) {
+  uint64_t value = 0;
 
-  if (value <= 0xffffffff) {
-    return 4;
+  for (size_t i = 0; i < size; ++i) {
+    value |= uint64_t(bytes[i]) << (8 * i);
   }
 
-  return 8;
+  return value;
 }
 
 template <class To, class From>
@@ -57,6 +57,30 @@ constexpr uint8_t SwitchPair(uint8_t l, uint8_t r) {
   return (l << 4) | r;
 }
 
+// Byte widths of {big, lil} in a zipped pair, same layout as the
+// switch in Zip(big, lil): lil takes at least one byte unless the
+// whole pair fits into a single byte, big is never narrower
+std::pair<uint8_t, uint8_t> PairWidths(uint64_t big, uint64_t lil) {
+  uint8_t big_len = ByteLen(big);
+  uint8_t lil_len = ByteLen(lil);
+
+  if (lil_len == 0 && big_len <= 1) {
+    return {big_len, 0};
+  }
+
+  lil_len = std::max<uint8_t>(lil_len, 1);
+  big_len = std::max(big_len, lil_len);
+
+  return {big_len, lil_len};
+}
+
+// Inverse of PairWidths, indexed by the total length; zero marks
+// lengths no valid pair can have
+constexpr uint8_t kBigWidth[17] = {0, 1, 1, 2, 2, 4, 4, 0, 4,
+                                   8, 8, 0, 8, 0, 0, 0, 8};
+constexpr uint8_t kLilWidth[17] = {0, 0, 1, 1, 2, 1, 2, 0, 4,
+                                   1, 2, 0, 4, 0, 0, 0, 8};
+
 }  // namespace
 
 Bytes Zip(uint64_t value) {
@@ -257,4 +281,93 @@ std::pair<int64_t, uint64_t> UnzipIU64Pair(const Bytes& bytes) {
   return {ZagZig(z), u};
 }
 
+///////////////////////////////////////////////
+
+uint64_t UnzipU64(Span bytes) {
+  return Load(bytes.data(), std::min(bytes.size(), sizeof(uint64_t)));
+}
+
+int64_t UnzipI64(Span bytes) {
+  return ZagZig(UnzipU64(bytes));
+}
+
+double UnzipDouble(Span bytes) {
+  return As<double>(Reverse(UnzipU64(bytes)));
+}
+
+std::pair<uint64_t, uint64_t> UnzipU64Pair(Span bytes) {
+  if (bytes.size() > kMaxZipLen) {
+    return {0, 0};
+  }
+
+  uint8_t big_len = kBigWidth[bytes.size()];
+  uint8_t lil_len = kLilWidth[bytes.size()];
+
+  return {Load(bytes.data(), big_len), Load(bytes.data() + big_len, lil_len)};
+}
+
+std::pair<int64_t, uint64_t> UnzipIU64Pair(Span bytes) {
+  auto [z, u] = UnzipU64Pair(bytes);
+  return {ZagZig(z), u};
+}
+
+size_t ZipTo(uint8_t* out, uint64_t value) {
+  uint8_t len = 0;
+
+  for (; value > 0; ++len) {
+    out[len] = value & 0xff;
+    value >>= 8;
+  }
+
+  return len;
+}
+
+size_t ZipTo(uint8_t* out, int64_t value) {
+  return ZipTo(out, ZigZag(value));
+}
+
+size_t ZipTo(uint8_t* out, double value) {
+  return ZipTo(out, Reverse(As<uint64_t>(value)));
+}
+
+size_t ZipTo(uint8_t* out, uint64_t big, uint64_t lil) {
+  auto [big_len, lil_len] = PairWidths(big, lil);
+
+  WriteLittleEndian(out, big, big_len);
+  WriteLittleEndian(out + big_len, lil, lil_len);
+
+  return big_len + lil_len;
+}
+
+size_t ZipTo(uint8_t* out, int64_t i, uint64_t u) {
+  return ZipTo(out, ZigZag(i), u);
+}
+
+size_t ZipLen(uint64_t big, uint64_t lil) {
+  auto [big_len, lil_len] = PairWidths(big, lil);
+  return big_len + lil_len;
+}
+
+bool IsPairLen(size_t length) {
+  return length == 0 || (length <= kMaxZipLen && kBigWidth[length] != 0);
+}
+
+bool IsMinimal(Span bytes) {
+  return bytes.size() <= sizeof(uint64_t) &&
+         (bytes.empty() || bytes.back() != 0);
+}
+
+bool IsMinimalPair(Span bytes) {
+  if (!IsPairLen(bytes.size())) {
+    return false;
+  }
+
+  size_t big_len = kBigWidth[bytes.size()];
+  size_t lil_len = kLilWidth[bytes.size()];
+
+  auto [min_big, min_lil] = PairWidths(Load(bytes.data(), big_len),
+                                       Load(bytes.data() + big_len, lil_len));
+  return min_big == big_len && min_lil == lil_len;
+}
+
 }  // namespace ll
@@ -23,4 +23,33 @@ std::pair<uint64_t, uint64_t> UnzipU64Pair(const Bytes& bytes);
 Bytes Zip(int64_t i, uint64_t u);
 std::pair<int64_t, uint64_t> UnzipIU64Pair(const Bytes& bytes);
 
+///////////////////////////////////////////////
+
+// Zero-copy variants: decode straight from a span, encode into
+// caller memory (at least kMaxZipLen bytes) returning the length
+
+constexpr size_t kMaxZipLen = 16;
+
+uint64_t UnzipU64(Span bytes);
+int64_t UnzipI64(Span bytes);
+double UnzipDouble(Span bytes);
+std::pair<uint64_t, uint64_t> UnzipU64Pair(Span bytes);
+std::pair<int64_t, uint64_t> UnzipIU64Pair(Span bytes);
+
+size_t ZipTo(uint8_t* out, uint64_t value);
+size_t ZipTo(uint8_t* out, int64_t value);
+size_t ZipTo(uint8_t* out, double value);
+size_t ZipTo(uint8_t* out, uint64_t big, uint64_t lil);
+size_t ZipTo(uint8_t* out, int64_t i, uint64_t u);
+
+size_t ZipLen(uint64_t big, uint64_t lil);
+
+// Whether a zipped pair can take that many bytes
+bool IsPairLen(size_t length);
+
+// Whether the bytes are the shortest zipped form of their value, as
+// ZipTo writes it; overlong encodings are not valid RDX
+bool IsMinimal(Span bytes);
+bool IsMinimalPair(Span bytes);
+
 }  // namespace ll
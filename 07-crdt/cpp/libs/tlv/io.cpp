@@ -1,3 +1,4 @@
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
 #include <stdexcept>
@@ -36,6 +37,34 @@ char LowerCaseTransfer(char literal) {
   return literal + 32;
 }
 
+constexpr size_t kMaxHeaderSize = 5;
+
+size_t EncodeHeader(uint8_t* out, char literal, size_t body_len, bool tiny) {
+  assert(!IsTiny(literal));
+  char long_literal = UpperCaseTransfer(literal);
+
+  if (!IsLong(long_literal)) {
+    assert(false && "TLV record type is A..Z");
+  }
+
+  size_t size = HeaderSize(literal, body_len, tiny);
+
+  switch (size) {
+    case 1:
+      out[0] = '0' + body_len;
+      break;
+    case 2:
+      out[0] = LowerCaseTransfer(literal);
+      out[1] = body_len;
+      break;
+    default:
+      out[0] = long_literal;
+      ll::WriteLittleEndian(out + 1, body_len, 4);
+  }
+
+  return size;
+}
+
 }  // namespace
 
 RecordWriter::RecordWriter(ll::Bytes bytes)
@@ -136,4 +165,166 @@ Header RecordReader::ReadHeader() {
   }
 }
 
+ViewReader::ViewReader(ll::Span bytes)
+    : bytes_(bytes) {
+}
+
+bool ViewReader::IsEmpty() const {
+  return bytes_.empty();
+}
+
+bool ViewReader::HasSome() const {
+  return !IsEmpty();
+}
+
+RecordView ViewReader::ReadNext() {
+  Header header = ReadHeader();
+
+  if (bytes_.size() < header.header_size + header.body_size) {
+    throw std::runtime_error("Invalid record");
+  }
+
+  ll::Span body = bytes_.subspan(header.header_size, header.body_size);
+  bytes_ = bytes_.subspan(header.header_size + header.body_size);
+
+  return {header, body};
+}
+
+ll::Span ViewReader::Rest() const {
+  return bytes_;
+}
+
+Header ViewReader::ReadHeader() {
+  if (bytes_.empty()) {
+    throw std::runtime_error("Incomplete header");
+  }
+
+  char literal = bytes_[0];
+
+  if (IsTiny(literal)) {
+    return {'0', 1, (size_t)literal - '0'};
+  } else if (IsSmall(literal)) {
+    if (bytes_.size() < 2) {
+      throw std::runtime_error("Incomplete header");
+    }
+
+    return {UpperCaseTransfer(literal), 2, bytes_[1]};
+  } else if (IsLong(literal)) {
+    if (bytes_.size() < 5) {
+      throw std::runtime_error("Incomplete header");
+    }
+
+    size_t body_len = ll::ReadLittleEndian(bytes_.subspan(1, 4));
+
+    return {literal, 5, body_len};
+  } else {
+    throw std::runtime_error("Bad format");
+  }
+}
+
+size_t HeaderSize(char literal, size_t body_len, bool tiny) {
+  if ((tiny && body_len <= 9) || (body_len < 10 && IsSmall(literal))) {
+    return 1;
+  }
+
+  if (body_len < 0xff) {
+    return 2;
+  }
+
+  return 5;
+}
+
+BufferWriter::BufferWriter(ll::Buffer buffer)
+    : bytes_{std::move(buffer)} {
+}
+
+BufferWriter& BufferWriter::Reserve(size_t bytes) {
+  bytes_.reserve(bytes_.size() + bytes);
+  return *this;
+}
+
+BufferWriter& BufferWriter::WriteRecord(char literal, ll::Span body,
+                                        bool tiny) {
+  WriteHeader(literal, body.size(), tiny);
+  return WriteRaw(body);
+}
+
+BufferWriter& BufferWriter::WriteHeader(char literal, size_t body_len,
+                                        bool tiny) {
+  uint8_t header[kMaxHeaderSize];
+  size_t size = EncodeHeader(header, literal, body_len, tiny);
+  bytes_.insert(bytes_.end(), header, header + size);
+  return *this;
+}
+
+BufferWriter& BufferWriter::WriteRaw(ll::Span bytes) {
+  bytes_.insert(bytes_.end(), bytes.begin(), bytes.end());
+  return *this;
+}
+
+size_t BufferWriter::Size() const {
+  return bytes_.size();
+}
+
+ll::Span BufferWriter::View() const {
+  return bytes_;
+}
+
+ll::Buffer BufferWriter::Extract() {
+  return std::move(bytes_);
+}
+
+ArenaWriter::ArenaWriter(ll::Arena& arena)
+    : arena_(&arena) {
+}
+
+ArenaWriter& ArenaWriter::Reserve(size_t bytes) {
+  if (size_ + bytes > capacity_) {
+    Grow(size_ + bytes);
+  }
+
+  return *this;
+}
+
+ArenaWriter& ArenaWriter::WriteRecord(char literal, ll::Span body,
+                                      bool tiny) {
+  WriteHeader(literal, body.size(), tiny);
+  return WriteRaw(body);
+}
+
+ArenaWriter& ArenaWriter::WriteHeader(char literal, size_t body_len,
+                                      bool tiny) {
+  Reserve(kMaxHeaderSize);
+  size_ += EncodeHeader(data_ + size_, literal, body_len, tiny);
+  return *this;
+}
+
+ArenaWriter& ArenaWriter::WriteRaw(ll::Span bytes) {
+  Reserve(bytes.size());
+  std::copy(bytes.begin(), bytes.end(), data_ + size_);
+  size_ += bytes.size();
+  return *this;
+}
+
+size_t ArenaWriter::Size() const {
+  return size_;
+}
+
+ll::Span ArenaWriter::Extract() {
+  ll::Span output{data_, size_};
+  data_ = nullptr;
+  size_ = 0;
+  capacity_ = 0;
+  return output;
+}
+
+// The old chunk stays in the arena till its reset
+void ArenaWriter::Grow(size_t bytes) {
+  size_t capacity = std::max(bytes, 2 * capacity_);
+  uint8_t* data = arena_->AllocateArray<uint8_t>(capacity);
+  std::copy(data_, data_ + size_, data);
+  data_ = data;
+  capacity_ = capacity;
+}
+
 }  // namespace tlv
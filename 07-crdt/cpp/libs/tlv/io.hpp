@@ -2,6 +2,7 @@
 
 #include <optional>
 
+#include <ll/arena.hpp>
 #include <tlv/record.hpp>
 
 namespace tlv {
@@ -41,4 +42,77 @@ class RecordReader {
   ll::Bytes bytes_;
 };
 
+// Zero-copy reader: records are views into the underlying memory,
+// which must outlive them
+class ViewReader {
+ public:
+  explicit ViewReader(ll::Span bytes);
+
+  bool IsEmpty() const;
+  bool HasSome() const;
+
+  RecordView ReadNext();
+
+  ll::Span Rest() const;
+
+ private:
+  Header ReadHeader();
+
+ private:
+  ll::Span bytes_;
+};
+
+// Size of the header RecordWriter/BufferWriter would emit
+size_t HeaderSize(char literal, size_t body_len, bool tiny = false);
+
+// Contiguous counterpart of RecordWriter. Reserve() the exact size
+// upfront to have the output written with a single allocation.
+class BufferWriter {
+ public:
+  BufferWriter() = default;
+  explicit BufferWriter(ll::Buffer buffer);
+
+  BufferWriter& Reserve(size_t bytes);
+
+  BufferWriter& WriteRecord(char literal, ll::Span body, bool tiny = false);
+  BufferWriter& WriteHeader(char literal, size_t body_len, bool tiny = false);
+  BufferWriter& WriteRaw(ll::Span bytes);
+
+  size_t Size() const;
+  // The bytes written so far, valid until the next write
+  ll::Span View() const;
+
+  ll::Buffer Extract();
+
+ private:
+  ll::Buffer bytes_;
+};
+
+// BufferWriter over arena memory. Reserve() the exact size upfront:
+// outgrowing the reservation moves the output to a bigger chunk.
+class ArenaWriter {
+ public:
+  explicit ArenaWriter(ll::Arena& arena);
+
+  ArenaWriter& Reserve(size_t bytes);
+
+  ArenaWriter& WriteRecord(char literal, ll::Span body, bool tiny = false);
+  ArenaWriter& WriteHeader(char literal, size_t body_len, bool tiny = false);
+  ArenaWriter& WriteRaw(ll::Span bytes);
+
+  size_t Size() const;
+
+  // Valid until the arena is reset
+  ll::Span Extract();
+
+ private:
+  void Grow(size_t bytes);
+
+ private:
+  ll::Arena* arena_;
+  uint8_t* data_ = nullptr;
+  size_t size_ = 0;
+  size_t capacity_ = 0;
+};
+
 }  // namespace tlv
@@ -15,4 +15,15 @@ struct Record {
   ll::Bytes body;
 };
 
+struct RecordView {
+  Header header;
+  ll::Span body;
+
+  // The whole record, header included
+  ll::Span Whole() const {
+    return {body.data() - header.header_size,
+            header.header_size + body.size()};
+  }
+};
+
 }  // namespace tlv
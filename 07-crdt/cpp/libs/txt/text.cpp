@@ -0,0 +1,570 @@
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <charconv>
+#include <cstring>
+#include <stdexcept>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#endif
+
+#include <txt/text.hpp>
+
+namespace txt {
+
+namespace {
+
+constexpr char kHexDigits[] = "0123456789abcdef";
+
+// Two hex digits per byte value
+constexpr std::array<char, 512> kHexPairs = [] {
+  std::array<char, 512> pairs{};
+
+  for (size_t i = 0; i < 256; ++i) {
+    pairs[2 * i] = kHexDigits[i >> 4];
+    pairs[2 * i + 1] = kHexDigits[i & 0xf];
+  }
+
+  return pairs;
+}();
+
+// Plain char on purpose: on signed-char targets this also catches
+// bytes from 0x80, the same as the old stream loop did
+bool NeedsEscape(char byte) {
+  return byte == '"' || byte == '\\' || byte < 0x20;
+}
+
+bool IsSpace(char c) {
+  return c == ' ' || ('\t' <= c && c <= '\r');
+}
+
+// What operator>> skips and accepts before the digits
+const char* SkipPrefix(const char* begin, const char* end) {
+  while (begin != end && IsSpace(*begin)) {
+    ++begin;
+  }
+
+  if (begin != end && *begin == '+') {
+    ++begin;
+
+    if (begin != end && *begin == '-') {
+      throw std::runtime_error("Invalid number: " + std::string(begin, end));
+    }
+  }
+
+  return begin;
+}
+
+void ThrowIfFailed(std::from_chars_result result, const char* begin,
+                   std::string_view text) {
+  if (result.ec != std::errc() || result.ptr == begin) {
+    throw std::runtime_error("Invalid number: " + std::string(text));
+  }
+}
+
+}  // namespace
+
+void AppendInt(std::string& out, int64_t value) {
+  char buffer[24];
+  auto result = std::to_chars(buffer, buffer + sizeof(buffer), value);
+  out.append(buffer, result.ptr);
+}
+
+void AppendFloat(std::string& out, double value) {
+  // DBL_MAX has 309 integer digits
+  char buffer[330];
+  auto result = std::to_chars(buffer, buffer + sizeof(buffer), value,
+                              std::chars_format::fixed, 6);
+  out.append(buffer, result.ptr);
+}
+
+void AppendHex(std::string& out, uint64_t value) {
+  size_t digits = std::max<size_t>(1, (std::bit_width(value) + 3) / 4);
+  size_t size = out.size();
+  out.resize(size + digits);
+
+  char* cursor = out.data() + out.size();
+
+  for (; digits >= 2; digits -= 2) {
+    cursor -= 2;
+    std::memcpy(cursor, &kHexPairs[2 * (value & 0xff)], 2);
+    value >>= 8;
+  }
+
+  if (digits == 1) {
+    *--cursor = kHexDigits[value & 0xf];
+  }
+}
+
+size_t FindEscape(std::string_view value, size_t from) {
+  size_t i = from;
+
+#if defined(__SSE2__)
+  const __m128i quote = _mm_set1_epi8('"');
+  const __m128i backslash = _mm_set1_epi8('\\');
+  const __m128i space = _mm_set1_epi8(0x20);
+
+  // Signed compare, so bytes from 0x80 hit too, like NeedsEscape
+  for (; i + 16 <= value.size(); i += 16) {
+    __m128i chunk =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(value.data() + i));
+    __m128i hits = _mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(chunk, quote),
+                     _mm_cmpeq_epi8(chunk, backslash)),
+        _mm_cmplt_epi8(chunk, space));
+    unsigned mask = _mm_movemask_epi8(hits);
+
+    if (mask != 0) {
+      return i + std::countr_zero(mask);
+    }
+  }
+#endif
+
+  for (; i < value.size(); ++i) {
+    if (NeedsEscape(value[i])) {
+      return i;
+    }
+  }
+
+  return std::string_view::npos;
+}
+
+void AppendQuoted(std::string& out, std::string_view value) {
+  out.reserve(out.size() + value.size() + 2);
+  out += '"';
+
+  size_t begin = 0;
+
+  while (begin < value.size()) {
+    size_t end = std::min(FindEscape(value, begin), value.size());
+    out.append(value.data() + begin, end - begin);
+
+    if (end == value.size()) {
+      break;
+    }
+
+    char byte = value[end];
+
+    switch (byte) {
+      case '\\':
+      case '"':
+        out += '\\';
+        out += byte;
+        break;
+      case '\n':
+        out += "\\n";
+        break;
+      case '\r':
+        out += "\\r";
+        break;
+      case '\t':
+        out += "\\t";
+        break;
+      default:
+        out += "\\u00";
+        AppendHex(out, static_cast<unsigned>(static_cast<int>(byte)));
+    }
+
+    begin = end + 1;
+  }
+
+  out += '"';
+}
+
+namespace {
+
+// From i on, one sequence at a time
+size_t FindInvalidUtf8Scalar(const uint8_t* bytes, size_t size, size_t i) {
+  while (i < size) {
+#if defined(__SSE2__)
+    // Skip ASCII 16 bytes at a time, the usual case
+    while (i + 16 <= size) {
+      __m128i chunk =
+          _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+      unsigned mask = _mm_movemask_epi8(chunk);
+
+      if (mask != 0) {
+        i += std::countr_zero(mask);
+        break;
+      }
+
+      i += 16;
+    }
+
+    if (i == size) {
+      break;
+    }
+#endif
+
+    uint8_t lead = bytes[i];
+
+    if (lead < 0x80) {
+      ++i;
+      continue;
+    }
+
+    // Length and the allowed range of the second byte, per the
+    // well-formed sequences table of the Unicode standard
+    size_t length = 0;
+    uint8_t low = 0x80;
+    uint8_t high = 0xbf;
+
+    if (0xc2 <= lead && lead <= 0xdf) {
+      length = 2;
+    } else if (0xe0 <= lead && lead <= 0xef) {
+      length = 3;
+      low = lead == 0xe0 ? 0xa0 : 0x80;
+      high = lead == 0xed ? 0x9f : 0xbf;
+    } else if (0xf0 <= lead && lead <= 0xf4) {
+      length = 4;
+      low = lead == 0xf0 ? 0x90 : 0x80;
+      high = lead == 0xf4 ? 0x8f : 0xbf;
+    } else {
+      return i;
+    }
+
+    if (i + length > size || bytes[i + 1] < low || bytes[i + 1] > high) {
+      return i;
+    }
+
+    for (size_t j = 2; j < length; ++j) {
+      if ((bytes[i + j] & 0xc0) != 0x80) {
+        return i;
+      }
+    }
+
+    i += length;
+  }
+
+  return std::string_view::npos;
+}
+
+#if defined(__x86_64__)
+
+// The lookup validator of Keiser and Lemire, "Validating UTF-8 in less
+// than one instruction per byte": every error shows in a pair of
+// adjacent bytes, found by three 16-entry table lookups on the high
+// nibble of the previous byte, its low nibble and the high nibble of
+// the byte. Continuations of 3 and 4 byte sequences are checked apart.
+constexpr uint8_t kTooShort = 1 << 0;
+constexpr uint8_t kTooLong = 1 << 1;
+constexpr uint8_t kOverlong3 = 1 << 2;
+constexpr uint8_t kTooLarge = 1 << 3;
+constexpr uint8_t kSurrogate = 1 << 4;
+constexpr uint8_t kOverlong2 = 1 << 5;
+constexpr uint8_t kTooLarge1000 = 1 << 6;
+constexpr uint8_t kOverlong4 = 1 << 6;
+constexpr uint8_t kTwoConts = 1 << 7;
+constexpr uint8_t kCarry = kTooShort | kTooLong | kTwoConts;
+
+alignas(16) constexpr uint8_t kByte1High[16] = {
+    kTooLong, kTooLong, kTooLong, kTooLong,
+    kTooLong, kTooLong, kTooLong, kTooLong,
+    kTwoConts, kTwoConts, kTwoConts, kTwoConts,
+    kTooShort | kOverlong2,
+    kTooShort,
+    kTooShort | kOverlong3 | kSurrogate,
+    kTooShort | kTooLarge | kTooLarge1000 | kOverlong4,
+};
+
+alignas(16) constexpr uint8_t kByte1Low[16] = {
+    kCarry | kOverlong3 | kOverlong2 | kOverlong4,
+    kCarry | kOverlong2,
+    kCarry,
+    kCarry,
+    kCarry | kTooLarge,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000 | kSurrogate,
+    kCarry | kTooLarge | kTooLarge1000,
+    kCarry | kTooLarge | kTooLarge1000,
+};
+
+alignas(16) constexpr uint8_t kByte2High[16] = {
+    kTooShort, kTooShort, kTooShort, kTooShort,
+    kTooShort, kTooShort, kTooShort, kTooShort,
+    kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge1000 |
+        kOverlong4,
+    kTooLong | kOverlong2 | kTwoConts | kOverlong3 | kTooLarge,
+    kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+    kTooLong | kOverlong2 | kTwoConts | kSurrogate | kTooLarge,
+    kTooShort, kTooShort, kTooShort, kTooShort,
+};
+
+// A block ending above these in its last three bytes leaves a sequence
+// for the next one; the 16 byte blocks use the second half
+alignas(32) constexpr uint8_t kIncompleteMax[32] = {
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff,
+    0xff, 0xff, 0xff, 0xff, 0xff, 0xef, 0xdf, 0xbf,
+};
+
+// The start of the first block with an error, or of the tail too short
+// for a block; everything before it is well-formed save for a sequence
+// running into it
+__attribute__((target("ssse3")))
+size_t SkipValidUtf8Ssse3(const uint8_t* bytes, size_t size) {
+  const __m128i byte1_high =
+      _mm_load_si128(reinterpret_cast<const __m128i*>(kByte1High));
+  const __m128i byte1_low =
+      _mm_load_si128(reinterpret_cast<const __m128i*>(kByte1Low));
+  const __m128i byte2_high =
+      _mm_load_si128(reinterpret_cast<const __m128i*>(kByte2High));
+  const __m128i incomplete_max =
+      _mm_load_si128(reinterpret_cast<const __m128i*>(kIncompleteMax + 16));
+  const __m128i nibble = _mm_set1_epi8(0x0f);
+  const __m128i zero = _mm_setzero_si128();
+
+  __m128i prev = zero;
+  __m128i prev_incomplete = zero;
+  size_t i = 0;
+
+  for (; i + 16 <= size; i += 16) {
+    __m128i input =
+        _mm_loadu_si128(reinterpret_cast<const __m128i*>(bytes + i));
+    __m128i error = prev_incomplete;
+
+    if (_mm_movemask_epi8(input) != 0) {
+      __m128i prev1 = _mm_alignr_epi8(input, prev, 15);
+      __m128i prev2 = _mm_alignr_epi8(input, prev, 14);
+      __m128i prev3 = _mm_alignr_epi8(input, prev, 13);
+
+      __m128i special = _mm_and_si128(
+          _mm_and_si128(
+              _mm_shuffle_epi8(byte1_high, _mm_and_si128(
+                                               _mm_srli_epi16(prev1, 4),
+                                               nibble)),
+              _mm_shuffle_epi8(byte1_low, _mm_and_si128(prev1, nibble))),
+          _mm_shuffle_epi8(byte2_high,
+                           _mm_and_si128(_mm_srli_epi16(input, 4), nibble)));
+
+      // Only third and fourth bytes may follow two continuations
+      __m128i must23 = _mm_or_si128(
+          _mm_subs_epu8(prev2, _mm_set1_epi8(0xe0 - 0x80)),
+          _mm_subs_epu8(prev3, _mm_set1_epi8(0xf0 - 0x80)));
+      error = _mm_xor_si128(
+          special, _mm_and_si128(must23, _mm_set1_epi8(char(0x80))));
+      prev_incomplete = _mm_subs_epu8(input, incomplete_max);
+    }
+
+    if (_mm_movemask_epi8(_mm_cmpeq_epi8(error, zero)) != 0xffff) {
+      return i;
+    }
+
+    prev = input;
+  }
+
+  return i;
+}
+
+__attribute__((target("avx2")))
+size_t SkipValidUtf8Avx2(const uint8_t* bytes, size_t size) {
+  const __m256i byte1_high = _mm256_broadcastsi128_si256(
+      _mm_load_si128(reinterpret_cast<const __m128i*>(kByte1High)));
+  const __m256i byte1_low = _mm256_broadcastsi128_si256(
+      _mm_load_si128(reinterpret_cast<const __m128i*>(kByte1Low)));
+  const __m256i byte2_high = _mm256_broadcastsi128_si256(
+      _mm_load_si128(reinterpret_cast<const __m128i*>(kByte2High)));
+  const __m256i incomplete_max =
+      _mm256_load_si256(reinterpret_cast<const __m256i*>(kIncompleteMax));
+  const __m256i nibble = _mm256_set1_epi8(0x0f);
+
+  __m256i prev = _mm256_setzero_si256();
+  __m256i prev_incomplete = _mm256_setzero_si256();
+  size_t i = 0;
+
+  for (; i + 32 <= size; i += 32) {
+    __m256i input =
+        _mm256_loadu_si256(reinterpret_cast<const __m256i*>(bytes + i));
+    __m256i error = prev_incomplete;
+
+    if (_mm256_movemask_epi8(input) != 0) {
+      // The byte shifts work per 128 bit lane, so the lane before each
+      // one is put alongside it first
+      __m256i before = _mm256_permute2x128_si256(prev, input, 0x21);
+      __m256i prev1 = _mm256_alignr_epi8(input, before, 15);
+      __m256i prev2 = _mm256_alignr_epi8(input, before, 14);
+      __m256i prev3 = _mm256_alignr_epi8(input, before, 13);
+
+      __m256i special = _mm256_and_si256(
+          _mm256_and_si256(
+              _mm256_shuffle_epi8(
+                  byte1_high,
+                  _mm256_and_si256(_mm256_srli_epi16(prev1, 4), nibble)),
+              _mm256_shuffle_epi8(byte1_low,
+                                  _mm256_and_si256(prev1, nibble))),
+          _mm256_shuffle_epi8(
+              byte2_high,
+              _mm256_and_si256(_mm256_srli_epi16(input, 4), nibble)));
+
+      __m256i must23 = _mm256_or_si256(
+          _mm256_subs_epu8(prev2, _mm256_set1_epi8(0xe0 - 0x80)),
+          _mm256_subs_epu8(prev3, _mm256_set1_epi8(0xf0 - 0x80)));
+      error = _mm256_xor_si256(
+          special,
+          _mm256_and_si256(must23, _mm256_set1_epi8(char(0x80))));
+      prev_incomplete = _mm256_subs_epu8(input, incomplete_max);
+    }
+
+    if (!_mm256_testz_si256(error, error)) {
+      return i;
+    }
+
+    prev = input;
+  }
+
+  return i;
+}
+
+using SkipValidUtf8 = size_t (*)(const uint8_t*, size_t);
+
+// Picked once for the CPU running the code
+const SkipValidUtf8 kSkipValidUtf8 = []() -> SkipValidUtf8 {
+  __builtin_cpu_init();
+
+  if (__builtin_cpu_supports("avx2")) {
+    return SkipValidUtf8Avx2;
+  }
+
+  if (__builtin_cpu_supports("ssse3")) {
+    return SkipValidUtf8Ssse3;
+  }
+
+  return nullptr;
+}();
+
+#endif
+
+}  // namespace
+
+size_t FindInvalidUtf8(std::string_view text) {
+  const auto* bytes = reinterpret_cast<const uint8_t*>(text.data());
+  size_t size = text.size();
+  size_t i = 0;
+
+#if defined(__x86_64__)
+  if (kSkipValidUtf8 != nullptr) {
+    i = kSkipValidUtf8(bytes, size);
+
+    // Back to the lead byte of a sequence running into the block, the
+    // scalar pass finds the exact offset of an error from there
+    for (size_t back = 0;
+         back < 3 && i > 0 && (bytes[i - 1] & 0xc0) == 0x80; ++back) {
+      --i;
+    }
+
+    if (i > 0 && bytes[i - 1] >= 0xc0) {
+      --i;
+    }
+  }
+#endif
+
+  return FindInvalidUtf8Scalar(bytes, size, i);
+}
+
+int64_t ParseInt(std::string_view text) {
+  const char* end = text.data() + text.size();
+  const char* begin = SkipPrefix(text.data(), end);
+
+  int64_t value = 0;
+  ThrowIfFailed(std::from_chars(begin, end, value), begin, text);
+
+  return value;
+}
+
+double ParseFloat(std::string_view text) {
+  const char* end = text.data() + text.size();
+  const char* begin = SkipPrefix(text.data(), end);
+
+  // from_chars also takes inf and nan, operator>> does not
+  const char* first = begin != end && *begin == '-' ? begin + 1 : begin;
+
+  if (first == end || (*first != '.' && (*first < '0' || '9' < *first))) {
+    throw std::runtime_error("Invalid number: " + std::string(text));
+  }
+
+  double value = 0;
+  ThrowIfFailed(std::from_chars(begin, end, value), begin, text);
+
+  return value;
+}
+
+uint64_t ParseHex(std::string_view text) {
+  const char* begin = text.data();
+  const char* end = begin + text.size();
+
+  uint64_t value = 0;
+  auto result = std::from_chars(begin, end, value, 16);
+  ThrowIfFailed(result, begin, text);
+
+  if (result.ptr != end) {
+    throw std::runtime_error("Invalid hex number: " + std::string(text));
+  }
+
+  return value;
+}
+
+std::string Unquote(std::string_view text) {
+  if (text.size() < 2 || text.front() != '"' || text.back() != '"') {
+    throw std::runtime_error("Incorrect text");
+  }
+
+  std::string value;
+  value.reserve(text.size() - 2);
+
+  size_t i = 1;
+
+  while (i + 1 < text.size()) {
+    size_t end = text.find('\\', i);
+    end = std::min(end, text.size() - 1);
+    value.append(text.data() + i, end - i);
+    i = end;
+
+    if (i + 1 == text.size()) {
+      break;
+    }
+
+    if (i + 2 >= text.size()) {
+      throw std::runtime_error("Invalid escape sequence");
+    }
+
+    switch (text[i + 1]) {
+      case 'n':
+        value += '\n';
+        break;
+      case 'r':
+        value += '\r';
+        break;
+      case 't':
+        value += '\t';
+        break;
+      case '\\':
+        value += '\\';
+        break;
+      case '"':
+        value += '"';
+        break;
+      default:
+        throw std::runtime_error("Unrecognized escape sequence: \\" +
+                                 std::string(1, text[i + 1]));
+    }
+
+    i += 2;
+  }
+
+  return value;
+}
+
+}  // namespace txt
@@ -0,0 +1,43 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace txt {
+
+// Appending writers for the RDX text forms. They write into the
+// caller's string without iostreams; the output is byte-identical to
+// the std::to_string / std::hex forms used before.
+
+// std::to_string(int64_t)
+void AppendInt(std::string& out, int64_t value);
+// std::to_string(double), i.e. "%f"
+void AppendFloat(std::string& out, double value);
+// std::hex, lowercase, no padding
+void AppendHex(std::string& out, uint64_t value);
+
+// A double-quoted string with \\ \" \n \r \t escapes and \u00<hex> for
+// other bytes below 0x20. Bytes from 0x80 go through the same branch
+// as a sign-extended char, as isfr has always printed them.
+void AppendQuoted(std::string& out, std::string_view value);
+
+// Position of the first byte AppendQuoted has to escape, or npos
+size_t FindEscape(std::string_view value, size_t from = 0);
+
+// Offset of the first byte of an ill-formed UTF-8 sequence (overlong
+// forms and surrogates included), or npos. Checks 32 or 16 bytes at a
+// time with AVX2 or SSSE3 where the CPU has them.
+size_t FindInvalidUtf8(std::string_view text);
+
+// Parsers throw std::runtime_error on malformed or out of range text.
+// Numbers may have leading whitespace, a sign and trailing text, as
+// with operator>>.
+int64_t ParseInt(std::string_view text);
+double ParseFloat(std::string_view text);
+// The whole text must be hex digits
+uint64_t ParseHex(std::string_view text);
+// Inverse of AppendQuoted for the \\ \" \n \r \t escapes
+std::string Unquote(std::string_view text);
+
+}  // namespace txt
@@ -1,6 +1,6 @@
+#include <algorithm>
 #include <cstddef>
 #include <cstdint>
-#include <sstream>
 #include <stdexcept>
 #include <string>
 #include <tuple>
@@ -10,6 +10,7 @@
 #include <ll/bytes.hpp>
 #include <tlv/io.hpp>
 #include <cmn/id.hpp>
+#include <txt/text.hpp>
 
 #include <isfr/types.hpp>
 
@@ -41,15 +42,35 @@ ll::Bytes ISFRmerge(std::vector<ll::Bytes> tlvs) {
   return Tlvt(std::move(max_value), std::move(max_time));
 }
 
-template <class T>
-T ReadFromText(const std::string& text) {
-  std::stringstream ss(text);
-  ss.exceptions(std::ios::failbit);
+// Same order as ISFRmerge, over views
+ll::Span MergeViews(std::span<const ll::Span> tlvs, ll::Arena& arena) {
+  Time max_time;
+  ll::Span max_value;
+
+  for (ll::Span tlv : tlvs) {
+    auto [time, value] = ParseView(tlv);
+    time.revision = std::abs(time.revision);
+
+    bool same_value = std::ranges::equal(value, max_value);
+    bool greater =
+        time.revision != max_time.revision ? time.revision > max_time.revision
+        : !same_value ? std::ranges::lexicographical_compare(max_value, value)
+                      : time.source > max_time.source;
 
-  T value;
-  ss >> value;
+    if (!greater) {
+      continue;
+    }
+
+    max_time = time;
+    max_value = value;
+  }
 
-  return value;
+  return Tlvt(max_value, max_time, arena);
+}
+
+ll::Span DeltaView(ll::Span tlv, ll::Span new_value, ll::Arena& arena) {
+  auto [time, _] = ParseView(tlv);
+  return Tlvt(new_value, {std::abs(time.revision) + 1, 0}, arena);
 }
 
 }  // namespace
@@ -97,7 +118,7 @@ ll::Bytes Itlv(int64_t value, Time time) {
 }
 
 ll::Bytes Iparse(std::string text) {
-  return Itlv(ReadFromText<int64_t>(text));
+  return Itlv(txt::ParseInt(text));
 }
 
 ll::Bytes Imerge(std::vector<ll::Bytes> tlvs) {
@@ -125,81 +146,18 @@ std::string Snative(ll::Bytes tlv) {
 
 std::string Sstring(ll::Bytes tlv) {
   auto [_, value] = Parse(std::move(tlv));
+  return Squote(std::string(value.begin(), value.end()));
+}
 
-  std::stringstream ss;
-  ss << '"';
-
-  for (char byte : value) {
-    switch (byte) {
-      case '\\':
-      case '"':
-        ss << "\\" << byte;
-        break;
-      case '\n':
-        ss << "\\n";
-        break;
-      case '\r':
-        ss << "\\r";
-        break;
-      case '\t':
-        ss << "\\t";
-        break;
-      default:
-        if (byte < 0x20) {
-          ss << "\\u00" << std::hex << static_cast<int>(byte);
-        } else {
-          ss << byte;
-        }
-    }
-  }
-
-  ss << '"';
-
-  return ss.str();
+std::string Squote(std::string_view value) {
+  std::string text;
+  txt::AppendQuoted(text, value);
+  return text;
 }
 
 ll::Bytes Sparse(std::string text) {
-  if (text.size() < 2 || text.front() != '"' || text.back() != '"') {
-    throw std::runtime_error("Incorrect text");
-  }
-
-  ll::Bytes value;
-
-  for (size_t i = 1; i + 1 < text.size(); ++i) {
-    if (text[i] != '\\') {
-      value.push_back(text[i]);
-      continue;
-    }
-
-    if (i + 2 >= text.size()) {
-      throw std::runtime_error("Invalid escape sequence");
-    }
-
-    switch (text[i + 1]) {
-      case 'n':
-        value.push_back('\n');
-        break;
-      case 'r':
-        value.push_back('\r');
-        break;
-      case 't':
-        value.push_back('\t');
-        break;
-      case '\\':
-        value.push_back('\\');
-        break;
-      case '"':
-        value.push_back('"');
-        break;
-      default:
-        throw std::runtime_error("Unrecognized escape sequence: \\" +
-                                 std::string(1, text[i + 1]));
-    }
-
-    ++i;
-  }
-
-  return Tlvt(std::move(value), {});
+  std::string value = txt::Unquote(text);
+  return Tlvt(ll::Bytes(value.begin(), value.end()), {});
 }
 
 ll::Bytes Stlv(std::string value, Time time) {
@@ -231,11 +189,13 @@ double Fnative(ll::Bytes tlv) {
 }
 
 std::string Fstring(ll::Bytes tlv) {
-  return std::to_string(Fnative(std::move(tlv)));
+  std::string text;
+  txt::AppendFloat(text, Fnative(std::move(tlv)));
+  return text;
 }
 
 ll::Bytes Fparse(std::string text) {
-  return Ftlv(ReadFromText<double>(text));
+  return Ftlv(txt::ParseFloat(text));
 }
 
 ll::Bytes Ftlv(double value, Time time) {
@@ -292,4 +252,72 @@ bool Rvalid(ll::Bytes tlv) {
   return !value.empty();
 }
 
+/////////////////////// Arena variants
+
+std::pair<Time, ll::Span> ParseView(ll::Span tlv) {
+  tlv::ViewReader reader(tlv);
+  tlv::RecordView record = reader.ReadNext();
+
+  if (record.header.literal != 'T' && record.header.literal != '0') {
+    throw std::runtime_error("invalid ISFR");
+  }
+
+  auto [rev, src] = ll::UnzipIU64Pair(record.body);
+
+  return {Time{rev, src}, reader.Rest()};
+}
+
+ll::Span Tlvt(ll::Span value, Time time, ll::Arena& arena) {
+  uint8_t zipped[ll::kMaxZipLen];
+  size_t size = ll::ZipTo(zipped, time.revision, time.source);
+
+  tlv::ArenaWriter writer(arena);
+  writer.Reserve(tlv::HeaderSize('T', size, true) + size + value.size());
+  writer.WriteRecord('T', {zipped, size}, true);
+  writer.WriteRaw(value);
+
+  return writer.Extract();
+}
+
+ll::Span Imerge(std::span<const ll::Span> tlvs, ll::Arena& arena) {
+  return MergeViews(tlvs, arena);
+}
+
+ll::Span Idelta(ll::Span tlv, int64_t new_value, ll::Arena& arena) {
+  uint8_t zipped[ll::kMaxZipLen];
+  size_t size = ll::ZipTo(zipped, new_value);
+  return DeltaView(tlv, {zipped, size}, arena);
+}
+
+ll::Span Smerge(std::span<const ll::Span> tlvs, ll::Arena& arena) {
+  return MergeViews(tlvs, arena);
+}
+
+ll::Span Sdelta(ll::Span tlv, std::string_view new_value, ll::Arena& arena) {
+  const auto* bytes = reinterpret_cast<const uint8_t*>(new_value.data());
+  return DeltaView(tlv, {bytes, new_value.size()}, arena);
+}
+
+ll::Span Fmerge(std::span<const ll::Span> tlvs, ll::Arena& arena) {
+  return MergeViews(tlvs, arena);
+}
+
+ll::Span Fdelta(ll::Span tlv, double new_value, ll::Arena& arena) {
+  uint8_t zipped[ll::kMaxZipLen];
+  size_t size = ll::ZipTo(zipped, new_value);
+  return DeltaView(tlv, {zipped, size}, arena);
+}
+
+ll::Span Rmerge(std::span<const ll::Span> tlvs, ll::Arena& arena) {
+  return MergeViews(tlvs, arena);
+}
+
+ll::Span Rdelta(ll::Span tlv, cmn::Id new_value, ll::Arena& arena) {
+  uint64_t progress = uint64_t(new_value.offset) << 32 | new_value.sequence;
+
+  uint8_t zipped[ll::kMaxZipLen];
+  size_t size = ll::ZipTo(zipped, progress, uint64_t(new_value.source));
+  return DeltaView(tlv, {zipped, size}, arena);
+}
+
 }  // namespace isfr
@@ -1,8 +1,11 @@
 #pragma once
 
+#include <span>
 #include <string>
+#include <string_view>
 #include <vector>
 
+#include <ll/arena.hpp>
 #include <ll/bytes.hpp>
 #include <cmn/id.hpp>
 
@@ -29,6 +32,7 @@ bool Ivalid(ll::Bytes tlv);
 // S
 std::string Snative(ll::Bytes tlv);
 std::string Sstring(ll::Bytes tlv);
+std::string Squote(std::string_view value);
 ll::Bytes Sparse(std::string text);
 ll::Bytes Stlv(std::string value, Time time = {});
 ll::Bytes Smerge(std::vector<ll::Bytes> tlvs);
@@ -53,4 +57,21 @@ ll::Bytes Rmerge(std::vector<ll::Bytes> tlvs);
 ll::Bytes Rdelta(ll::Bytes tlv, cmn::Id new_value);
 bool Rvalid(ll::Bytes tlv);
 
+// Arena variants of the above: no temporaries, the results live in
+// the arena until its next Reset()
+std::pair<Time, ll::Span> ParseView(ll::Span tlv);
+ll::Span Tlvt(ll::Span value, Time time, ll::Arena& arena);
+
+ll::Span Imerge(std::span<const ll::Span> tlvs, ll::Arena& arena);
+ll::Span Idelta(ll::Span tlv, int64_t new_value, ll::Arena& arena);
+
+ll::Span Smerge(std::span<const ll::Span> tlvs, ll::Arena& arena);
+ll::Span Sdelta(ll::Span tlv, std::string_view new_value, ll::Arena& arena);
+
+ll::Span Fmerge(std::span<const ll::Span> tlvs, ll::Arena& arena);
+ll::Span Fdelta(ll::Span tlv, double new_value, ll::Arena& arena);
+
+ll::Span Rmerge(std::span<const ll::Span> tlvs, ll::Arena& arena);
+ll::Span Rdelta(ll::Span tlv, cmn::Id new_value, ll::Arena& arena);
+
 }  // namespace isfr
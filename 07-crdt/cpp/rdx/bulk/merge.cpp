@@ -0,0 +1,239 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <exception>
+#include <mutex>
+#include <string>
+#include <thread>
+
+#include <lsm/merge_operator.hpp>
+
+#include <bulk/merge.hpp>
+
+namespace bulk {
+
+namespace {
+
+// Bytes a field costs on top of its inputs, so that runs of tiny or
+// empty fields stay bounded too
+constexpr size_t kFieldCost = 16;
+
+struct Run {
+  size_t begin;
+  size_t end;
+};
+
+// A worker's share of the runs, [begin, end) in one word, so that the
+// owner taking the front and a thief taking the back never both get
+// the last run
+struct alignas(64) Share {
+  std::atomic<uint64_t> bounds{0};
+};
+
+uint64_t Pack(uint64_t begin, uint64_t end) {
+  return begin << 32 | end;
+}
+
+bool Take(Share& share, bool front, size_t& run) {
+  uint64_t bounds = share.bounds.load(std::memory_order_relaxed);
+
+  for (;;) {
+    uint64_t begin = bounds >> 32;
+    uint64_t end = bounds & 0xffffffff;
+
+    if (begin >= end) {
+      return false;
+    }
+
+    uint64_t next = front ? Pack(begin + 1, end) : Pack(begin, end - 1);
+
+    if (share.bounds.compare_exchange_weak(bounds, next,
+                                           std::memory_order_acq_rel)) {
+      run = front ? begin : end - 1;
+      return true;
+    }
+  }
+}
+
+size_t CostOf(const Field& field) {
+  size_t cost = kFieldCost;
+
+  for (ll::Span input : field.inputs) {
+    cost += input.size();
+  }
+
+  return cost;
+}
+
+std::vector<Run> CutRuns(std::span<const Field> fields, size_t run_bytes,
+                         size_t threads) {
+  size_t total = 0;
+
+  for (const Field& field : fields) {
+    total += CostOf(field);
+  }
+
+  // A few runs per worker at the least, for the stealing to even out
+  size_t target = std::max<size_t>(
+      1, std::min(run_bytes, total / (threads * 4)));
+
+  std::vector<Run> runs;
+  size_t begin = 0;
+  size_t cost = 0;
+
+  for (size_t i = 0; i < fields.size(); ++i) {
+    cost += CostOf(fields[i]);
+
+    if (cost >= target) {
+      runs.push_back({begin, i + 1});
+      begin = i + 1;
+      cost = 0;
+    }
+  }
+
+  if (begin < fields.size()) {
+    runs.push_back({begin, fields.size()});
+  }
+
+  return runs;
+}
+
+class Batch {
+ public:
+  Batch(std::span<const Field> fields, std::vector<Run> runs,
+        size_t threads)
+      : fields_(fields),
+        runs_(std::move(runs)),
+        outputs_(runs_.size()),
+        ends_(fields.size()),
+        failed_(fields.size()),
+        shares_(threads) {
+    for (size_t w = 0; w < threads; ++w) {
+      shares_[w].bounds = Pack(runs_.size() * w / threads,
+                               runs_.size() * (w + 1) / threads);
+    }
+  }
+
+  // Own runs first, then the others' from the back
+  void Work(size_t worker) {
+    try {
+      lsm::MergeOperator merge;
+      ll::Buffer result;
+      size_t run = 0;
+
+      while (Take(shares_[worker], true, run)) {
+        MergeRun(run, merge, result);
+      }
+
+      for (size_t i = 1; i < shares_.size(); ++i) {
+        Share& victim = shares_[(worker + i) % shares_.size()];
+
+        while (Take(victim, false, run)) {
+          MergeRun(run, merge, result);
+        }
+      }
+    } catch (...) {
+      std::lock_guard lock(error_mutex_);
+
+      if (error_ == nullptr) {
+        error_ = std::current_exception();
+      }
+    }
+  }
+
+  Merged Collect() {
+    if (error_ != nullptr) {
+      std::rethrow_exception(error_);
+    }
+
+    Merged merged;
+    size_t size = 0;
+
+    for (const ll::Buffer& output : outputs_) {
+      size += output.size();
+    }
+
+    merged.bytes.reserve(size);
+
+    for (size_t r = 0; r < runs_.size(); ++r) {
+      size_t base = merged.bytes.size();
+
+      for (size_t i = runs_[r].begin; i < runs_[r].end; ++i) {
+        ends_[i] += base;
+
+        if (failed_[i] != 0) {
+          merged.failed.push_back(i);
+        }
+      }
+
+      merged.bytes.insert(merged.bytes.end(), outputs_[r].begin(),
+                          outputs_[r].end());
+    }
+
+    merged.ends = std::move(ends_);
+    return merged;
+  }
+
+ private:
+  void MergeRun(size_t run, lsm::MergeOperator& merge, ll::Buffer& result) {
+    ll::Buffer& output = outputs_[run];
+
+    for (size_t i = runs_[run].begin; i < runs_[run].end; ++i) {
+      const Field& field = fields_[i];
+      std::string key = lsm::FieldKey(field.id, field.literal);
+
+      if (merge.FullMerge(key, nullptr, field.inputs, result)) {
+        output.insert(output.end(), result.begin(), result.end());
+      } else {
+        failed_[i] = 1;
+      }
+
+      ends_[i] = output.size();
+    }
+  }
+
+  std::span<const Field> fields_;
+  std::vector<Run> runs_;
+  // Per run, so no two workers ever write the same one
+  std::vector<ll::Buffer> outputs_;
+  std::vector<size_t> ends_;
+  std::vector<uint8_t> failed_;
+  std::vector<Share> shares_;
+
+  std::mutex error_mutex_;
+  std::exception_ptr error_;
+};
+
+}  // namespace
+
+ll::Span Merged::Value(size_t index) const {
+  size_t begin = index == 0 ? 0 : ends[index - 1];
+  return ll::Span(bytes).subspan(begin, ends[index] - begin);
+}
+
+Merged Merge(std::span<const Field> fields, MergeOptions options) {
+  size_t threads = options.threads != 0
+                       ? options.threads
+                       : std::max(1u, std::thread::hardware_concurrency());
+
+  std::vector<Run> runs = CutRuns(fields, options.run_bytes, threads);
+  threads = std::max<size_t>(1, std::min(threads, runs.size()));
+
+  Batch batch(fields, std::move(runs), threads);
+  std::vector<std::thread> workers;
+  workers.reserve(threads - 1);
+
+  for (size_t w = 1; w < threads; ++w) {
+    workers.emplace_back([&batch, w] { batch.Work(w); });
+  }
+
+  batch.Work(0);
+
+  for (std::thread& worker : workers) {
+    worker.join();
+  }
+
+  return batch.Collect();
+}
+
+}  // namespace bulk
@@ -0,0 +1,45 @@
+#pragma once
+
+#include <cstddef>
+#include <span>
+#include <vector>
+
+#include <ll/bytes.hpp>
+#include <cmn/id.hpp>
+
+namespace bulk {
+
+// Batch merges of independent fields, as a large pull brings them.
+// Fields are cut into runs of consecutive fields of about even input
+// bytes; every worker starts on its own share of the runs and, once
+// done, steals runs off the back of the others' shares. The merges are
+// the lsm ones, inputs and results bare record bodies as in the store.
+
+struct Field {
+  cmn::Id id;
+  char literal = 0;
+  std::span<const ll::Span> inputs;
+};
+
+struct MergeOptions {
+  // Workers, 0 for one per core
+  size_t threads = 0;
+  // Input bytes per run, fewer if that leaves workers without runs
+  size_t run_bytes = 64 << 10;
+};
+
+// The merged values back to back, in the order of the fields
+struct Merged {
+  ll::Buffer bytes;
+  // Value i ends at ends[i] and starts where value i - 1 ends
+  std::vector<size_t> ends;
+  // Fields of an unknown type or with corrupt inputs, their values
+  // are left empty
+  std::vector<size_t> failed;
+
+  ll::Span Value(size_t index) const;
+};
+
+Merged Merge(std::span<const Field> fields, MergeOptions options = {});
+
+}  // namespace bulk
@@ -0,0 +1,228 @@
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <stdexcept>
+#include <vector>
+
+#include <ll/zipint.hpp>
+#include <tlv/io.hpp>
+
+#include <feed/feed.hpp>
+
+namespace feed {
+
+namespace {
+
+constexpr size_t kReadChunk = 64 << 10;
+// Way over any batch, a bigger length is garbage
+constexpr size_t kMaxFrame = 64 << 20;
+
+void Check(bool ok, const char* what) {
+  if (!ok) {
+    throw std::runtime_error(what);
+  }
+}
+
+// TLV frames over the socket, counted in the stats
+class Connection {
+ public:
+  Connection(int fd, FeedStats& stats)
+      : fd_(fd), stats_(&stats) {
+  }
+
+  void Send(ll::Span bytes) {
+    stats_->sent += bytes.size();
+
+    while (!bytes.empty()) {
+      ssize_t written = write(fd_, bytes.data(), bytes.size());
+
+      if (written < 0 && errno == EINTR) {
+        continue;
+      }
+
+      Check(written > 0, "Feed write failed");
+      bytes = bytes.subspan(written);
+    }
+  }
+
+  void SendRecord(char literal, ll::Span body) {
+    tlv::BufferWriter writer(std::move(out_));
+    writer.WriteRecord(literal, body);
+    out_ = writer.Extract();
+    Send(out_);
+    out_.clear();
+  }
+
+  // The next frame, valid until the next call
+  tlv::RecordView Receive() {
+    if (begin_ == in_.size()) {
+      in_.clear();
+      begin_ = 0;
+    } else if (begin_ >= kReadChunk) {
+      in_.erase(in_.begin(), in_.begin() + begin_);
+      begin_ = 0;
+    }
+
+    size_t size = 0;
+
+    while ((size = FrameSize()) == 0) {
+      size_t used = in_.size();
+      in_.resize(used + kReadChunk);
+      ssize_t got = read(fd_, in_.data() + used, kReadChunk);
+      in_.resize(used + std::max<ssize_t>(got, 0));
+
+      if (got < 0 && errno == EINTR) {
+        continue;
+      }
+
+      Check(got > 0, "Feed closed early");
+      stats_->received += got;
+    }
+
+    ll::Span frame(in_.data() + begin_, size);
+    begin_ += size;
+    return tlv::ViewReader(frame).ReadNext();
+  }
+
+ private:
+  // Of the buffered frame, zero while it is incomplete
+  size_t FrameSize() const {
+    ll::Span rest(in_.data() + begin_, in_.size() - begin_);
+
+    if (rest.empty()) {
+      return 0;
+    }
+
+    uint8_t literal = rest[0];
+    size_t header = 0;
+    size_t body = 0;
+
+    if (literal >= 'A' && literal <= 'Z') {
+      header = 5;
+      body = rest.size() < header ? 0
+                                  : ll::ReadLittleEndian(rest.subspan(1, 4));
+    } else if (literal >= 'a' && literal <= 'z') {
+      header = 2;
+      body = rest.size() < header ? 0 : rest[1];
+    } else {
+      throw std::runtime_error("Bad feed frame");
+    }
+
+    Check(body <= kMaxFrame, "Bad feed frame");
+    return rest.size() < header + body ? 0 : header + body;
+  }
+
+ private:
+  int fd_;
+  FeedStats* stats_;
+  ll::Buffer in_;
+  size_t begin_ = 0;
+  ll::Buffer out_;
+};
+
+size_t ReadAck(Connection& connection, size_t sent) {
+  tlv::RecordView ack = connection.Receive();
+  Check(ack.header.literal == 'K' && ack.body.size() <= sizeof(uint64_t),
+        "Bad feed acknowledgement");
+
+  uint64_t acked = ll::UnzipU64(ack.body);
+  Check(acked <= sent, "Bad feed acknowledgement");
+  return acked;
+}
+
+}  // namespace
+
+FeedStats Push(const plog::PacketLog& log, int fd, FeedOptions options) {
+  FeedStats stats;
+  Connection connection(fd, stats);
+
+  tlv::RecordView hello = connection.Receive();
+  Check(hello.header.literal == 'V', "Bad feed handshake");
+  std::vector<uint32_t> positions =
+      log.Since(vv::VersionVector::FromTlv(hello.body));
+
+  std::vector<ll::Span> records;
+  ll::Buffer batch;
+  size_t acked = 0;
+
+  for (size_t next = 0; next < positions.size();) {
+    size_t bytes = 0;
+    records.clear();
+
+    while (next < positions.size()) {
+      ll::Span record = log.RecordAt(positions[next]);
+
+      if (!records.empty() && bytes + record.size() > options.batch_bytes) {
+        break;
+      }
+
+      records.push_back(record);
+      bytes += record.size();
+      ++next;
+    }
+
+    tlv::BufferWriter writer(std::move(batch));
+    writer.Reserve(tlv::HeaderSize('B', bytes) + bytes);
+    writer.WriteHeader('B', bytes);
+
+    for (ll::Span record : records) {
+      writer.WriteRaw(record);
+    }
+
+    batch = writer.Extract();
+    connection.Send(batch);
+    batch.clear();
+
+    stats.packets += records.size();
+    ++stats.batches;
+
+    while (stats.batches - acked >= options.window) {
+      acked = ReadAck(connection, stats.batches);
+    }
+  }
+
+  connection.SendRecord('D', {});
+
+  while (acked < stats.batches) {
+    acked = ReadAck(connection, stats.batches);
+  }
+
+  return stats;
+}
+
+FeedStats Pull(plog::PacketLog& log, int fd) {
+  FeedStats stats;
+  Connection connection(fd, stats);
+  connection.SendRecord('V', log.Progress().Tlv());
+
+  for (;;) {
+    tlv::RecordView frame = connection.Receive();
+
+    if (frame.header.literal == 'D') {
+      break;
+    }
+
+    Check(frame.header.literal == 'B', "Bad feed frame");
+    tlv::ViewReader reader(frame.body);
+
+    while (reader.HasSome()) {
+      plog::PacketView packet = plog::ParsePacket(reader.ReadNext().Whole());
+      plog::Verdict verdict =
+          log.Append(packet.id, packet.literal, packet.body);
+      Check(verdict != plog::Verdict::kGap, "Causal gap in the feed");
+      ++stats.packets;
+    }
+
+    log.Commit();
+    ++stats.batches;
+
+    uint8_t zipped[ll::kMaxZipLen];
+    size_t size = ll::ZipTo(zipped, uint64_t(stats.batches));
+    connection.SendRecord('K', {zipped, size});
+  }
+
+  return stats;
+}
+
+}  // namespace feed
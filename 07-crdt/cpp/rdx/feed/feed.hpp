@@ -0,0 +1,37 @@
+#pragma once
+
+#include <cstddef>
+
+#include <plog/packet_log.hpp>
+
+namespace feed {
+
+// One side of a log feed over a connected stream socket. The puller
+// sends its version vector (V), the pusher answers with the packets
+// beyond it in the log order, a causal one, packed into batches (B)
+// each going out in a single write. The puller appends a batch with
+// one group commit and acknowledges it (K, the count of batches
+// taken); the pusher keeps up to a window of batches unacknowledged,
+// then says it is done (D).
+
+struct FeedOptions {
+  // Packet bytes per batch, a batch is at least one packet
+  size_t batch_bytes = 64 << 10;
+  // Batches in flight
+  size_t window = 4;
+};
+
+struct FeedStats {
+  size_t packets = 0;
+  size_t batches = 0;
+  // Bytes written and read on the socket
+  size_t sent = 0;
+  size_t received = 0;
+};
+
+FeedStats Push(const plog::PacketLog& log, int fd, FeedOptions options = {});
+
+// Throws if the packets do not fit the log causally
+FeedStats Pull(plog::PacketLog& log, int fd);
+
+}  // namespace feed
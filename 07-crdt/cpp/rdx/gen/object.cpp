@@ -0,0 +1,105 @@
+#include <cstring>
+
+#include <lsm/merge_operator.hpp>
+
+#include <gen/object.hpp>
+
+namespace gen {
+
+namespace {
+
+void Check(bool condition, const char* message) {
+  if (!condition) {
+    throw std::runtime_error(message);
+  }
+}
+
+}  // namespace
+
+bool IsFieldType(char literal) {
+  return literal != '\0' && std::strchr("FIRSNZEMLV", literal) != nullptr;
+}
+
+void IndexFields(ll::Span tlv, std::span<const char> literals,
+                 std::span<ll::Span> fields) {
+  tlv::ViewReader reader(tlv);
+
+  while (reader.HasSome()) {
+    tlv::RecordView record = reader.ReadNext();
+    tlv::ViewReader inner(record.body);
+    Check(inner.HasSome(), "Invalid field record");
+
+    tlv::RecordView offset_record = inner.ReadNext();
+    Check(offset_record.header.literal == '0' &&
+              offset_record.body.size() <= 2,
+          "Invalid field offset");
+
+    uint64_t offset = ll::UnzipU64(offset_record.body);
+    Check(offset != 0 && offset <= kMaxFields, "Invalid field offset");
+
+    if (offset > literals.size()) {
+      continue;
+    }
+
+    Check(record.header.literal == literals[offset - 1],
+          "Field type mismatch");
+    Check(fields[offset - 1].data() == nullptr, "Duplicate field");
+
+    // A present field with an empty value still reads as present
+    ll::Span value = inner.Rest();
+    fields[offset - 1] = value.data() == nullptr ? record.body.last(0)
+                                                 : value;
+  }
+}
+
+void WriteField(tlv::BufferWriter& writer, uint16_t offset, char literal,
+                ll::Span value) {
+  uint8_t zipped[ll::kMaxZipLen];
+  size_t size = ll::ZipTo(zipped, uint64_t(offset));
+  size_t inner = tlv::HeaderSize('T', size, true) + size + value.size();
+
+  writer.WriteHeader(literal, inner);
+  writer.WriteRecord('T', {zipped, size}, true);
+  writer.WriteRaw(value);
+}
+
+ll::Buffer Load(lsm::Store& store, cmn::Id object,
+                std::span<const char> literals) {
+  tlv::BufferWriter writer;
+  cmn::Id field = object;
+
+  for (size_t i = 0; i < literals.size(); ++i) {
+    field.offset = i + 1;
+    std::optional<ll::Buffer> value =
+        store.Get(lsm::FieldKey(field, literals[i]));
+
+    if (value.has_value()) {
+      WriteField(writer, i + 1, literals[i], *value);
+    }
+  }
+
+  return writer.Extract();
+}
+
+void Apply(lsm::Store& store, cmn::Id object, ll::Span delta) {
+  tlv::ViewReader reader(delta);
+  cmn::Id field = object;
+
+  while (reader.HasSome()) {
+    tlv::RecordView record = reader.ReadNext();
+    Check(IsFieldType(record.header.literal), "Invalid field type");
+
+    tlv::ViewReader inner(record.body);
+    Check(inner.HasSome(), "Invalid field record");
+    tlv::RecordView offset_record = inner.ReadNext();
+    uint64_t offset = ll::UnzipU64(offset_record.body);
+    Check(offset_record.header.literal == '0' && offset != 0 &&
+              offset <= kMaxFields,
+          "Invalid field offset");
+
+    field.offset = offset;
+    store.Merge(lsm::FieldKey(field, record.header.literal), inner.Rest());
+  }
+}
+
+}  // namespace gen
@@ -0,0 +1,242 @@
+#pragma once
+
+#include <array>
+#include <cstdint>
+#include <cstdlib>
+#include <span>
+#include <stdexcept>
+#include <string_view>
+#include <type_traits>
+
+#include <ll/bytes.hpp>
+#include <ll/zipint.hpp>
+#include <tlv/io.hpp>
+#include <cmn/id.hpp>
+#include <isfr/types.hpp>
+#include <nz/integer.hpp>
+#include <nz/natural.hpp>
+
+#include <lsm/store.hpp>
+#include <typed/traits.hpp>
+
+namespace gen {
+
+// Runtime of the code rdxgen emits. A packed object is one record per
+// field it has, in any order. The record literal is the field type,
+// the body a tiny record of the zipped field offset, then the bare
+// field value, the same body the field has in the store. Offsets
+// start at 1; offset 0 is the object itself, as in cmn::Id.
+
+constexpr size_t kMaxFields = 4095;
+
+// Whether the letter is a field type: F, I, R, S, N, Z, E, M, L, V
+bool IsFieldType(char literal);
+
+// Records the value spans of the fields by offset, fields[i] being
+// offset i + 1, with literals[i] its type. Offsets past the end are
+// fields of a newer schema and get skipped. Throws on a malformed
+// object, a duplicate offset or a type mismatch.
+void IndexFields(ll::Span tlv, std::span<const char> literals,
+                 std::span<ll::Span> fields);
+
+void WriteField(tlv::BufferWriter& writer, uint16_t offset, char literal,
+                ll::Span value);
+
+// The stored fields of the object packed, ready for a view; absent
+// fields are left out
+ll::Buffer Load(lsm::Store& store, cmn::Id object,
+                std::span<const char> literals);
+
+// Merges every field of a packed delta into its store entry
+void Apply(lsm::Store& store, cmn::Id object, ll::Span delta);
+
+// The native type of a field type: FIRST values and counters decode,
+// S reads as a view of the value bytes, E, M, L and V stay TLV
+template <char Literal>
+struct Native {
+  using Type = ll::Span;
+};
+
+template <>
+struct Native<'F'> {
+  using Type = double;
+};
+
+template <>
+struct Native<'I'> {
+  using Type = int64_t;
+};
+
+template <>
+struct Native<'R'> {
+  using Type = cmn::Id;
+};
+
+template <>
+struct Native<'S'> {
+  using Type = std::string_view;
+};
+
+template <>
+struct Native<'N'> {
+  using Type = uint64_t;
+};
+
+template <>
+struct Native<'Z'> {
+  using Type = int64_t;
+};
+
+template <char Literal>
+constexpr bool kIsFirst = Literal == 'F' || Literal == 'I' ||
+                          Literal == 'R' || Literal == 'S';
+
+// A FIRST value as its zipped bytes, into kMaxZipLen of scratch
+template <char Literal>
+ll::Span EncodeFirst(typename Native<Literal>::Type value,
+                     uint8_t* scratch) {
+  using Type = typename Native<Literal>::Type;
+
+  if constexpr (Literal == 'S') {
+    return {reinterpret_cast<const uint8_t*>(value.data()), value.size()};
+  } else {
+    return typed::Traits<Type>::Encode(value, scratch);
+  }
+}
+
+// An absent field reads as the zero value
+template <char Literal>
+typename Native<Literal>::Type Read(ll::Span value) {
+  if constexpr (kIsFirst<Literal>) {
+    if (value.empty()) {
+      return {};
+    }
+
+    ll::Span bytes = isfr::ParseView(value).second;
+
+    if constexpr (Literal == 'S') {
+      return {reinterpret_cast<const char*>(bytes.data()), bytes.size()};
+    } else {
+      return typed::Traits<typename Native<Literal>::Type>::Decode(bytes);
+    }
+  } else if constexpr (Literal == 'N') {
+    return nz::Nnative(value);
+  } else if constexpr (Literal == 'Z') {
+    return nz::Znative(value);
+  } else {
+    return value;
+  }
+}
+
+// Lazy view of a packed object with N fields. Nothing is parsed until
+// the first field access, which indexes the record headers; values
+// decode on access only. The bytes must outlive the view.
+template <size_t N>
+class Object {
+  static_assert(N <= kMaxFields, "Too many fields");
+
+ public:
+  Object(ll::Span tlv, const std::array<char, N>& literals)
+      : tlv_(tlv), literals_(&literals) {
+  }
+
+  ll::Span Tlv() const {
+    return tlv_;
+  }
+
+  // The bare value of the field at the offset, empty if absent
+  ll::Span Value(uint16_t offset) const {
+    if (!indexed_) {
+      IndexFields(tlv_, *literals_, fields_);
+      indexed_ = true;
+    }
+
+    return fields_[offset - 1];
+  }
+
+ private:
+  ll::Span tlv_;
+  const std::array<char, N>* literals_;
+  mutable std::array<ll::Span, N> fields_{};
+  mutable bool indexed_ = false;
+};
+
+// Writes field deltas against an old state straight into a packet
+// buffer, as one packed object. New FIRST values get the next
+// revision, counters the contribution of the source; unchanged fields
+// write nothing.
+template <size_t N>
+class Delta {
+ public:
+  Delta(const Object<N>& old, uint64_t source, tlv::BufferWriter& writer)
+      : old_(&old), source_(source), writer_(&writer) {
+  }
+
+  // Fields written so far
+  size_t Count() const {
+    return count_;
+  }
+
+ protected:
+  template <char Literal>
+  void Set(uint16_t offset, typename Native<Literal>::Type value) {
+    ll::Span old = old_->Value(offset);
+
+    if constexpr (kIsFirst<Literal>) {
+      if (!old.empty() && Read<Literal>(old) == value) {
+        return;
+      }
+
+      int64_t revision =
+          old.empty() ? 0 : std::abs(isfr::ParseView(old).first.revision);
+      uint8_t time[ll::kMaxZipLen];
+      size_t time_size = ll::ZipTo(time, revision + 1, source_);
+      uint8_t scratch[ll::kMaxZipLen];
+      ll::Span bytes = EncodeFirst<Literal>(value, scratch);
+
+      size_t size = tlv::HeaderSize('T', time_size, true) + time_size +
+                    bytes.size();
+      WriteHeader(offset, Literal, size);
+      writer_->WriteRecord('T', {time, time_size}, true);
+      writer_->WriteRaw(bytes);
+    } else if constexpr (Literal == 'N') {
+      Write(offset, Literal, nz::Ndelta(old, value, source_));
+    } else if constexpr (Literal == 'Z') {
+      Write(offset, Literal, nz::Zdelta(old, value, source_));
+    } else {
+      static_assert(!std::is_same_v<typename Native<Literal>::Type,
+                                    ll::Span>,
+                    "E, M, L and V fields take ops through Merge");
+    }
+  }
+
+  // A ready op of an E, M, L or V field
+  void Merge(uint16_t offset, char literal, ll::Span op) {
+    Write(offset, literal, op);
+  }
+
+ private:
+  void Write(uint16_t offset, char literal, ll::Span value) {
+    if (!value.empty()) {
+      WriteField(*writer_, offset, literal, value);
+      ++count_;
+    }
+  }
+
+  void WriteHeader(uint16_t offset, char literal, size_t value_size) {
+    uint8_t zipped[ll::kMaxZipLen];
+    size_t size = ll::ZipTo(zipped, uint64_t(offset));
+    size_t inner = tlv::HeaderSize('T', size, true) + size + value_size;
+    writer_->WriteHeader(literal, inner);
+    writer_->WriteRecord('T', {zipped, size}, true);
+    ++count_;
+  }
+
+ private:
+  const Object<N>* old_;
+  uint64_t source_;
+  tlv::BufferWriter* writer_;
+  size_t count_ = 0;
+};
+
+}  // namespace gen
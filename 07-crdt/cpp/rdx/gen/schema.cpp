@@ -0,0 +1,267 @@
+#include <algorithm>
+#include <cctype>
+#include <stdexcept>
+#include <unordered_set>
+
+#include <gen/object.hpp>
+
+#include <gen/schema.hpp>
+
+namespace gen {
+
+namespace {
+
+bool IsLower(char c) {
+  return ('a' <= c && c <= 'z') || ('0' <= c && c <= '9') || c == '_';
+}
+
+bool IsClassName(std::string_view name) {
+  return !name.empty() && 'A' <= name[0] && name[0] <= 'Z' &&
+         std::all_of(name.begin(), name.end(), [](char c) {
+           return std::isalnum(static_cast<unsigned char>(c));
+         });
+}
+
+bool IsFieldName(std::string_view name) {
+  return !name.empty() && 'a' <= name[0] && name[0] <= 'z' &&
+         std::all_of(name.begin(), name.end(), IsLower);
+}
+
+// snake_case to PascalCase
+std::string Pascal(std::string_view name) {
+  std::string pascal;
+  bool upper = true;
+
+  for (char c : name) {
+    if (c == '_') {
+      upper = true;
+    } else {
+      pascal += upper ? char(std::toupper(c)) : c;
+      upper = false;
+    }
+  }
+
+  return pascal;
+}
+
+std::vector<std::string_view> Words(std::string_view line) {
+  std::vector<std::string_view> words;
+  size_t begin = 0;
+
+  while (begin < line.size()) {
+    begin = line.find_first_not_of(" \t\r", begin);
+
+    if (begin == std::string_view::npos) {
+      break;
+    }
+
+    size_t end = std::min(line.find_first_of(" \t\r", begin), line.size());
+    words.push_back(line.substr(begin, end - begin));
+    begin = end;
+  }
+
+  return words;
+}
+
+class Schema {
+ public:
+  std::vector<ClassSpec> Parse(std::string_view text) {
+    size_t begin = 0;
+
+    while (begin < text.size()) {
+      size_t end = std::min(text.find('\n', begin), text.size());
+      ++line_;
+      Line(text.substr(begin, end - begin));
+      begin = end + 1;
+    }
+
+    if (open_) {
+      Fail("Unclosed class " + classes_.back().name);
+    }
+
+    return std::move(classes_);
+  }
+
+ private:
+  void Line(std::string_view line) {
+    line = line.substr(0, line.find('#'));
+    std::vector<std::string_view> words = Words(line);
+
+    if (words.empty()) {
+      return;
+    }
+
+    if (!open_) {
+      if (words.size() != 2 || words[1] != "{" || !IsClassName(words[0])) {
+        Fail("Expected a class: Name {");
+      }
+
+      for (const ClassSpec& spec : classes_) {
+        if (spec.name == words[0]) {
+          Fail("Duplicate class " + spec.name);
+        }
+      }
+
+      classes_.push_back({std::string(words[0]), {}});
+      names_.clear();
+      open_ = true;
+      return;
+    }
+
+    if (words.size() == 1 && words[0] == "}") {
+      if (classes_.back().fields.empty()) {
+        Fail("Empty class " + classes_.back().name);
+      }
+
+      open_ = false;
+      return;
+    }
+
+    if (words.size() != 2 || !IsFieldName(words[0]) ||
+        words[1].size() != 1 || !IsFieldType(words[1][0])) {
+      Fail("Expected a field: name TYPE, of F I R S N Z E M L V");
+    }
+
+    // Two fields may not get the same accessor, nor hide the base ones
+    std::string pascal = Pascal(words[0]);
+
+    if (pascal == "Tlv" || pascal == "Value" || pascal == "Field" ||
+        pascal == "FieldId" || pascal == "Count") {
+      Fail("Reserved field name " + std::string(words[0]));
+    }
+
+    if (!names_.insert(pascal).second) {
+      Fail("Duplicate field " + std::string(words[0]));
+    }
+
+    if (classes_.back().fields.size() == kMaxFields) {
+      Fail("Too many fields");
+    }
+
+    classes_.back().fields.push_back({std::string(words[0]), words[1][0]});
+  }
+
+  [[noreturn]] void Fail(const std::string& message) const {
+    throw std::runtime_error("Schema line " + std::to_string(line_) + ": " +
+                             message);
+  }
+
+ private:
+  std::vector<ClassSpec> classes_;
+  std::unordered_set<std::string> names_;
+  bool open_ = false;
+  size_t line_ = 0;
+};
+
+std::string Setter(char literal) {
+  switch (literal) {
+    case 'F':
+    case 'I':
+    case 'R':
+    case 'S':
+    case 'N':
+    case 'Z':
+      return "Set";
+    default:
+      return "Merge";
+  }
+}
+
+void GenerateClass(std::string& out, const ClassSpec& spec) {
+  std::string size = std::to_string(spec.fields.size());
+  std::string delta = spec.name + "Delta";
+
+  out += "class " + spec.name + " : public gen::Object<" + size + "> {\n";
+  out += " public:\n";
+  out += "  enum Field : uint16_t {\n";
+
+  for (size_t i = 0; i < spec.fields.size(); ++i) {
+    out += "    k" + Pascal(spec.fields[i].name) + " = " +
+           std::to_string(i + 1) + ",\n";
+  }
+
+  out += "  };\n\n";
+  out += "  static constexpr std::array<char, " + size + "> kLiterals = {";
+
+  for (size_t i = 0; i < spec.fields.size(); ++i) {
+    out += i == 0 ? "'" : ", '";
+    out += spec.fields[i].literal;
+    out += "'";
+  }
+
+  out += "};\n\n";
+  out += "  explicit " + spec.name + "(ll::Span tlv)\n";
+  out += "      : gen::Object<" + size + ">(tlv, kLiterals) {\n";
+  out += "  }\n\n";
+  out += "  static constexpr cmn::Id FieldId(cmn::Id object, "
+         "Field field) {\n";
+  out += "    object.offset = field;\n";
+  out += "    return object;\n";
+  out += "  }\n";
+
+  for (const FieldSpec& field : spec.fields) {
+    std::string pascal = Pascal(field.name);
+    out += "\n  gen::Native<'";
+    out += field.literal;
+    out += "'>::Type " + pascal + "() const {\n";
+    out += "    return gen::Read<'";
+    out += field.literal;
+    out += "'>(Value(k" + pascal + "));\n";
+    out += "  }\n";
+  }
+
+  out += "};\n\n";
+
+  out += "class " + delta + " : public gen::Delta<" + size + "> {\n";
+  out += " public:\n";
+  out += "  using gen::Delta<" + size + ">::Delta;\n";
+
+  for (const FieldSpec& field : spec.fields) {
+    std::string pascal = Pascal(field.name);
+    std::string literal = std::string("'") + field.literal + "'";
+    std::string setter = Setter(field.literal);
+    out += "\n  " + delta + "& " + setter + pascal + "(";
+
+    if (setter == "Set") {
+      out += "gen::Native<" + literal + ">::Type value) {\n";
+      out += "    Set<" + literal + ">(" + spec.name + "::k" + pascal +
+             ", value);\n";
+    } else {
+      out += "ll::Span op) {\n";
+      out += "    Merge(" + spec.name + "::k" + pascal + ", " + literal +
+             ", op);\n";
+    }
+
+    out += "    return *this;\n";
+    out += "  }\n";
+  }
+
+  out += "};\n";
+}
+
+}  // namespace
+
+std::vector<ClassSpec> ParseSchema(std::string_view text) {
+  return Schema().Parse(text);
+}
+
+std::string Generate(const std::vector<ClassSpec>& classes,
+                     std::string_view name_space) {
+  std::string out;
+  out += "// Generated by rdxgen, do not edit\n\n";
+  out += "#pragma once\n\n";
+  out += "#include <array>\n";
+  out += "#include <cstdint>\n\n";
+  out += "#include <gen/object.hpp>\n\n";
+  out += "namespace " + std::string(name_space) + " {\n";
+
+  for (const ClassSpec& spec : classes) {
+    out += "\n";
+    GenerateClass(out, spec);
+  }
+
+  out += "\n}  // namespace " + std::string(name_space) + "\n";
+  return out;
+}
+
+}  // namespace gen
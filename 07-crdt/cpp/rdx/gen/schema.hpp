@@ -0,0 +1,39 @@
+#pragma once
+
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace gen {
+
+struct FieldSpec {
+  std::string name;
+  char literal = 0;
+};
+
+// Fields in offset order, the first one at offset 1
+struct ClassSpec {
+  std::string name;
+  std::vector<FieldSpec> fields;
+};
+
+// Classes in the rdxgen schema language:
+//
+//   # a comment
+//   Person {
+//     name S
+//     age I
+//     tags E
+//   }
+//
+// Class names are CamelCase, field names snake_case, types are the
+// field type letters. Throws std::runtime_error with the line number.
+std::vector<ClassSpec> ParseSchema(std::string_view text);
+
+// A header with a gen::Object view and a gen::Delta builder per class.
+// Accessors are the PascalCase field names, setters Set<Name> for
+// FIRST and counter fields, Merge<Name> taking ops for the rest.
+std::string Generate(const std::vector<ClassSpec>& classes,
+                     std::string_view name_space);
+
+}  // namespace gen
@@ -0,0 +1,137 @@
+#include <algorithm>
+#include <bit>
+#include <stdexcept>
+
+#include <lsm/field_cache.hpp>
+
+namespace lsm {
+
+namespace {
+
+uint64_t Packed(cmn::Id field) {
+  return uint64_t(field.source) << 44 | uint64_t(field.sequence) << 12 |
+         field.offset;
+}
+
+struct Key {
+  uint64_t field;
+  char literal;
+
+  bool operator==(const Key& rhs) const = default;
+};
+
+struct KeyHash {
+  size_t operator()(const Key& key) const {
+    return std::hash<uint64_t>()(key.field * 0x9e3779b97f4a7c15 ^
+                                 uint8_t(key.literal));
+  }
+};
+
+}  // namespace
+
+// Most recently used first
+struct FieldCache::Shard {
+  using Order = std::list<std::pair<Key, Native>>;
+
+  std::mutex mutex;
+  Order order;
+  std::unordered_map<Key, Order::iterator, KeyHash> entries;
+  CacheStats stats;
+};
+
+FieldCache::FieldCache(size_t capacity, size_t shards)
+    : shard_count_(std::bit_ceil(std::max<size_t>(shards, 1))) {
+  if (capacity == 0) {
+    throw std::runtime_error("Empty field cache");
+  }
+
+  shards_ = std::make_unique<Shard[]>(shard_count_);
+  shard_capacity_ = std::max<size_t>(1, capacity / shard_count_);
+}
+
+FieldCache::~FieldCache() = default;
+
+std::optional<Native> FieldCache::Get(cmn::Id field, char literal) {
+  Shard& shard = ShardOf(field);
+  std::lock_guard lock(shard.mutex);
+  auto it = shard.entries.find(Key{Packed(field), literal});
+
+  if (it == shard.entries.end()) {
+    ++shard.stats.misses;
+    return std::nullopt;
+  }
+
+  ++shard.stats.hits;
+  shard.order.splice(shard.order.begin(), shard.order, it->second);
+  return it->second->second;
+}
+
+void FieldCache::Put(cmn::Id field, char literal, Native value) {
+  Shard& shard = ShardOf(field);
+  std::lock_guard lock(shard.mutex);
+  Key key{Packed(field), literal};
+  auto it = shard.entries.find(key);
+
+  if (it != shard.entries.end()) {
+    it->second->second = std::move(value);
+    shard.order.splice(shard.order.begin(), shard.order, it->second);
+    return;
+  }
+
+  if (shard.entries.size() == shard_capacity_) {
+    shard.entries.erase(shard.order.back().first);
+    shard.order.pop_back();
+    ++shard.stats.evictions;
+  }
+
+  shard.order.emplace_front(key, std::move(value));
+  shard.entries.emplace(key, shard.order.begin());
+}
+
+void FieldCache::Invalidate(cmn::Id field, char literal) {
+  Shard& shard = ShardOf(field);
+  std::lock_guard lock(shard.mutex);
+  auto it = shard.entries.find(Key{Packed(field), literal});
+
+  if (it == shard.entries.end()) {
+    return;
+  }
+
+  shard.order.erase(it->second);
+  shard.entries.erase(it);
+  ++shard.stats.invalidations;
+}
+
+size_t FieldCache::Size() const {
+  size_t size = 0;
+
+  for (size_t i = 0; i < shard_count_; ++i) {
+    std::lock_guard lock(shards_[i].mutex);
+    size += shards_[i].entries.size();
+  }
+
+  return size;
+}
+
+CacheStats FieldCache::Stats() const {
+  CacheStats stats;
+
+  for (size_t i = 0; i < shard_count_; ++i) {
+    std::lock_guard lock(shards_[i].mutex);
+    stats.hits += shards_[i].stats.hits;
+    stats.misses += shards_[i].stats.misses;
+    stats.evictions += shards_[i].stats.evictions;
+    stats.invalidations += shards_[i].stats.invalidations;
+  }
+
+  return stats;
+}
+
+// Fibonacci hashing: fields of one object differ in the low bits only.
+// Every type of a field goes to the same shard
+auto FieldCache::ShardOf(cmn::Id field) const -> Shard& {
+  uint64_t hash = Packed(field) * 0x9e3779b97f4a7c15;
+  return shards_[(hash >> 32) & (shard_count_ - 1)];
+}
+
+}  // namespace lsm
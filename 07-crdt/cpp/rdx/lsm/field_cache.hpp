@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstdint>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <variant>
+
+#include <cmn/id.hpp>
+
+namespace lsm {
+
+// The native value of an I, Z or N field, an F, an S or an R one
+using Native = std::variant<int64_t, double, std::string, cmn::Id>;
+
+struct CacheStats {
+  size_t hits = 0;
+  size_t misses = 0;
+  size_t evictions = 0;
+  size_t invalidations = 0;
+
+  double HitRate() const {
+    size_t reads = hits + misses;
+    return reads == 0 ? 0 : double(hits) / reads;
+  }
+};
+
+// Materialized field values, so a hot read skips the merge and the
+// decoding. A field keeps a value per type, as the store does, since
+// an I and an N read of one field both decode to int64_t. Split into
+// shards by field id, each with its own lock and its own LRU order, so
+// readers of different fields rarely contend.
+class FieldCache {
+ public:
+  explicit FieldCache(size_t capacity, size_t shards = 16);
+  ~FieldCache();
+
+  FieldCache(const FieldCache&) = delete;
+  FieldCache& operator=(const FieldCache&) = delete;
+
+  std::optional<Native> Get(cmn::Id field, char literal);
+  void Put(cmn::Id field, char literal, Native value);
+  // To be called on every op applied to the field of that type
+  void Invalidate(cmn::Id field, char literal);
+
+  size_t Size() const;
+  // Summed over the shards
+  CacheStats Stats() const;
+
+ private:
+  struct Shard;
+
+  Shard& ShardOf(cmn::Id field) const;
+
+ private:
+  std::unique_ptr<Shard[]> shards_;
+  size_t shard_count_;
+  size_t shard_capacity_;
+};
+
+}  // namespace lsm
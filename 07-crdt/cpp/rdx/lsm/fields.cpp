@@ -0,0 +1,74 @@
+#include <stdexcept>
+#include <string_view>
+
+#include <nz/integer.hpp>
+#include <nz/natural.hpp>
+#include <typed/register.hpp>
+
+#include <lsm/fields.hpp>
+#include <lsm/merge_operator.hpp>
+
+namespace lsm {
+
+namespace {
+
+bool HasNative(char literal) {
+  return std::string_view("IFSRNZ").find(literal) != std::string_view::npos;
+}
+
+}  // namespace
+
+Fields::Fields(Store& store, FieldCache& cache)
+    : store_(&store), cache_(&cache) {
+}
+
+void Fields::Merge(cmn::Id field, char literal, ll::Span op) {
+  store_->Merge(FieldKey(field, literal), op);
+  cache_->Invalidate(field, literal);
+}
+
+void Fields::Put(cmn::Id field, char literal, ll::Span value) {
+  store_->Put(FieldKey(field, literal), value);
+  cache_->Invalidate(field, literal);
+}
+
+std::optional<Native> Fields::Read(cmn::Id field, char literal) {
+  if (!HasNative(literal)) {
+    throw std::runtime_error("No native value for the type");
+  }
+
+  if (std::optional<Native> cached = cache_->Get(field, literal)) {
+    return cached;
+  }
+
+  std::optional<ll::Buffer> value = store_->Get(FieldKey(field, literal));
+
+  if (!value.has_value()) {
+    return std::nullopt;
+  }
+
+  Native native = Decode(literal, *value);
+  cache_->Put(field, literal, native);
+  return native;
+}
+
+Native Decode(char literal, ll::Span value) {
+  switch (literal) {
+    case 'I':
+      return typed::IRegister::Parse(value).Value();
+    case 'F':
+      return typed::FRegister::Parse(value).Value();
+    case 'S':
+      return typed::SRegister::Parse(value).Value();
+    case 'R':
+      return typed::RRegister::Parse(value).Value();
+    case 'N':
+      return int64_t(nz::Nnative(value));
+    case 'Z':
+      return nz::Znative(value);
+  }
+
+  throw std::runtime_error("No native value for the type");
+}
+
+}  // namespace lsm
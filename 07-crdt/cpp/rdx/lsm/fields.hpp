@@ -0,0 +1,36 @@
+#pragma once
+
+#include <optional>
+
+#include <ll/bytes.hpp>
+#include <cmn/id.hpp>
+
+#include <lsm/field_cache.hpp>
+#include <lsm/store.hpp>
+
+namespace lsm {
+
+// Native field reads over a Store, with the materialized values kept
+// in a FieldCache. Ops go through here to reach the store, so every op
+// drops the cached value of its field and type; the next read merges
+// and decodes once more.
+class Fields {
+ public:
+  Fields(Store& store, FieldCache& cache);
+
+  void Merge(cmn::Id field, char literal, ll::Span op);
+  void Put(cmn::Id field, char literal, ll::Span value);
+
+  // I, Z and N fields read as int64_t, F as double, S as std::string,
+  // R as cmn::Id; throws on other types
+  std::optional<Native> Read(cmn::Id field, char literal);
+
+ private:
+  Store* store_;
+  FieldCache* cache_;
+};
+
+// The native value of a merged field value
+Native Decode(char literal, ll::Span value);
+
+}  // namespace lsm
@@ -0,0 +1,148 @@
+#include <stdexcept>
+#include <vector>
+
+#include <isfr/types.hpp>
+#include <mel/array.hpp>
+#include <mel/map.hpp>
+#include <mel/set.hpp>
+#include <nz/integer.hpp>
+#include <nz/natural.hpp>
+#include <vv/vv.hpp>
+
+#include <lsm/merge_operator.hpp>
+
+namespace lsm {
+
+namespace {
+
+using ArenaMerge = ll::Span (*)(std::span<const ll::Span>, ll::Arena&);
+using BufferMerge = ll::Buffer (*)(const std::vector<ll::Span>&);
+
+// Exactly one of the two is set for a mergeable letter
+struct Merge {
+  ArenaMerge arena = nullptr;
+  BufferMerge buffer = nullptr;
+};
+
+ll::Span Tmerge(std::span<const ll::Span> tlvs, ll::Arena& arena) {
+  return isfr::Imerge(tlvs, arena);
+}
+
+struct MergeTable {
+  Merge merges[128];
+
+  MergeTable() {
+    merges['F'].arena = isfr::Fmerge;
+    merges['I'].arena = isfr::Imerge;
+    merges['R'].arena = isfr::Rmerge;
+    merges['S'].arena = isfr::Smerge;
+    merges['T'].arena = Tmerge;
+    merges['E'].arena = mel::Emerge;
+    merges['M'].arena = mel::Mmerge;
+    merges['L'].buffer = mel::Lmerge;
+    merges['N'].buffer = nz::Nmerge;
+    merges['Z'].buffer = nz::Zmerge;
+    merges['V'].buffer = vv::Vmerge;
+  }
+};
+
+const Merge& MergeOf(char literal) {
+  static const MergeTable table;
+  static const Merge none;
+  auto index = static_cast<unsigned char>(literal);
+  return index < 128 ? table.merges[index] : none;
+}
+
+bool Run(char literal, std::span<const ll::Span> inputs, ll::Arena& arena,
+         ll::Buffer& result) {
+  const Merge& merge = MergeOf(literal);
+
+  try {
+    if (merge.arena != nullptr) {
+      ll::Span merged = merge.arena(inputs, arena);
+      result.assign(merged.begin(), merged.end());
+    } else if (merge.buffer != nullptr) {
+      result = merge.buffer({inputs.begin(), inputs.end()});
+    } else {
+      return false;
+    }
+  } catch (const std::runtime_error&) {
+    arena.Reset();
+    return false;
+  }
+
+  arena.Reset();
+  return true;
+}
+
+bool FullMergeIn(char literal, const ll::Span* existing,
+                 std::span<const ll::Span> operands, ll::Arena& arena,
+                 ll::Buffer& result) {
+  if (existing == nullptr) {
+    return Run(literal, operands, arena, result);
+  }
+
+  std::vector<ll::Span> inputs;
+  inputs.reserve(operands.size() + 1);
+  inputs.push_back(*existing);
+  inputs.insert(inputs.end(), operands.begin(), operands.end());
+
+  return Run(literal, inputs, arena, result);
+}
+
+}  // namespace
+
+bool IsMergeable(char literal) {
+  const Merge& merge = MergeOf(literal);
+  return merge.arena != nullptr || merge.buffer != nullptr;
+}
+
+bool FullMerge(char literal, const ll::Span* existing,
+               std::span<const ll::Span> operands, ll::Buffer& result) {
+  ll::Arena arena;
+  return FullMergeIn(literal, existing, operands, arena, result);
+}
+
+bool PartialMerge(char literal, std::span<const ll::Span> operands,
+                  ll::Buffer& result) {
+  ll::Arena arena;
+  return Run(literal, operands, arena, result);
+}
+
+// Big-endian source, sequence, offset: keys of one replica's objects
+// sort together and in creation order
+std::string FieldKey(cmn::Id field, char literal) {
+  uint64_t packed = uint64_t(field.source) << 44 |
+                    uint64_t(field.sequence) << 12 | field.offset;
+
+  std::string key(sizeof(packed) + 1, '\0');
+
+  for (size_t i = 0; i < sizeof(packed); ++i) {
+    key[i] = char(packed >> (8 * (sizeof(packed) - 1 - i)));
+  }
+
+  key.back() = literal;
+  return key;
+}
+
+char LiteralOf(std::string_view key) {
+  if (key.empty()) {
+    throw std::runtime_error("Empty field key");
+  }
+
+  return key.back();
+}
+
+bool MergeOperator::FullMerge(std::string_view key, const ll::Span* existing,
+                              std::span<const ll::Span> operands,
+                              ll::Buffer& result) {
+  return FullMergeIn(LiteralOf(key), existing, operands, arena_, result);
+}
+
+bool MergeOperator::PartialMerge(std::string_view key,
+                                 std::span<const ll::Span> operands,
+                                 ll::Buffer& result) {
+  return Run(LiteralOf(key), operands, arena_, result);
+}
+
+}  // namespace lsm
@@ -0,0 +1,50 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <string_view>
+
+#include <ll/arena.hpp>
+#include <ll/bytes.hpp>
+#include <cmn/id.hpp>
+
+namespace lsm {
+
+// RDX merges as LSM merge operators. Every op is a state of its type,
+// so merging ops with ops (partial) and ops into the stored value
+// (full) are the same Xmerge, and compaction may collapse op chains
+// in any grouping. Values and operands are bare record bodies.
+
+// Whether the type letter has a merge: F, I, R, S, T, E, M, L, N, Z, V
+bool IsMergeable(char literal);
+
+// The stored value, if any, with the operands; false on a corrupt
+// input, the result is left untouched then
+bool FullMerge(char literal, const ll::Span* existing,
+               std::span<const ll::Span> operands, ll::Buffer& result);
+
+// Operands only. False means the operands are kept as they are for a
+// later full merge, e.g. L patches attached to elements none of them
+// has
+bool PartialMerge(char literal, std::span<const ll::Span> operands,
+                  ll::Buffer& result);
+
+// One field is one key: the object field id, then its type letter, so
+// the merge is picked from the key without reading the value
+std::string FieldKey(cmn::Id field, char literal);
+char LiteralOf(std::string_view key);
+
+// The key-based form an embedded LSM calls. Keeps one arena for the
+// merge temporaries, so it is per thread as the arena is.
+class MergeOperator {
+ public:
+  bool FullMerge(std::string_view key, const ll::Span* existing,
+                 std::span<const ll::Span> operands, ll::Buffer& result);
+  bool PartialMerge(std::string_view key, std::span<const ll::Span> operands,
+                    ll::Buffer& result);
+
+ private:
+  ll::Arena arena_;
+};
+
+}  // namespace lsm
@@ -0,0 +1,237 @@
+#include <algorithm>
+#include <stdexcept>
+
+#include <lsm/store.hpp>
+
+namespace lsm {
+
+namespace {
+
+std::vector<ll::Span> Spans(const std::vector<ll::Buffer>& buffers) {
+  return {buffers.begin(), buffers.end()};
+}
+
+}  // namespace
+
+Store::Store(StoreOptions options)
+    : options_(options) {
+}
+
+void Store::Put(std::string_view key, ll::Span value) {
+  auto [it, inserted] = memtable_.try_emplace(std::string(key));
+  Entry& entry = it->second;
+  size_t before = inserted ? 0 : EntryBytes(entry);
+
+  entry.base.emplace(value.begin(), value.end());
+  entry.operands.clear();
+
+  Account(key, inserted, before, entry);
+  ++stats_.puts;
+  MaybeFlush();
+}
+
+void Store::Merge(std::string_view key, ll::Span operand) {
+  auto [it, inserted] = memtable_.try_emplace(std::string(key));
+  Entry& entry = it->second;
+  size_t before = inserted ? 0 : EntryBytes(entry);
+
+  entry.operands.emplace_back(operand.begin(), operand.end());
+
+  if (entry.operands.size() >= options_.max_operands) {
+    Collapse(key, entry, false);
+  }
+
+  Account(key, inserted, before, entry);
+  ++stats_.merges;
+  MaybeFlush();
+}
+
+std::optional<ll::Buffer> Store::Get(std::string_view key) {
+  // Newest first, down to the first base value
+  std::vector<const Entry*> found;
+
+  auto visit = [&found](const Entry& entry) {
+    found.push_back(&entry);
+    return entry.base.has_value();
+  };
+
+  auto in_memtable = memtable_.find(key);
+  bool based = in_memtable != memtable_.end() && visit(in_memtable->second);
+
+  for (auto run = runs_.rbegin(); !based && run != runs_.rend(); ++run) {
+    auto it = std::lower_bound(
+        run->begin(), run->end(), key,
+        [](const auto& item, std::string_view key) {
+          return item.first < key;
+        });
+
+    if (it != run->end() && it->first == key) {
+      based = visit(it->second);
+    }
+  }
+
+  if (found.empty()) {
+    return std::nullopt;
+  }
+
+  std::vector<ll::Span> operands;
+
+  for (auto entry = found.rbegin(); entry != found.rend(); ++entry) {
+    operands.insert(operands.end(), (*entry)->operands.begin(),
+                    (*entry)->operands.end());
+  }
+
+  const std::optional<ll::Buffer>& base = found.back()->base;
+
+  if (operands.empty() && base.has_value()) {
+    return *base;
+  }
+
+  ll::Span base_span;
+
+  if (base.has_value()) {
+    base_span = *base;
+  }
+
+  ll::Buffer result;
+  ++stats_.full_merges;
+
+  if (!merge_.FullMerge(key, base.has_value() ? &base_span : nullptr,
+                        operands, result)) {
+    throw std::runtime_error("Corrupt merge operands");
+  }
+
+  return result;
+}
+
+void Store::Flush() {
+  if (memtable_.empty()) {
+    return;
+  }
+
+  Run run;
+  run.reserve(memtable_.size());
+
+  for (auto& [key, entry] : memtable_) {
+    Collapse(key, entry, false);
+    run.emplace_back(key, std::move(entry));
+  }
+
+  runs_.push_back(std::move(run));
+  memtable_.clear();
+  memtable_bytes_ = 0;
+  ++stats_.flushes;
+
+  if (runs_.size() > options_.max_runs) {
+    Compact();
+  }
+}
+
+void Store::Compact() {
+  if (runs_.empty()) {
+    return;
+  }
+
+  std::map<std::string, Entry, std::less<>> merged;
+
+  for (Run& run : runs_) {
+    for (auto& [key, entry] : run) {
+      Stack(merged[key], std::move(entry));
+    }
+  }
+
+  Run compacted;
+  compacted.reserve(merged.size());
+
+  for (auto& [key, entry] : merged) {
+    Collapse(key, entry, true);
+    compacted.emplace_back(key, std::move(entry));
+  }
+
+  runs_.clear();
+  runs_.push_back(std::move(compacted));
+  ++stats_.compactions;
+}
+
+size_t Store::RunCount() const {
+  return runs_.size();
+}
+
+const StoreStats& Store::Stats() const {
+  return stats_;
+}
+
+void Store::Stack(Entry& older, Entry&& newer) {
+  if (newer.base.has_value()) {
+    older = std::move(newer);
+    return;
+  }
+
+  for (ll::Buffer& operand : newer.operands) {
+    older.operands.push_back(std::move(operand));
+  }
+}
+
+// A base with operands turns into a plain value, so does a bare op
+// chain at the bottom level; above it, op chains merge into one op.
+// A merge that fails keeps the entry as it is for Get() to report.
+void Store::Collapse(std::string_view key, Entry& entry, bool bottom) {
+  if (entry.operands.empty() ||
+      (!entry.base.has_value() && !bottom && entry.operands.size() < 2)) {
+    return;
+  }
+
+  std::vector<ll::Span> operands = Spans(entry.operands);
+  ll::Buffer result;
+
+  if (entry.base.has_value() || bottom) {
+    ll::Span base;
+
+    if (entry.base.has_value()) {
+      base = *entry.base;
+    }
+
+    ++stats_.full_merges;
+
+    if (merge_.FullMerge(key, entry.base.has_value() ? &base : nullptr,
+                         operands, result)) {
+      entry.base = std::move(result);
+      entry.operands.clear();
+    }
+
+    return;
+  }
+
+  ++stats_.partial_merges;
+
+  if (merge_.PartialMerge(key, operands, result)) {
+    entry.operands.clear();
+    entry.operands.push_back(std::move(result));
+  }
+}
+
+size_t Store::EntryBytes(const Entry& entry) {
+  size_t bytes = entry.base.has_value() ? entry.base->size() : 0;
+
+  for (const ll::Buffer& operand : entry.operands) {
+    bytes += operand.size();
+  }
+
+  return bytes;
+}
+
+// The entry as it is now replaces the before bytes it held, so a
+// replaced value or collapsed operands stop counting
+void Store::Account(std::string_view key, bool inserted, size_t before,
+                    const Entry& entry) {
+  memtable_bytes_ -= before;
+  memtable_bytes_ += EntryBytes(entry) + (inserted ? key.size() : 0);
+}
+
+void Store::MaybeFlush() {
+  if (memtable_bytes_ >= options_.memtable_bytes) {
+    Flush();
+  }
+}
+
+}  // namespace lsm
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <functional>
+#include <map>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include <ll/bytes.hpp>
+
+#include <lsm/merge_operator.hpp>
+
+namespace lsm {
+
+struct StoreOptions {
+  // Memtable bytes (keys, values and operands) that trigger a flush
+  size_t memtable_bytes = 4 << 20;
+  // Operands of one key in the memtable that get partially merged
+  size_t max_operands = 16;
+  // Sorted runs that trigger a full compaction
+  size_t max_runs = 4;
+};
+
+struct StoreStats {
+  size_t puts = 0;
+  size_t merges = 0;
+  size_t flushes = 0;
+  size_t compactions = 0;
+  size_t partial_merges = 0;
+  size_t full_merges = 0;
+};
+
+// A small in-memory stand-in for an embedded LSM with merge operators:
+// a memtable, sorted immutable runs and a full compaction, with the
+// same contract as leveldb/RocksDB. Merge() is a blind write, op chains
+// get collapsed on flush and compaction and resolved on Get().
+class Store {
+ public:
+  explicit Store(StoreOptions options = {});
+
+  // Replaces whatever the key had
+  void Put(std::string_view key, ll::Span value);
+  // Merges the operand in, never reads
+  void Merge(std::string_view key, ll::Span operand);
+  std::optional<ll::Buffer> Get(std::string_view key);
+
+  void Flush();
+  // Merges all runs into one, every key becomes a plain value
+  void Compact();
+
+  size_t RunCount() const;
+  const StoreStats& Stats() const;
+
+ private:
+  // A base value, if any, with the operands merged on top of it
+  struct Entry {
+    std::optional<ll::Buffer> base;
+    std::vector<ll::Buffer> operands;
+  };
+
+  using Run = std::vector<std::pair<std::string, Entry>>;
+
+  // Folds a newer entry of the same key into an older one
+  static void Stack(Entry& older, Entry&& newer);
+
+  // Base and operand bytes, the key aside
+  static size_t EntryBytes(const Entry& entry);
+
+  void Collapse(std::string_view key, Entry& entry, bool bottom);
+  void Account(std::string_view key, bool inserted, size_t before,
+               const Entry& entry);
+  void MaybeFlush();
+
+ private:
+  StoreOptions options_;
+  StoreStats stats_;
+  MergeOperator merge_;
+
+  std::map<std::string, Entry, std::less<>> memtable_;
+  // Keys and what their entries hold now, not every operand ever added
+  size_t memtable_bytes_ = 0;
+
+  // Oldest first
+  std::vector<Run> runs_;
+};
+
+}  // namespace lsm
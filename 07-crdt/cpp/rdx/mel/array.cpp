@@ -0,0 +1,166 @@
+#include <stdexcept>
+
+#include <tlv/io.hpp>
+
+#include <mel/array.hpp>
+
+namespace mel {
+
+namespace {
+
+bool IsPatch(ll::Span tlv) {
+  tlv::ViewReader reader(tlv);
+  return reader.HasSome() && IsAttachment(reader.ReadNext());
+}
+
+}  // namespace
+
+bool Lvalid(ll::Span tlv) {
+  try {
+    tlv::ViewReader reader(tlv);
+
+    while (reader.HasSome()) {
+      tlv::RecordView record = reader.ReadNext();
+
+      if (!IsAttachment(record)) {
+        ParseElement(record);
+      }
+    }
+  } catch (const std::runtime_error&) {
+    return false;
+  }
+
+  return true;
+}
+
+std::string Lstring(ll::Span tlv) {
+  std::string text = "[";
+  bool first = true;
+
+  for (const Element& element : Lnative(tlv)) {
+    if (!first) {
+      text.push_back(',');
+    }
+
+    AppendElement(text, element);
+    first = false;
+  }
+
+  text.push_back(']');
+
+  return text;
+}
+
+// A deletion hides the closest preceding regular op, so one pass
+// with a single element of lookbehind does
+Elements Lnative(ll::Span tlv) {
+  Elements elements;
+  tlv::ViewReader reader(tlv);
+  bool hidden = true;
+
+  while (reader.HasSome()) {
+    tlv::RecordView record = reader.ReadNext();
+
+    if (IsAttachment(record)) {
+      continue;
+    }
+
+    Element element = ParseElement(record);
+
+    if (!element.IsTombstone()) {
+      elements.push_back(element);
+      hidden = false;
+    } else if (!hidden) {
+      elements.pop_back();
+      hidden = true;
+    }
+  }
+
+  return elements;
+}
+
+// Zero metadata means a chain: i-th element is {i+1, 0}, attached to
+// the previous one
+ll::Buffer Ltlv(const Elements& elements) {
+  tlv::BufferWriter writer;
+
+  for (size_t i = 0; i < elements.size(); ++i) {
+    if (elements[i].literal == 'R') {
+      throw std::runtime_error("L elements can not be R");
+    }
+
+    Element element = elements[i];
+    element.time = {int64_t(i + 1), 0};
+    element.record = {};
+    WriteElement(writer, element);
+  }
+
+  return writer.Extract();
+}
+
+ll::Buffer Lmerge(const std::vector<ll::Span>& tlvs) {
+  Weave weave;
+  std::vector<ll::Span> patches;
+
+  for (ll::Span tlv : tlvs) {
+    if (IsPatch(tlv)) {
+      patches.push_back(tlv);
+    } else {
+      weave.ApplyView(tlv);
+    }
+  }
+
+  // Patches may attach to each other, any order they apply in works
+  while (!patches.empty()) {
+    size_t applied = std::erase_if(patches, [&weave](ll::Span patch) {
+      if (!weave.Attachable(patch)) {
+        return false;
+      }
+
+      weave.ApplyView(patch);
+      return true;
+    });
+
+    if (applied == 0) {
+      throw std::runtime_error("L attachment point is missing");
+    }
+  }
+
+  return weave.Tlv();
+}
+
+// Keeps the common prefix and suffix, replaces the middle
+ll::Buffer Ldelta(ll::Span tlv, const Elements& new_elements) {
+  Weave weave;
+  weave.ApplyView(tlv);
+
+  size_t old_size = weave.Size();
+  size_t prefix = 0;
+  size_t suffix = 0;
+
+  while (prefix < old_size && prefix < new_elements.size() &&
+         Compare(weave.At(prefix), new_elements[prefix]) == 0) {
+    ++prefix;
+  }
+
+  while (suffix < old_size - prefix &&
+         suffix < new_elements.size() - prefix &&
+         Compare(weave.At(old_size - 1 - suffix),
+                 new_elements[new_elements.size() - 1 - suffix]) == 0) {
+    ++suffix;
+  }
+
+  tlv::BufferWriter writer;
+
+  for (size_t i = prefix; i < old_size - suffix; ++i) {
+    writer.WriteRaw(weave.Remove(prefix, 0));
+  }
+
+  for (size_t i = prefix; i < new_elements.size() - suffix; ++i) {
+    writer.WriteRaw(weave.Insert(i, new_elements[i], 0));
+  }
+
+  return writer.Extract();
+}
+
+}  // namespace mel
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <ll/bytes.hpp>
+#include <mel/element.hpp>
+#include <mel/weave.hpp>
+
+namespace mel {
+
+// L, an array of FIRST elements kept as a causal tree weave. Patches
+// are subtrees prepended with attachment points, see Weave.
+bool Lvalid(ll::Span tlv);
+std::string Lstring(ll::Span tlv);
+Elements Lnative(ll::Span tlv);
+ll::Buffer Ltlv(const Elements& elements);
+ll::Buffer Lmerge(const std::vector<ll::Span>& tlvs);
+ll::Buffer Ldelta(ll::Span tlv, const Elements& new_elements);
+
+}  // namespace mel
@@ -0,0 +1,156 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <stdexcept>
+#include <tuple>
+
+#include <ll/zipint.hpp>
+#include <cmn/id.hpp>
+#include <txt/text.hpp>
+
+#include <mel/element.hpp>
+
+namespace mel {
+
+namespace {
+
+bool IsFirst(char literal) {
+  return literal == 'F' || literal == 'I' || literal == 'R' ||
+         literal == 'S' || literal == 'T';
+}
+
+uint64_t AbsRevision(const Element& element) {
+  return std::abs(element.time.revision);
+}
+
+}  // namespace
+
+Element ParseElement(const tlv::RecordView& record) {
+  if (!IsFirst(record.header.literal)) {
+    throw std::runtime_error("invalid FIRST element");
+  }
+
+  tlv::ViewReader reader(record.body);
+  tlv::RecordView time = reader.ReadNext();
+
+  if (time.header.literal != 'T' && time.header.literal != '0') {
+    throw std::runtime_error("invalid FIRST element");
+  }
+
+  auto [rev, src] = ll::UnzipIU64Pair(time.body);
+
+  Element element;
+  element.literal = record.header.literal;
+  element.time = {rev, src};
+  element.value = reader.Rest();
+  element.record = record.Whole();
+
+  return element;
+}
+
+Element ReadElement(tlv::ViewReader& reader) {
+  return ParseElement(reader.ReadNext());
+}
+
+size_t ElementSize(const Element& element) {
+  if (!element.record.empty()) {
+    return element.record.size();
+  }
+
+  uint8_t time[ll::kMaxZipLen];
+  size_t time_size = ll::ZipTo(time, element.time.revision,
+                               element.time.source);
+  size_t body_size =
+      tlv::HeaderSize('T', time_size, true) + time_size + element.value.size();
+
+  return tlv::HeaderSize(element.literal, body_size) + body_size;
+}
+
+void WriteElement(tlv::BufferWriter& writer, const Element& element) {
+  if (!element.record.empty()) {
+    writer.WriteRaw(element.record);
+    return;
+  }
+
+  uint8_t time[ll::kMaxZipLen];
+  size_t time_size = ll::ZipTo(time, element.time.revision,
+                               element.time.source);
+  size_t body_size =
+      tlv::HeaderSize('T', time_size, true) + time_size + element.value.size();
+
+  writer.WriteHeader(element.literal, body_size);
+  writer.WriteRecord('T', {time, time_size}, true);
+  writer.WriteRaw(element.value);
+}
+
+int Compare(const Element& lhs, const Element& rhs) {
+  if (lhs.literal != rhs.literal) {
+    return lhs.literal < rhs.literal ? -1 : 1;
+  }
+
+  size_t common = std::min(lhs.value.size(), rhs.value.size());
+  int cmp = common == 0 ? 0
+                        : std::memcmp(lhs.value.data(), rhs.value.data(),
+                                      common);
+
+  if (cmp != 0) {
+    return cmp < 0 ? -1 : 1;
+  }
+
+  if (lhs.value.size() != rhs.value.size()) {
+    return lhs.value.size() < rhs.value.size() ? -1 : 1;
+  }
+
+  return 0;
+}
+
+bool Newer(const Element& lhs, const Element& rhs) {
+  return std::make_tuple(AbsRevision(lhs), lhs.time.source,
+                         rhs.time.revision) >
+         std::make_tuple(AbsRevision(rhs), rhs.time.source,
+                         lhs.time.revision);
+}
+
+bool NewerValue(const Element& lhs, const Element& rhs) {
+  if (AbsRevision(lhs) != AbsRevision(rhs)) {
+    return AbsRevision(lhs) > AbsRevision(rhs);
+  }
+
+  int cmp = Compare(lhs, rhs);
+
+  if (cmp != 0) {
+    return cmp > 0;
+  }
+
+  return Newer(lhs, rhs);
+}
+
+void AppendElement(std::string& out, const Element& element) {
+  switch (element.literal) {
+    case 'F':
+      txt::AppendFloat(out, ll::UnzipDouble(element.value));
+      break;
+    case 'I':
+      txt::AppendInt(out, ll::UnzipI64(element.value));
+      break;
+    case 'R':
+      cmn::AppendString(out, cmn::UnzipID(element.value));
+      break;
+    case 'S':
+      txt::AppendQuoted(
+          out, {reinterpret_cast<const char*>(element.value.data()),
+                element.value.size()});
+      break;
+    default:
+      out += "null";
+  }
+}
+
+std::string ElementString(const Element& element) {
+  std::string text;
+  AppendElement(text, element);
+  return text;
+}
+
+}  // namespace mel
@@ -0,0 +1,51 @@
+#pragma once
+
+#include <string>
+#include <vector>
+
+#include <ll/bytes.hpp>
+#include <tlv/record.hpp>
+#include <tlv/io.hpp>
+#include <isfr/types.hpp>
+
+namespace mel {
+
+// An enveloped FIRST op (F, I, R, S or T) as found in E, M and L
+// records. Parsed elements are views into the source buffer.
+struct Element {
+  char literal = 'T';
+  isfr::Time time;
+  ll::Span value;
+
+  // The source record, if any; copied verbatim on output
+  ll::Span record;
+
+  bool IsTombstone() const {
+    return time.revision < 0;
+  }
+};
+
+using Elements = std::vector<Element>;
+
+Element ParseElement(const tlv::RecordView& record);
+Element ReadElement(tlv::ViewReader& reader);
+
+size_t ElementSize(const Element& element);
+void WriteElement(tlv::BufferWriter& writer, const Element& element);
+
+// Value order: by type literal (F, I, R, S, T), then bytewise
+int Compare(const Element& lhs, const Element& rhs);
+
+// LWW order of ops on the same value: higher revision (by modulo)
+// wins, then higher source, then the tombstone
+bool Newer(const Element& lhs, const Element& rhs);
+
+// LWW order of ops on the same slot holding different values, as in
+// isfr merge: revision, then value order, then source
+bool NewerValue(const Element& lhs, const Element& rhs);
+
+std::string ElementString(const Element& element);
+// Appends the ElementString form
+void AppendElement(std::string& out, const Element& element);
+
+}  // namespace mel
@@ -0,0 +1,285 @@
+#include <cstdlib>
+#include <stdexcept>
+
+#include <ll/merge_heap.hpp>
+#include <tlv/io.hpp>
+
+#include <mel/map.hpp>
+
+namespace mel {
+
+namespace {
+
+struct Cursor {
+  tlv::ViewReader reader;
+  Entry head;
+};
+
+Entries ParseAll(ll::Span tlv) {
+  Entries entries;
+  tlv::ViewReader reader(tlv);
+
+  while (reader.HasSome()) {
+    entries.push_back(ReadEntry(reader));
+  }
+
+  return entries;
+}
+
+bool SameTime(const Element& lhs, const Element& rhs) {
+  return lhs.time.revision == rhs.time.revision &&
+         lhs.time.source == rhs.time.source;
+}
+
+// Keys are LWW-merged first; only ops on the very same key version
+// compete by their values
+bool NewerEntry(const Entry& lhs, const Entry& rhs) {
+  if (!SameTime(lhs.key, rhs.key)) {
+    return Newer(lhs.key, rhs.key);
+  }
+
+  if (!lhs.value || !rhs.value) {
+    return lhs.value.has_value();
+  }
+
+  return NewerValue(*lhs.value, *rhs.value);
+}
+
+size_t EntrySize(const Entry& entry) {
+  return ElementSize(entry.key) + (entry.value ? ElementSize(*entry.value) : 0);
+}
+
+void WriteEntry(tlv::BufferWriter& writer, const Entry& entry) {
+  WriteElement(writer, entry.key);
+
+  if (entry.value) {
+    WriteElement(writer, *entry.value);
+  }
+}
+
+Element Retimed(const Element& element, isfr::Time time) {
+  Element retimed = element;
+  retimed.time = time;
+  retimed.record = {};
+  return retimed;
+}
+
+}  // namespace
+
+Entry ReadEntry(tlv::ViewReader& reader) {
+  Entry entry;
+  entry.key = ReadElement(reader);
+
+  if (!entry.key.IsTombstone()) {
+    entry.value = ReadElement(reader);
+  }
+
+  return entry;
+}
+
+bool Mvalid(ll::Span tlv) {
+  try {
+    tlv::ViewReader reader(tlv);
+    Element prev;
+
+    for (bool first = true; reader.HasSome(); first = false) {
+      Entry entry = ReadEntry(reader);
+
+      if (!first && Compare(prev, entry.key) >= 0) {
+        return false;
+      }
+
+      prev = entry.key;
+    }
+  } catch (const std::runtime_error&) {
+    return false;
+  }
+
+  return true;
+}
+
+std::string Mstring(ll::Span tlv) {
+  std::string text = "{";
+  tlv::ViewReader reader(tlv);
+
+  for (bool first = true; reader.HasSome();) {
+    Entry entry = ReadEntry(reader);
+
+    if (!entry.value) {
+      continue;
+    }
+
+    if (!first) {
+      text.push_back(',');
+    }
+
+    AppendElement(text, entry.key);
+    text.push_back(':');
+    AppendElement(text, *entry.value);
+    first = false;
+  }
+
+  text.push_back('}');
+
+  return text;
+}
+
+Entries Mnative(ll::Span tlv) {
+  Entries entries = ParseAll(tlv);
+  std::erase_if(entries, [](const Entry& entry) {
+    return !entry.value;
+  });
+  return entries;
+}
+
+ll::Buffer Mtlv(const Entries& entries) {
+  size_t size = 0;
+
+  for (size_t i = 0; i < entries.size(); ++i) {
+    if (i > 0 && Compare(entries[i - 1].key, entries[i].key) >= 0) {
+      throw std::runtime_error("M keys are not in the value order");
+    }
+
+    size += EntrySize(entries[i]);
+  }
+
+  tlv::BufferWriter writer;
+  writer.Reserve(size);
+
+  for (const Entry& entry : entries) {
+    WriteEntry(writer, entry);
+  }
+
+  return writer.Extract();
+}
+
+namespace {
+
+// Winners are parsed, so they are copied verbatim by either writer
+template <class Writer>
+void MergeInto(std::span<const ll::Span> tlvs, Writer& writer,
+               std::pmr::memory_resource* memory) {
+  std::pmr::vector<Cursor> cursors(memory);
+  cursors.reserve(tlvs.size());
+
+  size_t total = 0;
+
+  for (ll::Span tlv : tlvs) {
+    if (tlv.empty()) {
+      continue;
+    }
+
+    total += tlv.size();
+
+    tlv::ViewReader reader(tlv);
+    Entry head = ReadEntry(reader);
+    cursors.push_back({reader, head});
+  }
+
+  ll::MergeHeap heap([&cursors](size_t lhs, size_t rhs) {
+    return Compare(cursors[lhs].head.key, cursors[rhs].head.key) < 0;
+  }, memory);
+  heap.Reserve(cursors.size());
+
+  for (size_t i = 0; i < cursors.size(); ++i) {
+    heap.Push(i);
+  }
+
+  auto advance = [&]() {
+    Cursor& cursor = cursors[heap.Top()];
+
+    if (cursor.reader.HasSome()) {
+      cursor.head = ReadEntry(cursor.reader);
+      heap.Update();
+    } else {
+      heap.Pop();
+    }
+  };
+
+  // The output never exceeds the inputs combined
+  writer.Reserve(total);
+
+  while (!heap.IsEmpty()) {
+    Entry winner = cursors[heap.Top()].head;
+    advance();
+
+    while (!heap.IsEmpty() &&
+           Compare(cursors[heap.Top()].head.key, winner.key) == 0) {
+      const Entry& entry = cursors[heap.Top()].head;
+
+      if (NewerEntry(entry, winner)) {
+        winner = entry;
+      }
+
+      advance();
+    }
+
+    writer.WriteRaw(winner.key.record);
+
+    if (winner.value) {
+      writer.WriteRaw(winner.value->record);
+    }
+  }
+}
+
+}  // namespace
+
+ll::Buffer Mmerge(const std::vector<ll::Span>& tlvs) {
+  tlv::BufferWriter writer;
+  MergeInto(tlvs, writer, std::pmr::get_default_resource());
+  return writer.Extract();
+}
+
+ll::Span Mmerge(std::span<const ll::Span> tlvs, ll::Arena& arena) {
+  tlv::ArenaWriter writer(arena);
+  MergeInto(tlvs, writer, &arena);
+  return writer.Extract();
+}
+
+ll::Buffer Mdelta(ll::Span tlv, const Entries& new_entries) {
+  Entries old = ParseAll(tlv);
+  Entries delta;
+
+  size_t i = 0;
+  size_t j = 0;
+
+  while (i < old.size() || j < new_entries.size()) {
+    int cmp = i == old.size()           ? 1
+              : j == new_entries.size() ? -1
+                                        : Compare(old[i].key,
+                                                  new_entries[j].key);
+
+    if (cmp < 0) {
+      // removed
+      const Entry& entry = old[i++];
+
+      if (!entry.key.IsTombstone()) {
+        int64_t revision = std::abs(entry.key.time.revision) + 1;
+        delta.push_back({Retimed(entry.key, {-revision, 0}), std::nullopt});
+      }
+    } else if (cmp > 0) {
+      // added
+      const Entry& entry = new_entries[j++];
+      delta.push_back({Retimed(entry.key, {}),
+                       Retimed(*entry.value, {1, 0})});
+    } else {
+      const Entry& was = old[i++];
+      const Entry& now = new_entries[j++];
+
+      if (was.key.IsTombstone()) {
+        // re-added
+        int64_t revision = std::abs(was.key.time.revision) + 1;
+        delta.push_back({Retimed(now.key, {revision, 0}),
+                         Retimed(*now.value, {1, 0})});
+      } else if (Compare(*was.value, *now.value) != 0) {
+        // changed, the key version stays
+        int64_t revision = std::abs(was.value->time.revision) + 1;
+        delta.push_back({was.key, Retimed(*now.value, {revision, 0})});
+      }
+    }
+  }
+
+  return Mtlv(delta);
+}
+
+}  // namespace mel
@@ -0,0 +1,35 @@
+#pragma once
+
+#include <optional>
+#include <span>
+#include <string>
+#include <vector>
+
+#include <ll/arena.hpp>
+#include <ll/bytes.hpp>
+#include <mel/element.hpp>
+
+namespace mel {
+
+// A key op followed by its value op. Removed keys have negative
+// revisions and no value.
+struct Entry {
+  Element key;
+  std::optional<Element> value;
+};
+
+using Entries = std::vector<Entry>;
+
+Entry ReadEntry(tlv::ViewReader& reader);
+
+// M, a map of FIRST keys to FIRST values kept in the value order of
+// the keys
+bool Mvalid(ll::Span tlv);
+std::string Mstring(ll::Span tlv);
+Entries Mnative(ll::Span tlv);
+ll::Buffer Mtlv(const Entries& entries);
+ll::Buffer Mmerge(const std::vector<ll::Span>& tlvs);
+ll::Span Mmerge(std::span<const ll::Span> tlvs, ll::Arena& arena);
+ll::Buffer Mdelta(ll::Span tlv, const Entries& new_entries);
+
+}  // namespace mel
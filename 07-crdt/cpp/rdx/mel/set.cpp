@@ -0,0 +1,230 @@
+#include <cstdlib>
+#include <stdexcept>
+
+#include <ll/merge_heap.hpp>
+#include <tlv/io.hpp>
+
+#include <mel/set.hpp>
+
+namespace mel {
+
+namespace {
+
+struct Cursor {
+  tlv::ViewReader reader;
+  Element head;
+};
+
+Elements ParseAll(ll::Span tlv) {
+  Elements elements;
+  tlv::ViewReader reader(tlv);
+
+  while (reader.HasSome()) {
+    elements.push_back(ReadElement(reader));
+  }
+
+  return elements;
+}
+
+Element Retimed(const Element& element, isfr::Time time) {
+  Element retimed = element;
+  retimed.time = time;
+  retimed.record = {};
+  return retimed;
+}
+
+}  // namespace
+
+bool Evalid(ll::Span tlv) {
+  try {
+    tlv::ViewReader reader(tlv);
+    Element prev;
+
+    for (bool first = true; reader.HasSome(); first = false) {
+      Element element = ReadElement(reader);
+
+      if (!first && Compare(prev, element) >= 0) {
+        return false;
+      }
+
+      prev = element;
+    }
+  } catch (const std::runtime_error&) {
+    return false;
+  }
+
+  return true;
+}
+
+std::string Estring(ll::Span tlv) {
+  std::string text = "{";
+  tlv::ViewReader reader(tlv);
+
+  for (bool first = true; reader.HasSome();) {
+    Element element = ReadElement(reader);
+
+    if (element.IsTombstone()) {
+      continue;
+    }
+
+    if (!first) {
+      text.push_back(',');
+    }
+
+    AppendElement(text, element);
+    first = false;
+  }
+
+  text.push_back('}');
+
+  return text;
+}
+
+Elements Enative(ll::Span tlv) {
+  Elements elements = ParseAll(tlv);
+  std::erase_if(elements, [](const Element& element) {
+    return element.IsTombstone();
+  });
+  return elements;
+}
+
+ll::Buffer Etlv(const Elements& elements) {
+  size_t size = 0;
+
+  for (size_t i = 0; i < elements.size(); ++i) {
+    if (i > 0 && Compare(elements[i - 1], elements[i]) >= 0) {
+      throw std::runtime_error("E elements are not in the value order");
+    }
+
+    size += ElementSize(elements[i]);
+  }
+
+  tlv::BufferWriter writer;
+  writer.Reserve(size);
+
+  for (const Element& element : elements) {
+    WriteElement(writer, element);
+  }
+
+  return writer.Extract();
+}
+
+namespace {
+
+// Winners are parsed, so they are copied verbatim by either writer
+template <class Writer>
+void MergeInto(std::span<const ll::Span> tlvs, Writer& writer,
+               std::pmr::memory_resource* memory) {
+  std::pmr::vector<Cursor> cursors(memory);
+  cursors.reserve(tlvs.size());
+
+  size_t total = 0;
+
+  for (ll::Span tlv : tlvs) {
+    if (tlv.empty()) {
+      continue;
+    }
+
+    total += tlv.size();
+
+    tlv::ViewReader reader(tlv);
+    Element head = ReadElement(reader);
+    cursors.push_back({reader, head});
+  }
+
+  ll::MergeHeap heap([&cursors](size_t lhs, size_t rhs) {
+    return Compare(cursors[lhs].head, cursors[rhs].head) < 0;
+  }, memory);
+  heap.Reserve(cursors.size());
+
+  for (size_t i = 0; i < cursors.size(); ++i) {
+    heap.Push(i);
+  }
+
+  auto advance = [&]() {
+    Cursor& cursor = cursors[heap.Top()];
+
+    if (cursor.reader.HasSome()) {
+      cursor.head = ReadElement(cursor.reader);
+      heap.Update();
+    } else {
+      heap.Pop();
+    }
+  };
+
+  // The output never exceeds the inputs combined
+  writer.Reserve(total);
+
+  while (!heap.IsEmpty()) {
+    Element winner = cursors[heap.Top()].head;
+    advance();
+
+    while (!heap.IsEmpty() &&
+           Compare(cursors[heap.Top()].head, winner) == 0) {
+      const Element& element = cursors[heap.Top()].head;
+
+      if (Newer(element, winner)) {
+        winner = element;
+      }
+
+      advance();
+    }
+
+    writer.WriteRaw(winner.record);
+  }
+}
+
+}  // namespace
+
+ll::Buffer Emerge(const std::vector<ll::Span>& tlvs) {
+  tlv::BufferWriter writer;
+  MergeInto(tlvs, writer, std::pmr::get_default_resource());
+  return writer.Extract();
+}
+
+ll::Span Emerge(std::span<const ll::Span> tlvs, ll::Arena& arena) {
+  tlv::ArenaWriter writer(arena);
+  MergeInto(tlvs, writer, &arena);
+  return writer.Extract();
+}
+
+ll::Buffer Edelta(ll::Span tlv, const Elements& new_elements) {
+  Elements old = ParseAll(tlv);
+  Elements delta;
+
+  size_t i = 0;
+  size_t j = 0;
+
+  while (i < old.size() || j < new_elements.size()) {
+    int cmp = i == old.size()            ? 1
+              : j == new_elements.size() ? -1
+                                         : Compare(old[i], new_elements[j]);
+
+    if (cmp < 0) {
+      // removed
+      const Element& element = old[i++];
+
+      if (!element.IsTombstone()) {
+        int64_t revision = std::abs(element.time.revision) + 1;
+        delta.push_back(Retimed(element, {-revision, 0}));
+      }
+    } else if (cmp > 0) {
+      // added
+      delta.push_back(Retimed(new_elements[j++], {1, 0}));
+    } else {
+      // re-added, if it was removed
+      const Element& element = old[i++];
+
+      if (element.IsTombstone()) {
+        int64_t revision = std::abs(element.time.revision) + 1;
+        delta.push_back(Retimed(new_elements[j], {revision, 0}));
+      }
+
+      ++j;
+    }
+  }
+
+  return Etlv(delta);
+}
+
+}  // namespace mel
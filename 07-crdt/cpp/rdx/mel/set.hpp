@@ -0,0 +1,23 @@
+#pragma once
+
+#include <span>
+#include <string>
+#include <vector>
+
+#include <ll/arena.hpp>
+#include <ll/bytes.hpp>
+#include <mel/element.hpp>
+
+namespace mel {
+
+// E, a set of FIRST elements kept in the value order. Removed
+// elements stay as tombstones (negative revisions).
+bool Evalid(ll::Span tlv);
+std::string Estring(ll::Span tlv);
+Elements Enative(ll::Span tlv);
+ll::Buffer Etlv(const Elements& elements);
+ll::Buffer Emerge(const std::vector<ll::Span>& tlvs);
+ll::Span Emerge(std::span<const ll::Span> tlvs, ll::Arena& arena);
+ll::Buffer Edelta(ll::Span tlv, const Elements& new_elements);
+
+}  // namespace mel
@@ -0,0 +1,477 @@
+#include <cstdlib>
+#include <stdexcept>
+#include <unordered_set>
+
+#include <ll/zipint.hpp>
+#include <tlv/io.hpp>
+
+#include <mel/weave.hpp>
+
+namespace mel {
+
+OpId IdOf(const Element& element) {
+  return {uint64_t(std::abs(element.time.revision)), element.time.source};
+}
+
+size_t OpIdHash::operator()(const OpId& id) const {
+  uint64_t mix = id.revision * 0x9e3779b97f4a7c15 ^ id.source;
+  return std::hash<uint64_t>{}(mix ^ (mix >> 29));
+}
+
+bool IsAttachment(const tlv::RecordView& record) {
+  return record.header.literal == 'R';
+}
+
+OpId ReadAttachment(const tlv::RecordView& record) {
+  auto [rev, src] = ll::UnzipIU64Pair(record.body);
+  return {uint64_t(std::abs(rev)), src};
+}
+
+void WriteAttachment(tlv::BufferWriter& writer, OpId id) {
+  uint8_t zipped[ll::kMaxZipLen];
+  size_t size = ll::ZipTo(zipped, int64_t(id.revision), id.source);
+  writer.WriteRecord('R', {zipped, size});
+}
+
+Weave::Weave() {
+  Node head;
+  head.priority = UINT32_MAX;
+  head.visible = 0;
+  nodes_.push_back(head);
+  ids_.emplace(OpId{}, kHead);
+}
+
+void Weave::Apply(ll::Buffer tlv) {
+  storage_.push_back(std::move(tlv));
+  ApplyView(storage_.back());
+}
+
+void Weave::ApplyView(ll::Span tlv) {
+  tlv::ViewReader reader(tlv);
+
+  if (nodes_.size() == 1 && reader.HasSome()) {
+    tlv::ViewReader probe(tlv);
+
+    if (!IsAttachment(probe.ReadNext())) {
+      Build(tlv);
+      return;
+    }
+  }
+
+  uint32_t ref = kHead;
+
+  while (reader.HasSome()) {
+    tlv::RecordView record = reader.ReadNext();
+
+    if (IsAttachment(record)) {
+      auto it = ids_.find(ReadAttachment(record));
+
+      if (it == ids_.end()) {
+        throw std::runtime_error("L attachment point is missing");
+      }
+
+      ref = it->second;
+      continue;
+    }
+
+    Element element = ParseElement(record);
+
+    if (auto it = ids_.find(IdOf(element)); it != ids_.end()) {
+      ref = it->second;
+      continue;
+    }
+
+    ref = Place(ref, element);
+  }
+}
+
+bool Weave::Attachable(ll::Span tlv) const {
+  std::unordered_set<OpId, OpIdHash> introduced;
+  tlv::ViewReader reader(tlv);
+
+  while (reader.HasSome()) {
+    tlv::RecordView record = reader.ReadNext();
+
+    if (!IsAttachment(record)) {
+      introduced.insert(IdOf(ParseElement(record)));
+      continue;
+    }
+
+    OpId id = ReadAttachment(record);
+
+    if (!ids_.contains(id) && !introduced.contains(id)) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+size_t Weave::Size() const {
+  return nodes_[root_].visible;
+}
+
+const Element& Weave::At(size_t index) const {
+  return nodes_[Shown(index)].element;
+}
+
+std::optional<size_t> Weave::IndexOf(OpId id) const {
+  auto it = ids_.find(id);
+
+  if (it == ids_.end() || !nodes_[it->second].shown) {
+    return std::nullopt;
+  }
+
+  uint32_t node = it->second;
+  uint32_t left = nodes_[node].left;
+  size_t index = left == kNil ? 0 : nodes_[left].visible;
+
+  for (uint32_t parent = nodes_[node].parent; parent != kNil;
+       node = parent, parent = nodes_[parent].parent) {
+    if (nodes_[parent].right != node) {
+      continue;
+    }
+
+    uint32_t sibling = nodes_[parent].left;
+    index += nodes_[parent].shown;
+    index += sibling == kNil ? 0 : nodes_[sibling].visible;
+  }
+
+  return index;
+}
+
+ll::Buffer Weave::Insert(size_t index, const Element& element,
+                         uint64_t source) {
+  if (element.literal == 'R') {
+    throw std::runtime_error("L elements can not be R");
+  }
+
+  uint32_t ref = index == 0 ? kHead : Shown(index - 1);
+
+  Element op = element;
+  op.time = {int64_t(max_revision_ + 1), source};
+  op.record = {};
+
+  tlv::BufferWriter writer;
+  WriteAttachment(writer, IdOf(nodes_[ref].element));
+  WriteElement(writer, op);
+
+  ll::Buffer patch = writer.Extract();
+  Apply(patch);
+
+  return patch;
+}
+
+ll::Buffer Weave::Remove(size_t index, uint64_t source) {
+  uint32_t target = Shown(index);
+
+  Element op;
+  op.time = {-int64_t(max_revision_ + 1), source};
+
+  tlv::BufferWriter writer;
+  WriteAttachment(writer, IdOf(nodes_[target].element));
+  WriteElement(writer, op);
+
+  ll::Buffer patch = writer.Extract();
+  Apply(patch);
+
+  return patch;
+}
+
+void Weave::ForEach(
+    const std::function<void(const Element&, bool)>& visit) const {
+  for (uint32_t node = Next(kHead); node != kNil; node = Next(node)) {
+    visit(nodes_[node].element, nodes_[node].shown);
+  }
+}
+
+ll::Buffer Weave::Tlv() const {
+  tlv::BufferWriter writer;
+  writer.Reserve(bytes_);
+
+  for (uint32_t node = Next(kHead); node != kNil; node = Next(node)) {
+    WriteElement(writer, nodes_[node].element);
+  }
+
+  return writer.Extract();
+}
+
+uint32_t Weave::NewNode(const Element& element) {
+  seed_ ^= seed_ << 13;
+  seed_ ^= seed_ >> 7;
+  seed_ ^= seed_ << 17;
+
+  Node node;
+  node.element = element;
+  node.priority = seed_ % UINT32_MAX;
+
+  uint32_t index = nodes_.size();
+  nodes_.push_back(node);
+
+  OpId id = IdOf(element);
+  ids_.emplace(id, index);
+  max_revision_ = std::max(max_revision_, id.revision);
+  bytes_ += ElementSize(element);
+
+  return index;
+}
+
+// Cartesian tree construction in the weave order, O(n)
+void Weave::Build(ll::Span tlv) {
+  tlv::ViewReader reader(tlv);
+
+  // An element takes at least 4 bytes
+  nodes_.reserve(1 + tlv.size() / 4);
+  ids_.reserve(1 + tlv.size() / 4);
+
+  while (reader.HasSome()) {
+    Element element = ParseElement(reader.ReadNext());
+
+    if (!ids_.contains(IdOf(element))) {
+      NewNode(element);
+    }
+  }
+
+  // Visibility: a regular op not followed by a deletion
+  uint32_t regular = kNil;
+
+  for (uint32_t node = 1; node < nodes_.size(); ++node) {
+    if (!nodes_[node].element.IsTombstone()) {
+      nodes_[node].shown = true;
+      regular = node;
+    } else if (regular != kNil) {
+      nodes_[regular].shown = false;
+    }
+  }
+
+  // A node leaving the right spine has its subtree complete
+  std::vector<uint32_t> spine = {kHead};
+
+  for (uint32_t node = 1; node < nodes_.size(); ++node) {
+    uint32_t last = kNil;
+
+    while (nodes_[spine.back()].priority < nodes_[node].priority) {
+      last = spine.back();
+      spine.pop_back();
+      Pull(last);
+    }
+
+    nodes_[node].left = last;
+    nodes_[node].parent = spine.back();
+    nodes_[spine.back()].right = node;
+
+    if (last != kNil) {
+      nodes_[last].parent = node;
+    }
+
+    spine.push_back(node);
+  }
+
+  for (auto it = spine.rbegin(); it != spine.rend(); ++it) {
+    Pull(*it);
+  }
+}
+
+uint32_t Weave::InsertAfter(uint32_t pos, const Element& element) {
+  uint32_t node = NewNode(element);
+  uint32_t parent = pos;
+
+  if (nodes_[pos].right == kNil) {
+    nodes_[pos].right = node;
+  } else {
+    parent = nodes_[pos].right;
+
+    while (nodes_[parent].left != kNil) {
+      parent = nodes_[parent].left;
+    }
+
+    nodes_[parent].left = node;
+  }
+
+  nodes_[node].parent = parent;
+
+  for (uint32_t up = parent; up != kNil; up = nodes_[up].parent) {
+    ++nodes_[up].size;
+  }
+
+  while (nodes_[node].parent != kNil &&
+         nodes_[nodes_[node].parent].priority < nodes_[node].priority) {
+    Rotate(node);
+  }
+
+  return node;
+}
+
+// RGA placement: skip the deletions of the attachment op, then
+// everything newer than the op being placed
+uint32_t Weave::Place(uint32_t ref, const Element& element) {
+  OpId id = IdOf(element);
+  bool deletion = element.IsTombstone();
+
+  uint32_t pos = ref;
+
+  for (uint32_t next = Next(pos); next != kNil; next = Next(pos)) {
+    const Element& follower = nodes_[next].element;
+    bool newer = id < IdOf(follower);
+    bool skip = follower.IsTombstone() ? !deletion || newer
+                                       : !deletion && newer;
+
+    if (!skip) {
+      break;
+    }
+
+    pos = next;
+  }
+
+  uint32_t node = InsertAfter(pos, element);
+
+  if (!deletion) {
+    Show(node, true);
+    return node;
+  }
+
+  uint32_t target = Prev(node);
+
+  while (target != kHead && nodes_[target].element.IsTombstone()) {
+    target = Prev(target);
+  }
+
+  if (target != kHead) {
+    Show(target, false);
+  }
+
+  return node;
+}
+
+void Weave::Show(uint32_t node, bool shown) {
+  if (nodes_[node].shown == shown) {
+    return;
+  }
+
+  nodes_[node].shown = shown;
+
+  for (uint32_t up = node; up != kNil; up = nodes_[up].parent) {
+    nodes_[up].visible += shown ? 1 : -1;
+  }
+}
+
+uint32_t Weave::Next(uint32_t node) const {
+  if (nodes_[node].right != kNil) {
+    node = nodes_[node].right;
+
+    while (nodes_[node].left != kNil) {
+      node = nodes_[node].left;
+    }
+
+    return node;
+  }
+
+  while (nodes_[node].parent != kNil &&
+         nodes_[nodes_[node].parent].right == node) {
+    node = nodes_[node].parent;
+  }
+
+  return nodes_[node].parent;
+}
+
+uint32_t Weave::Prev(uint32_t node) const {
+  if (nodes_[node].left != kNil) {
+    node = nodes_[node].left;
+
+    while (nodes_[node].right != kNil) {
+      node = nodes_[node].right;
+    }
+
+    return node;
+  }
+
+  while (nodes_[node].parent != kNil &&
+         nodes_[nodes_[node].parent].left == node) {
+    node = nodes_[node].parent;
+  }
+
+  return nodes_[node].parent;
+}
+
+void Weave::Pull(uint32_t node) {
+  Node& n = nodes_[node];
+  n.size = 1;
+  n.visible = n.shown;
+
+  for (uint32_t child : {n.left, n.right}) {
+    if (child != kNil) {
+      n.size += nodes_[child].size;
+      n.visible += nodes_[child].visible;
+    }
+  }
+}
+
+void Weave::Rotate(uint32_t node) {
+  uint32_t parent = nodes_[node].parent;
+  uint32_t grand = nodes_[parent].parent;
+
+  if (nodes_[parent].left == node) {
+    nodes_[parent].left = nodes_[node].right;
+
+    if (nodes_[node].right != kNil) {
+      nodes_[nodes_[node].right].parent = parent;
+    }
+
+    nodes_[node].right = parent;
+  } else {
+    nodes_[parent].right = nodes_[node].left;
+
+    if (nodes_[node].left != kNil) {
+      nodes_[nodes_[node].left].parent = parent;
+    }
+
+    nodes_[node].left = parent;
+  }
+
+  nodes_[parent].parent = node;
+  nodes_[node].parent = grand;
+
+  if (grand == kNil) {
+    root_ = node;
+  } else if (nodes_[grand].left == parent) {
+    nodes_[grand].left = node;
+  } else {
+    nodes_[grand].right = node;
+  }
+
+  Pull(parent);
+  Pull(node);
+}
+
+// The node of the index-th visible element
+uint32_t Weave::Shown(size_t index) const {
+  if (index >= Size()) {
+    throw std::out_of_range("L index out of range");
+  }
+
+  uint32_t node = root_;
+
+  while (true) {
+    uint32_t left = nodes_[node].left;
+    uint32_t skipped = left == kNil ? 0 : nodes_[left].visible;
+
+    if (index < skipped) {
+      node = left;
+      continue;
+    }
+
+    index -= skipped;
+
+    if (nodes_[node].shown) {
+      if (index == 0) {
+        return node;
+      }
+
+      --index;
+    }
+
+    node = nodes_[node].right;
+  }
+}
+
+}  // namespace mel
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <optional>
+#include <unordered_map>
+#include <vector>
+
+#include <ll/bytes.hpp>
+#include <mel/element.hpp>
+
+namespace mel {
+
+// Op ids are {|rev|, src}; the causal tree orders siblings newest
+// first, ops must be newer than their parents (Lamport)
+struct OpId {
+  uint64_t revision = 0;
+  uint64_t source = 0;
+
+  auto operator<=>(const OpId& rhs) const = default;
+};
+
+OpId IdOf(const Element& element);
+
+struct OpIdHash {
+  size_t operator()(const OpId& id) const;
+};
+
+// L patches attach subtrees with `R` records holding a bare zipped
+// {rev, src} of the attachment op; {0, 0} is the array start. A bare
+// id may look like a valid FIRST body, so `R` records in L are
+// always attachment points and arrays can not hold R elements.
+bool IsAttachment(const tlv::RecordView& record);
+OpId ReadAttachment(const tlv::RecordView& record);
+void WriteAttachment(tlv::BufferWriter& writer, OpId id);
+
+// An RGA/causal tree weave with a position index: an implicit treap
+// over the weave order plus an id hash. Inserting at an attachment
+// point, deleting and looking up by array index all take O(log n).
+//
+// A deletion is an op with a negative revision attached to its
+// target; deletions go right after their target, before any other
+// child, so a deletion hides the closest preceding regular op.
+class Weave {
+ public:
+  Weave();
+
+  Weave(const Weave&) = delete;
+  Weave& operator=(const Weave&) = delete;
+  Weave(Weave&&) = default;
+  Weave& operator=(Weave&&) = default;
+
+  // Merges in a weave or a patch. The owning version keeps a copy of
+  // the bytes, the view version requires them to outlive the weave.
+  void Apply(ll::Buffer tlv);
+  void ApplyView(ll::Span tlv);
+
+  // Whether every attachment point of a patch is known
+  bool Attachable(ll::Span tlv) const;
+
+  // Visible (not deleted) elements
+  size_t Size() const;
+  const Element& At(size_t index) const;
+  std::optional<size_t> IndexOf(OpId id) const;
+
+  // Local edits; apply the change and return it as a patch
+  ll::Buffer Insert(size_t index, const Element& element, uint64_t source);
+  ll::Buffer Remove(size_t index, uint64_t source);
+
+  void ForEach(const std::function<void(const Element&, bool)>& visit) const;
+  ll::Buffer Tlv() const;
+
+ private:
+  static constexpr uint32_t kNil = UINT32_MAX;
+  static constexpr uint32_t kHead = 0;
+
+  struct Node {
+    Element element;
+    uint32_t priority = 0;
+    uint32_t parent = kNil;
+    uint32_t left = kNil;
+    uint32_t right = kNil;
+    uint32_t size = 1;
+    uint32_t visible = 0;
+    bool shown = false;
+  };
+
+  uint32_t NewNode(const Element& element);
+  void Build(ll::Span tlv);
+
+  uint32_t InsertAfter(uint32_t pos, const Element& element);
+  uint32_t Place(uint32_t ref, const Element& element);
+
+  void Show(uint32_t node, bool shown);
+  uint32_t Next(uint32_t node) const;
+  uint32_t Prev(uint32_t node) const;
+
+  void Pull(uint32_t node);
+  void Rotate(uint32_t node);
+  uint32_t Shown(size_t index) const;
+
+ private:
+  std::vector<Node> nodes_;
+  std::unordered_map<OpId, uint32_t, OpIdHash> ids_;
+  std::vector<ll::Buffer> storage_;
+  uint32_t root_ = kHead;
+  uint64_t max_revision_ = 0;
+  uint64_t seed_ = 0x9e3779b97f4a7c15;
+  size_t bytes_ = 0;
+};
+
+}  // namespace mel
@@ -0,0 +1,513 @@
+#include <algorithm>
+#include <cmath>
+#include <optional>
+#include <queue>
+#include <random>
+#include <stdexcept>
+#include <unordered_map>
+#include <vector>
+
+#include <tlv/io.hpp>
+#include <cmn/id.hpp>
+#include <vv/vv.hpp>
+
+#include <mesh/simulator.hpp>
+
+namespace mesh {
+
+namespace {
+
+// Sequence numbers start at 1, so an announce entry of 0 says the
+// node has nothing of that source
+struct Packet {
+  cmn::Id id;
+  std::optional<cmn::Id> ref;
+};
+
+struct Message {
+  uint32_t sender = 0;
+  // A packet index, or none for an announce
+  std::optional<uint32_t> packet;
+  vv::VersionVector fragment;
+  // The fragment is the whole vector of the sender, so a source it
+  // does not list is a source it has nothing of
+  bool complete = false;
+  size_t accepted = 0;
+};
+
+enum class EventKind {
+  kCreate,
+  kReceive,
+  kAnnounce,
+  kPeriodic,
+  kRelay,
+  kFlood,
+};
+
+struct Event {
+  double time = 0;
+  uint64_t order = 0;
+  EventKind kind = EventKind::kCreate;
+  uint32_t node = 0;
+  // A packet, a message or a source, by kind
+  uint64_t subject = 0;
+
+  bool operator>(const Event& rhs) const {
+    return time != rhs.time ? time > rhs.time : order > rhs.order;
+  }
+};
+
+struct Heard {
+  uint64_t sequence = 0;
+  double time = 0;
+};
+
+struct Relay {
+  uint64_t from = 0;
+  uint64_t to = 0;
+  double since = 0;
+};
+
+struct Node {
+  double x = 0;
+  double y = 0;
+  std::vector<uint32_t> neighbours;
+  double busy_until = 0;
+
+  // Packets held, by index; the vector is the per source maximum
+  std::vector<bool> held;
+  vv::VersionVector have;
+  // Sources to put first into the next announce
+  std::vector<uint64_t> priority;
+  bool announce_pending = false;
+  size_t cursor = 0;
+
+  std::unordered_map<uint64_t, Heard> heard;
+  std::unordered_map<uint64_t, Relay> relays;
+  std::unordered_map<uint32_t, uint32_t> heard_count;
+};
+
+class Simulator {
+ public:
+  explicit Simulator(const MeshConfig& config)
+      : config_(config), rng_(config.seed) {
+    if (config.nodes == 0 || config.sources == 0 ||
+        config.sources > config.nodes || config.fragment_entries == 0) {
+      throw std::runtime_error("Invalid mesh config");
+    }
+  }
+
+  MeshStats Run() {
+    Place();
+    std::vector<uint32_t> component = LargestComponent();
+    stats_.nodes = component.size();
+
+    std::shuffle(component.begin(), component.end(), rng_);
+    size_t sources = std::min(config_.sources, component.size());
+    stats_.expected = stats_.nodes * sources * config_.packets;
+
+    for (size_t s = 0; s < sources; ++s) {
+      uint32_t origin = component[s];
+
+      for (uint64_t k = 0; k < config_.packets; ++k) {
+        Packet packet;
+        packet.id.source = origin;
+        packet.id.sequence = k + 1;
+        index_[Key(packet.id)] = packets_.size();
+        Schedule(k * config_.packet_interval, EventKind::kCreate, origin,
+                 packets_.size());
+        packets_.push_back(packet);
+      }
+    }
+
+    if (config_.protocol == Protocol::kAnnounce) {
+      for (uint32_t node : component) {
+        Schedule(Uniform(config_.announce_period), EventKind::kPeriodic,
+                 node, 0);
+      }
+    }
+
+    while (!events_.empty() && !stats_.converged) {
+      Event event = events_.top();
+      events_.pop();
+
+      if (event.time > config_.horizon) {
+        break;
+      }
+
+      now_ = event.time;
+      ++stats_.events;
+      Handle(event);
+    }
+
+    for (const Message& message : messages_) {
+      stats_.redundant_sends += message.packet && message.accepted == 0;
+    }
+
+    return stats_;
+  }
+
+ private:
+  static uint64_t Key(cmn::Id id) {
+    return uint64_t(id.source) << 32 | id.sequence;
+  }
+
+  double Uniform(double max) {
+    return std::uniform_real_distribution<double>(0, max)(rng_);
+  }
+
+  void Schedule(double time, EventKind kind, uint32_t node,
+                uint64_t subject) {
+    events_.push({time, order_++, kind, node, subject});
+  }
+
+  // Uniform placement, neighbours found through a grid of radius cells
+  void Place() {
+    nodes_.resize(config_.nodes);
+    double radius =
+        std::sqrt(config_.degree / (M_PI * double(config_.nodes)));
+    size_t cells = std::max<size_t>(1, size_t(1 / radius));
+    std::vector<std::vector<uint32_t>> grid(cells * cells);
+
+    auto cell = [cells](double coordinate) {
+      return std::min(cells - 1, size_t(coordinate * cells));
+    };
+
+    for (uint32_t i = 0; i < nodes_.size(); ++i) {
+      nodes_[i].x = Uniform(1);
+      nodes_[i].y = Uniform(1);
+      grid[cell(nodes_[i].y) * cells + cell(nodes_[i].x)].push_back(i);
+    }
+
+    for (uint32_t i = 0; i < nodes_.size(); ++i) {
+      Node& node = nodes_[i];
+      size_t cx = cell(node.x);
+      size_t cy = cell(node.y);
+
+      for (size_t y = cy == 0 ? 0 : cy - 1; y <= std::min(cy + 1, cells - 1);
+           ++y) {
+        for (size_t x = cx == 0 ? 0 : cx - 1;
+             x <= std::min(cx + 1, cells - 1); ++x) {
+          for (uint32_t j : grid[y * cells + x]) {
+            double dx = nodes_[j].x - node.x;
+            double dy = nodes_[j].y - node.y;
+
+            if (j != i && dx * dx + dy * dy <= radius * radius) {
+              node.neighbours.push_back(j);
+            }
+          }
+        }
+      }
+    }
+  }
+
+  std::vector<uint32_t> LargestComponent() const {
+    std::vector<int> component(nodes_.size(), -1);
+    std::vector<uint32_t> largest;
+
+    for (uint32_t start = 0; start < nodes_.size(); ++start) {
+      if (component[start] >= 0) {
+        continue;
+      }
+
+      std::vector<uint32_t> members = {start};
+      component[start] = start;
+
+      for (size_t i = 0; i < members.size(); ++i) {
+        for (uint32_t next : nodes_[members[i]].neighbours) {
+          if (component[next] < 0) {
+            component[next] = start;
+            members.push_back(next);
+          }
+        }
+      }
+
+      if (members.size() > largest.size()) {
+        largest = std::move(members);
+      }
+    }
+
+    return largest;
+  }
+
+  void Handle(const Event& event) {
+    Node& node = nodes_[event.node];
+
+    switch (event.kind) {
+      case EventKind::kCreate:
+        Create(event.node, event.subject);
+        break;
+      case EventKind::kReceive:
+        Receive(event.node, event.subject);
+        break;
+      case EventKind::kAnnounce:
+        node.announce_pending = false;
+        Announce(event.node);
+        break;
+      case EventKind::kPeriodic:
+        Announce(event.node);
+        Schedule(now_ + config_.announce_period * (0.5 + Uniform(1)),
+                 EventKind::kPeriodic, event.node, 0);
+        break;
+      case EventKind::kRelay:
+        SendRelay(event.node, event.subject);
+        break;
+      case EventKind::kFlood:
+        if (node.heard_count[event.subject] <= 1) {
+          SendPacket(event.node, event.subject);
+        }
+
+        break;
+    }
+  }
+
+  void Create(uint32_t origin, uint64_t packet) {
+    Node& node = nodes_[origin];
+    Packet& created = packets_[packet];
+    std::vector<size_t> others;
+
+    for (size_t i = 0; i < node.have.Size(); ++i) {
+      if (node.have.Sources()[i] != origin) {
+        others.push_back(i);
+      }
+    }
+
+    if (config_.references && !others.empty()) {
+      size_t other = others[rng_() % others.size()];
+      cmn::Id ref;
+      ref.source = node.have.Sources()[other];
+      ref.sequence = node.have.Progress()[other];
+      created.ref = ref;
+    }
+
+    Accept(origin, packet);
+
+    if (config_.protocol == Protocol::kFlood) {
+      SendPacket(origin, packet);
+    }
+  }
+
+  bool Has(const Node& node, cmn::Id id) const {
+    return !node.held.empty() && node.held[index_.at(Key(id))];
+  }
+
+  void Accept(uint32_t at, uint64_t packet) {
+    Node& node = nodes_[at];
+    cmn::Id id = packets_[packet].id;
+    node.held.resize(packets_.size());
+    node.held[packet] = true;
+    node.have.Put(id.source, id.sequence);
+
+    if (++stats_.delivered == stats_.expected) {
+      stats_.converged = true;
+      stats_.convergence_time = now_;
+    }
+
+    if (config_.protocol == Protocol::kAnnounce) {
+      TriggerAnnounce(at, id.source);
+    } else if (at != id.source) {
+      Schedule(now_ + Uniform(config_.jitter), EventKind::kFlood, at,
+               packet);
+    }
+  }
+
+  void Receive(uint32_t at, uint64_t index) {
+    Node& node = nodes_[at];
+    Message& message = messages_[index];
+
+    if (!message.packet.has_value()) {
+      ReceiveAnnounce(at, message);
+      return;
+    }
+
+    const Packet& packet = packets_[*message.packet];
+    Heard& heard = node.heard[packet.id.source];
+    heard.sequence = std::max<uint64_t>(heard.sequence, packet.id.sequence);
+    heard.time = now_;
+    ++node.heard_count[*message.packet];
+
+    if (Has(node, packet.id)) {
+      ++stats_.duplicate_receptions;
+      return;
+    }
+
+    // Out of causal order: dropped, announces get it again. Flooded
+    // messages are independent of each other.
+    if (config_.protocol == Protocol::kAnnounce &&
+        (node.have.Get(packet.id.source).value_or(0) + 1 !=
+             packet.id.sequence ||
+         (packet.ref.has_value() && !Has(node, *packet.ref)))) {
+      return;
+    }
+
+    ++message.accepted;
+    Accept(at, *message.packet);
+  }
+
+  void ReceiveAnnounce(uint32_t at, const Message& message) {
+    Node& node = nodes_[at];
+    const vv::VersionVector& fragment = message.fragment;
+
+    for (size_t i = 0; i < fragment.Size(); ++i) {
+      uint64_t source = fragment.Sources()[i];
+      uint64_t theirs = fragment.Progress()[i];
+      uint64_t mine = node.have.Get(source).value_or(0);
+
+      if (mine > theirs) {
+        ScheduleRelay(at, source, theirs + 1, mine);
+      } else if (mine < theirs) {
+        TriggerAnnounce(at, source);
+      }
+    }
+
+    if (!message.complete) {
+      return;
+    }
+
+    for (size_t i = 0; i < node.have.Size(); ++i) {
+      uint64_t source = node.have.Sources()[i];
+
+      if (!fragment.Get(source).has_value()) {
+        ScheduleRelay(at, source, 1, node.have.Progress()[i]);
+      }
+    }
+  }
+
+  void TriggerAnnounce(uint32_t at, uint64_t source) {
+    Node& node = nodes_[at];
+
+    if (std::find(node.priority.begin(), node.priority.end(), source) ==
+        node.priority.end()) {
+      node.priority.push_back(source);
+    }
+
+    if (!node.announce_pending) {
+      node.announce_pending = true;
+      Schedule(now_ + Uniform(config_.jitter), EventKind::kAnnounce, at, 0);
+    }
+  }
+
+  // Pending answers to several announces for one source get merged
+  void ScheduleRelay(uint32_t at, uint64_t source, uint64_t from,
+                     uint64_t to) {
+    Node& node = nodes_[at];
+    to = std::min(to, from + config_.max_relay - 1);
+    auto [it, added] = node.relays.try_emplace(source);
+
+    if (!added) {
+      it->second.from = std::min(it->second.from, from);
+      it->second.to = std::max(it->second.to, to);
+      return;
+    }
+
+    it->second = {from, to, now_};
+    Schedule(now_ + Uniform(config_.jitter), EventKind::kRelay, at, source);
+  }
+
+  // Packets overheard since the answer was scheduled went out already
+  void SendRelay(uint32_t at, uint64_t source) {
+    Node& node = nodes_[at];
+    auto it = node.relays.find(source);
+    Relay relay = it->second;
+    node.relays.erase(it);
+
+    auto heard = node.heard.find(source);
+
+    if (heard != node.heard.end() && heard->second.time > relay.since) {
+      relay.from = std::max(relay.from, heard->second.sequence + 1);
+    }
+
+    cmn::Id id;
+    id.source = source;
+
+    for (uint64_t sequence = relay.from; sequence <= relay.to; ++sequence) {
+      id.sequence = sequence;
+      SendPacket(at, index_.at(Key(id)));
+    }
+  }
+
+  void Announce(uint32_t at) {
+    Node& node = nodes_[at];
+    Message message;
+    message.sender = at;
+
+    for (uint64_t source : node.priority) {
+      if (message.fragment.Size() == config_.fragment_entries) {
+        break;
+      }
+
+      message.fragment.Put(source, node.have.Get(source).value_or(0));
+    }
+
+    node.priority.clear();
+
+    // The rest from a rotating cursor, so periodic announces go over
+    // the whole vector
+    size_t size = node.have.Size();
+
+    for (size_t i = 0;
+         i < size && message.fragment.Size() < config_.fragment_entries;
+         ++i) {
+      size_t entry = (node.cursor + i) % size;
+      message.fragment.Put(node.have.Sources()[entry],
+                           node.have.Progress()[entry]);
+    }
+
+    if (size != 0) {
+      node.cursor = (node.cursor + config_.fragment_entries) % size;
+    }
+
+    message.complete = message.fragment.Dominates(node.have) &&
+                       node.have.Dominates(message.fragment);
+    ++stats_.announce_sends;
+
+    size_t body = message.fragment.TlvSize();
+    Send(at, std::move(message), tlv::HeaderSize('A', body) + body);
+  }
+
+  void SendPacket(uint32_t at, uint64_t packet) {
+    Message message;
+    message.sender = at;
+    message.packet = packet;
+    ++stats_.packet_sends;
+    Send(at, std::move(message), config_.packet_bytes);
+  }
+
+  void Send(uint32_t at, Message message, size_t bytes) {
+    Node& node = nodes_[at];
+    double start = std::max(now_, node.busy_until);
+    node.busy_until = start + bytes / config_.bytes_per_second;
+    stats_.bytes_on_air += bytes;
+
+    size_t index = messages_.size();
+    messages_.push_back(std::move(message));
+
+    for (uint32_t neighbour : node.neighbours) {
+      if (Uniform(1) >= config_.loss) {
+        Schedule(node.busy_until, EventKind::kReceive, neighbour, index);
+      }
+    }
+  }
+
+ private:
+  MeshConfig config_;
+  std::mt19937_64 rng_;
+  MeshStats stats_;
+
+  std::vector<Node> nodes_;
+  std::vector<Packet> packets_;
+  std::unordered_map<uint64_t, size_t> index_;
+  std::vector<Message> messages_;
+
+  std::priority_queue<Event, std::vector<Event>, std::greater<>> events_;
+  uint64_t order_ = 0;
+  double now_ = 0;
+};
+
+}  // namespace
+
+MeshStats Simulate(const MeshConfig& config) {
+  return Simulator(config).Run();
+}
+
+}  // namespace mesh
@@ -0,0 +1,81 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+namespace mesh {
+
+// Announce: the 0a-mesh protocol. Nodes broadcast version vector
+// fragments, never relay a packet unasked; a neighbour that sees it
+// lacks something answers with its own announce, and whoever has the
+// packets it lacks sends them, unless it overhears them first.
+// Flood: the Meshtastic baseline, every node rebroadcasts a new packet
+// once unless it overhears a rebroadcast first; there is no repair,
+// and no causal order either.
+enum class Protocol {
+  kAnnounce,
+  kFlood,
+};
+
+struct MeshConfig {
+  Protocol protocol = Protocol::kAnnounce;
+  uint64_t seed = 1;
+
+  // Nodes on a unit square, each hearing the ones within the radius
+  // that gives this many neighbours on average
+  size_t nodes = 100;
+  double degree = 8;
+  // Per reception, independently
+  double loss = 0.1;
+  // Shared by all nodes, every message is heard after its airtime
+  double bytes_per_second = 12500;
+
+  // Nodes issuing packets, one every interval each
+  size_t sources = 4;
+  size_t packets = 16;
+  size_t packet_bytes = 256;
+  double packet_interval = 1;
+  // Whether a packet refers to the latest one its source got from
+  // another source, a causal dependency on top of the per-source order
+  bool references = true;
+
+  // Version vector entries per announce
+  size_t fragment_entries = 8;
+  // Packets of one source sent in answer to one announce
+  size_t max_relay = 4;
+  // Between the periodic announces of a node, randomized +-50%
+  double announce_period = 10;
+  // Max random delay of answers and rebroadcasts
+  double jitter = 0.5;
+
+  // Simulated seconds before giving up
+  double horizon = 3600;
+};
+
+struct MeshStats {
+  // In the part of the network the sources are connected to
+  size_t nodes = 0;
+  bool converged = false;
+  // Seconds from the first packet until every node has every packet
+  double convergence_time = 0;
+  // Packets held at the end, out of nodes times packets issued
+  size_t delivered = 0;
+  size_t expected = 0;
+
+  size_t packet_sends = 0;
+  size_t announce_sends = 0;
+  size_t bytes_on_air = 0;
+  // Packet sends no receiver took as new
+  size_t redundant_sends = 0;
+  // Packets received by a node that had them
+  size_t duplicate_receptions = 0;
+  size_t events = 0;
+};
+
+// Deterministic for a given config: one random generator, events in
+// (time, scheduling order). Half-duplex nodes send one message at a
+// time; there are no collisions beyond the loss rate. Ends on
+// convergence or at the horizon.
+MeshStats Simulate(const MeshConfig& config);
+
+}  // namespace mesh
@@ -0,0 +1,227 @@
+#include <algorithm>
+#include <cstdlib>
+#include <stdexcept>
+
+#include <ll/merge_heap.hpp>
+#include <ll/zipint.hpp>
+#include <mel/element.hpp>
+
+#include <nz/contribution.hpp>
+
+namespace nz {
+
+namespace {
+
+struct Cursor {
+  const Contributions* contributions;
+  size_t position;
+
+  const Contribution& Head() const {
+    return (*contributions)[position];
+  }
+};
+
+template <size_t (*Size)(const Contribution&),
+          void (*Write)(tlv::BufferWriter&, const Contribution&)>
+ll::Buffer WriteAll(const Contributions& contributions) {
+  size_t size = 0;
+
+  for (const Contribution& contribution : contributions) {
+    size += Size(contribution);
+  }
+
+  tlv::BufferWriter writer;
+  writer.Reserve(size);
+
+  for (const Contribution& contribution : contributions) {
+    Write(writer, contribution);
+  }
+
+  return writer.Extract();
+}
+
+bool BySource(const Contribution& lhs, const Contribution& rhs) {
+  return lhs.source < rhs.source;
+}
+
+mel::Element ElementOf(const Contribution& contribution,
+                       uint8_t (&zipped)[ll::kMaxZipLen]) {
+  size_t size = ll::ZipTo(zipped, int64_t(contribution.value));
+
+  mel::Element element;
+  element.literal = 'I';
+  element.time = {contribution.revision, contribution.source};
+  element.value = {zipped, size};
+  element.record = contribution.record;
+
+  return element;
+}
+
+}  // namespace
+
+Contributions ParseN(ll::Span tlv) {
+  Contributions contributions;
+  contributions.reserve(tlv.size() / 4);
+  tlv::ViewReader reader(tlv);
+
+  while (reader.HasSome()) {
+    tlv::RecordView record = reader.ReadNext();
+
+    if (record.header.literal != 'U' || !ll::IsPairLen(record.body.size())) {
+      throw std::runtime_error("Invalid N record");
+    }
+
+    auto [value, source] = ll::UnzipU64Pair(record.body);
+    contributions.push_back({source, int64_t(value), value, record.Whole()});
+  }
+
+  return contributions;
+}
+
+bool NewerN(const Contribution& lhs, const Contribution& rhs) {
+  return lhs.value > rhs.value;
+}
+
+size_t SizeN(const Contribution& contribution) {
+  if (!contribution.record.empty()) {
+    return contribution.record.size();
+  }
+
+  size_t body = ll::ZipLen(contribution.value, contribution.source);
+  return tlv::HeaderSize('U', body) + body;
+}
+
+void WriteN(tlv::BufferWriter& writer, const Contribution& contribution) {
+  if (!contribution.record.empty()) {
+    writer.WriteRaw(contribution.record);
+    return;
+  }
+
+  uint8_t zipped[ll::kMaxZipLen];
+  size_t size = ll::ZipTo(zipped, contribution.value, contribution.source);
+  writer.WriteRecord('U', {zipped, size});
+}
+
+ll::Buffer TlvN(const Contributions& contributions) {
+  return WriteAll<SizeN, WriteN>(contributions);
+}
+
+Contributions ParseZ(ll::Span tlv) {
+  Contributions contributions;
+  contributions.reserve(tlv.size() / 8);
+  tlv::ViewReader reader(tlv);
+
+  while (reader.HasSome()) {
+    mel::Element element = mel::ReadElement(reader);
+
+    if (element.literal != 'I' || element.value.size() > sizeof(int64_t)) {
+      throw std::runtime_error("Invalid Z record");
+    }
+
+    contributions.push_back({element.time.source, element.time.revision,
+                             uint64_t(ll::UnzipI64(element.value)),
+                             element.record});
+  }
+
+  return contributions;
+}
+
+bool NewerZ(const Contribution& lhs, const Contribution& rhs) {
+  uint64_t lhs_revision = std::abs(lhs.revision);
+  uint64_t rhs_revision = std::abs(rhs.revision);
+
+  if (lhs_revision != rhs_revision) {
+    return lhs_revision > rhs_revision;
+  }
+
+  return int64_t(lhs.value) > int64_t(rhs.value);
+}
+
+size_t SizeZ(const Contribution& contribution) {
+  uint8_t zipped[ll::kMaxZipLen];
+  return mel::ElementSize(ElementOf(contribution, zipped));
+}
+
+void WriteZ(tlv::BufferWriter& writer, const Contribution& contribution) {
+  uint8_t zipped[ll::kMaxZipLen];
+  mel::WriteElement(writer, ElementOf(contribution, zipped));
+}
+
+ll::Buffer TlvZ(const Contributions& contributions) {
+  return WriteAll<SizeZ, WriteZ>(contributions);
+}
+
+uint64_t Sum(const Contributions& contributions) {
+  uint64_t sum = 0;
+
+  for (const Contribution& contribution : contributions) {
+    sum += contribution.value;
+  }
+
+  return sum;
+}
+
+Contributions MergeBySource(std::vector<Contributions> inputs,
+                            NewerFn newer) {
+  std::vector<Cursor> cursors;
+  cursors.reserve(inputs.size());
+
+  size_t total = 0;
+
+  for (Contributions& input : inputs) {
+    if (input.empty()) {
+      continue;
+    }
+
+    if (!std::is_sorted(input.begin(), input.end(), BySource)) {
+      std::stable_sort(input.begin(), input.end(), BySource);
+    }
+
+    total += input.size();
+    cursors.push_back({&input, 0});
+  }
+
+  ll::MergeHeap heap([&cursors](size_t lhs, size_t rhs) {
+    return cursors[lhs].Head().source < cursors[rhs].Head().source;
+  });
+  heap.Reserve(cursors.size());
+
+  for (size_t i = 0; i < cursors.size(); ++i) {
+    heap.Push(i);
+  }
+
+  auto advance = [&]() {
+    Cursor& cursor = cursors[heap.Top()];
+
+    if (++cursor.position < cursor.contributions->size()) {
+      heap.Update();
+    } else {
+      heap.Pop();
+    }
+  };
+
+  Contributions merged;
+  merged.reserve(total);
+
+  while (!heap.IsEmpty()) {
+    Contribution winner = cursors[heap.Top()].Head();
+    advance();
+
+    while (!heap.IsEmpty() &&
+           cursors[heap.Top()].Head().source == winner.source) {
+      const Contribution& contribution = cursors[heap.Top()].Head();
+
+      if (newer(contribution, winner)) {
+        winner = contribution;
+      }
+
+      advance();
+    }
+
+    merged.push_back(winner);
+  }
+
+  return merged;
+}
+
+}  // namespace nz
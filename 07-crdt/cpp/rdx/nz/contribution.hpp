@@ -0,0 +1,47 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include <ll/bytes.hpp>
+#include <tlv/io.hpp>
+
+namespace nz {
+
+// One source's part of a counter. Z values are stored as two's
+// complement, so both counters sum the same way modulo 2^64.
+struct Contribution {
+  uint64_t source = 0;
+  int64_t revision = 0;
+  uint64_t value = 0;
+
+  // The source record, if any; copied verbatim on output
+  ll::Span record;
+};
+
+using Contributions = std::vector<Contribution>;
+
+// N: `U` records of zipped {value, source}; the value is the revision
+Contributions ParseN(ll::Span tlv);
+bool NewerN(const Contribution& lhs, const Contribution& rhs);
+size_t SizeN(const Contribution& contribution);
+void WriteN(tlv::BufferWriter& writer, const Contribution& contribution);
+ll::Buffer TlvN(const Contributions& contributions);
+
+// Z: `I` FIRST elements, LWW per source by revision, then value
+Contributions ParseZ(ll::Span tlv);
+bool NewerZ(const Contribution& lhs, const Contribution& rhs);
+size_t SizeZ(const Contribution& contribution);
+void WriteZ(tlv::BufferWriter& writer, const Contribution& contribution);
+ll::Buffer TlvZ(const Contributions& contributions);
+
+uint64_t Sum(const Contributions& contributions);
+
+using NewerFn = bool (*)(const Contribution&, const Contribution&);
+
+// Single k-way pass over inputs sorted by source (unsorted inputs are
+// sorted first), keeping the newest contribution of every source
+Contributions MergeBySource(std::vector<Contributions> inputs,
+                            NewerFn newer);
+
+}  // namespace nz
@@ -0,0 +1,102 @@
+#include <algorithm>
+
+#include <nz/contribution.hpp>
+#include <nz/counter.hpp>
+
+namespace nz {
+
+namespace {
+
+Contributions SortedBySource(Contributions contributions) {
+  std::sort(contributions.begin(), contributions.end(),
+            [](const Contribution& lhs, const Contribution& rhs) {
+              return lhs.source < rhs.source;
+            });
+  return contributions;
+}
+
+}  // namespace
+
+bool NCounter::Apply(uint64_t source, uint64_t value) {
+  auto [entry, added] = table_.Emplace(source);
+
+  if (!added && entry->value >= value) {
+    return false;
+  }
+
+  sum_ += value - entry->value;
+  entry->value = value;
+
+  return true;
+}
+
+void NCounter::ApplyTlv(ll::Span tlv) {
+  for (const Contribution& contribution : ParseN(tlv)) {
+    Apply(contribution.source, contribution.value);
+  }
+}
+
+uint64_t NCounter::Sum() const {
+  return sum_;
+}
+
+size_t NCounter::Size() const {
+  return table_.Size();
+}
+
+ll::Buffer NCounter::Tlv() const {
+  Contributions contributions;
+  contributions.reserve(Size());
+
+  for (const auto& entry : table_.Entries()) {
+    contributions.push_back(
+        {entry.source, int64_t(entry.value), entry.value, {}});
+  }
+
+  return TlvN(SortedBySource(std::move(contributions)));
+}
+
+bool ZCounter::Apply(uint64_t source, int64_t revision, int64_t value) {
+  auto [entry, added] = table_.Emplace(source);
+  Version& version = entry->value;
+
+  if (!added && !NewerZ({source, revision, uint64_t(value), {}},
+                        {source, version.revision,
+                         uint64_t(version.value), {}})) {
+    return false;
+  }
+
+  sum_ += uint64_t(value) - uint64_t(version.value);
+  version = {revision, value};
+
+  return true;
+}
+
+void ZCounter::ApplyTlv(ll::Span tlv) {
+  for (const Contribution& contribution : ParseZ(tlv)) {
+    Apply(contribution.source, contribution.revision,
+          int64_t(contribution.value));
+  }
+}
+
+int64_t ZCounter::Sum() const {
+  return int64_t(sum_);
+}
+
+size_t ZCounter::Size() const {
+  return table_.Size();
+}
+
+ll::Buffer ZCounter::Tlv() const {
+  Contributions contributions;
+  contributions.reserve(Size());
+
+  for (const auto& entry : table_.Entries()) {
+    contributions.push_back({entry.source, entry.value.revision,
+                             uint64_t(entry.value.value), {}});
+  }
+
+  return TlvZ(SortedBySource(std::move(contributions)));
+}
+
+}  // namespace nz
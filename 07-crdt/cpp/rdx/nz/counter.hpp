@@ -0,0 +1,49 @@
+#pragma once
+
+#include <cstdint>
+
+#include <ll/bytes.hpp>
+#include <nz/flat_table.hpp>
+
+namespace nz {
+
+// Incremental counter states for applying a stream of ops. Every op
+// costs one hash probe, the native sum is kept up to date on the fly.
+class NCounter {
+ public:
+  // Whether the op advanced its source
+  bool Apply(uint64_t source, uint64_t value);
+  void ApplyTlv(ll::Span tlv);
+
+  uint64_t Sum() const;
+  size_t Size() const;
+
+  ll::Buffer Tlv() const;
+
+ private:
+  FlatTable<uint64_t> table_;
+  uint64_t sum_ = 0;
+};
+
+class ZCounter {
+ public:
+  // Whether the op won over the current value of its source
+  bool Apply(uint64_t source, int64_t revision, int64_t value);
+  void ApplyTlv(ll::Span tlv);
+
+  int64_t Sum() const;
+  size_t Size() const;
+
+  ll::Buffer Tlv() const;
+
+ private:
+  struct Version {
+    int64_t revision = 0;
+    int64_t value = 0;
+  };
+
+  FlatTable<Version> table_;
+  uint64_t sum_ = 0;
+};
+
+}  // namespace nz
@@ -0,0 +1,138 @@
+#pragma once
+
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+namespace nz {
+
+// Open addressing hash from a source to a dense entry. Entries stay
+// in insertion order in one array; the slots only hold their indices
+// and are probed linearly, kept at most half full.
+template <class Value>
+class FlatTable {
+ public:
+  struct Entry {
+    uint64_t source = 0;
+    Value value{};
+  };
+
+  FlatTable();
+
+  void Reserve(size_t entries);
+
+  Entry* Find(uint64_t source);
+  const Entry* Find(uint64_t source) const;
+
+  // The entry of the source and whether it was just added
+  std::pair<Entry*, bool> Emplace(uint64_t source);
+
+  size_t Size() const;
+  const std::vector<Entry>& Entries() const;
+
+ private:
+  static constexpr uint32_t kEmpty = UINT32_MAX;
+
+  size_t Slot(uint64_t source) const;
+  void Rehash(size_t slots);
+
+ private:
+  std::vector<Entry> entries_;
+  std::vector<uint32_t> slots_;
+  size_t mask_ = 0;
+};
+
+template <class Value>
+FlatTable<Value>::FlatTable() {
+  Rehash(16);
+}
+
+template <class Value>
+void FlatTable<Value>::Reserve(size_t entries) {
+  entries_.reserve(entries);
+
+  if (2 * entries > slots_.size()) {
+    size_t slots = slots_.size();
+
+    while (2 * entries > slots) {
+      slots *= 2;
+    }
+
+    Rehash(slots);
+  }
+}
+
+template <class Value>
+auto FlatTable<Value>::Find(uint64_t source) -> Entry* {
+  const FlatTable& self = *this;
+  return const_cast<Entry*>(self.Find(source));
+}
+
+template <class Value>
+auto FlatTable<Value>::Find(uint64_t source) const -> const Entry* {
+  for (size_t slot = Slot(source);; slot = (slot + 1) & mask_) {
+    uint32_t index = slots_[slot];
+
+    if (index == kEmpty) {
+      return nullptr;
+    }
+
+    if (entries_[index].source == source) {
+      return &entries_[index];
+    }
+  }
+}
+
+template <class Value>
+auto FlatTable<Value>::Emplace(uint64_t source) -> std::pair<Entry*, bool> {
+  size_t slot = Slot(source);
+
+  for (; slots_[slot] != kEmpty; slot = (slot + 1) & mask_) {
+    if (entries_[slots_[slot]].source == source) {
+      return {&entries_[slots_[slot]], false};
+    }
+  }
+
+  slots_[slot] = entries_.size();
+  entries_.push_back({source, {}});
+
+  if (2 * entries_.size() > slots_.size()) {
+    Rehash(2 * slots_.size());
+  }
+
+  return {&entries_.back(), true};
+}
+
+template <class Value>
+size_t FlatTable<Value>::Size() const {
+  return entries_.size();
+}
+
+template <class Value>
+auto FlatTable<Value>::Entries() const -> const std::vector<Entry>& {
+  return entries_;
+}
+
+// Fibonacci hashing, sources are often small consecutive numbers
+template <class Value>
+size_t FlatTable<Value>::Slot(uint64_t source) const {
+  return (source * 0x9e3779b97f4a7c15) >> 32 & mask_;
+}
+
+template <class Value>
+void FlatTable<Value>::Rehash(size_t slots) {
+  slots_.assign(slots, kEmpty);
+  mask_ = slots - 1;
+
+  for (size_t index = 0; index < entries_.size(); ++index) {
+    size_t slot = Slot(entries_[index].source);
+
+    while (slots_[slot] != kEmpty) {
+      slot = (slot + 1) & mask_;
+    }
+
+    slots_[slot] = index;
+  }
+}
+
+}  // namespace nz
@@ -0,0 +1,66 @@
+#include <cstdlib>
+#include <stdexcept>
+
+#include <nz/contribution.hpp>
+#include <nz/integer.hpp>
+
+namespace nz {
+
+bool Zvalid(ll::Span tlv) {
+  try {
+    ParseZ(tlv);
+  } catch (const std::runtime_error&) {
+    return false;
+  }
+
+  return true;
+}
+
+std::string Zstring(ll::Span tlv) {
+  return std::to_string(Znative(tlv));
+}
+
+// Repeated sources count once, with their newest value
+int64_t Znative(ll::Span tlv) {
+  return int64_t(Sum(MergeBySource({ParseZ(tlv)}, NewerZ)));
+}
+
+ll::Buffer Ztlv(int64_t value, uint64_t source) {
+  return TlvZ({{source, 1, uint64_t(value), {}}});
+}
+
+ll::Buffer Zmerge(const std::vector<ll::Span>& tlvs) {
+  std::vector<Contributions> inputs;
+  inputs.reserve(tlvs.size());
+
+  for (ll::Span tlv : tlvs) {
+    inputs.push_back(ParseZ(tlv));
+  }
+
+  return TlvZ(MergeBySource(std::move(inputs), NewerZ));
+}
+
+ll::Buffer Zdelta(ll::Span tlv, int64_t new_value, uint64_t source) {
+  Contributions contributions = MergeBySource({ParseZ(tlv)}, NewerZ);
+  uint64_t old_value = Sum(contributions);
+
+  if (uint64_t(new_value) == old_value) {
+    return {};
+  }
+
+  Contribution own{source, 0, 0, {}};
+
+  for (const Contribution& contribution : contributions) {
+    if (contribution.source == source) {
+      own = contribution;
+    }
+  }
+
+  own.revision = std::abs(own.revision) + 1;
+  own.value += uint64_t(new_value) - old_value;
+  own.record = {};
+
+  return TlvZ({own});
+}
+
+}  // namespace nz
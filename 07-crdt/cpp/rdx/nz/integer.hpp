@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <ll/bytes.hpp>
+
+namespace nz {
+
+// Z, a two-way counter: per-source LWW, the native value is the sum
+// of all contributions. Deltas overwrite the given source.
+bool Zvalid(ll::Span tlv);
+std::string Zstring(ll::Span tlv);
+int64_t Znative(ll::Span tlv);
+ll::Buffer Ztlv(int64_t value, uint64_t source = 0);
+ll::Buffer Zmerge(const std::vector<ll::Span>& tlvs);
+ll::Buffer Zdelta(ll::Span tlv, int64_t new_value, uint64_t source = 0);
+
+}  // namespace nz
@@ -0,0 +1,67 @@
+#include <stdexcept>
+
+#include <nz/contribution.hpp>
+#include <nz/natural.hpp>
+
+namespace nz {
+
+bool Nvalid(ll::Span tlv) {
+  try {
+    ParseN(tlv);
+  } catch (const std::runtime_error&) {
+    return false;
+  }
+
+  return true;
+}
+
+std::string Nstring(ll::Span tlv) {
+  return std::to_string(Nnative(tlv));
+}
+
+// Repeated sources count once, with their max
+uint64_t Nnative(ll::Span tlv) {
+  return Sum(MergeBySource({ParseN(tlv)}, NewerN));
+}
+
+ll::Buffer Ntlv(uint64_t value, uint64_t source) {
+  return TlvN({{source, int64_t(value), value, {}}});
+}
+
+ll::Buffer Nmerge(const std::vector<ll::Span>& tlvs) {
+  std::vector<Contributions> inputs;
+  inputs.reserve(tlvs.size());
+
+  for (ll::Span tlv : tlvs) {
+    inputs.push_back(ParseN(tlv));
+  }
+
+  return TlvN(MergeBySource(std::move(inputs), NewerN));
+}
+
+ll::Buffer Ndelta(ll::Span tlv, uint64_t new_value, uint64_t source) {
+  Contributions contributions = MergeBySource({ParseN(tlv)}, NewerN);
+  uint64_t old_value = Sum(contributions);
+
+  if (new_value < old_value) {
+    throw std::runtime_error("N can not decrease");
+  }
+
+  if (new_value == old_value) {
+    return {};
+  }
+
+  uint64_t own = 0;
+
+  for (const Contribution& contribution : contributions) {
+    if (contribution.source == source) {
+      own = contribution.value;
+    }
+  }
+
+  own += new_value - old_value;
+
+  return TlvN({{source, int64_t(own), own, {}}});
+}
+
+}  // namespace nz
@@ -0,0 +1,20 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include <ll/bytes.hpp>
+
+namespace nz {
+
+// N, an increment-only counter: per-source max, the native value is
+// the sum of all contributions. Deltas bump the given source.
+bool Nvalid(ll::Span tlv);
+std::string Nstring(ll::Span tlv);
+uint64_t Nnative(ll::Span tlv);
+ll::Buffer Ntlv(uint64_t value, uint64_t source = 0);
+ll::Buffer Nmerge(const std::vector<ll::Span>& tlvs);
+ll::Buffer Ndelta(ll::Span tlv, uint64_t new_value, uint64_t source = 0);
+
+}  // namespace nz
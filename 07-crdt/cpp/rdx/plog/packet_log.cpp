@@ -0,0 +1,430 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <cstdio>
+#include <stdexcept>
+#include <string>
+
+#include <ll/crc32c.hpp>
+#include <ll/merge_heap.hpp>
+#include <ll/zipint.hpp>
+
+#include <plog/packet_log.hpp>
+
+namespace plog {
+
+namespace {
+
+// Every record is followed by the CRC-32C of it, little-endian
+constexpr size_t kChecksumSize = 4;
+
+// The id record, the longest tiny one, the longest header and the
+// checksum
+constexpr size_t kMaxOverhead = 1 + 9 + 5 + kChecksumSize;
+
+std::filesystem::path SegmentPath(const std::filesystem::path& dir,
+                                  uint32_t number) {
+  char name[16];
+  std::snprintf(name, sizeof(name), "%08u.seg", number);
+  return dir / name;
+}
+
+void Check(bool ok, const char* what) {
+  if (!ok) {
+    throw std::runtime_error(what);
+  }
+}
+
+size_t WholeSize(ll::Span bytes) {
+  return tlv::ViewReader(bytes).ReadNext().Whole().size();
+}
+
+bool IsZero(ll::Span bytes) {
+  return std::all_of(bytes.begin(), bytes.end(),
+                     [](uint8_t byte) { return byte == 0; });
+}
+
+// The new segment file is only there once its directory entry is
+void SyncDir(const std::filesystem::path& dir) {
+  int fd = open(dir.c_str(), O_RDONLY | O_DIRECTORY | O_CLOEXEC);
+  Check(fd >= 0, "Cannot open packet log directory");
+  int synced = fsync(fd);
+  close(fd);
+  Check(synced == 0, "Packet log sync failed");
+}
+
+}  // namespace
+
+PacketView ParsePacket(ll::Span bytes) {
+  tlv::ViewReader reader(bytes);
+  tlv::RecordView record = reader.ReadNext();
+  Check(record.header.literal >= 'A' && record.header.literal <= 'Z',
+        "Invalid packet");
+
+  tlv::ViewReader inner(record.body);
+  tlv::RecordView id_record = inner.ReadNext();
+  Check(id_record.header.literal == '0' &&
+            ll::IsPairLen(id_record.body.size()),
+        "Invalid packet id");
+
+  auto [sequence, source] = ll::UnzipU64Pair(id_record.body);
+  Check(sequence <= UINT32_MAX && source < (1 << 20), "Invalid packet id");
+
+  PacketView packet;
+  packet.id.sequence = sequence;
+  packet.id.source = source;
+  packet.literal = record.header.literal;
+  packet.body = inner.Rest();
+
+  return packet;
+}
+
+PacketLog::PacketLog(std::filesystem::path dir, LogOptions options)
+    : dir_(std::move(dir)), options_(options) {
+  Check(options_.segment_bytes >= kMaxPacket + kMaxOverhead &&
+            options_.segment_bytes <= UINT32_MAX,
+        "Invalid segment size");
+
+  std::filesystem::create_directories(dir_);
+  std::vector<uint32_t> numbers;
+
+  for (const auto& entry : std::filesystem::directory_iterator(dir_)) {
+    std::string stem = entry.path().stem().string();
+    uint32_t number = 0;
+
+    if (entry.path().extension() != ".seg" ||
+        std::from_chars(stem.data(), stem.data() + stem.size(), number).ec !=
+            std::errc()) {
+      continue;
+    }
+
+    numbers.push_back(number);
+  }
+
+  std::sort(numbers.begin(), numbers.end());
+
+  for (uint32_t i = 0; i < numbers.size(); ++i) {
+    Check(numbers[i] == i, "Missing packet log segment");
+    OpenSegment(i, false);
+    Recover(i, i + 1 == numbers.size());
+  }
+
+  if (segments_.empty()) {
+    OpenSegment(0, true);
+  }
+
+  pending_.Reserve(options_.commit_bytes + kMaxPacket + kMaxOverhead);
+}
+
+PacketLog::~PacketLog() {
+  try {
+    Commit();
+  } catch (const std::runtime_error&) {
+    // Whatever made it to the disk is recovered on the next open
+  }
+
+  for (size_t i = 0; i < segments_.size(); ++i) {
+    Segment& segment = segments_[i];
+
+    if (i + 1 == segments_.size()) {
+      ftruncate(segment.fd, segment.size);
+    }
+
+    munmap(segment.map, segment.mapped);
+    close(segment.fd);
+  }
+}
+
+Verdict PacketLog::Append(cmn::Id id, char literal, ll::Span body) {
+  Check(id.offset == 0 && literal >= 'A' && literal <= 'Z' &&
+            body.size() <= kMaxPacket,
+        "Invalid packet");
+
+  std::optional<uint64_t> known = progress_.Get(id.source);
+
+  if (known.has_value() && id.sequence <= *known) {
+    return Verdict::kDuplicate;
+  }
+
+  if (id.sequence != (known.has_value() ? *known + 1 : 0)) {
+    return Verdict::kGap;
+  }
+
+  uint8_t zipped[ll::kMaxZipLen];
+  size_t id_size =
+      ll::ZipTo(zipped, uint64_t(id.sequence), uint64_t(id.source));
+  size_t inner = 1 + id_size + body.size();
+  size_t size = tlv::HeaderSize(literal, inner) + inner + kChecksumSize;
+
+  if (segments_.back().size + pending_.Size() + size >
+      options_.segment_bytes) {
+    Rotate();
+  }
+
+  Location location;
+  location.segment = segments_.size() - 1;
+  location.offset = segments_.back().size + pending_.Size();
+
+  size_t start = pending_.Size();
+  pending_.WriteHeader(literal, inner)
+      .WriteRecord('T', {zipped, id_size}, true)
+      .WriteRaw(body);
+
+  uint8_t checksum[kChecksumSize];
+  ll::WriteLittleEndian(checksum,
+                        ll::Crc32c(pending_.View().subspan(start)),
+                        kChecksumSize);
+  pending_.WriteRaw({checksum, kChecksumSize});
+
+  Index(id, location);
+  bytes_ += size;
+
+  if (pending_.Size() >= options_.commit_bytes) {
+    Write();
+  }
+
+  return Verdict::kAppended;
+}
+
+void PacketLog::Commit() {
+  Write();
+
+  if (options_.sync) {
+    Check(fdatasync(segments_.back().fd) == 0, "Packet log sync failed");
+  }
+}
+
+std::optional<PacketView> PacketLog::Get(cmn::Id id) const {
+  const auto* entry = index_.Find(id.source);
+
+  if (entry == nullptr || id.offset != 0 ||
+      id.sequence >= entry->value.size()) {
+    return std::nullopt;
+  }
+
+  return At(entry->value[id.sequence]);
+}
+
+size_t PacketLog::Size() const {
+  return locations_.size();
+}
+
+PacketView PacketLog::At(size_t position) const {
+  return ParsePacket(Record(locations_.at(position)));
+}
+
+ll::Span PacketLog::RecordAt(size_t position) const {
+  ll::Span record = Record(locations_.at(position));
+  return record.first(WholeSize(record));
+}
+
+// A k-way merge of the per-source position lists, each from the first
+// sequence number the vector lacks
+std::vector<uint32_t> PacketLog::Since(const vv::VersionVector& seen) const {
+  struct Cursor {
+    const std::vector<uint32_t>* positions;
+    size_t next;
+
+    uint32_t Head() const {
+      return (*positions)[next];
+    }
+  };
+
+  std::vector<Cursor> cursors;
+  size_t total = 0;
+
+  for (const auto& entry : index_.Entries()) {
+    std::optional<uint64_t> progress = seen.Get(entry.source);
+    uint64_t first = progress.has_value() ? *progress + 1 : 0;
+
+    if (first < entry.value.size()) {
+      cursors.push_back({&entry.value, first});
+      total += entry.value.size() - first;
+    }
+  }
+
+  ll::MergeHeap heap([&cursors](size_t lhs, size_t rhs) {
+    return cursors[lhs].Head() < cursors[rhs].Head();
+  });
+  heap.Reserve(cursors.size());
+
+  for (size_t i = 0; i < cursors.size(); ++i) {
+    heap.Push(i);
+  }
+
+  std::vector<uint32_t> positions;
+  positions.reserve(total);
+
+  while (!heap.IsEmpty()) {
+    Cursor& cursor = cursors[heap.Top()];
+    positions.push_back(cursor.Head());
+
+    if (++cursor.next < cursor.positions->size()) {
+      heap.Update();
+    } else {
+      heap.Pop();
+    }
+  }
+
+  return positions;
+}
+
+const vv::VersionVector& PacketLog::Progress() const {
+  return progress_;
+}
+
+size_t PacketLog::Bytes() const {
+  return bytes_;
+}
+
+// The whole segment is mapped upfront; the file is grown to match, so
+// reads of freshly written packets never fault past its end
+void PacketLog::OpenSegment(uint32_t number, bool fresh) {
+  std::filesystem::path path = SegmentPath(dir_, number);
+  int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+  Check(fd >= 0, "Cannot open packet log segment");
+
+  struct stat info;
+  Check(fstat(fd, &info) == 0, "Cannot open packet log segment");
+
+  Segment segment;
+  segment.fd = fd;
+  segment.size = fresh ? 0 : info.st_size;
+  segment.mapped = std::max<size_t>(options_.segment_bytes, info.st_size);
+
+  if (fresh) {
+    Check(ftruncate(fd, segment.mapped) == 0, "Cannot grow packet log");
+
+    if (options_.sync) {
+      SyncDir(dir_);
+    }
+  }
+
+  void* map = mmap(nullptr, segment.mapped, PROT_READ, MAP_SHARED, fd, 0);
+  Check(map != MAP_FAILED, "Cannot map packet log segment");
+  segment.map = static_cast<uint8_t*>(map);
+
+  segments_.push_back(segment);
+}
+
+// Re-indexes the packets of the segment, up to the first record that
+// does not parse or match its checksum: a torn one, or one whose body
+// never made it to the disk while the header did. The last segment is
+// cut right before it and reopened for appends. Any other one was full
+// and synced, so past its packets it may only have the zeroes of a
+// preallocation whose cut was lost; those are cut too.
+void PacketLog::Recover(uint32_t number, bool last) {
+  Segment& segment = segments_[number];
+  ll::Span data(segment.map, segment.size);
+  size_t offset = 0;
+
+  while (offset < data.size() && data[offset] != 0) {
+    ll::Span rest = data.subspan(offset);
+    PacketView packet;
+    size_t size = 0;
+
+    try {
+      packet = ParsePacket(rest);
+      size = WholeSize(rest);
+    } catch (const std::runtime_error&) {
+      break;
+    }
+
+    if (size + kChecksumSize > rest.size() ||
+        ll::ReadLittleEndian(rest.subspan(size, kChecksumSize)) !=
+            ll::Crc32c(rest.first(size))) {
+      break;
+    }
+
+    std::optional<uint64_t> known = progress_.Get(packet.id.source);
+    Check(packet.id.sequence == (known.has_value() ? *known + 1 : 0),
+          "Packet log out of causal order");
+
+    Index(packet.id, {number, uint32_t(offset)});
+    bytes_ += size + kChecksumSize;
+    offset += size + kChecksumSize;
+  }
+
+  if (!last) {
+    Check(IsZero(data.subspan(offset)), "Corrupt packet log segment");
+
+    if (offset < data.size()) {
+      segment.size = offset;
+      Check(ftruncate(segment.fd, offset) == 0 && fsync(segment.fd) == 0,
+            "Cannot cut packet log");
+    }
+
+    return;
+  }
+
+  // Zero the cut-off tail, then grow the file back to the mapping. The
+  // cut is synced before anything is appended after it, or a crash
+  // could bring the old tail back behind new packets.
+  segment.size = offset;
+  Check(ftruncate(segment.fd, offset) == 0 &&
+            ftruncate(segment.fd, segment.mapped) == 0 &&
+            fsync(segment.fd) == 0,
+        "Cannot grow packet log");
+}
+
+void PacketLog::Index(cmn::Id id, Location location) {
+  auto [entry, added] = index_.Emplace(id.source);
+  entry->value.push_back(uint32_t(locations_.size()));
+  locations_.push_back(location);
+  progress_.Put(id);
+}
+
+void PacketLog::Write() {
+  Segment& segment = segments_.back();
+  ll::Span data = pending_.View();
+
+  while (!data.empty()) {
+    ssize_t written =
+        pwrite(segment.fd, data.data(), data.size(), segment.size);
+
+    if (written < 0 && errno == EINTR) {
+      continue;
+    }
+
+    Check(written > 0, "Packet log write failed");
+    segment.size += written;
+    data = data.subspan(written);
+  }
+
+  ll::Buffer buffer = pending_.Extract();
+  buffer.clear();
+  pending_ = tlv::BufferWriter(std::move(buffer));
+}
+
+// The full segment is cut to its size and synced, the size with it,
+// before the next one gets any packets, so only the last segment can
+// have a torn tail
+void PacketLog::Rotate() {
+  Write();
+  Segment& segment = segments_.back();
+  Check(ftruncate(segment.fd, segment.size) == 0, "Cannot cut packet log");
+
+  if (options_.sync) {
+    Check(fsync(segment.fd) == 0, "Packet log sync failed");
+  }
+
+  OpenSegment(segments_.size(), true);
+}
+
+ll::Span PacketLog::Record(Location location) const {
+  const Segment& segment = segments_[location.segment];
+
+  if (location.segment + 1 == segments_.size() &&
+      location.offset >= segment.size) {
+    return pending_.View().subspan(location.offset - segment.size);
+  }
+
+  return {segment.map + location.offset, segment.mapped - location.offset};
+}
+
+}  // namespace plog
@@ -0,0 +1,126 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <vector>
+
+#include <ll/bytes.hpp>
+#include <tlv/io.hpp>
+#include <cmn/id.hpp>
+#include <nz/flat_table.hpp>
+#include <vv/vv.hpp>
+
+namespace plog {
+
+// A packet body is at most a page
+constexpr size_t kMaxPacket = 4096;
+
+struct LogOptions {
+  // A segment file is preallocated to this size and mapped whole
+  size_t segment_bytes = 64 << 20;
+  // Appended bytes buffered before they are written out
+  size_t commit_bytes = 1 << 20;
+  // Whether Commit() waits for the disk
+  bool sync = true;
+};
+
+struct PacketView {
+  cmn::Id id;
+  char literal = 0;
+  ll::Span body;
+};
+
+// Throws on a record that is not a packet
+PacketView ParsePacket(ll::Span record);
+
+enum class Verdict {
+  kAppended,
+  // Already in the log
+  kDuplicate,
+  // The previous packet of the source is missing
+  kGap,
+};
+
+// An append-only log of packets in segment files 00000000.seg, ...
+// Every packet is one TLV record of its literal, the body being the
+// packet id as a tiny record followed by the packet body, and then the
+// CRC-32C of the record, four bytes little-endian. Packets are
+// accepted in causal order only: a-b needs a-(b-1) unless b is 0, as
+// tracked by the version vector of the log. Appends are buffered and
+// go to the disk in one write, Commit() makes them durable with one
+// fsync for the whole group. Reads are views into the mapped segments,
+// a packet is found by its id through a dense per-source index.
+class PacketLog {
+ public:
+  // Opens or creates the log in the directory. A torn record at the
+  // end of the last segment, as left by a crash, is cut off, and so is
+  // one failing its checksum with everything after it.
+  explicit PacketLog(std::filesystem::path dir, LogOptions options = {});
+  ~PacketLog();
+
+  PacketLog(const PacketLog&) = delete;
+  PacketLog& operator=(const PacketLog&) = delete;
+
+  // Throws on an id with an offset, a literal that is not A-Z or a body
+  // over kMaxPacket
+  Verdict Append(cmn::Id id, char literal, ll::Span body);
+
+  // Writes out and syncs everything appended
+  void Commit();
+
+  // Views of committed packets live as long as the log, the ones
+  // still buffered until the next Append() or Commit()
+  std::optional<PacketView> Get(cmn::Id id) const;
+
+  // Packets in the log order, which is a causal order
+  size_t Size() const;
+  PacketView At(size_t position) const;
+  // The packet record as stored, to be passed on as is
+  ll::Span RecordAt(size_t position) const;
+
+  // Log positions of the packets beyond the vector, in the log order
+  std::vector<uint32_t> Since(const vv::VersionVector& seen) const;
+
+  const vv::VersionVector& Progress() const;
+  size_t Bytes() const;
+
+ private:
+  struct Location {
+    uint32_t segment = 0;
+    uint32_t offset = 0;
+  };
+
+  struct Segment {
+    int fd = -1;
+    uint8_t* map = nullptr;
+    size_t mapped = 0;
+    // Bytes in the file, not counting the buffered ones
+    size_t size = 0;
+  };
+
+  void OpenSegment(uint32_t number, bool fresh);
+  void Recover(uint32_t number, bool last);
+  void Index(cmn::Id id, Location location);
+
+  void Write();
+  void Rotate();
+
+  ll::Span Record(Location location) const;
+
+ private:
+  std::filesystem::path dir_;
+  LogOptions options_;
+
+  std::vector<Segment> segments_;
+  tlv::BufferWriter pending_;
+
+  vv::VersionVector progress_;
+  // Log order
+  std::vector<Location> locations_;
+  // Per source, the log position of every sequence number
+  nz::FlatTable<std::vector<uint32_t>> index_;
+  size_t bytes_ = 0;
+};
+
+}  // namespace plog
@@ -0,0 +1,223 @@
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <charconv>
+#include <cstring>
+#include <fstream>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+#include <ll/arena.hpp>
+#include <ll/zipint.hpp>
+#include <isfr/types.hpp>
+#include <nz/integer.hpp>
+#include <nz/natural.hpp>
+
+#include <replay/corpus.hpp>
+
+namespace replay {
+
+namespace {
+
+constexpr char kMagic[8] = {'R', 'D', 'X', 'R', 'P', 'L', 'A', 'Y'};
+
+// Op bytes buffered before a write
+constexpr size_t kWriteBytes = 1 << 20;
+
+void Check(bool ok, const char* what) {
+  if (!ok) {
+    throw std::runtime_error(what);
+  }
+}
+
+void WriteHeader(uint8_t* out, const CorpusHeader& header) {
+  std::memcpy(out, kMagic, sizeof(kMagic));
+  ll::WriteLittleEndian(out + 8, header.ops, 8);
+  ll::WriteLittleEndian(out + 16, header.fields, 8);
+  ll::WriteLittleEndian(out + 24, header.seed, 8);
+  ll::WriteLittleEndian(out + 32, header.replicas, 4);
+  ll::WriteLittleEndian(out + 36, header.conflicts_ppm, 4);
+}
+
+CorpusHeader ReadHeader(ll::Span bytes) {
+  Check(bytes.size() >= kHeaderSize &&
+            std::memcmp(bytes.data(), kMagic, sizeof(kMagic)) == 0,
+        "Not a replay corpus");
+
+  CorpusHeader header;
+  header.ops = ll::ReadLittleEndian(bytes.subspan(8, 8));
+  header.fields = ll::ReadLittleEndian(bytes.subspan(16, 8));
+  header.seed = ll::ReadLittleEndian(bytes.subspan(24, 8));
+  header.replicas = ll::ReadLittleEndian(bytes.subspan(32, 4));
+  header.conflicts_ppm = ll::ReadLittleEndian(bytes.subspan(36, 4));
+  return header;
+}
+
+void WriteOp(tlv::BufferWriter& writer, cmn::Id field, char literal,
+             ll::Span body) {
+  uint8_t zipped[ll::kMaxZipLen * 2];
+  size_t size = cmn::ZipTo(zipped, field);
+
+  writer.WriteHeader(literal,
+                     tlv::HeaderSize('T', size, true) + size + body.size());
+  writer.WriteRecord('T', {zipped, size}, true);
+  writer.WriteRaw(body);
+}
+
+}  // namespace
+
+void Generate(const std::filesystem::path& path,
+              const CorpusOptions& options) {
+  Check(options.replicas != 0 && !options.literals.empty() &&
+            options.conflict_rate >= 0 && options.conflict_rate <= 1,
+        "Invalid corpus options");
+
+  for (char literal : options.literals) {
+    Check(literal != '\0' && std::strchr("ISNZ", literal) != nullptr,
+          "Invalid corpus field type");
+  }
+
+  CorpusHeader header;
+  header.ops = options.ops;
+  header.fields = options.fields != 0
+                      ? options.fields
+                      : std::max<uint64_t>(1, options.ops / 16);
+  header.seed = options.seed;
+  header.replicas = options.replicas;
+  header.conflicts_ppm = uint32_t(options.conflict_rate * 1'000'000);
+  Check(header.fields <= UINT32_MAX, "Too many corpus fields");
+
+  std::ofstream file(path, std::ios::binary | std::ios::trunc);
+  uint8_t bytes[kHeaderSize];
+  WriteHeader(bytes, header);
+  file.write(reinterpret_cast<const char*>(bytes), sizeof(bytes));
+
+  std::mt19937_64 rng(options.seed);
+  std::bernoulli_distribution conflict(options.conflict_rate);
+  // The last register revision of every field
+  std::vector<uint32_t> revisions(header.fields);
+  ll::Arena arena;
+  ll::Buffer buffer;
+
+  for (uint64_t i = 0; i < options.ops;) {
+    tlv::BufferWriter writer(std::move(buffer));
+
+    for (; i < options.ops && writer.Size() < kWriteBytes; ++i) {
+      uint64_t index = rng() % header.fields;
+      uint64_t replica = 1 + rng() % options.replicas;
+      char literal = options.literals[index % options.literals.size()];
+      cmn::Id field{1, uint32_t(index), 0};
+
+      if (literal == 'N') {
+        WriteOp(writer, field, literal, nz::Ntlv(i + 1, replica));
+        continue;
+      }
+
+      if (literal == 'Z') {
+        int64_t value = rng() % 2 == 0 ? int64_t(i + 1) : -int64_t(i + 1);
+        WriteOp(writer, field, literal, nz::Ztlv(value, replica));
+        continue;
+      }
+
+      uint32_t& revision = revisions[index];
+
+      if (revision == 0 || !conflict(rng)) {
+        ++revision;
+      }
+
+      uint8_t scratch[ll::kMaxZipLen];
+      char text[24] = {'s'};
+      ll::Span value;
+
+      if (literal == 'I') {
+        value = {scratch, ll::ZipTo(scratch, int64_t(rng() % 1000))};
+      } else {
+        char* end = std::to_chars(text + 1, text + sizeof(text), i, 16).ptr;
+        value = {reinterpret_cast<const uint8_t*>(text), size_t(end - text)};
+      }
+
+      WriteOp(writer, field, literal,
+              isfr::Tlvt(value, {int64_t(revision), replica}, arena));
+      arena.Reset();
+    }
+
+    buffer = writer.Extract();
+    file.write(reinterpret_cast<const char*>(buffer.data()), buffer.size());
+    buffer.clear();
+  }
+
+  file.close();
+  Check(!file.fail(), "Cannot write replay corpus");
+}
+
+OpReader::OpReader(ll::Span ops) : reader_(ops) {
+}
+
+bool OpReader::Next(Op& op) {
+  if (!reader_.HasSome()) {
+    return false;
+  }
+
+  tlv::RecordView record = reader_.ReadNext();
+  tlv::ViewReader inner(record.body);
+  Check(inner.HasSome(), "Invalid replay op");
+
+  tlv::RecordView id = inner.ReadNext();
+  Check(id.header.literal == '0', "Invalid replay op id");
+
+  op.field = cmn::UnzipID(id.body);
+  op.literal = record.header.literal;
+  op.body = inner.Rest();
+  return true;
+}
+
+Corpus::Corpus(const std::filesystem::path& path) {
+  int fd = open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  Check(fd >= 0, "Cannot open replay corpus");
+
+  struct stat info;
+  bool ok = fstat(fd, &info) == 0 && size_t(info.st_size) >= kHeaderSize;
+  void* map = MAP_FAILED;
+
+  if (ok) {
+    size_ = info.st_size;
+    map = mmap(nullptr, size_, PROT_READ, MAP_PRIVATE, fd, 0);
+  }
+
+  close(fd);
+  Check(ok, "Not a replay corpus");
+  Check(map != MAP_FAILED, "Cannot map replay corpus");
+  map_ = static_cast<uint8_t*>(map);
+
+  // Replays read the ops once, front to back
+  madvise(map_, size_, MADV_SEQUENTIAL);
+
+  try {
+    header_ = ReadHeader({map_, size_});
+  } catch (...) {
+    munmap(map_, size_);
+    throw;
+  }
+}
+
+Corpus::~Corpus() {
+  munmap(map_, size_);
+}
+
+const CorpusHeader& Corpus::Header() const {
+  return header_;
+}
+
+ll::Span Corpus::Ops() const {
+  return ll::Span(map_, size_).subspan(kHeaderSize);
+}
+
+OpReader Corpus::Read() const {
+  return OpReader(Ops());
+}
+
+}  // namespace replay
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+
+#include <ll/bytes.hpp>
+#include <tlv/io.hpp>
+#include <cmn/id.hpp>
+
+namespace replay {
+
+// A replay corpus is a file of ops to profile the merges with at
+// realistic sizes. A 40-byte header, then one TLV record per op: the
+// record literal is the field type, the body a tiny record of the
+// zipped field id followed by the op, a bare record body as the store
+// takes it. The same options always make the same bytes.
+//
+// Header, little-endian: "RDXRPLAY", ops, fields, seed (u64 each),
+// replicas, conflicts per million (u32 each).
+
+constexpr size_t kHeaderSize = 40;
+
+struct CorpusOptions {
+  uint64_t ops = 1'000'000;
+  uint32_t replicas = 8;
+  // 0 for one field per 16 ops
+  uint64_t fields = 0;
+  // Share of register writes concurrent to the last write of their
+  // field: same revision, another replica. Counters never conflict.
+  double conflict_rate = 0.05;
+  uint64_t seed = 1;
+  // Field types, the type of field f being literals[f % size]; any of
+  // I, S, N, Z
+  std::string literals = "INZS";
+};
+
+struct CorpusHeader {
+  uint64_t ops = 0;
+  uint64_t fields = 0;
+  uint64_t seed = 0;
+  uint32_t replicas = 0;
+  uint32_t conflicts_ppm = 0;
+};
+
+struct Op {
+  cmn::Id field;
+  char literal = 0;
+  ll::Span body;
+};
+
+// Writes the corpus in one streaming pass; throws on bad options or a
+// failed write
+void Generate(const std::filesystem::path& path,
+              const CorpusOptions& options);
+
+// Reads ops off an op stream; throws on a record that is not an op
+class OpReader {
+ public:
+  explicit OpReader(ll::Span ops);
+
+  bool Next(Op& op);
+
+ private:
+  tlv::ViewReader reader_;
+};
+
+// A corpus file mapped read-only, the ops being views into the map.
+// Throws on a file that is not a corpus.
+class Corpus {
+ public:
+  explicit Corpus(const std::filesystem::path& path);
+  ~Corpus();
+
+  Corpus(const Corpus&) = delete;
+  Corpus& operator=(const Corpus&) = delete;
+
+  const CorpusHeader& Header() const;
+  // The op stream past the header
+  ll::Span Ops() const;
+  OpReader Read() const;
+
+ private:
+  CorpusHeader header_;
+  uint8_t* map_ = nullptr;
+  size_t size_ = 0;
+};
+
+}  // namespace replay
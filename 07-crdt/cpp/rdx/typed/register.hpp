@@ -0,0 +1,144 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdlib>
+#include <span>
+#include <stdexcept>
+#include <string>
+
+#include <ll/bytes.hpp>
+#include <ll/zipint.hpp>
+#include <tlv/io.hpp>
+#include <isfr/types.hpp>
+
+#include <typed/traits.hpp>
+
+namespace typed {
+
+// A FIRST register with its type fixed at compile time. Parsing,
+// merging and writing go straight through Traits<T>, so there is no
+// literal dispatch and no intermediate ll::Bytes. The wire format and
+// the merge order are the ones of isfr::*merge.
+template <class T>
+class Register {
+ public:
+  static constexpr char kLiteral = Traits<T>::kLiteral;
+
+  Register() = default;
+
+  explicit Register(T value, isfr::Time time = {})
+      : value_(std::move(value)), time_(time) {
+  }
+
+  static Register Parse(ll::Span tlv) {
+    auto [time, bytes] = isfr::ParseView(tlv);
+
+    if (!Valid(bytes)) {
+      throw std::runtime_error("Invalid FIRST value");
+    }
+
+    return Register(Traits<T>::Decode(bytes), time);
+  }
+
+  static bool Valid(ll::Span bytes) {
+    if constexpr (Traits<T>::kMaxWidth == 0) {
+      return true;
+    } else if constexpr (kLiteral == 'R') {
+      return ll::IsPairLen(bytes.size());
+    } else {
+      return bytes.size() <= Traits<T>::kMaxWidth;
+    }
+  }
+
+  const T& Value() const {
+    return value_;
+  }
+
+  isfr::Time Time() const {
+    return time_;
+  }
+
+  // (|revision|, value bytes, source), highest wins
+  bool NewerThan(const Register& other) const {
+    uint64_t revision = std::abs(time_.revision);
+    uint64_t other_revision = std::abs(other.time_.revision);
+
+    if (revision != other_revision) {
+      return revision > other_revision;
+    }
+
+    uint8_t scratch[ll::kMaxZipLen];
+    uint8_t other_scratch[ll::kMaxZipLen];
+    ll::Span bytes = Traits<T>::Encode(value_, scratch);
+    ll::Span other_bytes = Traits<T>::Encode(other.value_, other_scratch);
+
+    if (!std::ranges::equal(bytes, other_bytes)) {
+      return std::ranges::lexicographical_compare(other_bytes, bytes);
+    }
+
+    return time_.source > other.time_.source;
+  }
+
+  Register& Merge(const Register& other) {
+    if (other.NewerThan(*this)) {
+      *this = other;
+    }
+
+    time_.revision = std::abs(time_.revision);
+    return *this;
+  }
+
+  static Register Merge(std::span<const ll::Span> tlvs) {
+    Register merged;
+
+    for (ll::Span tlv : tlvs) {
+      merged.Merge(Parse(tlv));
+    }
+
+    return merged;
+  }
+
+  Register Delta(T new_value) const {
+    return Register(std::move(new_value),
+                    {std::abs(time_.revision) + 1, 0});
+  }
+
+  size_t TlvSize() const {
+    uint8_t zipped[ll::kMaxZipLen];
+    size_t time = ll::ZipTo(zipped, time_.revision, time_.source);
+    return tlv::HeaderSize('T', time, true) + time +
+           Traits<T>::Encode(value_, zipped).size();
+  }
+
+  template <class Writer>
+  void WriteTlv(Writer& writer) const {
+    uint8_t zipped[ll::kMaxZipLen];
+    size_t size = ll::ZipTo(zipped, time_.revision, time_.source);
+    writer.WriteRecord('T', {zipped, size}, true);
+
+    uint8_t scratch[ll::kMaxZipLen];
+    writer.WriteRaw(Traits<T>::Encode(value_, scratch));
+  }
+
+  ll::Buffer Tlv() const {
+    tlv::BufferWriter writer;
+    writer.Reserve(TlvSize());
+    WriteTlv(writer);
+    return writer.Extract();
+  }
+
+  std::string String() const {
+    return Traits<T>::String(value_);
+  }
+
+ private:
+  T value_{};
+  isfr::Time time_;
+};
+
+using IRegister = Register<int64_t>;
+using FRegister = Register<double>;
+using RRegister = Register<cmn::Id>;
+using SRegister = Register<std::string>;
+
+}  // namespace typed
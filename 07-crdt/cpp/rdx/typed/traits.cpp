@@ -0,0 +1,34 @@
+#include <isfr/types.hpp>
+#include <txt/text.hpp>
+
+#include <typed/traits.hpp>
+
+namespace typed {
+
+std::string Traits<int64_t>::String(const int64_t& value) {
+  return std::to_string(value);
+}
+
+std::string Traits<double>::String(const double& value) {
+  std::string text;
+  txt::AppendFloat(text, value);
+  return text;
+}
+
+ll::Span Traits<cmn::Id>::Encode(const cmn::Id& value, uint8_t* scratch) {
+  return {scratch, cmn::ZipTo(scratch, value)};
+}
+
+cmn::Id Traits<cmn::Id>::Decode(ll::Span bytes) {
+  return cmn::UnzipID(bytes);
+}
+
+std::string Traits<cmn::Id>::String(const cmn::Id& value) {
+  return cmn::ToString(value);
+}
+
+std::string Traits<std::string>::String(const std::string& value) {
+  return isfr::Squote(value);
+}
+
+}  // namespace typed
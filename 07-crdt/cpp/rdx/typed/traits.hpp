@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstdint>
+#include <string>
+
+#include <ll/bytes.hpp>
+#include <ll/zipint.hpp>
+#include <cmn/id.hpp>
+
+namespace typed {
+
+// Compile-time description of a FIRST value type: the TLV literal,
+// the widest zipped form (0 if unbounded) and the wire encoding.
+// Encode() zips into `scratch` (kMaxZipLen bytes) or returns a view
+// of the value itself; the bytes also define the value order in LWW
+// merges, same as in isfr.
+template <class T>
+struct Traits;
+
+template <>
+struct Traits<int64_t> {
+  static constexpr char kLiteral = 'I';
+  static constexpr size_t kMaxWidth = sizeof(int64_t);
+
+  static ll::Span Encode(const int64_t& value, uint8_t* scratch) {
+    return {scratch, ll::ZipTo(scratch, value)};
+  }
+
+  static int64_t Decode(ll::Span bytes) {
+    return ll::UnzipI64(bytes);
+  }
+
+  static std::string String(const int64_t& value);
+};
+
+template <>
+struct Traits<double> {
+  static constexpr char kLiteral = 'F';
+  static constexpr size_t kMaxWidth = sizeof(double);
+
+  static ll::Span Encode(const double& value, uint8_t* scratch) {
+    return {scratch, ll::ZipTo(scratch, value)};
+  }
+
+  static double Decode(ll::Span bytes) {
+    return ll::UnzipDouble(bytes);
+  }
+
+  static std::string String(const double& value);
+};
+
+template <>
+struct Traits<cmn::Id> {
+  static constexpr char kLiteral = 'R';
+  static constexpr size_t kMaxWidth = ll::kMaxZipLen;
+
+  static ll::Span Encode(const cmn::Id& value, uint8_t* scratch);
+  static cmn::Id Decode(ll::Span bytes);
+  static std::string String(const cmn::Id& value);
+};
+
+template <>
+struct Traits<std::string> {
+  static constexpr char kLiteral = 'S';
+  static constexpr size_t kMaxWidth = 0;
+
+  static ll::Span Encode(const std::string& value, uint8_t*) {
+    return {reinterpret_cast<const uint8_t*>(value.data()), value.size()};
+  }
+
+  static std::string Decode(ll::Span bytes) {
+    return {bytes.begin(), bytes.end()};
+  }
+
+  static std::string String(const std::string& value);
+};
+
+// The reverse mapping, from a literal to its native type
+template <char Literal>
+struct Native;
+
+template <>
+struct Native<'I'> {
+  using Type = int64_t;
+};
+
+template <>
+struct Native<'F'> {
+  using Type = double;
+};
+
+template <>
+struct Native<'R'> {
+  using Type = cmn::Id;
+};
+
+template <>
+struct Native<'S'> {
+  using Type = std::string;
+};
+
+template <char Literal>
+using NativeType = typename Native<Literal>::Type;
+
+// Widest zipped value per literal, 0 for unbounded or non-FIRST
+constexpr size_t MaxWidth(char literal) {
+  switch (literal) {
+    case 'I':
+      return Traits<NativeType<'I'>>::kMaxWidth;
+    case 'F':
+      return Traits<NativeType<'F'>>::kMaxWidth;
+    case 'R':
+      return Traits<NativeType<'R'>>::kMaxWidth;
+    default:
+      return 0;
+  }
+}
+
+static_assert(MaxWidth('I') == 8 && MaxWidth('R') == 16);
+static_assert(Traits<NativeType<'I'>>::kLiteral == 'I');
+static_assert(Traits<NativeType<'F'>>::kLiteral == 'F');
+static_assert(Traits<NativeType<'R'>>::kLiteral == 'R');
+static_assert(Traits<NativeType<'S'>>::kLiteral == 'S');
+
+}  // namespace typed
@@ -0,0 +1,328 @@
+#include <string_view>
+
+#include <ll/zipint.hpp>
+#include <tlv/record.hpp>
+#include <txt/text.hpp>
+#include <mel/element.hpp>
+
+#include <valid/validator.hpp>
+
+namespace valid {
+
+namespace {
+
+bool IsFirst(char literal) {
+  return literal == 'F' || literal == 'I' || literal == 'R' ||
+         literal == 'S' || literal == 'T';
+}
+
+// Same header rules as tlv::ViewReader, reporting instead of throwing
+const char* ReadRecord(ll::Span& rest, tlv::RecordView& record) {
+  uint8_t lead = rest[0];
+  tlv::Header header;
+
+  if ('0' <= lead && lead <= '9') {
+    header = {'0', 1, size_t(lead - '0')};
+  } else if ('a' <= lead && lead <= 'z') {
+    if (rest.size() < 2) {
+      return "truncated header";
+    }
+
+    header = {char(lead - 32), 2, rest[1]};
+  } else if ('A' <= lead && lead <= 'Z') {
+    if (rest.size() < 5) {
+      return "truncated header";
+    }
+
+    header = {char(lead), 5, ll::ReadLittleEndian(rest.subspan(1, 4))};
+  } else {
+    return "bad record type";
+  }
+
+  if (rest.size() - header.header_size < header.body_size) {
+    return "truncated record";
+  }
+
+  record = {header, rest.subspan(header.header_size, header.body_size)};
+  rest = rest.subspan(header.header_size + header.body_size);
+
+  return nullptr;
+}
+
+class Validator {
+ public:
+  explicit Validator(const uint8_t* base)
+      : base_(base) {
+  }
+
+  std::optional<Error> Stream(ll::Span tlv) {
+    while (!tlv.empty()) {
+      tlv::RecordView record;
+
+      if (const char* reason = ReadRecord(tlv, record)) {
+        return Fail(tlv.data(), reason);
+      }
+
+      if (auto error = Body(record.header.literal, record.body)) {
+        return error;
+      }
+    }
+
+    return std::nullopt;
+  }
+
+  std::optional<Error> Body(char literal, ll::Span body) {
+    switch (literal) {
+      case 'E':
+        return Set(body);
+      case 'M':
+        return Map(body);
+      case 'L':
+        return Array(body);
+      case 'N':
+        return Natural(body);
+      case 'Z':
+        return Integer(body);
+      case 'V':
+        return Vector(body);
+      default:
+        if (IsFirst(literal)) {
+          mel::Element element;
+          return First(literal, body, element);
+        }
+
+        return Fail(body.data(), "unknown type");
+    }
+  }
+
+ private:
+  std::optional<Error> Fail(const uint8_t* at, const char* reason) const {
+    return Error{size_t(at - base_), reason};
+  }
+
+  // Runs `check` on every record of the body
+  template <class Check>
+  std::optional<Error> Records(ll::Span body, Check check) {
+    while (!body.empty()) {
+      const uint8_t* at = body.data();
+      tlv::RecordView record;
+
+      if (const char* reason = ReadRecord(body, record)) {
+        return Fail(at, reason);
+      }
+
+      if (auto error = check(record, at)) {
+        return error;
+      }
+    }
+
+    return std::nullopt;
+  }
+
+  // A timestamp record, then the value
+  std::optional<Error> First(char literal, ll::Span body,
+                             mel::Element& element) {
+    if (body.empty()) {
+      return Fail(body.data(), "missing timestamp");
+    }
+
+    tlv::RecordView time;
+
+    if (const char* reason = ReadRecord(body, time)) {
+      return Fail(body.data(), reason);
+    }
+
+    if (time.header.literal != '0' && time.header.literal != 'T') {
+      return Fail(time.Whole().data(), "missing timestamp");
+    }
+
+    if (!ll::IsMinimalPair(time.body)) {
+      return Fail(time.body.data(), "overlong timestamp");
+    }
+
+    auto [revision, source] = ll::UnzipIU64Pair(time.body);
+    element.literal = literal;
+    element.time = {revision, source};
+    element.value = body;
+
+    switch (literal) {
+      case 'F':
+      case 'I':
+        if (!ll::IsMinimal(body)) {
+          return Fail(body.data(), "overlong zipint");
+        }
+        break;
+      case 'R':
+        if (!ll::IsMinimalPair(body)) {
+          return Fail(body.data(), "overlong id");
+        }
+        break;
+      case 'S': {
+        size_t bad = txt::FindInvalidUtf8(
+            {reinterpret_cast<const char*>(body.data()), body.size()});
+
+        if (bad != std::string_view::npos) {
+          return Fail(body.data() + bad, "invalid UTF-8");
+        }
+        break;
+      }
+      default:
+        if (!body.empty()) {
+          return Fail(body.data(), "T with a value");
+        }
+    }
+
+    return std::nullopt;
+  }
+
+  std::optional<Error> FirstElement(const tlv::RecordView& record,
+                                    const uint8_t* at,
+                                    mel::Element& element) {
+    if (!IsFirst(record.header.literal)) {
+      return Fail(at, "not a FIRST element");
+    }
+
+    return First(record.header.literal, record.body, element);
+  }
+
+  std::optional<Error> Set(ll::Span body) {
+    mel::Element prev;
+    bool first = true;
+
+    return Records(body, [&](const tlv::RecordView& record,
+                             const uint8_t* at) -> std::optional<Error> {
+      mel::Element element;
+
+      if (auto error = FirstElement(record, at, element)) {
+        return error;
+      }
+
+      if (!first && mel::Compare(prev, element) >= 0) {
+        return Fail(at, "E elements out of order");
+      }
+
+      prev = element;
+      first = false;
+      return std::nullopt;
+    });
+  }
+
+  std::optional<Error> Map(ll::Span body) {
+    mel::Element prev;
+    bool first = true;
+    bool is_key = true;
+
+    auto result = Records(body, [&](const tlv::RecordView& record,
+                                   const uint8_t* at) -> std::optional<Error> {
+      mel::Element element;
+
+      if (auto error = FirstElement(record, at, element)) {
+        return error;
+      }
+
+      if (is_key && !first && mel::Compare(prev, element) >= 0) {
+        return Fail(at, "M keys out of order");
+      }
+
+      if (is_key) {
+        prev = element;
+        first = false;
+      }
+
+      // Removed keys come without a value
+      is_key = !is_key || element.IsTombstone();
+      return std::nullopt;
+    });
+
+    if (!result && !is_key) {
+      return Fail(body.data() + body.size(), "M key without a value");
+    }
+
+    return result;
+  }
+
+  // Elements and the R attachments of patches
+  std::optional<Error> Array(ll::Span body) {
+    return Records(body, [&](const tlv::RecordView& record,
+                             const uint8_t* at) -> std::optional<Error> {
+      if (record.header.literal == 'R') {
+        if (!ll::IsMinimalPair(record.body)) {
+          return Fail(record.body.data(), "overlong id");
+        }
+
+        return std::nullopt;
+      }
+
+      mel::Element element;
+      return FirstElement(record, at, element);
+    });
+  }
+
+  std::optional<Error> Natural(ll::Span body) {
+    return Records(body, [&](const tlv::RecordView& record,
+                             const uint8_t* at) -> std::optional<Error> {
+      if (record.header.literal != 'U') {
+        return Fail(at, "N expects U records");
+      }
+
+      if (!ll::IsMinimalPair(record.body)) {
+        return Fail(record.body.data(), "overlong zipint");
+      }
+
+      return std::nullopt;
+    });
+  }
+
+  std::optional<Error> Integer(ll::Span body) {
+    return Records(body, [&](const tlv::RecordView& record,
+                             const uint8_t* at) -> std::optional<Error> {
+      if (record.header.literal != 'I') {
+        return Fail(at, "Z expects I records");
+      }
+
+      mel::Element element;
+      return First('I', record.body, element);
+    });
+  }
+
+  // Sorted by source, the order vv::VersionVector writes
+  std::optional<Error> Vector(ll::Span body) {
+    uint64_t prev = 0;
+    bool first = true;
+
+    return Records(body, [&](const tlv::RecordView& record,
+                             const uint8_t* at) -> std::optional<Error> {
+      if (record.header.literal != 'V') {
+        return Fail(at, "V expects V records");
+      }
+
+      if (!ll::IsMinimalPair(record.body)) {
+        return Fail(record.body.data(), "overlong id");
+      }
+
+      uint64_t source = ll::UnzipU64Pair(record.body).second;
+
+      if (!first && prev >= source) {
+        return Fail(at, "V sources out of order");
+      }
+
+      prev = source;
+      first = false;
+      return std::nullopt;
+    });
+  }
+
+  const uint8_t* base_;
+};
+
+}  // namespace
+
+std::optional<Error> Validate(ll::Span tlv) {
+  return Validator(tlv.data()).Stream(tlv);
+}
+
+std::optional<Error> ValidateBody(char literal, ll::Span body) {
+  return Validator(body.data()).Body(literal, body);
+}
+
+}  // namespace valid
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <optional>
+
+#include <ll/bytes.hpp>
+
+namespace valid {
+
+struct Error {
+  // From the start of the validated bytes
+  size_t offset = 0;
+  const char* reason = "";
+};
+
+// Checks a whole packet or file of enveloped RDX records (F, I, R, S,
+// T, N, Z, E, M, L, V) in one pass without copying or throwing:
+// TLV framing, overlong zipints, UTF-8 of S values, and the value
+// order of E elements, M keys and V sources. Returns the first error.
+std::optional<Error> Validate(ll::Span tlv);
+
+// Same, for the bare body of one record of the given type
+std::optional<Error> ValidateBody(char literal, ll::Span body);
+
+}  // namespace valid
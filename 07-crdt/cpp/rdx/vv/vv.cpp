@@ -0,0 +1,354 @@
+#include <algorithm>
+#include <numeric>
+#include <stdexcept>
+
+#include <ll/zipint.hpp>
+
+#include <vv/vv.hpp>
+
+namespace vv {
+
+namespace {
+
+// cmn keeps the offset above the sequence in the zipped progress
+uint64_t ProgressOf(cmn::Id id) {
+  return uint64_t(id.offset) << 32 | id.sequence;
+}
+
+cmn::Id IdOf(uint64_t source, uint64_t progress) {
+  cmn::Id id;
+  id.offset = progress >> 32;
+  id.sequence = progress & 0xffffffff;
+  id.source = source;
+  return id;
+}
+
+}  // namespace
+
+VersionVector VersionVector::FromTlv(ll::Span tlv) {
+  VersionVector vector;
+  tlv::ViewReader reader(tlv);
+  bool sorted = true;
+
+  while (reader.HasSome()) {
+    tlv::RecordView record = reader.ReadNext();
+
+    if (record.header.literal != 'V' || !ll::IsPairLen(record.body.size())) {
+      throw std::runtime_error("Invalid V record");
+    }
+
+    auto [progress, source] = ll::UnzipU64Pair(record.body);
+    sorted = sorted && (vector.sources_.empty() ||
+                        vector.sources_.back() < source);
+    vector.sources_.push_back(source);
+    vector.progress_.push_back(progress);
+  }
+
+  if (sorted) {
+    return vector;
+  }
+
+  std::vector<size_t> order(vector.Size());
+  std::iota(order.begin(), order.end(), 0);
+  std::stable_sort(order.begin(), order.end(), [&](size_t lhs, size_t rhs) {
+    return vector.sources_[lhs] < vector.sources_[rhs];
+  });
+
+  VersionVector sorted_vector;
+
+  for (size_t i : order) {
+    uint64_t source = vector.sources_[i];
+    uint64_t progress = vector.progress_[i];
+
+    if (!sorted_vector.IsEmpty() && sorted_vector.sources_.back() == source) {
+      sorted_vector.progress_.back() =
+          std::max(sorted_vector.progress_.back(), progress);
+      continue;
+    }
+
+    sorted_vector.sources_.push_back(source);
+    sorted_vector.progress_.push_back(progress);
+  }
+
+  return sorted_vector;
+}
+
+size_t VersionVector::Size() const {
+  return sources_.size();
+}
+
+bool VersionVector::IsEmpty() const {
+  return sources_.empty();
+}
+
+const std::vector<uint64_t>& VersionVector::Sources() const {
+  return sources_;
+}
+
+const std::vector<uint64_t>& VersionVector::Progress() const {
+  return progress_;
+}
+
+std::optional<uint64_t> VersionVector::Get(uint64_t source) const {
+  auto it = std::lower_bound(sources_.begin(), sources_.end(), source);
+
+  if (it == sources_.end() || *it != source) {
+    return std::nullopt;
+  }
+
+  return progress_[it - sources_.begin()];
+}
+
+bool VersionVector::Put(uint64_t source, uint64_t progress) {
+  auto it = std::lower_bound(sources_.begin(), sources_.end(), source);
+  size_t index = it - sources_.begin();
+
+  if (it == sources_.end() || *it != source) {
+    sources_.insert(it, source);
+    progress_.insert(progress_.begin() + index, progress);
+    return true;
+  }
+
+  if (progress_[index] >= progress) {
+    return false;
+  }
+
+  progress_[index] = progress;
+  return true;
+}
+
+bool VersionVector::Put(cmn::Id id) {
+  return Put(id.source, ProgressOf(id));
+}
+
+void VersionVector::Merge(const VersionVector& other) {
+  if (sources_ == other.sources_) {
+    for (size_t i = 0; i < progress_.size(); ++i) {
+      progress_[i] = std::max(progress_[i], other.progress_[i]);
+    }
+
+    return;
+  }
+
+  VersionVector merged;
+  merged.sources_.reserve(Size() + other.Size());
+  merged.progress_.reserve(Size() + other.Size());
+
+  size_t i = 0;
+  size_t j = 0;
+
+  while (i < Size() || j < other.Size()) {
+    if (j == other.Size() ||
+        (i < Size() && sources_[i] < other.sources_[j])) {
+      merged.sources_.push_back(sources_[i]);
+      merged.progress_.push_back(progress_[i++]);
+    } else if (i == Size() || other.sources_[j] < sources_[i]) {
+      merged.sources_.push_back(other.sources_[j]);
+      merged.progress_.push_back(other.progress_[j++]);
+    } else {
+      merged.sources_.push_back(sources_[i]);
+      merged.progress_.push_back(
+          std::max(progress_[i++], other.progress_[j++]));
+    }
+  }
+
+  *this = std::move(merged);
+}
+
+bool VersionVector::Dominates(const VersionVector& other) const {
+  if (sources_ == other.sources_) {
+    bool behind = false;
+
+    for (size_t i = 0; i < progress_.size(); ++i) {
+      behind |= progress_[i] < other.progress_[i];
+    }
+
+    return !behind;
+  }
+
+  size_t i = 0;
+
+  for (size_t j = 0; j < other.Size(); ++j) {
+    while (i < Size() && sources_[i] < other.sources_[j]) {
+      ++i;
+    }
+
+    bool known = i < Size() && sources_[i] == other.sources_[j];
+    uint64_t progress = known ? progress_[i] : 0;
+
+    if (progress < other.progress_[j]) {
+      return false;
+    }
+  }
+
+  return true;
+}
+
+VersionVector VersionVector::Difference(const VersionVector& other) const {
+  VersionVector difference;
+  difference.sources_.resize(Size());
+  difference.progress_.resize(Size());
+  size_t count = 0;
+
+  if (sources_ == other.sources_) {
+    // Write every entry, keep the ones ahead
+    for (size_t i = 0; i < progress_.size(); ++i) {
+      difference.sources_[count] = sources_[i];
+      difference.progress_[count] = progress_[i];
+      count += progress_[i] > other.progress_[i];
+    }
+  } else {
+    size_t j = 0;
+
+    for (size_t i = 0; i < Size(); ++i) {
+      while (j < other.Size() && other.sources_[j] < sources_[i]) {
+        ++j;
+      }
+
+      bool known = j < other.Size() && other.sources_[j] == sources_[i];
+
+      difference.sources_[count] = sources_[i];
+      difference.progress_[count] = progress_[i];
+      count += !known || progress_[i] > other.progress_[j];
+    }
+  }
+
+  difference.sources_.resize(count);
+  difference.progress_.resize(count);
+
+  return difference;
+}
+
+VersionVector VersionVector::Intersection(const VersionVector& other) const {
+  VersionVector intersection;
+
+  if (sources_ == other.sources_) {
+    intersection.sources_ = sources_;
+    intersection.progress_.resize(Size());
+
+    for (size_t i = 0; i < progress_.size(); ++i) {
+      intersection.progress_[i] = std::min(progress_[i], other.progress_[i]);
+    }
+
+    return intersection;
+  }
+
+  size_t i = 0;
+  size_t j = 0;
+
+  while (i < Size() && j < other.Size()) {
+    if (sources_[i] < other.sources_[j]) {
+      ++i;
+    } else if (other.sources_[j] < sources_[i]) {
+      ++j;
+    } else {
+      intersection.sources_.push_back(sources_[i]);
+      intersection.progress_.push_back(
+          std::min(progress_[i++], other.progress_[j++]));
+    }
+  }
+
+  return intersection;
+}
+
+size_t VersionVector::TlvSize() const {
+  size_t size = 0;
+
+  for (size_t i = 0; i < Size(); ++i) {
+    size_t body = ll::ZipLen(progress_[i], sources_[i]);
+    size += tlv::HeaderSize('V', body) + body;
+  }
+
+  return size;
+}
+
+void VersionVector::WriteTlv(tlv::BufferWriter& writer) const {
+  uint8_t zipped[ll::kMaxZipLen];
+
+  for (size_t i = 0; i < Size(); ++i) {
+    size_t size = ll::ZipTo(zipped, progress_[i], sources_[i]);
+    writer.WriteRecord('V', {zipped, size});
+  }
+}
+
+ll::Buffer VersionVector::Tlv() const {
+  tlv::BufferWriter writer;
+  writer.Reserve(TlvSize());
+  WriteTlv(writer);
+  return writer.Extract();
+}
+
+std::string VersionVector::String() const {
+  std::string text;
+
+  for (size_t i = 0; i < Size(); ++i) {
+    if (i != 0) {
+      text += ',';
+    }
+
+    cmn::AppendString(text, IdOf(sources_[i], progress_[i]));
+  }
+
+  return text;
+}
+
+bool Vvalid(ll::Span tlv) {
+  try {
+    VersionVector::FromTlv(tlv);
+  } catch (const std::runtime_error&) {
+    return false;
+  }
+
+  return true;
+}
+
+std::string Vstring(ll::Span tlv) {
+  return VersionVector::FromTlv(tlv).String();
+}
+
+ll::Buffer Vparse(const std::string& text) {
+  VersionVector vector;
+
+  for (cmn::Id id : cmn::FromStrings(text)) {
+    vector.Put(id);
+  }
+
+  return vector.Tlv();
+}
+
+VersionVector Vnative(ll::Span tlv) {
+  return VersionVector::FromTlv(tlv);
+}
+
+ll::Buffer Vtlv(const VersionVector& vector) {
+  return vector.Tlv();
+}
+
+ll::Buffer Vmerge(const std::vector<ll::Span>& tlvs) {
+  VersionVector merged;
+
+  for (ll::Span tlv : tlvs) {
+    merged.Merge(VersionVector::FromTlv(tlv));
+  }
+
+  return merged.Tlv();
+}
+
+// Entries of the new vector that differ from the old one
+ll::Buffer Vdelta(ll::Span tlv, const VersionVector& new_vector) {
+  VersionVector old_vector = VersionVector::FromTlv(tlv);
+  VersionVector delta;
+
+  for (size_t i = 0; i < new_vector.Size(); ++i) {
+    uint64_t source = new_vector.Sources()[i];
+    uint64_t progress = new_vector.Progress()[i];
+
+    if (old_vector.Get(source) != progress) {
+      delta.Put(source, progress);
+    }
+  }
+
+  return delta.Tlv();
+}
+
+}  // namespace vv
@@ -0,0 +1,75 @@
+#pragma once
+
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include <ll/bytes.hpp>
+#include <tlv/io.hpp>
+#include <cmn/id.hpp>
+
+namespace vv {
+
+// A version vector, the max seen progress of every known source.
+// Kept as a structure of arrays sorted by source, so the common case
+// of two vectors over the same sources merges and compares with
+// branch-free loops over the parallel arrays.
+class VersionVector {
+ public:
+  VersionVector() = default;
+
+  // Accepts records in any order, repeated sources keep the max
+  static VersionVector FromTlv(ll::Span tlv);
+
+  size_t Size() const;
+  bool IsEmpty() const;
+
+  const std::vector<uint64_t>& Sources() const;
+  const std::vector<uint64_t>& Progress() const;
+
+  // No entry is distinct from a zero progress
+  std::optional<uint64_t> Get(uint64_t source) const;
+
+  // Returns whether the entry advanced
+  bool Put(uint64_t source, uint64_t progress);
+  bool Put(cmn::Id id);
+
+  // Per source max
+  void Merge(const VersionVector& other);
+
+  // Whether everything the other one has seen is seen here too; a
+  // missing entry counts as zero progress
+  bool Dominates(const VersionVector& other) const;
+
+  // Entries of this vector the other one is behind on
+  VersionVector Difference(const VersionVector& other) const;
+
+  // Common sources, min progress
+  VersionVector Intersection(const VersionVector& other) const;
+
+  // Writes V records straight into the writer, no temporaries
+  size_t TlvSize() const;
+  void WriteTlv(tlv::BufferWriter& writer) const;
+  ll::Buffer Tlv() const;
+
+  std::string String() const;
+
+  bool operator==(const VersionVector& rhs) const = default;
+
+ private:
+  std::vector<uint64_t> sources_;
+  std::vector<uint64_t> progress_;
+};
+
+// V, a version vector as a sequence of V records holding zipped
+// {progress, source} pairs sorted by source
+bool Vvalid(ll::Span tlv);
+std::string Vstring(ll::Span tlv);
+ll::Buffer Vparse(const std::string& text);
+VersionVector Vnative(ll::Span tlv);
+ll::Buffer Vtlv(const VersionVector& vector);
+ll::Buffer Vmerge(const std::vector<ll::Span>& tlvs);
+ll::Buffer Vdelta(ll::Span tlv, const VersionVector& new_vector);
+
+}  // namespace vv
@@ -0,0 +1,113 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <tlv/io.hpp>
+#include <lsm/merge_operator.hpp>
+#include <bulk/merge.hpp>
+
+namespace {
+
+std::vector<ll::Span> Bodies(const ll::Buffer& data) {
+  std::vector<ll::Span> bodies;
+  tlv::ViewReader reader(data);
+
+  while (reader.HasSome()) {
+    bodies.push_back(reader.ReadNext().body);
+  }
+
+  return bodies;
+}
+
+struct Corpus {
+  std::vector<ll::Buffer> data;
+  std::vector<std::vector<ll::Span>> inputs;
+  std::vector<bulk::Field> fields;
+};
+
+// Fields of every type over the test ops, each merging a random
+// window of the ops of its type; L patches need the elements they
+// patch, so L windows start at the first op
+Corpus MakeCorpus(size_t count) {
+  const std::string literals = "ISEMLNZ";
+  Corpus corpus;
+  std::vector<std::vector<ll::Span>> bodies;
+
+  for (char literal : literals) {
+    std::ifstream file(std::string(TEST_DATA_DIR) + "/" + literal + "0.tlv",
+                       std::ios::binary);
+    corpus.data.emplace_back(std::istreambuf_iterator<char>(file),
+                             std::istreambuf_iterator<char>());
+    bodies.push_back(Bodies(corpus.data.back()));
+  }
+
+  std::mt19937_64 rng(7);
+  corpus.inputs.reserve(count);
+
+  for (size_t i = 0; i < count; ++i) {
+    size_t type = rng() % literals.size();
+    const std::vector<ll::Span>& ops = bodies[type];
+    size_t begin = literals[type] == 'L' ? 0 : rng() % ops.size();
+    size_t end = begin + 1 + rng() % (ops.size() - begin);
+
+    corpus.inputs.emplace_back(ops.begin() + begin, ops.begin() + end);
+    corpus.fields.push_back({cmn::Id{0, uint32_t(i), 1}, literals[type],
+                             corpus.inputs.back()});
+  }
+
+  return corpus;
+}
+
+}  // namespace
+
+TEST(Bulk, TestMatchesFieldByField) {
+  Corpus corpus = MakeCorpus(2000);
+
+  std::vector<ll::Buffer> expected;
+
+  for (const bulk::Field& field : corpus.fields) {
+    ll::Buffer merged;
+    ASSERT_TRUE(lsm::FullMerge(field.literal, nullptr, field.inputs, merged));
+    expected.push_back(std::move(merged));
+  }
+
+  for (size_t threads : {1, 2, 8}) {
+    for (size_t run_bytes : {1, 256, 64 << 10}) {
+      bulk::Merged merged = bulk::Merge(
+          corpus.fields, {.threads = threads, .run_bytes = run_bytes});
+
+      ASSERT_TRUE(merged.failed.empty());
+      ASSERT_EQ(merged.ends.size(), corpus.fields.size());
+      ASSERT_EQ(merged.ends.back(), merged.bytes.size());
+
+      for (size_t i = 0; i < expected.size(); ++i) {
+        ASSERT_TRUE(std::ranges::equal(merged.Value(i), expected[i]))
+            << threads << " " << run_bytes << " " << i;
+      }
+    }
+  }
+}
+
+TEST(Bulk, TestFailedFields) {
+  ll::Buffer garbage{0xff, 0xff, 0xff};
+  Corpus corpus = MakeCorpus(10);
+  std::vector<ll::Span> bad = {garbage};
+
+  corpus.fields[3].literal = 'Q';
+  corpus.fields[7] = {cmn::Id{}, 'N', bad};
+
+  bulk::Merged merged = bulk::Merge(corpus.fields, {.threads = 4});
+
+  ASSERT_EQ(merged.failed, (std::vector<size_t>{3, 7}));
+  ASSERT_TRUE(merged.Value(3).empty());
+  ASSERT_TRUE(merged.Value(7).empty());
+  ASSERT_FALSE(merged.Value(8).empty());
+
+  bulk::Merged none = bulk::Merge({});
+  ASSERT_TRUE(none.bytes.empty());
+  ASSERT_TRUE(none.ends.empty());
+}
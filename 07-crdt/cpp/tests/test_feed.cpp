@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <filesystem>
+#include <string>
+#include <thread>
+
+#include <feed/feed.hpp>
+
+namespace {
+
+class TempDir {
+ public:
+  explicit TempDir(const std::string& name)
+      : path_(std::filesystem::temp_directory_path() /
+              ("test_feed_" + std::to_string(getpid()) + "_" + name)) {
+    std::filesystem::remove_all(path_);
+  }
+
+  ~TempDir() {
+    std::filesystem::remove_all(path_);
+  }
+
+  const std::filesystem::path& Path() const {
+    return path_;
+  }
+
+ private:
+  std::filesystem::path path_;
+};
+
+cmn::Id PacketId(uint64_t source, uint64_t sequence) {
+  cmn::Id id;
+  id.source = source;
+  id.sequence = sequence;
+  return id;
+}
+
+void AppendRange(plog::PacketLog& log, uint64_t source, uint64_t from,
+                 uint64_t to) {
+  for (uint64_t sequence = from; sequence < to; ++sequence) {
+    ll::Buffer body(100 + sequence % 300, uint8_t(source + sequence));
+    ASSERT_EQ(log.Append(PacketId(source, sequence), 'E', body),
+              plog::Verdict::kAppended);
+  }
+}
+
+// Pulls from `from` into `to` over a socketpair
+std::pair<feed::FeedStats, feed::FeedStats> Feed(
+    const plog::PacketLog& from, plog::PacketLog& to,
+    feed::FeedOptions options) {
+  int fds[2];
+  EXPECT_EQ(socketpair(AF_UNIX, SOCK_STREAM, 0, fds), 0);
+
+  feed::FeedStats pushed;
+  std::thread pusher(
+      [&]() { pushed = feed::Push(from, fds[0], options); });
+  feed::FeedStats pulled = feed::Pull(to, fds[1]);
+  pusher.join();
+
+  close(fds[0]);
+  close(fds[1]);
+  return {pushed, pulled};
+}
+
+void ExpectSame(const plog::PacketLog& lhs, const plog::PacketLog& rhs) {
+  ASSERT_EQ(lhs.Progress(), rhs.Progress());
+
+  for (size_t i = 0; i < lhs.Size(); ++i) {
+    plog::PacketView packet = lhs.At(i);
+    std::optional<plog::PacketView> other = rhs.Get(packet.id);
+    ASSERT_TRUE(other.has_value());
+    ASSERT_EQ(other->literal, packet.literal);
+    ASSERT_TRUE(std::ranges::equal(other->body, packet.body));
+  }
+}
+
+}  // namespace
+
+TEST(Feed, TestSyncBothWays) {
+  TempDir alice_dir("alice");
+  TempDir bob_dir("bob");
+  plog::LogOptions log_options;
+  log_options.sync = false;
+  plog::PacketLog alice(alice_dir.Path(), log_options);
+  plog::PacketLog bob(bob_dir.Path(), log_options);
+
+  for (uint64_t source = 1; source <= 3; ++source) {
+    AppendRange(alice, source, 0, 200);
+    AppendRange(bob, source, 0, 50 * source);
+  }
+
+  AppendRange(bob, 9, 0, 30);
+  AppendRange(alice, 4, 0, 10);
+
+  // Small batches and window, so the pusher waits for acks
+  feed::FeedOptions options;
+  options.batch_bytes = 4 << 10;
+  options.window = 2;
+
+  auto [pushed, pulled] = Feed(alice, bob, options);
+  ASSERT_EQ(pushed.packets, 150 + 100 + 50 + 10);
+  ASSERT_EQ(pulled.packets, pushed.packets);
+  ASSERT_EQ(pulled.batches, pushed.batches);
+  ASSERT_GT(pushed.batches, 10);
+  ASSERT_EQ(pushed.sent, pulled.received);
+  ASSERT_EQ(pulled.sent, pushed.received);
+  ASSERT_EQ(bob.Size(), 600 + 30 + 10);
+
+  auto [back, back_pulled] = Feed(bob, alice, options);
+  ASSERT_EQ(back.packets, 30);
+  ExpectSame(alice, bob);
+  ExpectSame(bob, alice);
+
+  // In sync already: the handshake and the end only
+  auto [idle, idle_pulled] = Feed(alice, bob, {});
+  ASSERT_EQ(idle.packets, 0);
+  ASSERT_EQ(idle.batches, 0);
+  ASSERT_EQ(idle_pulled.sent, 2 + bob.Progress().TlvSize());
+}
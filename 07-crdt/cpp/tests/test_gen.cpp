@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+
+#include <string>
+
+#include <gen/schema.hpp>
+#include <vv/vv.hpp>
+
+#include <test_gen.hpp>
+
+namespace {
+
+bool Within(std::string_view view, ll::Span bytes) {
+  auto* begin = reinterpret_cast<const char*>(bytes.data());
+  return view.data() >= begin &&
+         view.data() + view.size() <= begin + bytes.size();
+}
+
+}  // namespace
+
+TEST(Gen, TestSchema) {
+  std::vector<gen::ClassSpec> classes = gen::ParseSchema(
+      "# comment\n"
+      "Point {  # trailing\n"
+      "  x F\n"
+      "\n"
+      "  y_pos F\n"
+      "}\n"
+      "Tag {\n"
+      "  names E\n"
+      "}\n");
+
+  ASSERT_EQ(classes.size(), 2);
+  ASSERT_EQ(classes[0].name, "Point");
+  ASSERT_EQ(classes[0].fields.size(), 2);
+  ASSERT_EQ(classes[0].fields[1].name, "y_pos");
+  ASSERT_EQ(classes[0].fields[1].literal, 'F');
+  ASSERT_EQ(classes[1].fields[0].literal, 'E');
+
+  for (const char* bad : {
+           "Point {\n  x T\n}\n",
+           "Point {\n  x F\n  x I\n}\n",
+           "Point {\n  x_y F\n  x__y I\n}\n",
+           "Point {\n  value F\n}\n",
+           "Point {\n  x F\n",
+           "Point {\n}\n",
+           "point {\n  x F\n}\n",
+           "Point {\n  X F\n}\n",
+           "Point {\n  x F\n}\nPoint {\n  y F\n}\n",
+       }) {
+    ASSERT_THROW(gen::ParseSchema(bad), std::runtime_error) << bad;
+  }
+
+  try {
+    gen::ParseSchema("Point {\n  x F\n  y Q\n}\n");
+    FAIL();
+  } catch (const std::runtime_error& error) {
+    ASSERT_EQ(std::string(error.what()).rfind("Schema line 3:", 0), 0);
+  }
+
+  std::string header = gen::Generate(classes, "geo");
+  ASSERT_NE(header.find("namespace geo {"), std::string::npos);
+  ASSERT_NE(header.find("class Point : public gen::Object<2> {"),
+            std::string::npos);
+  ASSERT_NE(header.find("kYPos = 2,"), std::string::npos);
+  ASSERT_NE(header.find("TagDelta& MergeNames(ll::Span op)"),
+            std::string::npos);
+}
+
+TEST(Gen, TestViewsAndDeltas) {
+  static_assert(rdx::Person::kSeen == 7);
+  static_assert(rdx::Person::kLiterals[3] == 'R');
+  static_assert(rdx::Person::FieldId(cmn::Id{0, 5, 3}, rdx::Person::kAge) ==
+                cmn::Id{2, 5, 3});
+
+  // Nothing yet: every field reads as zero
+  rdx::Person empty({});
+  ASSERT_EQ(empty.Name(), "");
+  ASSERT_EQ(empty.Likes(), 0);
+  ASSERT_TRUE(empty.Seen().empty());
+
+  tlv::BufferWriter writer;
+  rdx::PersonDelta delta(empty, 7, writer);
+  ll::Buffer seen = vv::Vparse("1-5,2-3");
+  delta.SetName("alice")
+      .SetAge(31)
+      .SetScore(2.5)
+      .SetBestFriend(cmn::FromString("a-2"))
+      .SetLikes(10)
+      .SetBalance(-4)
+      .MergeSeen(seen);
+  ASSERT_EQ(delta.Count(), 7);
+
+  ll::Buffer first = writer.Extract();
+  rdx::Person alice(first);
+  ASSERT_EQ(alice.Name(), "alice");
+  ASSERT_TRUE(Within(alice.Name(), first));
+  ASSERT_EQ(alice.Age(), 31);
+  ASSERT_EQ(alice.Score(), 2.5);
+  ASSERT_EQ(alice.BestFriend(), cmn::FromString("a-2"));
+  ASSERT_EQ(alice.Likes(), 10);
+  ASSERT_EQ(alice.Balance(), -4);
+  ASSERT_EQ(vv::Vstring(alice.Seen()), "1-5,2-3");
+
+  // Through the store, then an update against the loaded state
+  lsm::Store store;
+  cmn::Id id = cmn::FromString("3-5");
+  gen::Apply(store, id, first);
+
+  ll::Buffer loaded = gen::Load(store, id, rdx::Person::kLiterals);
+  rdx::Person stored(loaded);
+  ASSERT_EQ(stored.Name(), "alice");
+  ASSERT_EQ(stored.Likes(), 10);
+
+  tlv::BufferWriter update_writer;
+  rdx::PersonDelta update(stored, 8, update_writer);
+  update.SetName("alice").SetAge(32).SetLikes(15).SetBalance(-4);
+  ASSERT_EQ(update.Count(), 2);
+  ll::Buffer second = update_writer.Extract();
+  gen::Apply(store, id, second);
+
+  loaded = gen::Load(store, id, rdx::Person::kLiterals);
+  rdx::Person updated(loaded);
+  ASSERT_EQ(updated.Name(), "alice");
+  ASSERT_EQ(updated.Age(), 32);
+  ASSERT_EQ(updated.Likes(), 15);
+  ASSERT_EQ(updated.Balance(), -4);
+
+  // The field values are the store values as they are
+  cmn::Id age = rdx::Person::FieldId(id, rdx::Person::kAge);
+  std::optional<ll::Buffer> stored_age =
+      store.Get(lsm::FieldKey(age, 'I'));
+  ASSERT_TRUE(stored_age.has_value());
+  ASSERT_TRUE(std::ranges::equal(*stored_age,
+                                 updated.Value(rdx::Person::kAge)));
+
+  // An older schema skips the fields it does not know
+  rdx::PersonName name(loaded);
+  ASSERT_EQ(name.Name(), "alice");
+}
+
+TEST(Gen, TestMalformed) {
+  tlv::BufferWriter duplicate;
+  gen::WriteField(duplicate, 1, 'S', {});
+  gen::WriteField(duplicate, 1, 'S', {});
+  ASSERT_THROW(rdx::Person(duplicate.View()).Name(), std::runtime_error);
+
+  tlv::BufferWriter mismatch;
+  gen::WriteField(mismatch, 2, 'S', {});
+  ASSERT_THROW(rdx::Person(mismatch.View()).Age(), std::runtime_error);
+
+  tlv::BufferWriter writer;
+  gen::WriteField(writer, 0, 'S', {});
+  ll::Buffer zero = writer.Extract();
+  ASSERT_THROW(rdx::Person(zero).Age(), std::runtime_error);
+
+  lsm::Store store;
+  ASSERT_THROW(gen::Apply(store, {}, zero), std::runtime_error);
+}
@@ -91,3 +91,41 @@ TEST(ISFR, TestLWWTie) {
   ASSERT_EQ(time.revision, 4);
   ASSERT_EQ(time.source, 7);
 }
+
+TEST(ISFR, TestArenaVariants) {
+  ll::Arena arena;
+
+  ll::Bytes i1 = isfr::Itlv(123, isfr::Time{-3, 1});
+  ll::Bytes i2 = isfr::Itlv(42, isfr::Time{3, 2});
+  ll::Bytes s1 = isfr::Stlv("abc", isfr::Time{5, 1});
+  ll::Bytes s2 = isfr::Stlv("abd", isfr::Time{5, 0});
+
+  ll::Buffer bi1(i1.begin(), i1.end());
+  ll::Buffer bi2(i2.begin(), i2.end());
+  ll::Buffer bs1(s1.begin(), s1.end());
+  ll::Buffer bs2(s2.begin(), s2.end());
+
+  auto bytes = [](ll::Span span) {
+    return ll::Bytes(span.begin(), span.end());
+  };
+
+  std::vector<ll::Span> ints = {bi1, bi2};
+  ASSERT_EQ(bytes(isfr::Imerge(ints, arena)), isfr::Imerge({i1, i2}));
+  std::vector<ll::Span> reversed = {bi2, bi1};
+  ASSERT_EQ(bytes(isfr::Imerge(reversed, arena)), isfr::Imerge({i2, i1}));
+  ASSERT_EQ(bytes(isfr::Idelta(bi1, -7, arena)), isfr::Idelta(i1, -7));
+
+  std::vector<ll::Span> strings = {bs1, bs2};
+  ASSERT_EQ(bytes(isfr::Smerge(strings, arena)), isfr::Smerge({s1, s2}));
+  ASSERT_EQ(bytes(isfr::Sdelta(bs1, "x", arena)), isfr::Sdelta(s1, "x"));
+
+  ll::Bytes f = isfr::Ftlv(2.5);
+  ll::Buffer bf(f.begin(), f.end());
+  ASSERT_EQ(bytes(isfr::Fdelta(bf, 0.5, arena)), isfr::Fdelta(f, 0.5));
+
+  ll::Bytes r = isfr::Rparse("ae-32");
+  ll::Buffer br(r.begin(), r.end());
+  cmn::Id id = cmn::FromString("1-2-3");
+  ASSERT_EQ(bytes(isfr::Rdelta(br, id, arena)), isfr::Rdelta(r, id));
+  ASSERT_EQ(isfr::ParseView(br).second.size(), 2);
+}
@@ -0,0 +1,289 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <isfr/types.hpp>
+#include <mel/array.hpp>
+#include <mel/map.hpp>
+#include <mel/set.hpp>
+#include <nz/integer.hpp>
+#include <nz/natural.hpp>
+#include <tlv/io.hpp>
+#include <lsm/field_cache.hpp>
+#include <lsm/fields.hpp>
+#include <lsm/merge_operator.hpp>
+#include <lsm/store.hpp>
+
+namespace {
+
+ll::Buffer ReadTestData(const std::string& name) {
+  std::ifstream file(std::string(TEST_DATA_DIR) + "/" + name,
+                     std::ios::binary);
+  return ll::Buffer(std::istreambuf_iterator<char>(file), {});
+}
+
+std::vector<ll::Span> Bodies(const ll::Buffer& data, char literal) {
+  std::vector<ll::Span> bodies;
+  tlv::ViewReader reader(data);
+
+  while (reader.HasSome()) {
+    tlv::RecordView record = reader.ReadNext();
+    EXPECT_EQ(record.header.literal, literal);
+    bodies.push_back(record.body);
+  }
+
+  return bodies;
+}
+
+ll::Buffer Buffer(const ll::Bytes& bytes) {
+  return ll::Buffer(bytes.begin(), bytes.end());
+}
+
+ll::Buffer Merged(char literal, const std::vector<ll::Span>& tlvs) {
+  switch (literal) {
+    case 'E':
+      return mel::Emerge(tlvs);
+    case 'M':
+      return mel::Mmerge(tlvs);
+    case 'L':
+      return mel::Lmerge(tlvs);
+    case 'N':
+      return nz::Nmerge(tlvs);
+    case 'Z':
+      return nz::Zmerge(tlvs);
+  }
+
+  ll::Arena arena;
+  ll::Span merged = isfr::Imerge(tlvs, arena);
+  return ll::Buffer(merged.begin(), merged.end());
+}
+
+}  // namespace
+
+TEST(LSM, TestFieldKey) {
+  cmn::Id field = cmn::FromString("2a8-5e2005-3");
+  std::string key = lsm::FieldKey(field, 'M');
+
+  ASSERT_EQ(key.size(), 9);
+  ASSERT_EQ(lsm::LiteralOf(key), 'M');
+  ASSERT_LT(key, lsm::FieldKey(cmn::FromString("2a8-5e2005-4"), 'I'));
+  ASSERT_LT(key, lsm::FieldKey(cmn::FromString("2a8-5e2006"), 'I'));
+  ASSERT_LT(key, lsm::FieldKey(cmn::FromString("2a9-0"), 'I'));
+  ASSERT_THROW(lsm::LiteralOf(""), std::runtime_error);
+
+  ASSERT_TRUE(lsm::IsMergeable('V'));
+  ASSERT_FALSE(lsm::IsMergeable('Q'));
+  ASSERT_FALSE(lsm::IsMergeable(char(0xc1)));
+}
+
+TEST(LSM, TestMergesAreAssociative) {
+  for (char literal : {'I', 'S', 'E', 'M', 'L', 'N', 'Z'}) {
+    ll::Buffer data = ReadTestData(std::string(1, literal) + "0.tlv");
+    std::vector<ll::Span> bodies = Bodies(data, literal);
+    ASSERT_GE(bodies.size(), 2) << literal;
+
+    ll::Buffer full;
+    ASSERT_TRUE(lsm::FullMerge(literal, nullptr, bodies, full)) << literal;
+    ASSERT_EQ(full, Merged(literal, bodies)) << literal;
+
+    // Any prefix as the stored value, the rest as operands
+    for (size_t split = 1; split < bodies.size(); ++split) {
+      ll::Buffer base;
+      ASSERT_TRUE(lsm::FullMerge(
+          literal, nullptr, std::span(bodies).first(split), base));
+
+      ll::Span base_span = base;
+      ll::Buffer stacked;
+      ASSERT_TRUE(lsm::FullMerge(literal, &base_span,
+                                 std::span(bodies).subspan(split), stacked));
+      ASSERT_EQ(stacked, full) << literal << split;
+    }
+
+    // Operands collapsed pairwise, or kept if they don't merge alone
+    std::vector<ll::Buffer> partials;
+
+    for (size_t i = 0; i < bodies.size(); i += 2) {
+      std::span<const ll::Span> pair = std::span(bodies).subspan(
+          i, std::min<size_t>(2, bodies.size() - i));
+      ll::Buffer partial;
+
+      if (lsm::PartialMerge(literal, pair, partial)) {
+        partials.push_back(std::move(partial));
+      } else {
+        for (ll::Span body : pair) {
+          partials.emplace_back(body.begin(), body.end());
+        }
+      }
+    }
+
+    std::vector<ll::Span> partial_spans(partials.begin(), partials.end());
+    ll::Buffer collapsed;
+    ASSERT_TRUE(lsm::FullMerge(literal, nullptr, partial_spans, collapsed));
+    ASSERT_EQ(collapsed, full) << literal;
+  }
+}
+
+TEST(LSM, TestRejects) {
+  ll::Buffer result{1, 2, 3};
+  ll::Buffer garbage{0xff, 0xff, 0xff};
+  std::vector<ll::Span> operands = {garbage};
+
+  ASSERT_FALSE(lsm::FullMerge('Q', nullptr, operands, result));
+  ASSERT_FALSE(lsm::FullMerge('N', nullptr, operands, result));
+  ASSERT_FALSE(lsm::PartialMerge('E', operands, result));
+  ASSERT_EQ(result, (ll::Buffer{1, 2, 3}));
+}
+
+TEST(LSM, TestStoreMatchesMerge) {
+  std::mt19937_64 rng(42);
+  lsm::Store store({.memtable_bytes = 2 << 10,
+                    .max_operands = 4,
+                    .max_runs = 2});
+
+  std::map<std::string, std::vector<ll::Buffer>> ops;
+
+  for (size_t i = 0; i < 5000; ++i) {
+    cmn::Id field;
+    field.sequence = rng() % 100;
+    bool counter = rng() % 2 != 0;
+    std::string key = lsm::FieldKey(field, counter ? 'N' : 'I');
+
+    ll::Buffer op =
+        counter ? nz::Ntlv(rng() % 1000, rng() % 8)
+                : Buffer(isfr::Itlv(int64_t(rng() % 1000) - 500,
+                                    {int64_t(rng() % 50), rng() % 8}));
+
+    if (rng() % 100 == 0) {
+      store.Put(key, op);
+      ops[key] = {op};
+    } else {
+      store.Merge(key, op);
+      ops[key].push_back(op);
+    }
+
+    if (rng() % 1000 == 0) {
+      ASSERT_EQ(store.Get(key), Merged(lsm::LiteralOf(key),
+                                       {ops[key].begin(), ops[key].end()}));
+    }
+  }
+
+  ASSERT_GT(store.Stats().flushes, 0);
+  ASSERT_GT(store.Stats().compactions, 0);
+  ASSERT_GT(store.Stats().partial_merges, 0);
+  ASSERT_EQ(store.Stats().merges + store.Stats().puts, 5000);
+
+  auto check = [&]() {
+    for (const auto& [key, key_ops] : ops) {
+      ASSERT_EQ(store.Get(key), Merged(lsm::LiteralOf(key),
+                                       {key_ops.begin(), key_ops.end()}));
+    }
+  };
+
+  check();
+  store.Flush();
+  check();
+  store.Compact();
+  ASSERT_EQ(store.RunCount(), 1);
+  check();
+
+  ASSERT_EQ(store.Get(lsm::FieldKey(cmn::FromString("1-1"), 'I')),
+            std::nullopt);
+}
+
+TEST(LSM, TestCollapsedKeyDoesNotFlush) {
+  lsm::Store store({.memtable_bytes = 1 << 10, .max_operands = 4});
+  std::string key = lsm::FieldKey(cmn::FromString("1-1"), 'N');
+
+  // One source's counter collapses to the same few bytes every time
+  for (uint64_t i = 1; i <= 1000; ++i) {
+    store.Merge(key, nz::Ntlv(i, 1));
+  }
+  store.Put(key, nz::Ntlv(1, 1));
+  for (size_t i = 0; i < 1000; ++i) {
+    store.Put(key, nz::Ntlv(7, 1));
+  }
+
+  ASSERT_EQ(store.Stats().flushes, 0);
+  ASSERT_GT(store.Stats().partial_merges, 0);
+  ASSERT_EQ(store.Get(key), nz::Ntlv(7, 1));
+}
+
+TEST(LSM, TestFieldCache) {
+  lsm::FieldCache cache(4, 1);
+
+  for (uint64_t i = 0; i < 6; ++i) {
+    cmn::Id field;
+    field.offset = i;
+    cache.Put(field, 'I', int64_t(i));
+  }
+
+  ASSERT_EQ(cache.Size(), 4);
+  ASSERT_EQ(cache.Get(cmn::FromString("0"), 'I'), std::nullopt);
+  ASSERT_EQ(cache.Get(cmn::FromString("2"), 'I'), lsm::Native(int64_t(2)));
+
+  // 2 is fresh now, 3 is the oldest
+  cache.Put(cmn::FromString("6"), 'S', std::string("six"));
+  ASSERT_EQ(cache.Get(cmn::FromString("3"), 'I'), std::nullopt);
+  ASSERT_EQ(cache.Get(cmn::FromString("2"), 'I'), lsm::Native(int64_t(2)));
+  ASSERT_EQ(cache.Get(cmn::FromString("6"), 'S'), lsm::Native("six"));
+
+  cache.Invalidate(cmn::FromString("6"), 'S');
+  cache.Invalidate(cmn::FromString("7"), 'S');
+  ASSERT_EQ(cache.Get(cmn::FromString("6"), 'S'), std::nullopt);
+
+  lsm::CacheStats stats = cache.Stats();
+  ASSERT_EQ(stats.hits, 3);
+  ASSERT_EQ(stats.misses, 3);
+  ASSERT_EQ(stats.evictions, 3);
+  ASSERT_EQ(stats.invalidations, 1);
+  ASSERT_DOUBLE_EQ(stats.HitRate(), 0.5);
+  ASSERT_THROW(lsm::FieldCache(0), std::runtime_error);
+}
+
+TEST(LSM, TestFieldsReadThroughCache) {
+  lsm::Store store;
+  lsm::FieldCache cache(1024);
+  lsm::Fields fields(store, cache);
+
+  cmn::Id name = cmn::FromString("2a8-5e2005-1");
+  cmn::Id score = cmn::FromString("2a8-5e2005-2");
+  cmn::Id visits = cmn::FromString("2a8-5e2005-3");
+
+  ASSERT_EQ(fields.Read(name, 'S'), std::nullopt);
+
+  fields.Merge(name, 'S', Buffer(isfr::Stlv("Petr", {1, 1})));
+  fields.Merge(score, 'F', Buffer(isfr::Ftlv(8.5, {1, 1})));
+  fields.Merge(visits, 'N', nz::Ntlv(3, 1));
+  fields.Merge(visits, 'N', nz::Ntlv(4, 2));
+
+  ASSERT_EQ(fields.Read(name, 'S'), lsm::Native("Petr"));
+  ASSERT_EQ(fields.Read(score, 'F'), lsm::Native(8.5));
+  ASSERT_EQ(fields.Read(visits, 'N'), lsm::Native(int64_t(7)));
+  ASSERT_EQ(cache.Stats().hits, 0);
+
+  ASSERT_EQ(fields.Read(name, 'S'), lsm::Native("Petr"));
+  ASSERT_EQ(cache.Stats().hits, 1);
+
+  // An op drops the cached value, the next read sees the merge
+  fields.Merge(name, 'S', Buffer(isfr::Stlv("Pyotr", {2, 3})));
+  ASSERT_EQ(fields.Read(name, 'S'), lsm::Native("Pyotr"));
+  fields.Merge(name, 'S', Buffer(isfr::Stlv("Pavel", {1, 9})));
+  ASSERT_EQ(fields.Read(name, 'S'), lsm::Native("Pyotr"));
+  fields.Put(visits, 'N', nz::Ntlv(1, 1));
+  ASSERT_EQ(fields.Read(visits, 'N'), lsm::Native(int64_t(1)));
+
+  ASSERT_EQ(cache.Stats().invalidations, 3);
+  ASSERT_THROW(fields.Read(cmn::FromString("1-1"), 'E'), std::runtime_error);
+
+  // Each type of a field is a store entry of its own, cached on its own
+  fields.Merge(visits, 'I', Buffer(isfr::Itlv(-5, {1, 1})));
+  ASSERT_EQ(fields.Read(visits, 'I'), lsm::Native(int64_t(-5)));
+  ASSERT_EQ(fields.Read(visits, 'N'), lsm::Native(int64_t(1)));
+  ASSERT_EQ(fields.Read(visits, 'Z'), std::nullopt);
+  ASSERT_EQ(fields.Read(name, 'R'), std::nullopt);
+}
@@ -0,0 +1,277 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include <ll/zipint.hpp>
+#include <tlv/io.hpp>
+#include <mel/element.hpp>
+#include <mel/set.hpp>
+#include <mel/map.hpp>
+#include <mel/array.hpp>
+#include <mel/weave.hpp>
+
+namespace {
+
+ll::Buffer ReadTestData(const std::string& name) {
+  std::ifstream file(std::string(TEST_DATA_DIR) + "/" + name,
+                     std::ios::binary);
+  return ll::Buffer(std::istreambuf_iterator<char>(file), {});
+}
+
+std::vector<ll::Span> Bodies(const ll::Buffer& data, char literal) {
+  std::vector<ll::Span> bodies;
+  tlv::ViewReader reader(data);
+
+  while (reader.HasSome()) {
+    tlv::RecordView record = reader.ReadNext();
+    EXPECT_EQ(record.header.literal, literal);
+    bodies.push_back(record.body);
+  }
+
+  return bodies;
+}
+
+ll::Buffer Zipped(int64_t value) {
+  ll::Bytes bytes = ll::Zip(value);
+  return ll::Buffer(bytes.begin(), bytes.end());
+}
+
+}  // namespace
+
+TEST(Mel, TestElementRoundTrip) {
+  ll::Buffer value = Zipped(-11);
+  mel::Element element{'I', {4, 5}, value, {}};
+
+  tlv::BufferWriter writer;
+  mel::WriteElement(writer, element);
+  ll::Buffer tlv = writer.Extract();
+
+  ASSERT_EQ(tlv, (ll::Buffer{0x69, 0x04, 0x32, 0x08, 0x05, 0x15}));
+  ASSERT_EQ(tlv.size(), mel::ElementSize(element));
+
+  tlv::ViewReader reader(tlv);
+  mel::Element parsed = mel::ReadElement(reader);
+  ASSERT_EQ(parsed.literal, 'I');
+  ASSERT_EQ(parsed.time.revision, 4);
+  ASSERT_EQ(parsed.time.source, 5);
+  ASSERT_EQ(mel::Compare(parsed, element), 0);
+  ASSERT_EQ(mel::ElementString(parsed), "-11");
+}
+
+TEST(Mel, TestEmergeTestData) {
+  ll::Buffer data = ReadTestData("E0.tlv");
+  std::vector<ll::Span> bodies = Bodies(data, 'E');
+
+  for (ll::Span body : bodies) {
+    ASSERT_TRUE(mel::Evalid(body));
+  }
+
+  ll::Buffer merged = mel::Emerge(bodies);
+  ASSERT_EQ(mel::Estring(merged), "{1,2,3,4}");
+  ASSERT_TRUE(mel::Evalid(merged));
+
+  std::sort(bodies.begin(), bodies.end(), [](ll::Span lhs, ll::Span rhs) {
+    return lhs.data() < rhs.data();
+  });
+
+  do {
+    std::vector<ll::Span> twice = bodies;
+    twice.push_back(bodies.front());
+    ASSERT_EQ(mel::Emerge(twice), merged);
+  } while (std::next_permutation(
+      bodies.begin(), bodies.end(), [](ll::Span lhs, ll::Span rhs) {
+        return lhs.data() < rhs.data();
+      }));
+
+  ASSERT_EQ(mel::Emerge({merged, bodies.back()}), merged);
+}
+
+TEST(Mel, TestEdelta) {
+  ll::Buffer one = Zipped(1);
+  ll::Buffer two = Zipped(2);
+  ll::Buffer three = Zipped(3);
+
+  ll::Buffer tlv = mel::Etlv({{'I', {}, one, {}}, {'I', {}, two, {}}});
+  ASSERT_EQ(mel::Estring(tlv), "{1,2}");
+
+  ll::Buffer delta = mel::Edelta(tlv, {{'I', {}, two, {}},
+                                       {'I', {}, three, {}}});
+  ll::Buffer merged = mel::Emerge({tlv, delta});
+  ASSERT_EQ(mel::Estring(merged), "{2,3}");
+  ASSERT_EQ(mel::Enative(merged).size(), 2);
+
+  ll::Buffer readd = mel::Edelta(merged, {{'I', {}, one, {}}});
+  ll::Buffer remerged = mel::Emerge({readd, merged});
+  ASSERT_EQ(mel::Estring(remerged), "{1}");
+  ASSERT_EQ(mel::Emerge({merged, readd}), remerged);
+}
+
+TEST(Mel, TestMmergeTestData) {
+  ll::Buffer data = ReadTestData("M0.tlv");
+  std::vector<ll::Span> bodies = Bodies(data, 'M');
+
+  for (ll::Span body : bodies) {
+    ASSERT_TRUE(mel::Mvalid(body));
+  }
+
+  ll::Buffer merged = mel::Mmerge(bodies);
+  ASSERT_EQ(mel::Mstring(merged), "{1:2,3:4}");
+
+  std::reverse(bodies.begin(), bodies.end());
+  ASSERT_EQ(mel::Mmerge(bodies), merged);
+  ASSERT_EQ(mel::Mmerge({merged, merged}), merged);
+}
+
+TEST(Mel, TestMdelta) {
+  ll::Buffer one = Zipped(1);
+  ll::Buffer two = Zipped(2);
+  ll::Buffer three = Zipped(3);
+
+  ll::Buffer tlv =
+      mel::Mtlv({{{'I', {}, one, {}}, mel::Element{'I', {}, two, {}}}});
+  ASSERT_EQ(mel::Mstring(tlv), "{1:2}");
+
+  ll::Buffer delta = mel::Mdelta(
+      tlv, {{{'I', {}, one, {}}, mel::Element{'I', {}, three, {}}},
+            {{'I', {}, two, {}}, mel::Element{'T', {}, {}, {}}}});
+  ll::Buffer merged = mel::Mmerge({tlv, delta});
+  ASSERT_EQ(mel::Mstring(merged), "{1:3,2:null}");
+
+  ll::Buffer removal = mel::Mdelta(merged, {});
+  ASSERT_EQ(mel::Mstring(mel::Mmerge({removal, merged})), "{}");
+  ASSERT_EQ(mel::Mnative(mel::Mmerge({merged, removal})).size(), 0);
+}
+
+TEST(Mel, TestLmergeTestData) {
+  ll::Buffer data = ReadTestData("L0.tlv");
+  std::vector<ll::Span> bodies = Bodies(data, 'L');
+
+  for (ll::Span body : bodies) {
+    ASSERT_TRUE(mel::Lvalid(body));
+  }
+
+  ll::Buffer merged = mel::Lmerge(bodies);
+  ASSERT_EQ(mel::Lstring(merged), "[1,2,3,4,5]");
+
+  std::reverse(bodies.begin(), bodies.end());
+  ASSERT_EQ(mel::Lmerge(bodies), merged);
+  ASSERT_EQ(mel::Lmerge({merged, bodies.front(), merged}), merged);
+}
+
+TEST(Mel, TestLdeletion) {
+  ll::Buffer one = Zipped(1);
+  ll::Buffer two = Zipped(2);
+  ll::Buffer three = Zipped(3);
+
+  tlv::BufferWriter writer;
+  mel::WriteElement(writer, {'I', {1, 3}, one, {}});
+  mel::WriteElement(writer, {'I', {2, 3}, two, {}});
+  mel::WriteElement(writer, {'I', {3, 3}, three, {}});
+  ll::Buffer array = writer.Extract();
+  ASSERT_EQ(mel::Lstring(array), "[1,2,3]");
+
+  tlv::BufferWriter patch_writer;
+  mel::WriteAttachment(patch_writer, {1, 3});
+  mel::WriteElement(patch_writer, {'T', {-4, 4}, {}, {}});
+  ll::Buffer patch = patch_writer.Extract();
+
+  ll::Buffer merged = mel::Lmerge({array, patch});
+  ASSERT_EQ(mel::Lstring(merged), "[2,3]");
+  ASSERT_EQ(mel::Lmerge({patch, array}), merged);
+  ASSERT_EQ(merged.size(), array.size() + 5);
+}
+
+TEST(Mel, TestWeaveConcurrentEdits) {
+  std::vector<ll::Buffer> values;
+
+  for (int64_t i = 0; i < 100; ++i) {
+    values.push_back(Zipped(i));
+  }
+
+  mel::Elements elements;
+
+  for (size_t i = 0; i < 10; ++i) {
+    elements.push_back({'I', {}, values[i], {}});
+  }
+
+  ll::Buffer base = mel::Ltlv(elements);
+
+  mel::Weave alice;
+  mel::Weave bob;
+  alice.ApplyView(base);
+  bob.ApplyView(base);
+  ASSERT_EQ(alice.Size(), 10);
+  ASSERT_EQ(mel::ElementString(alice.At(9)), "9");
+
+  std::vector<ll::Buffer> from_alice;
+  std::vector<ll::Buffer> from_bob;
+
+  for (size_t i = 0; i < 20; ++i) {
+    from_alice.push_back(
+        alice.Insert((i * 7) % alice.Size(), {'I', {}, values[10 + i], {}}, 1));
+    from_bob.push_back(
+        bob.Insert((i * 3) % bob.Size(), {'I', {}, values[50 + i], {}}, 2));
+
+    if (i % 4 == 0) {
+      from_alice.push_back(alice.Remove(i % alice.Size(), 1));
+      from_bob.push_back(bob.Remove((i + 1) % bob.Size(), 2));
+    }
+  }
+
+  for (const ll::Buffer& patch : from_bob) {
+    alice.Apply(patch);
+  }
+
+  for (const ll::Buffer& patch : from_alice) {
+    bob.Apply(patch);
+  }
+
+  ll::Buffer converged = alice.Tlv();
+  ASSERT_EQ(bob.Tlv(), converged);
+  ASSERT_EQ(alice.Size(), mel::Lnative(converged).size());
+
+  mel::Elements native = mel::Lnative(converged);
+
+  for (size_t i = 0; i < native.size(); ++i) {
+    ASSERT_EQ(mel::Compare(alice.At(i), native[i]), 0);
+    ASSERT_EQ(alice.IndexOf(mel::IdOf(alice.At(i))), i);
+  }
+
+  std::vector<ll::Span> inputs = {base};
+  inputs.insert(inputs.end(), from_alice.begin(), from_alice.end());
+  inputs.insert(inputs.end(), from_bob.begin(), from_bob.end());
+  std::reverse(inputs.begin(), inputs.end());
+  ASSERT_EQ(mel::Lmerge(inputs), converged);
+
+  mel::Elements edited = native;
+  edited.erase(edited.begin() + 3);
+  edited.push_back({'I', {}, values[99], {}});
+
+  ll::Buffer delta = mel::Ldelta(converged, edited);
+  ll::Buffer applied = mel::Lmerge({converged, delta});
+  mel::Elements result = mel::Lnative(applied);
+  ASSERT_EQ(result.size(), edited.size());
+
+  for (size_t i = 0; i < result.size(); ++i) {
+    ASSERT_EQ(mel::Compare(result[i], edited[i]), 0);
+  }
+}
+
+TEST(Mel, TestArenaMerge) {
+  ll::Buffer data = ReadTestData("M0.tlv");
+  std::vector<ll::Span> bodies = Bodies(data, 'M');
+
+  ll::Arena arena;
+  ll::Span merged = mel::Mmerge(bodies, arena);
+  ASSERT_EQ(ll::Buffer(merged.begin(), merged.end()), mel::Mmerge(bodies));
+
+  arena.Reset();
+  data = ReadTestData("E0.tlv");
+  bodies = Bodies(data, 'E');
+  merged = mel::Emerge(bodies, arena);
+  ASSERT_EQ(ll::Buffer(merged.begin(), merged.end()), mel::Emerge(bodies));
+}
@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+
+#include <mesh/simulator.hpp>
+
+namespace {
+
+mesh::MeshConfig SmallConfig(uint64_t seed) {
+  mesh::MeshConfig config;
+  config.seed = seed;
+  config.nodes = 40;
+  config.sources = 3;
+  config.packets = 8;
+  config.loss = 0.2;
+  return config;
+}
+
+}  // namespace
+
+TEST(Mesh, TestConvergesUnderLoss) {
+  for (uint64_t seed = 1; seed <= 10; ++seed) {
+    mesh::MeshConfig config = SmallConfig(seed);
+    mesh::MeshStats stats = mesh::Simulate(config);
+
+    ASSERT_TRUE(stats.converged) << seed;
+    ASSERT_EQ(stats.delivered, stats.expected) << seed;
+    ASSERT_GT(stats.nodes, 1) << seed;
+    ASSERT_LE(stats.nodes, config.nodes) << seed;
+    ASSERT_GT(stats.convergence_time, 0) << seed;
+    ASSERT_LT(stats.convergence_time, config.horizon) << seed;
+
+    // Every node but the origin needs each packet at least once
+    ASSERT_GE(stats.packet_sends, config.sources * config.packets) << seed;
+    ASSERT_GT(stats.announce_sends, 0) << seed;
+    ASSERT_LE(stats.redundant_sends, stats.packet_sends) << seed;
+    ASSERT_GE(stats.bytes_on_air, stats.packet_sends * config.packet_bytes)
+        << seed;
+  }
+}
+
+TEST(Mesh, TestDeterministic) {
+  mesh::MeshStats first = mesh::Simulate(SmallConfig(7));
+  mesh::MeshStats second = mesh::Simulate(SmallConfig(7));
+  mesh::MeshStats other = mesh::Simulate(SmallConfig(8));
+
+  ASSERT_EQ(first.convergence_time, second.convergence_time);
+  ASSERT_EQ(first.bytes_on_air, second.bytes_on_air);
+  ASSERT_EQ(first.packet_sends, second.packet_sends);
+  ASSERT_EQ(first.announce_sends, second.announce_sends);
+  ASSERT_EQ(first.duplicate_receptions, second.duplicate_receptions);
+  ASSERT_EQ(first.events, second.events);
+
+  ASSERT_NE(first.events, other.events);
+}
+
+TEST(Mesh, TestLosslessAndFlood) {
+  mesh::MeshConfig config = SmallConfig(3);
+  config.loss = 0;
+  config.references = false;
+  mesh::MeshStats announce = mesh::Simulate(config);
+  ASSERT_TRUE(announce.converged);
+
+  // Suppressed rebroadcasts and no repair: a flood may leave holes
+  config.protocol = mesh::Protocol::kFlood;
+  mesh::MeshStats flood = mesh::Simulate(config);
+  ASSERT_EQ(flood.converged, flood.delivered == flood.expected);
+  ASSERT_GT(flood.delivered, flood.expected / 2);
+  ASSERT_EQ(flood.expected, announce.expected);
+  ASSERT_EQ(flood.announce_sends, 0);
+  ASSERT_EQ(flood.bytes_on_air, flood.packet_sends * config.packet_bytes);
+}
+
+TEST(Mesh, TestBadConfig) {
+  mesh::MeshConfig config;
+  config.sources = config.nodes + 1;
+  ASSERT_THROW(mesh::Simulate(config), std::runtime_error);
+
+  config = {};
+  config.fragment_entries = 0;
+  ASSERT_THROW(mesh::Simulate(config), std::runtime_error);
+}
@@ -0,0 +1,151 @@
+#include <gtest/gtest.h>
+
+#include <algorithm>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <string>
+#include <vector>
+
+#include <tlv/io.hpp>
+#include <nz/counter.hpp>
+#include <nz/integer.hpp>
+#include <nz/natural.hpp>
+
+namespace {
+
+ll::Buffer ReadTestData(const std::string& name) {
+  std::ifstream file(std::string(TEST_DATA_DIR) + "/" + name,
+                     std::ios::binary);
+  return ll::Buffer(std::istreambuf_iterator<char>(file), {});
+}
+
+std::vector<ll::Span> Bodies(const ll::Buffer& data, char literal) {
+  std::vector<ll::Span> bodies;
+  tlv::ViewReader reader(data);
+
+  while (reader.HasSome()) {
+    tlv::RecordView record = reader.ReadNext();
+    EXPECT_EQ(record.header.literal, literal);
+    bodies.push_back(record.body);
+  }
+
+  return bodies;
+}
+
+ll::Buffer Concat(const std::vector<ll::Buffer>& tlvs) {
+  ll::Buffer all;
+
+  for (const ll::Buffer& tlv : tlvs) {
+    all.insert(all.end(), tlv.begin(), tlv.end());
+  }
+
+  return all;
+}
+
+}  // namespace
+
+TEST(NZ, TestNmergeTestData) {
+  ll::Buffer data = ReadTestData("N0.tlv");
+  std::vector<ll::Span> bodies = Bodies(data, 'N');
+
+  for (ll::Span body : bodies) {
+    ASSERT_TRUE(nz::Nvalid(body));
+  }
+
+  ll::Buffer merged = nz::Nmerge(bodies);
+  ASSERT_EQ(nz::Nstring(merged), "14");
+
+  std::reverse(bodies.begin(), bodies.end());
+  ASSERT_EQ(nz::Nmerge(bodies), merged);
+  ASSERT_EQ(nz::Nmerge({merged, bodies.front(), merged}), merged);
+
+  nz::NCounter counter;
+
+  for (ll::Span body : bodies) {
+    counter.ApplyTlv(body);
+  }
+
+  ASSERT_EQ(counter.Sum(), 14);
+  ASSERT_EQ(counter.Tlv(), merged);
+}
+
+TEST(NZ, TestZmergeTestData) {
+  ll::Buffer data = ReadTestData("Z0.tlv");
+  std::vector<ll::Span> bodies = Bodies(data, 'Z');
+
+  for (ll::Span body : bodies) {
+    ASSERT_TRUE(nz::Zvalid(body));
+  }
+
+  ll::Buffer merged = nz::Zmerge(bodies);
+  ASSERT_EQ(nz::Zstring(merged), "0");
+
+  std::reverse(bodies.begin(), bodies.end());
+  ASSERT_EQ(nz::Zmerge(bodies), merged);
+  ASSERT_EQ(nz::Zmerge({merged, bodies.front(), merged}), merged);
+
+  nz::ZCounter counter;
+
+  for (ll::Span body : bodies) {
+    counter.ApplyTlv(body);
+  }
+
+  ASSERT_EQ(counter.Sum(), 0);
+  ASSERT_EQ(counter.Tlv(), merged);
+}
+
+TEST(NZ, TestDeltas) {
+  ll::Buffer n = nz::Ntlv(5, 1);
+  ll::Buffer n_delta = nz::Ndelta(n, 12, 2);
+  ll::Buffer n_merged = nz::Nmerge({n, n_delta});
+  ASSERT_EQ(nz::Nnative(n_merged), 12);
+  ASSERT_EQ(nz::Nnative(nz::Nmerge({n_merged, nz::Ndelta(n_merged, 13, 1)})),
+            13);
+  ASSERT_TRUE(nz::Ndelta(n_merged, 12).empty());
+  ASSERT_THROW(nz::Ndelta(n_merged, 11), std::runtime_error);
+
+  ll::Buffer z = nz::Ztlv(-3, 1);
+  ll::Buffer z_delta = nz::Zdelta(z, 4, 1);
+  ll::Buffer z_merged = nz::Zmerge({z_delta, z});
+  ASSERT_EQ(nz::Znative(z_merged), 4);
+  ASSERT_EQ(nz::Znative(nz::Zmerge({z_merged, nz::Zdelta(z_merged, -9, 2)})),
+            -9);
+}
+
+TEST(NZ, TestCountersMatchMerge) {
+  std::mt19937_64 rng(42);
+  std::vector<ll::Buffer> n_ops;
+  std::vector<ll::Buffer> z_ops;
+  nz::NCounter n_counter;
+  nz::ZCounter z_counter;
+
+  for (size_t i = 0; i < 1000; ++i) {
+    uint64_t source = rng() % 50;
+    uint64_t value = rng() % 1000;
+    int64_t revision = 1 + rng() % 20;
+    int64_t signed_value = int64_t(rng() % 2000) - 1000;
+
+    n_ops.push_back(nz::Ntlv(value, source));
+    n_counter.Apply(source, value);
+
+    nz::ZCounter single;
+    single.Apply(source, revision, signed_value);
+    z_ops.push_back(single.Tlv());
+    z_counter.Apply(source, revision, signed_value);
+  }
+
+  std::vector<ll::Span> n_spans(n_ops.begin(), n_ops.end());
+  std::vector<ll::Span> z_spans(z_ops.begin(), z_ops.end());
+
+  ll::Buffer n_merged = nz::Nmerge(n_spans);
+  ll::Buffer z_merged = nz::Zmerge(z_spans);
+
+  ASSERT_EQ(n_counter.Sum(), nz::Nnative(n_merged));
+  ASSERT_EQ(n_counter.Tlv(), n_merged);
+  ASSERT_EQ(nz::Nnative(Concat(n_ops)), n_counter.Sum());
+
+  ASSERT_EQ(z_counter.Sum(), nz::Znative(z_merged));
+  ASSERT_EQ(z_counter.Tlv(), z_merged);
+  ASSERT_EQ(nz::Znative(Concat(z_ops)), z_counter.Sum());
+}
@@ -0,0 +1,291 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include <ll/crc32c.hpp>
+#include <plog/packet_log.hpp>
+
+namespace {
+
+// A fresh directory per test, removed at the end
+class TempDir {
+ public:
+  TempDir()
+      : path_(std::filesystem::temp_directory_path() /
+              ("test_plog_" + std::to_string(getpid()) + "_" +
+               ::testing::UnitTest::GetInstance()->current_test_info()
+                   ->name())) {
+    std::filesystem::remove_all(path_);
+  }
+
+  ~TempDir() {
+    std::filesystem::remove_all(path_);
+  }
+
+  const std::filesystem::path& Path() const {
+    return path_;
+  }
+
+ private:
+  std::filesystem::path path_;
+};
+
+cmn::Id PacketId(uint64_t source, uint64_t sequence) {
+  cmn::Id id;
+  id.source = source;
+  id.sequence = sequence;
+  return id;
+}
+
+ll::Buffer Body(uint64_t source, uint64_t sequence, size_t size) {
+  ll::Buffer body(size);
+
+  for (size_t i = 0; i < size; ++i) {
+    body[i] = uint8_t(source * 31 + sequence * 7 + i);
+  }
+
+  return body;
+}
+
+void ExpectPacket(const plog::PacketLog& log, uint64_t source,
+                  uint64_t sequence, size_t size) {
+  std::optional<plog::PacketView> packet =
+      log.Get(PacketId(source, sequence));
+  ASSERT_TRUE(packet.has_value()) << source << "-" << sequence;
+  ASSERT_EQ(packet->id, PacketId(source, sequence));
+  ASSERT_EQ(packet->literal, 'E');
+
+  ll::Buffer body = Body(source, sequence, size);
+  ASSERT_TRUE(std::ranges::equal(packet->body, body));
+}
+
+}  // namespace
+
+TEST(PacketLog, TestCausalOrder) {
+  TempDir dir;
+  plog::PacketLog log(dir.Path());
+  ll::Buffer body = Body(1, 0, 10);
+
+  ASSERT_EQ(log.Append(PacketId(1, 1), 'E', body), plog::Verdict::kGap);
+  ASSERT_EQ(log.Append(PacketId(1, 0), 'E', body),
+            plog::Verdict::kAppended);
+  ASSERT_EQ(log.Append(PacketId(1, 0), 'E', body),
+            plog::Verdict::kDuplicate);
+  ASSERT_EQ(log.Append(PacketId(1, 2), 'E', body), plog::Verdict::kGap);
+  ASSERT_EQ(log.Append(PacketId(2, 0), 'E', body),
+            plog::Verdict::kAppended);
+  ASSERT_EQ(log.Append(PacketId(1, 1), 'E', body),
+            plog::Verdict::kAppended);
+
+  ASSERT_EQ(log.Size(), 3);
+  ASSERT_EQ(log.Progress().String(), "1-1,2-0");
+  ASSERT_EQ(log.At(1).id, PacketId(2, 0));
+
+  ASSERT_THROW(log.Append(PacketId(3, 0), 'e', body), std::runtime_error);
+  ASSERT_THROW(log.Append(cmn::FromString("3-0-1"), 'E', body),
+               std::runtime_error);
+  ASSERT_THROW(log.Append(PacketId(3, 0), 'E', ll::Buffer(4097)),
+               std::runtime_error);
+
+  ASSERT_EQ(log.Get(PacketId(1, 2)), std::nullopt);
+  ASSERT_EQ(log.Get(PacketId(3, 0)), std::nullopt);
+  ASSERT_EQ(log.Get(cmn::FromString("1-0-1")), std::nullopt);
+}
+
+TEST(PacketLog, TestSegmentsAndReopen) {
+  TempDir dir;
+  plog::LogOptions options;
+  options.segment_bytes = 16 << 10;
+  options.commit_bytes = 4 << 10;
+  options.sync = false;
+
+  size_t bytes = 0;
+
+  {
+    plog::PacketLog log(dir.Path(), options);
+
+    for (uint64_t sequence = 0; sequence < 50; ++sequence) {
+      for (uint64_t source = 1; source <= 4; ++source) {
+        size_t size = (source * 997 + sequence * 131) % plog::kMaxPacket;
+        ASSERT_EQ(log.Append(PacketId(source, sequence), 'E',
+                             Body(source, sequence, size)),
+                  plog::Verdict::kAppended);
+        // Buffered and written out packets read the same
+        ExpectPacket(log, source, sequence, size);
+      }
+
+      if (sequence % 10 == 0) {
+        log.Commit();
+      }
+    }
+
+    bytes = log.Bytes();
+  }
+
+  ASSERT_GT(std::distance(std::filesystem::directory_iterator(dir.Path()),
+                          std::filesystem::directory_iterator()),
+            1);
+
+  plog::PacketLog log(dir.Path(), options);
+  ASSERT_EQ(log.Size(), 200);
+  ASSERT_EQ(log.Bytes(), bytes);
+  ASSERT_EQ(log.Progress().String(), "1-31,2-31,3-31,4-31");
+
+  for (uint64_t sequence = 0; sequence < 50; ++sequence) {
+    for (uint64_t source = 1; source <= 4; ++source) {
+      ExpectPacket(log, source, sequence,
+                   (source * 997 + sequence * 131) % plog::kMaxPacket);
+    }
+  }
+
+  ASSERT_EQ(log.Append(PacketId(1, 50), 'E', Body(1, 50, 5)),
+            plog::Verdict::kAppended);
+}
+
+TEST(PacketLog, TestTornTail) {
+  TempDir dir;
+
+  {
+    plog::PacketLog log(dir.Path());
+
+    for (uint64_t sequence = 0; sequence < 10; ++sequence) {
+      log.Append(PacketId(7, sequence), 'E', Body(7, sequence, 100));
+    }
+  }
+
+  // A crash in the middle of the next packet
+  {
+    std::ofstream file(dir.Path() / "00000000.seg",
+                       std::ios::binary | std::ios::app);
+    file.write("E\x80\x00\x00\x00\x33\x07\x0a", 8);
+  }
+
+  {
+    plog::PacketLog log(dir.Path());
+    ASSERT_EQ(log.Size(), 10);
+    ExpectPacket(log, 7, 9, 100);
+    ASSERT_EQ(log.Append(PacketId(7, 10), 'E', Body(7, 10, 100)),
+              plog::Verdict::kAppended);
+  }
+
+  plog::PacketLog log(dir.Path());
+  ASSERT_EQ(log.Size(), 11);
+  ExpectPacket(log, 7, 10, 100);
+}
+
+// The header made it to the disk, the body and checksum did not
+TEST(PacketLog, TestLostBody) {
+  TempDir dir;
+  std::filesystem::path segment = dir.Path() / "00000000.seg";
+
+  {
+    plog::PacketLog log(dir.Path());
+
+    for (uint64_t sequence = 0; sequence < 10; ++sequence) {
+      log.Append(PacketId(7, sequence), 'E', Body(7, sequence, 100));
+    }
+  }
+
+  {
+    std::fstream file(segment, std::ios::binary | std::ios::in |
+                                   std::ios::out);
+    file.seekp(std::filesystem::file_size(segment) - 60);
+    file.write(std::string(60, '\0').data(), 60);
+  }
+
+  {
+    plog::PacketLog log(dir.Path());
+    ASSERT_EQ(log.Size(), 9);
+    ASSERT_EQ(log.Get(PacketId(7, 9)), std::nullopt);
+    ASSERT_EQ(log.Append(PacketId(7, 9), 'E', Body(7, 9, 100)),
+              plog::Verdict::kAppended);
+  }
+
+  plog::PacketLog log(dir.Path());
+  ASSERT_EQ(log.Size(), 10);
+  ExpectPacket(log, 7, 9, 100);
+}
+
+// A full segment whose cut to size was lost in a crash
+TEST(PacketLog, TestZeroTailInFullSegment) {
+  TempDir dir;
+  std::filesystem::path segment = dir.Path() / "00000000.seg";
+  plog::LogOptions options;
+  options.segment_bytes = 16 << 10;
+  options.sync = false;
+
+  {
+    plog::PacketLog log(dir.Path(), options);
+
+    for (uint64_t sequence = 0; sequence < 20; ++sequence) {
+      log.Append(PacketId(1, sequence), 'E', Body(1, sequence, 1000));
+    }
+  }
+
+  uintmax_t size = std::filesystem::file_size(segment);
+  std::filesystem::resize_file(segment, options.segment_bytes);
+
+  {
+    plog::PacketLog log(dir.Path(), options);
+    ASSERT_EQ(log.Size(), 20);
+    ExpectPacket(log, 1, 19, 1000);
+  }
+
+  ASSERT_EQ(std::filesystem::file_size(segment), size);
+
+  // Anything but zeroes there is not a crash but a corruption
+  {
+    std::ofstream file(segment, std::ios::binary | std::ios::app);
+    file.write("E\x01", 2);
+  }
+
+  ASSERT_THROW(plog::PacketLog(dir.Path(), options), std::runtime_error);
+}
+
+TEST(PacketLog, TestChecksum) {
+  std::string check = "123456789";
+  ll::Span bytes(reinterpret_cast<const uint8_t*>(check.data()),
+                 check.size());
+
+  ASSERT_EQ(ll::Crc32c({}), 0u);
+  ASSERT_EQ(ll::Crc32c(bytes), 0xe3069283u);
+  ASSERT_EQ(ll::Crc32c(bytes.subspan(4), ll::Crc32c(bytes.first(4))),
+            0xe3069283u);
+
+  // Long enough for the wide steps
+  std::string text(1000, 'x');
+  ll::Span long_bytes(reinterpret_cast<const uint8_t*>(text.data()),
+                      text.size());
+  ASSERT_EQ(ll::Crc32c(long_bytes),
+            ll::Crc32c(long_bytes.subspan(333),
+                       ll::Crc32c(long_bytes.first(333))));
+}
+
+TEST(PacketLog, TestSince) {
+  TempDir dir;
+  plog::LogOptions options;
+  options.sync = false;
+  plog::PacketLog log(dir.Path(), options);
+
+  for (uint64_t sequence = 0; sequence < 3; ++sequence) {
+    log.Append(PacketId(1, sequence), 'E', Body(1, sequence, 10));
+    log.Append(PacketId(2, sequence), 'E', Body(2, sequence, 10));
+  }
+
+  ASSERT_EQ(log.Since({}), (std::vector<uint32_t>{0, 1, 2, 3, 4, 5}));
+  ASSERT_EQ(log.Since(log.Progress()), std::vector<uint32_t>{});
+
+  vv::VersionVector seen;
+  seen.Put(1, 1);
+  seen.Put(3, 7);
+  ASSERT_EQ(log.Since(seen), (std::vector<uint32_t>{1, 3, 4, 5}));
+  ASSERT_EQ(log.At(4).id, PacketId(1, 2));
+  ASSERT_EQ(plog::ParsePacket(log.RecordAt(4)).id, PacketId(1, 2));
+  // Without the checksum
+  ASSERT_EQ(log.RecordAt(4).size(), 1 + 1 + 3 + 10);
+}
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include <unistd.h>
+
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <string>
+#include <vector>
+
+#include <isfr/types.hpp>
+#include <lsm/merge_operator.hpp>
+#include <replay/corpus.hpp>
+
+namespace {
+
+class TempDir {
+ public:
+  TempDir()
+      : path_(std::filesystem::temp_directory_path() /
+              ("test_replay_" + std::to_string(getpid()))) {
+    std::filesystem::remove_all(path_);
+    std::filesystem::create_directories(path_);
+  }
+
+  ~TempDir() {
+    std::filesystem::remove_all(path_);
+  }
+
+  std::filesystem::path operator/(const std::string& name) const {
+    return path_ / name;
+  }
+
+ private:
+  std::filesystem::path path_;
+};
+
+std::string ReadFile(const std::filesystem::path& path) {
+  std::ifstream file(path, std::ios::binary);
+  return std::string(std::istreambuf_iterator<char>(file), {});
+}
+
+}  // namespace
+
+TEST(Replay, TestGenerateAndLoad) {
+  TempDir dir;
+  replay::CorpusOptions options;
+  options.ops = 20000;
+  options.replicas = 4;
+  options.conflict_rate = 0.5;
+  options.seed = 3;
+
+  replay::Generate(dir / "a.rpl", options);
+  replay::Generate(dir / "b.rpl", options);
+  ASSERT_EQ(ReadFile(dir / "a.rpl"), ReadFile(dir / "b.rpl"));
+
+  options.seed = 4;
+  replay::Generate(dir / "c.rpl", options);
+  ASSERT_NE(ReadFile(dir / "a.rpl"), ReadFile(dir / "c.rpl"));
+
+  replay::Corpus corpus(dir / "a.rpl");
+  ASSERT_EQ(corpus.Header().ops, 20000);
+  ASSERT_EQ(corpus.Header().fields, 20000 / 16);
+  ASSERT_EQ(corpus.Header().replicas, 4);
+  ASSERT_EQ(corpus.Header().conflicts_ppm, 500000);
+  ASSERT_EQ(corpus.Header().seed, 3);
+
+  // By field sequence, the fields being 1-<sequence>-0
+  std::map<uint64_t, std::vector<ll::Span>> fields;
+  std::map<char, size_t> types;
+  size_t conflicts = 0;
+  size_t registers = 0;
+
+  replay::OpReader reader = corpus.Read();
+  replay::Op op;
+
+  while (reader.Next(op)) {
+    ASSERT_EQ(std::string("INZS")[op.field.sequence % 4], op.literal);
+    ASSERT_LT(op.field.sequence, corpus.Header().fields);
+    ++types[op.literal];
+
+    ASSERT_EQ(op.field.offset, 1);
+    ASSERT_EQ(op.field.source, 0);
+    std::vector<ll::Span>& ops = fields[op.field.sequence];
+
+    if (op.literal == 'I' || op.literal == 'S') {
+      ++registers;
+      isfr::Time time = isfr::ParseView(op.body).first;
+      ASSERT_GE(time.source, 1);
+      ASSERT_LE(time.source, 4);
+
+      if (!ops.empty() &&
+          isfr::ParseView(ops.back()).first.revision == time.revision) {
+        ++conflicts;
+      }
+    }
+
+    ops.push_back(op.body);
+  }
+
+  size_t count = 0;
+
+  for (const auto& [literal, ops] : types) {
+    count += ops;
+  }
+
+  ASSERT_EQ(count, 20000);
+  ASSERT_EQ(types.size(), 4);
+  ASSERT_NEAR(double(conflicts) / registers, 0.5, 0.05);
+
+  // Every field merges
+  for (const auto& [sequence, ops] : fields) {
+    char literal = "INZS"[sequence % 4];
+    ll::Buffer merged;
+    ASSERT_TRUE(lsm::FullMerge(literal, nullptr, ops, merged));
+  }
+}
+
+TEST(Replay, TestRejects) {
+  TempDir dir;
+
+  {
+    std::ofstream file(dir / "short.rpl", std::ios::binary);
+    file << "RDXRPLAY";
+  }
+
+  {
+    std::ofstream file(dir / "magic.rpl", std::ios::binary);
+    file << std::string(replay::kHeaderSize, 'x');
+  }
+
+  ASSERT_THROW(replay::Corpus(dir / "none.rpl"), std::runtime_error);
+  ASSERT_THROW(replay::Corpus(dir / "short.rpl"), std::runtime_error);
+  ASSERT_THROW(replay::Corpus(dir / "magic.rpl"), std::runtime_error);
+
+  replay::CorpusOptions options;
+  options.literals = "IQ";
+  ASSERT_THROW(replay::Generate(dir / "bad.rpl", options),
+               std::runtime_error);
+
+  // An op with no id record
+  ll::Buffer ops{'I', 0, 0, 0, 0};
+  replay::OpReader reader(ops);
+  replay::Op op;
+  ASSERT_THROW(reader.Next(op), std::runtime_error);
+}
@@ -41,3 +41,87 @@ TEST(Tlv, TestWriteRecord) {
 
   ASSERT_THROW(reader.ReadNext(), std::runtime_error);
 }
+
+TEST(Tlv, TestBufferWriterViewReader) {
+  ll::Bytes c256(256, 'C');
+
+  tlv::RecordWriter writer;
+  writer.WriteRecord('A', {'A'});
+  writer.WriteRecord('b', {'B', 'B'});
+  writer.WriteRecord('T', {1, 2}, true);
+  writer.WriteRecord('C', c256);
+  ll::Bytes correct = writer.Extract();
+
+  ll::Buffer a = {'A'};
+  ll::Buffer b = {'B', 'B'};
+  ll::Buffer t = {1, 2};
+  ll::Buffer c(256, 'C');
+
+  tlv::BufferWriter buffer_writer;
+  buffer_writer.WriteRecord('A', a);
+  buffer_writer.WriteRecord('b', b);
+  buffer_writer.WriteRecord('T', t, true);
+  buffer_writer.WriteRecord('C', c);
+  ll::Buffer buf = buffer_writer.Extract();
+
+  ASSERT_EQ(ll::Bytes(buf.begin(), buf.end()), correct);
+  ASSERT_EQ(tlv::HeaderSize('C', c.size()), 5);
+  ASSERT_EQ(tlv::HeaderSize('b', b.size()), 1);
+  ASSERT_EQ(tlv::HeaderSize('A', a.size()), 2);
+
+  tlv::ViewReader reader(buf);
+  tlv::RecordView record = reader.ReadNext();
+  ASSERT_EQ(record.header.literal, 'A');
+  ASSERT_EQ(ll::Buffer(record.body.begin(), record.body.end()), a);
+  ASSERT_EQ(record.Whole().data(), buf.data());
+
+  ASSERT_EQ(reader.ReadNext().header.literal, '0');
+  ASSERT_EQ(reader.ReadNext().header.literal, '0');
+
+  tlv::RecordView record3 = reader.ReadNext();
+  ASSERT_EQ(record3.header.literal, 'C');
+  ASSERT_EQ(record3.body.size(), 256);
+  ASSERT_TRUE(reader.IsEmpty());
+
+  ASSERT_THROW(reader.ReadNext(), std::runtime_error);
+
+  tlv::ViewReader truncated(ll::Span(buf).first(buf.size() - 1));
+  truncated.ReadNext();
+  truncated.ReadNext();
+  truncated.ReadNext();
+  ASSERT_THROW(truncated.ReadNext(), std::runtime_error);
+}
+
+TEST(Tlv, TestArenaWriter) {
+  ll::Buffer b = {'B', 'B'};
+  ll::Buffer c(256, 'C');
+
+  tlv::BufferWriter buffer_writer;
+  buffer_writer.WriteRecord('b', b);
+  buffer_writer.WriteRecord('C', c);
+  ll::Buffer correct = buffer_writer.Extract();
+
+  ll::Arena arena(64);
+
+  for (size_t round = 0; round < 3; ++round) {
+    // Outgrows both the reservation and the first block
+    tlv::ArenaWriter writer(arena);
+    writer.Reserve(4);
+    writer.WriteRecord('b', b);
+    writer.WriteRecord('C', c);
+    ll::Span written = writer.Extract();
+
+    ASSERT_EQ(ll::Buffer(written.begin(), written.end()), correct);
+    ASSERT_GE(arena.Used(), correct.size());
+
+    arena.Reset();
+    ASSERT_EQ(arena.Used(), 0);
+  }
+
+  // Reset leaves one block big enough for the whole batch
+  ASSERT_EQ(arena.BlockAllocations(), 3);
+
+  ll::Span copy = arena.Copy(b);
+  ASSERT_EQ(ll::Buffer(copy.begin(), copy.end()), b);
+  ASSERT_EQ(arena.BlockAllocations(), 3);
+}
@@ -0,0 +1,215 @@
+#include <gtest/gtest.h>
+
+#include <cmath>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+
+#include <cmn/id.hpp>
+#include <txt/text.hpp>
+
+namespace {
+
+// The stream forms the text writers replace
+
+std::string StreamQuote(std::string_view value) {
+  std::stringstream ss;
+  ss << '"';
+
+  for (char byte : value) {
+    switch (byte) {
+      case '\\':
+      case '"':
+        ss << "\\" << byte;
+        break;
+      case '\n':
+        ss << "\\n";
+        break;
+      case '\r':
+        ss << "\\r";
+        break;
+      case '\t':
+        ss << "\\t";
+        break;
+      default:
+        if (byte < 0x20) {
+          ss << "\\u00" << std::hex << static_cast<int>(byte);
+        } else {
+          ss << byte;
+        }
+    }
+  }
+
+  ss << '"';
+
+  return ss.str();
+}
+
+std::string StreamHex(uint64_t value) {
+  std::stringstream ss;
+  ss << std::hex << value;
+  return ss.str();
+}
+
+std::string Quote(std::string_view value) {
+  std::string text;
+  txt::AppendQuoted(text, value);
+  return text;
+}
+
+std::string Float(double value) {
+  std::string text;
+  txt::AppendFloat(text, value);
+  return text;
+}
+
+}  // namespace
+
+TEST(Txt, TestQuoteMatchesStream) {
+  std::mt19937_64 rng(3);
+
+  for (size_t i = 0; i < 2000; ++i) {
+    std::string value(rng() % 70, ' ');
+
+    for (char& byte : value) {
+      // Mostly plain text with some of every escape class
+      byte = rng() % 4 == 0 ? char(rng() % 256) : char('a' + rng() % 26);
+    }
+
+    ASSERT_EQ(Quote(value), StreamQuote(value));
+    ASSERT_EQ(txt::FindEscape(value) == std::string::npos,
+              Quote(value).size() == value.size() + 2);
+  }
+
+  ASSERT_EQ(Quote(""), "\"\"");
+  ASSERT_EQ(Quote("a\x01\"\\\n"), "\"a\\u001\\\"\\\\\\n\"");
+}
+
+TEST(Txt, TestNumbersMatchStdForms) {
+  std::mt19937_64 rng(5);
+
+  for (size_t i = 0; i < 2000; ++i) {
+    int64_t value = int64_t(rng()) >> (rng() % 64);
+    double real = std::ldexp(double(value), int(rng() % 80) - 60);
+
+    std::string text;
+    txt::AppendInt(text, value);
+    ASSERT_EQ(text, std::to_string(value));
+    ASSERT_EQ(txt::ParseInt(text), value);
+
+    ASSERT_EQ(Float(real), std::to_string(real));
+
+    text.clear();
+    txt::AppendHex(text, uint64_t(value));
+    ASSERT_EQ(text, StreamHex(uint64_t(value)));
+    ASSERT_EQ(txt::ParseHex(text), uint64_t(value));
+  }
+
+  for (double value : {0.0, -0.0, 0.5e-6, 1e300, -1.0 / 3,
+                       std::numeric_limits<double>::max(),
+                       std::numeric_limits<double>::infinity()}) {
+    ASSERT_EQ(Float(value), std::to_string(value));
+  }
+
+  ASSERT_EQ(txt::ParseInt("  +42abc"), 42);
+  ASSERT_EQ(txt::ParseFloat("-1.5e3"), -1500);
+  ASSERT_THROW(txt::ParseInt("99999999999999999999"), std::runtime_error);
+  ASSERT_THROW(txt::ParseFloat("inf"), std::runtime_error);
+  ASSERT_THROW(txt::ParseHex("12g"), std::runtime_error);
+}
+
+TEST(Txt, TestUnquote) {
+  ASSERT_EQ(txt::Unquote("\"a\\tb\\\"c\\\\\""), "a\tb\"c\\");
+  ASSERT_EQ(txt::Unquote(Quote("plain\ntext")), "plain\ntext");
+  ASSERT_THROW(txt::Unquote("\"a\\\""), std::runtime_error);
+  ASSERT_THROW(txt::Unquote("\"\\x\""), std::runtime_error);
+  ASSERT_THROW(txt::Unquote("a"), std::runtime_error);
+}
+
+TEST(Txt, TestUtf8) {
+  constexpr size_t npos = std::string_view::npos;
+
+  ASSERT_EQ(txt::FindInvalidUtf8("plain ascii, long enough for a block"), npos);
+  ASSERT_EQ(txt::FindInvalidUtf8("\xd0\xbf\xe2\x82\xac\xf0\x9f\x98\x80"), npos);
+  ASSERT_EQ(txt::FindInvalidUtf8("\xf4\x8f\xbf\xbf"), npos);
+
+  // Overlong, surrogate, above U+10FFFF, stray continuation, cut off
+  ASSERT_EQ(txt::FindInvalidUtf8("ab\xc1\xbf"), 2);
+  ASSERT_EQ(txt::FindInvalidUtf8("\xe0\x9f\xbf"), 0);
+  ASSERT_EQ(txt::FindInvalidUtf8("\xed\xa0\x80"), 0);
+  ASSERT_EQ(txt::FindInvalidUtf8("\xf4\x90\x80\x80"), 0);
+  ASSERT_EQ(txt::FindInvalidUtf8("0123456789abcdef0123\x80"), 20);
+  ASSERT_EQ(txt::FindInvalidUtf8("0123456789abcdef\xe2\x82"), 16);
+}
+
+// Every error at every offset of text long enough for the vector
+// blocks, among ASCII and among multibyte characters
+TEST(Txt, TestUtf8Blocks) {
+  constexpr size_t npos = std::string_view::npos;
+  const char* bad[] = {"\xc1\xbf",         "\xe0\x9f\xbf", "\xed\xa0\x80",
+                       "\xf4\x90\x80\x80", "\x80",         "\xbf\xbf",
+                       "\xe2\x82",         "\xf0\x9f\x98", "\xf8"};
+
+  for (std::string fill : {"a", "\xd0\xbf", "\xe2\x82\xac", "\xf0\x9f\x98\x80"}) {
+    std::string suffix;
+
+    while (suffix.size() < 100) {
+      suffix += fill;
+    }
+
+    for (std::string prefix; prefix.size() < 100; prefix += fill) {
+      ASSERT_EQ(txt::FindInvalidUtf8(prefix + suffix), npos);
+
+      for (const char* error : bad) {
+        ASSERT_EQ(txt::FindInvalidUtf8(prefix + error + suffix),
+                  prefix.size())
+            << prefix.size() << " " << fill.size();
+        ASSERT_EQ(txt::FindInvalidUtf8(prefix + error), prefix.size());
+      }
+    }
+  }
+}
+
+TEST(Txt, TestIdText) {
+  for (const char* text : {"0", "1f", "a-1", "b-2-3", "fffff-ffffffff-fff"}) {
+    ASSERT_EQ(cmn::ToString(cmn::FromString(text)), text);
+  }
+
+  ASSERT_EQ(cmn::ToString(cmn::FromString("A-0")), "a-0");
+  ASSERT_THROW(cmn::FromString("1-2-3-4"), std::runtime_error);
+  ASSERT_THROW(cmn::FromString("1--2"), std::runtime_error);
+  ASSERT_THROW(cmn::FromString(""), std::runtime_error);
+}
+
+TEST(Txt, TestIdBatches) {
+  std::vector<cmn::Id> ids =
+      cmn::FromStrings("0,1f,a-1,b-2-3,fffff-ffffffff-fff");
+  ASSERT_EQ(ids.size(), 5);
+  ASSERT_EQ(ids[3], cmn::FromString("b-2-3"));
+
+  std::string text = "[";
+  cmn::AppendStrings(text, ids, ' ');
+  ASSERT_EQ(text, "[0 1f a-1 b-2-3 fffff-ffffffff-fff");
+  ASSERT_EQ(cmn::FromStrings(text.substr(1), ' '), ids);
+
+  tlv::BufferWriter writer;
+  cmn::WriteIds(writer, 'V', ids);
+  ll::Buffer tlv = writer.Extract();
+  ASSERT_EQ(cmn::ReadIds(tlv, 'V'), ids);
+  ASSERT_THROW(cmn::ReadIds(tlv, 'R'), std::runtime_error);
+
+  for (cmn::Id id : ids) {
+    uint8_t out[ll::kMaxZipLen];
+    size_t len = cmn::ZipTo(out, id);
+    ASSERT_EQ(ll::Bytes(out, out + len), cmn::Zip(id));
+    ASSERT_EQ(cmn::UnzipID(ll::Span(out, len)), id);
+  }
+
+  ASSERT_EQ(cmn::FromStrings(""), std::vector<cmn::Id>{});
+  ASSERT_EQ(cmn::FromStrings("1-2,").size(), 1);
+  ASSERT_THROW(cmn::FromStrings("1-2,,3"), std::runtime_error);
+  ASSERT_THROW(cmn::FromStrings("1-2 3"), std::runtime_error);
+  ASSERT_THROW(cmn::FromString(std::string_view("1-2\0", 4)),
+               std::runtime_error);
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include <random>
+#include <string>
+#include <vector>
+
+#include <isfr/types.hpp>
+#include <typed/register.hpp>
+
+namespace {
+
+ll::Buffer ToBuffer(const ll::Bytes& bytes) {
+  return ll::Buffer(bytes.begin(), bytes.end());
+}
+
+template <class T>
+void CheckMerge(const std::vector<T>& values,
+                ll::Bytes (*isfr_tlv)(T, isfr::Time),
+                ll::Bytes (*isfr_merge)(std::vector<ll::Bytes>)) {
+  std::mt19937_64 rng(7);
+  std::vector<ll::Bytes> bytes;
+  std::vector<ll::Buffer> buffers;
+
+  for (const T& value : values) {
+    isfr::Time time{int64_t(rng() % 5) - 2, rng() % 3};
+    bytes.push_back(isfr_tlv(value, time));
+    buffers.push_back(typed::Register<T>(value, time).Tlv());
+    ASSERT_EQ(buffers.back(), ToBuffer(bytes.back()));
+    ASSERT_EQ(buffers.back().size(),
+              typed::Register<T>(value, time).TlvSize());
+  }
+
+  std::vector<ll::Span> spans(buffers.begin(), buffers.end());
+  typed::Register<T> merged = typed::Register<T>::Merge(spans);
+  ll::Bytes expected = isfr_merge(bytes);
+  ASSERT_EQ(merged.Tlv(), ToBuffer(expected));
+
+  // Pairwise merging is order independent
+  typed::Register<T> reversed;
+
+  for (auto it = spans.rbegin(); it != spans.rend(); ++it) {
+    reversed.Merge(typed::Register<T>::Parse(*it));
+  }
+
+  ASSERT_EQ(reversed.Tlv(), merged.Tlv());
+}
+
+}  // namespace
+
+TEST(Typed, TestLiterals) {
+  static_assert(typed::IRegister::kLiteral == 'I');
+  static_assert(typed::FRegister::kLiteral == 'F');
+  static_assert(typed::RRegister::kLiteral == 'R');
+  static_assert(typed::SRegister::kLiteral == 'S');
+  static_assert(std::is_same_v<typed::NativeType<'S'>, std::string>);
+  static_assert(typed::MaxWidth('S') == 0);
+}
+
+TEST(Typed, TestMergeMatchesIsfr) {
+  CheckMerge<int64_t>({0, 5, -5, 1 << 20, 5, -1, 300}, isfr::Itlv,
+                      isfr::Imerge);
+  CheckMerge<double>({0.5, -2.25, 1e10, 0.5, 3.0}, isfr::Ftlv, isfr::Fmerge);
+  CheckMerge<std::string>({"a", "bb", "", "ab", "b"}, isfr::Stlv,
+                          isfr::Smerge);
+  CheckMerge<cmn::Id>({cmn::FromString("a-1"), cmn::FromString("b-2-3"),
+                       cmn::FromString("a-2"), cmn::FromString("1-1")},
+                      isfr::Rtlv, isfr::Rmerge);
+}
+
+TEST(Typed, TestDeltaAndString) {
+  typed::IRegister value(7, {-3, 4});
+  typed::IRegister delta = value.Delta(8);
+
+  ASSERT_EQ(delta.Tlv(), ToBuffer(isfr::Idelta(isfr::Itlv(7, {-3, 4}), 8)));
+  ASSERT_EQ(value.Merge(delta).Value(), 8);
+  ASSERT_EQ(value.String(), "8");
+
+  typed::SRegister text("say \"hi\"\n", {1, 1});
+  ASSERT_EQ(text.String(), isfr::Sstring(isfr::Stlv("say \"hi\"\n", {1, 1})));
+  ASSERT_EQ(typed::SRegister::Parse(text.Tlv()).Value(), text.Value());
+
+  cmn::Id id = cmn::FromString("b-2-3");
+  ASSERT_EQ(typed::RRegister(id).String(), "b-2-3");
+  ASSERT_EQ(typed::RRegister::Parse(typed::RRegister(id).Tlv()).Value(), id);
+  ASSERT_EQ(typed::FRegister(1.5).String(), isfr::Fstring(isfr::Ftlv(1.5)));
+
+  ASSERT_THROW(typed::IRegister::Parse(typed::SRegister("123456789").Tlv()),
+               std::runtime_error);
+}
@@ -0,0 +1,128 @@
+#include <gtest/gtest.h>
+
+#include <fstream>
+#include <iterator>
+#include <string>
+
+#include <ll/zipint.hpp>
+#include <tlv/io.hpp>
+#include <isfr/types.hpp>
+#include <mel/set.hpp>
+#include <vv/vv.hpp>
+#include <valid/validator.hpp>
+
+namespace {
+
+ll::Buffer ReadTestData(const std::string& name) {
+  std::ifstream file(std::string(TEST_DATA_DIR) + "/" + name,
+                     std::ios::binary);
+  return ll::Buffer(std::istreambuf_iterator<char>(file), {});
+}
+
+ll::Buffer Envelope(char literal, const ll::Buffer& body) {
+  tlv::BufferWriter writer;
+  writer.WriteRecord(literal, body);
+  return writer.Extract();
+}
+
+ll::Buffer ToBuffer(const ll::Bytes& bytes) {
+  return ll::Buffer(bytes.begin(), bytes.end());
+}
+
+// A FIRST body with a raw, possibly non-canonical value
+ll::Buffer First(const ll::Buffer& value) {
+  ll::Buffer body;
+  body.reserve(3 + value.size());
+  body.assign({0x32, 0x08, 0x05});
+  body.insert(body.end(), value.begin(), value.end());
+  return body;
+}
+
+}  // namespace
+
+TEST(Valid, TestTestData) {
+  for (const char* name : {"E0.tlv", "I0.tlv", "L0.tlv", "M0.tlv", "N0.tlv",
+                           "S0.tlv", "Z0.tlv"}) {
+    ll::Buffer data = ReadTestData(name);
+    ASSERT_FALSE(data.empty()) << name;
+    ASSERT_EQ(valid::Validate(data), std::nullopt) << name;
+  }
+
+  ll::Buffer versions = Envelope('V', vv::Vparse("a-1,b-2,c-3"));
+  ASSERT_EQ(valid::Validate(versions), std::nullopt);
+}
+
+TEST(Valid, TestFraming) {
+  ll::Buffer data = ReadTestData("E0.tlv");
+
+  ll::Buffer truncated(data.begin(), data.end() - 1);
+  auto error = valid::Validate(truncated);
+  ASSERT_TRUE(error);
+  ASSERT_STREQ(error->reason, "truncated record");
+
+  ll::Buffer bad = data;
+  bad.push_back('!');
+  error = valid::Validate(bad);
+  ASSERT_TRUE(error);
+  ASSERT_EQ(error->offset, data.size());
+}
+
+TEST(Valid, TestOverlongAndUtf8) {
+  // -11 zipped is 0x15; a trailing zero byte is overlong
+  ll::Buffer good = Envelope('I', First({0x15}));
+  ll::Buffer overlong = Envelope('I', First({0x15, 0x00}));
+  ASSERT_EQ(valid::Validate(good), std::nullopt);
+
+  auto error = valid::Validate(overlong);
+  ASSERT_TRUE(error);
+  ASSERT_EQ(error->offset, 5);
+  ASSERT_STREQ(error->reason, "overlong zipint");
+
+  ll::Buffer time_overlong = Envelope('T', {0x32, 0x08, 0x00});
+  ASSERT_STREQ(valid::Validate(time_overlong)->reason, "overlong timestamp");
+
+  ll::Buffer text = ToBuffer(isfr::Stlv("caf\xc3\xa9"));
+  ASSERT_EQ(valid::ValidateBody('S', text), std::nullopt);
+
+  // Overlong NUL, a surrogate and a cut sequence
+  for (ll::Buffer bytes : {ll::Buffer{0xc0, 0x80}, ll::Buffer{0xed, 0xa0, 0x80},
+                           ll::Buffer{'a', 0xe2, 0x82}}) {
+    ll::Buffer body = First(bytes);
+    error = valid::ValidateBody('S', body);
+    ASSERT_TRUE(error);
+    ASSERT_STREQ(error->reason, "invalid UTF-8");
+    ASSERT_EQ(body[error->offset] & 0x80, 0x80);
+  }
+}
+
+TEST(Valid, TestOrder) {
+  ll::Bytes one = ll::Zip(int64_t(1));
+  ll::Bytes two = ll::Zip(int64_t(2));
+  ll::Buffer one_body(one.begin(), one.end());
+  ll::Buffer two_body(two.begin(), two.end());
+
+  ll::Buffer sorted = mel::Etlv({{'I', {}, one_body, {}},
+                                 {'I', {}, two_body, {}}});
+  ASSERT_EQ(valid::ValidateBody('E', sorted), std::nullopt);
+
+  tlv::BufferWriter writer;
+  writer.WriteRecord('I', First(two_body));
+  writer.WriteRecord('I', First(one_body));
+  ll::Buffer unsorted = writer.Extract();
+
+  auto error = valid::ValidateBody('E', unsorted);
+  ASSERT_TRUE(error);
+  ASSERT_EQ(error->offset, 6);
+  ASSERT_STREQ(error->reason, "E elements out of order");
+
+  ll::Buffer key_only(unsorted.begin(), unsorted.begin() + 6);
+  ASSERT_STREQ(valid::ValidateBody('M', key_only)->reason,
+               "M key without a value");
+
+  tlv::BufferWriter vv_writer;
+  vv_writer.WriteRecord('V', ll::Buffer{0x01, 0x02});
+  vv_writer.WriteRecord('V', ll::Buffer{0x05, 0x01});
+  ll::Buffer versions = vv_writer.Extract();
+  ASSERT_STREQ(valid::ValidateBody('V', versions)->reason,
+               "V sources out of order");
+}
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+
+#include <utility>
+#include <vector>
+
+#include <ll/zipint.hpp>
+#include <tlv/io.hpp>
+#include <vv/vv.hpp>
+
+namespace {
+
+ll::Buffer Records(
+    const std::vector<std::pair<uint64_t, uint64_t>>& entries) {
+  tlv::BufferWriter writer;
+
+  for (auto [source, progress] : entries) {
+    ll::Bytes zipped = ll::Zip(progress, source);
+    writer.WriteRecord('V', ll::Buffer(zipped.begin(), zipped.end()));
+  }
+
+  return writer.Extract();
+}
+
+vv::VersionVector Vector(
+    const std::vector<std::pair<uint64_t, uint64_t>>& entries) {
+  return vv::Vnative(Records(entries));
+}
+
+}  // namespace
+
+TEST(VV, TestVmerge) {
+  ll::Buffer lhs = vv::Vparse("a-123,b-345");
+  ll::Buffer rhs = vv::Vparse("a-234,b-344,c-567");
+
+  ASSERT_EQ(lhs, Records({{0xa, 0x123}, {0xb, 0x345}}));
+  ASSERT_TRUE(vv::Vvalid(lhs));
+
+  ll::Buffer merged = vv::Vmerge({lhs, rhs});
+  ASSERT_EQ(merged, Records({{0xa, 0x234}, {0xb, 0x345}, {0xc, 0x567}}));
+  ASSERT_EQ(vv::Vstring(merged), "a-234,b-345,c-567");
+  ASSERT_EQ(vv::Vmerge({rhs, lhs}), merged);
+  ASSERT_EQ(vv::Vmerge({merged, merged}), merged);
+}
+
+TEST(VV, TestParseAndWrite) {
+  vv::VersionVector vector = Vector({{3, 1}, {1, 7}, {3, 5}, {2, 0}});
+
+  ASSERT_EQ(vector.Sources(), (std::vector<uint64_t>{1, 2, 3}));
+  ASSERT_EQ(vector.Progress(), (std::vector<uint64_t>{7, 0, 5}));
+  ASSERT_EQ(vector.Get(2), 0);
+  ASSERT_EQ(vector.Get(4), std::nullopt);
+  ASSERT_EQ(vector.Tlv(), Records({{1, 7}, {2, 0}, {3, 5}}));
+  ASSERT_EQ(vector.TlvSize(), vector.Tlv().size());
+
+  ASSERT_TRUE(vector.Put(cmn::FromString("4-1-2")));
+  ASSERT_FALSE(vector.Put(1, 6));
+  ASSERT_EQ(vector.String(), "1-7,2-0,3-5,4-1-2");
+
+  ASSERT_FALSE(vv::Vvalid(ll::Buffer{0x76, 0x07, 1, 2, 3, 4, 5, 6, 7}));
+  ASSERT_FALSE(vv::Vvalid(ll::Buffer{0x69, 0x01, 1}));
+}
+
+TEST(VV, TestQueries) {
+  vv::VersionVector lhs = Vector({{1, 5}, {2, 3}, {3, 9}});
+  vv::VersionVector same = Vector({{1, 5}, {2, 4}, {3, 1}});
+  vv::VersionVector other = Vector({{2, 3}, {4, 0}, {5, 1}});
+
+  ASSERT_TRUE(lhs.Dominates(lhs));
+  ASSERT_FALSE(lhs.Dominates(same));
+  ASSERT_FALSE(lhs.Dominates(other));
+  ASSERT_TRUE(lhs.Dominates(Vector({{2, 3}, {4, 0}})));
+  ASSERT_TRUE(other.Dominates({}));
+
+  ASSERT_EQ(lhs.Difference(same), Vector({{3, 9}}));
+  ASSERT_EQ(lhs.Difference(other), Vector({{1, 5}, {3, 9}}));
+  ASSERT_EQ(other.Difference(lhs), Vector({{4, 0}, {5, 1}}));
+
+  ASSERT_EQ(lhs.Intersection(same), Vector({{1, 5}, {2, 3}, {3, 1}}));
+  ASSERT_EQ(lhs.Intersection(other), Vector({{2, 3}}));
+
+  vv::VersionVector merged = lhs;
+  merged.Merge(same);
+  ASSERT_EQ(merged, Vector({{1, 5}, {2, 4}, {3, 9}}));
+  merged.Merge(other);
+  ASSERT_EQ(merged, Vector({{1, 5}, {2, 4}, {3, 9}, {4, 0}, {5, 1}}));
+  ASSERT_TRUE(merged.Dominates(lhs) && merged.Dominates(other));
+
+  ll::Buffer delta = vv::Vdelta(lhs.Tlv(), merged);
+  ASSERT_EQ(vv::Vnative(delta), Vector({{2, 4}, {4, 0}, {5, 1}}));
+  ASSERT_EQ(vv::Vmerge({lhs.Tlv(), delta}), merged.Tlv());
+}
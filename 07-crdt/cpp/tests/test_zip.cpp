@@ -61,3 +61,38 @@ TEST(ZipInt, TestZipIU64Pair) {
   ASSERT_EQ(a, i);
   ASSERT_EQ(b, u);
 }
+
+TEST(ZipInt, TestZipToMatchesZip) {
+  std::vector<uint64_t> nums = {
+      0, 0xca, 0xbeff, 0x12345678, 0x7777777788888888,
+  };
+
+  for (uint64_t big : nums) {
+    for (uint64_t lil : nums) {
+      ll::Bytes bin = ll::Zip(big, lil);
+
+      uint8_t out[ll::kMaxZipLen];
+      size_t len = ll::ZipTo(out, big, lil);
+      ASSERT_EQ(len, ll::ZipLen(big, lil));
+      ASSERT_EQ(ll::Bytes(out, out + len), bin);
+
+      auto [rbig, rlil] = ll::UnzipU64Pair(ll::Span(out, len));
+      ASSERT_EQ(rbig, big);
+      ASSERT_EQ(rlil, lil);
+    }
+  }
+
+  for (int64_t i : {int64_t(0), int64_t(-11), int64_t(1) << 40}) {
+    uint8_t out[ll::kMaxZipLen];
+    size_t len = ll::ZipTo(out, i);
+    ASSERT_EQ(ll::Bytes(out, out + len), ll::Zip(i));
+    ASSERT_EQ(ll::UnzipI64(ll::Span(out, len)), i);
+  }
+
+  for (double d : {0.0, 1.0, 12.25, -3.1415}) {
+    uint8_t out[ll::kMaxZipLen];
+    size_t len = ll::ZipTo(out, d);
+    ASSERT_EQ(ll::Bytes(out, out + len), ll::Zip(d));
+    ASSERT_EQ(ll::UnzipDouble(ll::Span(out, len)), d);
+  }
+}
@@ -0,0 +1,40 @@
+#include <fstream>
+#include <iostream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+#include <gen/schema.hpp>
+
+// rdxgen SCHEMA OUTPUT [NAMESPACE]: a C++ header of gen::Object views
+// and gen::Delta builders for the classes of the schema
+int main(int argc, char** argv) {
+  if (argc != 3 && argc != 4) {
+    std::cerr << "Usage: rdxgen SCHEMA OUTPUT [NAMESPACE]\n";
+    return 2;
+  }
+
+  try {
+    std::ifstream input(argv[1]);
+
+    if (!input) {
+      throw std::runtime_error(std::string("Can not read ") + argv[1]);
+    }
+
+    std::string text(std::istreambuf_iterator<char>(input), {});
+    std::string header =
+        gen::Generate(gen::ParseSchema(text), argc == 4 ? argv[3] : "rdx");
+
+    std::ofstream output(argv[2]);
+    output << header;
+
+    if (!output) {
+      throw std::runtime_error(std::string("Can not write ") + argv[2]);
+    }
+  } catch (const std::exception& error) {
+    std::cerr << argv[1] << ": " << error.what() << "\n";
+    return 1;
+  }
+
+  return 0;
+}
@@ -0,0 +1,59 @@
+#include <charconv>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+#include <replay/corpus.hpp>
+
+namespace {
+
+template <class T>
+T Number(std::string_view text) {
+  T value{};
+  auto [end, error] =
+      std::from_chars(text.data(), text.data() + text.size(), value);
+
+  if (error != std::errc() || end != text.data() + text.size()) {
+    throw std::runtime_error("Not a number: " + std::string(text));
+  }
+
+  return value;
+}
+
+}  // namespace
+
+// replaygen OUTPUT OPS [REPLICAS [CONFLICT_RATE [SEED]]]: a replay
+// corpus for bench_replay, see replay/corpus.hpp
+int main(int argc, char** argv) {
+  if (argc < 3 || argc > 6) {
+    std::cerr << "Usage: replaygen OUTPUT OPS [REPLICAS [CONFLICT_RATE "
+                 "[SEED]]]\n";
+    return 2;
+  }
+
+  try {
+    replay::CorpusOptions options;
+    // 1e8 reads better than 100000000
+    options.ops = uint64_t(Number<double>(argv[2]));
+
+    if (argc > 3) {
+      options.replicas = Number<uint32_t>(argv[3]);
+    }
+
+    if (argc > 4) {
+      options.conflict_rate = Number<double>(argv[4]);
+    }
+
+    if (argc > 5) {
+      options.seed = Number<uint64_t>(argv[5]);
+    }
+
+    replay::Generate(argv[1], options);
+  } catch (const std::exception& error) {
+    std::cerr << argv[1] << ": " << error.what() << "\n";
+    return 1;
+  }
+
+  return 0;
+}
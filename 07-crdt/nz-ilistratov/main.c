@@ -164,7 +164,75 @@ void TestZ() {
   puts("================ TEST [Z] FINISHED ================\n");
 }
 
+/// More inputs than the k-way merge keeps on the stack; input i has
+/// the sources i..i+2; source s wins from the first input it is in
+void TestMergeMany() {
+  puts("================ TEST [MERGE MANY] STARTED ================");
+
+  enum { kInputs = 100 };
+  struct Bytes n_tlvs[kInputs];
+  struct Bytes z_tlvs[kInputs];
+  for (uint64_t i = 0; i < kInputs; i++) {
+    struct URecord u_arr[3];
+    struct IRecord i_arr[3];
+    for (uint64_t j = 0; j < 3; j++) {
+      uint64_t src = i + j;
+      u_arr[j] = (struct URecord){ src * 3 + (2 - j), src };
+      /// the same revision everywhere: the values decide, negative ones
+      i_arr[j] = (struct IRecord){ 1, src, -(int64_t)(src * 3 + j) };
+    }
+    n_tlvs[i] = Ntlv((struct NRecord){ .data = u_arr, .size = 3 });
+    z_tlvs[i] = Ztlv((struct ZRecord){ .data = i_arr, .size = 3 });
+  }
+
+  uint64_t n_expected = 0;
+  int64_t z_expected = 0;
+  for (uint64_t src = 0; src < kInputs + 2; src++) {
+    uint64_t j = src < kInputs ? 0 : src - kInputs + 1;
+    n_expected += src * 3 + (2 - j);
+    z_expected -= src * 3 + j;
+  }
+
+  uint64_t n_sum = 0;
+  struct Bytes n_merged = NmergeSum(n_tlvs, kInputs, &n_sum);
+  assert(n_sum == n_expected);
+  assert(Nnative(n_merged) == n_expected);
+
+  int64_t z_sum = 0;
+  struct Bytes z_merged = ZmergeSum(z_tlvs, kInputs, &z_sum);
+  assert(z_sum == z_expected);
+  assert(Znative(z_merged) == z_expected);
+
+  /// an unsorted input takes the pairwise path, same result
+  struct URecord unsorted_arr[] = {
+    { 7ull, 5ull },
+    { 9ull, 1ull },
+  };
+  struct Bytes unsorted =
+      Ntlv((struct NRecord){ .data = unsorted_arr, .size = 2 });
+  struct Bytes sorted = Nparse("2 9 1 7 5");
+  const struct Bytes pair1[2] = {n_tlvs[0], unsorted};
+  const struct Bytes pair2[2] = {n_tlvs[0], sorted};
+  struct Bytes merged1 = Nmerge(pair1, 2);
+  struct Bytes merged2 = Nmerge(pair2, 2);
+  assert(Equals(merged1, merged2));
+
+  for (size_t i = 0; i < kInputs; i++) {
+    free(n_tlvs[i].data);
+    free(z_tlvs[i].data);
+  }
+  free(n_merged.data);
+  free(z_merged.data);
+  free(unsorted.data);
+  free(sorted.data);
+  free(merged1.data);
+  free(merged2.data);
+
+  puts("================ TEST [MERGE MANY] FINISHED ================\n");
+}
+
 int main(void) {
   TestN();
   TestZ();
+  TestMergeMany();
 }
@@ -13,6 +13,7 @@
 
 struct NRecord InvalidateNRecord(struct NRecord *rec) {
   free(rec->data);
+  rec->data = NULL;
   rec->size = 0;
   return *rec;
 }
@@ -51,7 +52,7 @@ struct NRecord NRecordFromBytes(const struct Bytes tlv) {
       tlv.len - offset
     };
     const struct RecordHeader u_hdr = ProbeHeader2(u_tlv);
-    if (tolower(u_hdr.lit) != 'u' && !isdigit(n_hdr.lit)) {
+    if (tolower(u_hdr.lit) != 'u' && !isdigit(u_hdr.lit)) {
       return InvalidateNRecord(&res);
     }
     int u_tlv_len = u_hdr.hdrlen + u_hdr.bodylen;
@@ -64,7 +65,8 @@ struct NRecord NRecordFromBytes(const struct Bytes tlv) {
     res.data[res.size].src = u_rec.r1;
     ++res.size;
     if (res.size == cap) {
-      res.data = realloc(res.data, cap * 2 * sizeof(struct URecord));
+      cap *= 2;
+      res.data = realloc(res.data, cap * sizeof(struct URecord));
     }
   }
   res.data = realloc(res.data, res.size * sizeof(struct URecord));
@@ -228,7 +230,7 @@ struct NRecord NRecordMerge(struct NRecord lhs, struct NRecord rhs) {
     }
     result_rec.data[dst] = lhs.data[it_l];
     if (lhs.data[it_l].val < rhs.data[it_r].val) {
-      result_rec.data[dst] = lhs.data[it_r];
+      result_rec.data[dst] = rhs.data[it_r];
     }
     ++it_l;
     ++it_r;
@@ -243,18 +245,23 @@ struct NRecord NRecordMerge(struct NRecord lhs, struct NRecord rhs) {
   return result_rec;
 }
 
-const struct Bytes Nmerge(const struct Bytes tlvs[], size_t tlvs_len) {
-  if (tlvs_len == 1) {
-    return tlvs[0];
-  }
+/// The pairwise merge, for inputs the k-way one can not take
+const struct Bytes NmergePairwise(const struct Bytes tlvs[], size_t tlvs_len,
+                                  uint64_t* sum) {
   struct NRecord res_n_rec = NRecordFromBytes(tlvs[0]);
   for (size_t tlv_idx = 1; tlv_idx < tlvs_len; tlv_idx++) {
-    struct NRecord next_rec = NRecordFromBytes(tlvs[1]);
+    struct NRecord next_rec = NRecordFromBytes(tlvs[tlv_idx]);
     struct NRecord merged_rec = NRecordMerge(res_n_rec, next_rec);
     InvalidateNRecord(&res_n_rec);
     InvalidateNRecord(&next_rec);
     res_n_rec = merged_rec;
   }
+  if (sum != NULL) {
+    *sum = 0;
+    for (uint32_t rec_idx = 0; rec_idx < res_n_rec.size; rec_idx++) {
+      *sum += res_n_rec.data[rec_idx].val;
+    }
+  }
   struct Bytes res = Ntlv(res_n_rec);
   InvalidateNRecord(&res_n_rec);
   return res;
@@ -262,6 +269,7 @@ const struct Bytes Nmerge(const struct Bytes tlvs[], size_t tlvs_len) {
 
 struct ZRecord InvalidateZRecord(struct ZRecord* rec) {
   free(rec->data);
+  rec->data = NULL;
   rec->size = 0;
   return *rec;
 }
@@ -276,9 +284,12 @@ int IRecCmp(const void* lhs, const void* rhs) {
     return 1;
   }
   if (rec_l->rev != rec_r->rev) {
-    return rec_l->rev - rec_r->rev;
+    return rec_l->rev < rec_r->rev ? -1 : 1;
   }
-  return rec_l->val - rec_r->val;
+  if (rec_l->val != rec_r->val) {
+    return rec_l->val < rec_r->val ? -1 : 1;
+  }
+  return 0;
 }
 
 struct ZRecord ZRecordFromBytes(struct Bytes tlv) {
@@ -321,7 +332,8 @@ struct ZRecord ZRecordFromBytes(struct Bytes tlv) {
     res.data[res.size] = i_rec;
     res.size += 1;
     if (res.size == cap) {
-      res.data = realloc(res.data, cap * 2 * sizeof(struct IRecord));
+      cap *= 2;
+      res.data = realloc(res.data, cap * sizeof(struct IRecord));
     }
   }
   res.data = realloc(res.data, res.size * sizeof(struct IRecord));
@@ -481,9 +493,9 @@ struct ZRecord ZRecordMerge(const struct ZRecord lhs, const struct ZRecord rhs)
       continue;
     }
     if (IRecCmp(lhs.data + it_l, rhs.data + it_r) < 0) {
-      res.data[dst] = rhs.data[it_l];  
+      res.data[dst] = rhs.data[it_r];
     } else {
-      res.data[dst] = lhs.data[it_l];  
+      res.data[dst] = lhs.data[it_l];
     }
     ++it_l;
     ++it_r;
@@ -498,19 +510,248 @@ struct ZRecord ZRecordMerge(const struct ZRecord lhs, const struct ZRecord rhs)
   return res;
 }
 
-const struct Bytes Zmerge(const struct Bytes tlvs[], size_t tlvs_len) {
-  if (tlvs_len == 1) {
-    return tlvs[0];
-  }
+/// The pairwise merge, for inputs the k-way one can not take
+const struct Bytes ZmergePairwise(const struct Bytes tlvs[], size_t tlvs_len,
+                                  int64_t* sum) {
   struct ZRecord res_n_rec = ZRecordFromBytes(tlvs[0]);
   for (size_t tlv_idx = 1; tlv_idx < tlvs_len; tlv_idx++) {
-    struct ZRecord next_rec = ZRecordFromBytes(tlvs[1]);
+    struct ZRecord next_rec = ZRecordFromBytes(tlvs[tlv_idx]);
     struct ZRecord merged_rec = ZRecordMerge(res_n_rec, next_rec);
     InvalidateZRecord(&res_n_rec);
     InvalidateZRecord(&next_rec);
     res_n_rec = merged_rec;
   }
+  if (sum != NULL) {
+    *sum = 0;
+    for (uint32_t rec_idx = 0; rec_idx < res_n_rec.size; rec_idx++) {
+      *sum += res_n_rec.data[rec_idx].val;
+    }
+  }
   struct Bytes res = Ztlv(res_n_rec);
   InvalidateZRecord(&res_n_rec);
   return res;
 }
+
+////////////////////////////////////////////////////////////////////
+/// K-way merge
+///
+/// Every input is read in place by a cursor; a heap of cursors keyed
+/// on (src, input) yields the contributions in src order, and the
+/// winner of every src is copied as it is into one output buffer.
+/// Canonical inputs, the ones Ntlv/Ztlv and the merges write, are
+/// sorted by src; an input that is not, or is malformed, sends the
+/// whole merge to the pairwise path, which sorts.
+
+enum { kStackInputs = 64 };
+
+struct Cursor {
+  struct Bytes tlv;
+  size_t offset;
+  /// the current contribution; `rev` is 0 for N
+  uint64_t src;
+  int64_t rev;
+  uint64_t val;
+  const char* body;
+  size_t bodylen;
+};
+
+/// Opens the cursor past the outer `lit` header; false if malformed
+bool CursorOpen(struct Cursor* cur, const struct Bytes tlv, char lit) {
+  const struct RecordHeader hdr = ReadHeader(tlv.data, tlv.len);
+  cur->tlv = tlv;
+  cur->offset = hdr.hdrlen;
+  cur->src = 0;
+  return (hdr.lit == lit || hdr.lit == '0') &&
+         (size_t)hdr.hdrlen + hdr.bodylen == tlv.len;
+}
+
+/// Reads the next contribution of a `u` (N) or `i` (Z) record.
+/// Returns 1 on success, 0 at the end, -1 on malformed or unsorted
+/// input.
+int CursorNext(struct Cursor* cur, char lit) {
+  if (cur->offset == cur->tlv.len) {
+    return 0;
+  }
+  const char* data = cur->tlv.data + cur->offset;
+  size_t len = cur->tlv.len - cur->offset;
+  const struct RecordHeader hdr = ReadHeader(data, len);
+  if ((hdr.lit != lit && hdr.lit != '0') ||
+      (size_t)hdr.hdrlen + hdr.bodylen > len) {
+    return -1;
+  }
+  const bool first = cur->body == NULL;
+  const uint64_t prev_src = cur->src;
+  cur->body = data + hdr.hdrlen;
+  cur->bodylen = hdr.bodylen;
+  cur->offset += hdr.hdrlen + hdr.bodylen;
+  if (lit == 'U') {
+    cur->rev = 0;
+    if (!UnzipPair(cur->body, cur->bodylen, &cur->val, &cur->src)) {
+      return -1;
+    }
+  } else {
+    const struct RecordHeader t_hdr = ReadHeader(cur->body, cur->bodylen);
+    size_t t_len = t_hdr.hdrlen + t_hdr.bodylen;
+    uint64_t rev = 0;
+    if (t_hdr.hdrlen == 0 || t_len > cur->bodylen ||
+        cur->bodylen - t_len > 8 ||
+        !UnzipPair(cur->body + t_hdr.hdrlen, t_hdr.bodylen, &rev,
+                   &cur->src)) {
+      return -1;
+    }
+    cur->rev = ZagZig(rev);
+    cur->val = UnzipU64(cur->body + t_len, cur->bodylen - t_len);
+  }
+  return first || cur->src > prev_src ? 1 : -1;
+}
+
+/// Whether the contribution of `a` wins over the one of `b`, same src
+bool CursorWins(const struct Cursor* a, const struct Cursor* b, char lit) {
+  if (lit == 'U') {
+    return a->val > b->val;
+  }
+  if (a->rev != b->rev) {
+    return a->rev > b->rev;
+  }
+  return ZagZig(a->val) > ZagZig(b->val);
+}
+
+bool HeapLess(const struct Cursor* curs, uint32_t a, uint32_t b) {
+  return curs[a].src != curs[b].src ? curs[a].src < curs[b].src : a < b;
+}
+
+void HeapDown(const struct Cursor* curs, uint32_t* heap, size_t size,
+              size_t pos) {
+  for (;;) {
+    size_t min = pos;
+    size_t left = 2 * pos + 1;
+    if (left < size && HeapLess(curs, heap[left], heap[min])) {
+      min = left;
+    }
+    if (left + 1 < size && HeapLess(curs, heap[left + 1], heap[min])) {
+      min = left + 1;
+    }
+    if (min == pos) {
+      return;
+    }
+    uint32_t tmp = heap[pos];
+    heap[pos] = heap[min];
+    heap[min] = tmp;
+    pos = min;
+  }
+}
+
+/// The k-way merge of `U` or `I` contributions under an `lit` outer
+/// record; sums the winners' values into `sum`. False if the inputs
+/// need the pairwise path, nothing is returned then.
+bool MergeKWay(const struct Bytes tlvs[], size_t tlvs_len, char lit,
+               char inner_lit, struct Bytes* res, uint64_t* sum) {
+  struct Cursor stack_curs[kStackInputs];
+  uint32_t stack_heap[kStackInputs];
+  struct Cursor* curs = stack_curs;
+  uint32_t* heap = stack_heap;
+  if (tlvs_len > kStackInputs) {
+    curs = malloc(tlvs_len * (sizeof(struct Cursor) + sizeof(uint32_t)));
+    heap = (uint32_t*)(curs + tlvs_len);
+  }
+
+  size_t cap = 5;
+  size_t size = 0;
+  bool ok = true;
+  for (size_t idx = 0; idx < tlvs_len && ok; idx++) {
+    cap += tlvs[idx].len;
+    curs[idx].body = NULL;
+    ok = CursorOpen(&curs[idx], tlvs[idx], lit);
+    int got = ok ? CursorNext(&curs[idx], inner_lit) : -1;
+    ok = got >= 0;
+    if (got == 1) {
+      heap[size++] = idx;
+    }
+  }
+  for (size_t pos = size / 2; pos-- > 0;) {
+    HeapDown(curs, heap, size, pos);
+  }
+
+  /// the body goes after the longest header, moved back at the end
+  char* out = ok ? malloc(cap) : NULL;
+  size_t bodylen = 0;
+  *sum = 0;
+  while (ok && size > 0) {
+    /// every cursor at `src` comes to the top in turn as it advances;
+    /// the inputs stay put, so the winner is kept by its body
+    const uint64_t src = curs[heap[0]].src;
+    struct Cursor best = curs[heap[0]];
+    while (size > 0 && curs[heap[0]].src == src) {
+      struct Cursor* top = &curs[heap[0]];
+      if (CursorWins(top, &best, inner_lit)) {
+        best = *top;
+      }
+      int got = CursorNext(top, inner_lit);
+      if (got < 0) {
+        ok = false;
+        break;
+      }
+      if (got == 0) {
+        heap[0] = heap[--size];
+      }
+      HeapDown(curs, heap, size, 0);
+    }
+    if (!ok) {
+      break;
+    }
+    char* dst = out + 5 + bodylen;
+    size_t hdrlen = WriteHeader(dst, inner_lit + ('a' - 'A'), best.bodylen);
+    memcpy(dst + hdrlen, best.body, best.bodylen);
+    bodylen += hdrlen + best.bodylen;
+    *sum += inner_lit == 'U' ? best.val : (uint64_t)ZagZig(best.val);
+  }
+
+  if (curs != stack_curs) {
+    free(curs);
+  }
+  if (!ok) {
+    free(out);
+    return false;
+  }
+  char header[5];
+  size_t hdrlen = WriteHeader(header, lit + ('a' - 'A'), bodylen);
+  memmove(out + hdrlen, out + 5, bodylen);
+  memcpy(out, header, hdrlen);
+  res->data = out;
+  res->len = hdrlen + bodylen;
+  return true;
+}
+
+const struct Bytes NmergeSum(const struct Bytes tlvs[], size_t tlvs_len,
+                             uint64_t* sum) {
+  struct Bytes res;
+  uint64_t native = 0;
+  if (!MergeKWay(tlvs, tlvs_len, 'N', 'U', &res, &native)) {
+    return NmergePairwise(tlvs, tlvs_len, sum);
+  }
+  if (sum != NULL) {
+    *sum = native;
+  }
+  return res;
+}
+
+const struct Bytes Nmerge(const struct Bytes tlvs[], size_t tlvs_len) {
+  return NmergeSum(tlvs, tlvs_len, NULL);
+}
+
+const struct Bytes ZmergeSum(const struct Bytes tlvs[], size_t tlvs_len,
+                             int64_t* sum) {
+  struct Bytes res;
+  uint64_t native = 0;
+  if (!MergeKWay(tlvs, tlvs_len, 'Z', 'I', &res, &native)) {
+    return ZmergePairwise(tlvs, tlvs_len, sum);
+  }
+  if (sum != NULL) {
+    *sum = (int64_t)native;
+  }
+  return res;
+}
+
+const struct Bytes Zmerge(const struct Bytes tlvs[], size_t tlvs_len) {
+  return ZmergeSum(tlvs, tlvs_len, NULL);
+}
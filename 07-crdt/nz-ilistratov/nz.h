@@ -27,6 +27,11 @@ uint64_t Nnative(const struct Bytes tlv);
 
 struct Bytes Ndelta(const struct Bytes old_tlv, struct NRecord new_vals);
 
+/// The merge of all the inputs at once, always a new buffer. Also
+/// stores the Nnative of the result into `sum` unless it is NULL.
+const struct Bytes NmergeSum(const struct Bytes tlvs[], size_t tlvs_len,
+                             uint64_t* sum);
+
 const struct Bytes Nmerge(const struct Bytes tlvs[], size_t tlvs_len);
 
 struct IRecord {
@@ -52,4 +57,8 @@ int64_t Znative(const struct Bytes tlv);
 
 struct Bytes Zdelta(const struct Bytes old_tlv, struct ZRecord new_vals);
 
+/// Same as NmergeSum, the Znative of the result into `sum`
+const struct Bytes ZmergeSum(const struct Bytes tlvs[], size_t tlvs_len,
+                             int64_t* sum);
+
 const struct Bytes Zmerge(const struct Bytes tlvs[], size_t tlvs_len);
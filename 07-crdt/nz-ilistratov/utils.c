@@ -1,5 +1,6 @@
 #include "utils.h"
 
+#include <stdbool.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <string.h>
@@ -40,3 +41,73 @@ void LittleEndianPutUint32(char* out, uint32_t v) {
     out[i] = (char)(v >> (8 * i));
   }
 }
+
+struct RecordHeader ReadHeader(const char* data, size_t len) {
+  struct RecordHeader hdr = {.lit = 0, .hdrlen = 0, .bodylen = 0};
+  if (len == 0) {
+    return hdr;
+  }
+  char lit = data[0];
+  if (lit >= '0' && lit <= '9') {
+    hdr.lit = '0';
+    hdr.hdrlen = 1;
+    hdr.bodylen = lit - '0';
+  } else if (lit >= 'a' && lit <= 'z') {
+    if (len >= 2) {
+      hdr.lit = lit - ('a' - 'A');
+      hdr.hdrlen = 2;
+      hdr.bodylen = (uint8_t)data[1];
+    }
+  } else if (lit >= 'A' && lit <= 'Z') {
+    if (len >= 5) {
+      uint32_t bodylen = LittleEndianUint32(data + 1);
+      hdr.lit = bodylen > 0x7fffffff ? '-' : lit;
+      hdr.hdrlen = bodylen > 0x7fffffff ? 0 : 5;
+      hdr.bodylen = bodylen > 0x7fffffff ? 0 : (int32_t)bodylen;
+    }
+  } else {
+    hdr.lit = '-';
+  }
+  return hdr;
+}
+
+size_t WriteHeader(char* out, char lit, size_t bodylen) {
+  if (bodylen < 10) {
+    out[0] = (char)('0' + bodylen);
+    return 1;
+  }
+  if (bodylen <= 0xff) {
+    out[0] = lit;
+    out[1] = (char)bodylen;
+    return 2;
+  }
+  out[0] = (char)(lit - ('a' - 'A'));
+  LittleEndianPutUint32(out + 1, (uint32_t)bodylen);
+  return 5;
+}
+
+uint64_t UnzipU64(const char* data, size_t len) {
+  uint64_t v = 0;
+  for (size_t i = len; i > 0; --i) {
+    v = (v << 8) | (uint8_t)data[i - 1];
+  }
+  return v;
+}
+
+bool UnzipPair(const char* data, size_t len, uint64_t* big, uint64_t* lil) {
+  /// byte widths of `big` by the pair length, 0 for no such pair
+  static const uint8_t kBigLen[17] = {0, 1, 1, 2, 2, 4, 4, 0, 4,
+                                      8, 8, 0, 8, 0, 0, 0, 8};
+  if (len > 16 || (len != 0 && kBigLen[len] == 0)) {
+    return false;
+  }
+  *big = UnzipU64(data, kBigLen[len]);
+  *lil = UnzipU64(data + kBigLen[len], len - kBigLen[len]);
+  return true;
+}
+
+int64_t ZagZig(uint64_t u) {
+  uint64_t half = u >> 1;
+  uint64_t mask = -(u & 1);
+  return (int64_t)(half ^ mask);
+}
@@ -11,3 +11,18 @@ void PrintStringBytes(const char* name, const char* txt);
 uint32_t LittleEndianUint32(const char* data);
 
 void LittleEndianPutUint32(char* out, uint32_t v);
+
+/// Same as ProbeHeader2, without a call into Go and its copy
+/// of the data: `lit` is 0 for an incomplete header, '-' for a bad one
+struct RecordHeader ReadHeader(const char* data, size_t len);
+
+/// Writes the header Record() would write for a lower-case `lit`,
+/// at most 5 bytes; returns its length
+size_t WriteHeader(char* out, char lit, size_t bodylen);
+
+/// UnzipUint64Pair in C; false on a length no pair can have
+bool UnzipPair(const char* data, size_t len, uint64_t* big, uint64_t* lil);
+
+uint64_t UnzipU64(const char* data, size_t len);
+
+int64_t ZagZig(uint64_t u);